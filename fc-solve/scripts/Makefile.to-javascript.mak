@@ -75,6 +75,10 @@ move_funcs_order.c \
 preset.c \
 scans.c \
 simpsim.c \
+specialized_moves__bakers_game.c \
+specialized_moves__freecell.c \
+specialized_moves__seahaven_towers.c \
+specialized_moves__simple_simon.c \
 split_cmd_line.c \
 state.c \
 $(PATS_C_FILES)
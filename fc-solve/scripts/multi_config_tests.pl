@@ -695,6 +695,23 @@ reg_tatzer_test(
     },
     qw(--without-depth-field --rcs)
 );
+reg_test(
+    {
+        blurb          => "FCS_RECONSTRUCT_MOVES",
+        randomly_avoid => $TRUE,
+    },
+    {
+        cmake_args         => ['-DFCS_RECONSTRUCT_MOVES=1'],
+        extra_test_command => [
+            (
+                map { ; ( "--execute", $_ ) } (
+                    $^X,
+"$CWD/../../cpan/Games-Solitaire-Verify/benchmark/sanity-test.pl",
+                )
+            ),
+        ],
+    },
+);
 reg_theme_test(
     {
         blurb          => "No FCS_SINGLE_HARD_THREAD",
@@ -6,7 +6,27 @@
 //
 // Copyright (c) 2000 Shlomi Fish
 #include <rinutils/longlong.h>
+#include "freecell-solver/config.h"
 #include "gen_ms_boards__find_deal.h"
+#ifdef FCS_HAVE_PTHREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+static inline bool is_deal_matching(
+    const fc_solve_ms_deal_idx_type deal_idx, const uint_fast32_t *const ints)
+{
+    microsoft_rand seedx = microsoft_rand__calc_init_seedx(deal_idx);
+    const uint_fast32_t *ptr = ints;
+    for (uint_fast32_t n = 4 * 13; n > 1; --n, ++ptr)
+    {
+        if (microsoft_rand__game_num_rand(&seedx, deal_idx) % n != *ptr)
+        {
+            return false;
+        }
+    }
+    return true;
+}
 
 long long DLLEXPORT __attribute__((pure)) fc_solve_find_deal_in_range(
     const fc_solve_ms_deal_idx_type start, const fc_solve_ms_deal_idx_type end,
@@ -15,26 +35,231 @@ long long DLLEXPORT __attribute__((pure)) fc_solve_find_deal_in_range(
     for (fc_solve_ms_deal_idx_type deal_idx = (microsoft_rand)start;
          deal_idx <= end; ++deal_idx)
     {
-        microsoft_rand seedx = microsoft_rand__calc_init_seedx(deal_idx);
-        const uint_fast32_t *ptr = ints;
-        for (uint_fast32_t n = 4 * 13; n > 1; --n, ++ptr)
+        if (is_deal_matching(deal_idx, ints))
+        {
+            return (long long)deal_idx;
+        }
+    }
+    return -1;
+}
+
+// The deals are checked FIND_DEAL_LANES at a time against the first
+// FIND_DEAL_NUM_VEC_INTS ints, which rules out all but one in
+// 52 * 51 of them, and the rest are checked one by one. Only bits 16 to 31 of
+// the seeds are used, so they are kept in 32 bits.
+#define FIND_DEAL_LANES 16
+#define FIND_DEAL_NUM_VEC_INTS 2
+typedef uint32_t find_deal_vec
+    __attribute__((vector_size(FIND_DEAL_LANES * sizeof(uint32_t))));
+typedef int32_t find_deal_signed_vec
+    __attribute__((vector_size(FIND_DEAL_LANES * sizeof(int32_t))));
+
+// The deals above 2^32 are drawn with the 16 bits of microsoft_rand_randp()
+// plus one, and the ones between 2^31 and 2^32 have their 16th bit set.
+typedef struct
+{
+    uint32_t mask, or_bits, add;
+} find_deal_draw;
+
+static inline find_deal_draw calc_find_deal_draw(
+    const fc_solve_ms_deal_idx_type deal_idx)
+{
+    return ((deal_idx < 0x80000000ULL)
+                ? (find_deal_draw){.mask = 0x7fff, .or_bits = 0, .add = 0}
+            : (deal_idx < 0x100000000ULL)
+                ? (find_deal_draw){.mask = 0x7fff, .or_bits = 0x8000, .add = 0}
+                : (find_deal_draw){.mask = 0xffff, .or_bits = 0, .add = 1});
+}
+
+// Returns the first deal between start and end, which should all be drawn
+// in the same way, that matches the ints, or -1.
+//
+// A draw r matches the int t of n only if n divides r - t, which is the case
+// iff (r - t) * ceil(2^32 / n) is below ceil(2^32 / n) modulo 2^32 (see
+// "Faster Remainder by Direct Computation" by Lemire, Kaser and Kurz), so no
+// lane needs a division. The comparison is done on signed ints after flipping
+// their top bits, which the vector units support.
+#if defined(__GNUC__) && defined(__x86_64__) && defined(__linux__) &&          \
+    !defined(__SANITIZE_THREAD__)
+__attribute__((target_clones("avx512f", "avx2", "default")))
+#endif
+static long long find_deal_in_range_vec(const fc_solve_ms_deal_idx_type start,
+    const fc_solve_ms_deal_idx_type end, const uint_fast32_t *const ints)
+{
+    const find_deal_draw draw = calc_find_deal_draw(start);
+    find_deal_vec targets[FIND_DEAL_NUM_VEC_INTS];
+    find_deal_vec multipliers[FIND_DEAL_NUM_VEC_INTS];
+    find_deal_signed_vec flipped_multipliers[FIND_DEAL_NUM_VEC_INTS];
+    for (size_t i = 0; i < FIND_DEAL_NUM_VEC_INTS; ++i)
+    {
+        const uint32_t n = (uint32_t)(4 * 13 - i);
+        targets[i] = (find_deal_vec){0} + (uint32_t)ints[i];
+        multipliers[i] =
+            (find_deal_vec){0} + (uint32_t)((0x100000000ULL + n - 1) / n);
+        flipped_multipliers[i] =
+            (find_deal_signed_vec)(multipliers[i] ^ 0x80000000U);
+    }
+    find_deal_vec lanes;
+    for (size_t l = 0; l < FIND_DEAL_LANES; ++l)
+    {
+        lanes[l] = (uint32_t)l;
+    }
+    const find_deal_signed_vec zero = {0};
+
+    for (fc_solve_ms_deal_idx_type base = start; base <= end;
+         base += FIND_DEAL_LANES)
+    {
+        find_deal_vec seeds = lanes + (uint32_t)base;
+        find_deal_signed_vec matches = ~zero;
+        for (size_t i = 0; i < FIND_DEAL_NUM_VEC_INTS; ++i)
         {
-            if (microsoft_rand__game_num_rand(&seedx, deal_idx) % n != *ptr)
+            seeds = seeds * 214013 + 2531011;
+            const find_deal_vec draws =
+                (((seeds >> 16) & draw.mask) | draw.or_bits) + draw.add;
+            const find_deal_vec products =
+                (draws - targets[i]) * multipliers[i];
+            matches &= ((find_deal_signed_vec)(products ^ 0x80000000U) <
+                        flipped_multipliers[i]);
+        }
+        if (!memcmp(&matches, &zero, sizeof(zero)))
+        {
+            continue;
+        }
+        for (size_t l = 0; l < FIND_DEAL_LANES; ++l)
+        {
+            const fc_solve_ms_deal_idx_type deal_idx = base + l;
+            if (matches[l] && (deal_idx <= end) &&
+                is_deal_matching(deal_idx, ints))
             {
-                goto next_deal;
+                return (long long)deal_idx;
             }
         }
-        return (long long)deal_idx;
-    next_deal:;
     }
     return -1;
 }
 
+// The deals are handed to the threads in chunks of this size.
+#define FIND_DEAL_CHUNK_SIZE (1ULL << 22)
+
+typedef struct
+{
+    fc_solve_ms_deal_idx_type next_start, end;
+    const uint_fast32_t *ints;
+    long long found;
+#ifdef FCS_HAVE_PTHREADS
+    pthread_mutex_t lock;
+#endif
+} find_deal_context;
+
+static inline void find_deal_lock(find_deal_context *const context GCC_UNUSED)
+{
+#ifdef FCS_HAVE_PTHREADS
+    pthread_mutex_lock(&context->lock);
+#endif
+}
+
+static inline void find_deal_unlock(
+    find_deal_context *const context GCC_UNUSED)
+{
+#ifdef FCS_HAVE_PTHREADS
+    pthread_mutex_unlock(&context->lock);
+#endif
+}
+
+// Checks the chunks of the range in ascending order until they are past the
+// earliest deal that was found so far, so the earliest deal of the range is
+// always found.
+static void *find_deal_worker(void *const void_context)
+{
+    find_deal_context *const context = (find_deal_context *)void_context;
+    while (true)
+    {
+        find_deal_lock(context);
+        const fc_solve_ms_deal_idx_type start = context->next_start;
+        const bool is_done = ((start > context->end) ||
+                              ((context->found >= 0) &&
+                                  (start > (fc_solve_ms_deal_idx_type)
+                                               context->found)));
+        fc_solve_ms_deal_idx_type end = context->end;
+        if (!is_done)
+        {
+            // A chunk does not cross the deals where the way of drawing the
+            // cards changes.
+            end = min(end, start + FIND_DEAL_CHUNK_SIZE - 1);
+            if (start < 0x80000000ULL)
+            {
+                end = min(end, 0x80000000ULL - 1);
+            }
+            else if (start < 0x100000000ULL)
+            {
+                end = min(end, 0x100000000ULL - 1);
+            }
+            context->next_start = end + 1;
+        }
+        find_deal_unlock(context);
+        if (is_done)
+        {
+            return NULL;
+        }
+
+        const long long found =
+            find_deal_in_range_vec(start, end, context->ints);
+        if (found >= 0)
+        {
+            find_deal_lock(context);
+            if ((context->found < 0) || (found < context->found))
+            {
+                context->found = found;
+            }
+            find_deal_unlock(context);
+        }
+    }
+}
+
+static long long find_deal_in_range_parallel(
+    const fc_solve_ms_deal_idx_type start, const fc_solve_ms_deal_idx_type end,
+    const uint_fast32_t *const ints, size_t num_threads)
+{
+    find_deal_context context = {
+        .next_start = start, .end = end, .ints = ints, .found = -1};
+#ifdef FCS_HAVE_PTHREADS
+    if (!num_threads)
+    {
+        const long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = ((num_cpus > 0) ? (size_t)num_cpus : 1);
+    }
+    pthread_mutex_init(&context.lock, NULL);
+    pthread_t threads[num_threads];
+    bool is_running[num_threads];
+    for (size_t i = 1; i < num_threads; ++i)
+    {
+        is_running[i] =
+            !pthread_create(&threads[i], NULL, find_deal_worker, &context);
+    }
+    find_deal_worker(&context);
+    for (size_t i = 1; i < num_threads; ++i)
+    {
+        if (is_running[i])
+        {
+            pthread_join(threads[i], NULL);
+        }
+    }
+    pthread_mutex_destroy(&context.lock);
+#else
+    (void)num_threads;
+    find_deal_worker(&context);
+#endif
+
+    return context.found;
+}
+
 #define NUM_CARDS ((4 * 13) - 1)
 typedef uint_fast32_t fcs_find_deal__int;
 typedef struct
 {
     fcs_find_deal__int ints[NUM_CARDS];
+    // 0 means one thread per online CPU.
+    size_t num_threads;
     char ret[128];
 } find_deal;
 
@@ -43,6 +268,7 @@ static find_deal global_instance;
 DLLEXPORT void *fc_solve_user__find_deal__alloc(void)
 {
     find_deal *const ret = SMALLOC1(ret);
+    ret->num_threads = 0;
     return ret;
 }
 
@@ -71,12 +297,19 @@ void DLLEXPORT fc_solve_user__find_deal__fill(
     }
 }
 
+void DLLEXPORT fc_solve_user__find_deal__set_num_threads(
+    void *const obj_ptr, const int num_threads)
+{
+    ((find_deal *)obj_ptr)->num_threads =
+        (size_t)((num_threads > 0) ? num_threads : 0);
+}
+
 extern DLLEXPORT const char *fc_solve_user__find_deal__run(
     void *obj_ptr, const char *const start, const char *const end)
 {
     find_deal *const obj = obj_ptr;
     sprintf(obj->ret, RIN_LL_FMT,
-        fc_solve_find_deal_in_range(
-            fcs_str2msdeal(start), fcs_str2msdeal(end), obj->ints));
+        find_deal_in_range_parallel(fcs_str2msdeal(start),
+            fcs_str2msdeal(end), obj->ints, obj->num_threads));
     return obj->ret;
 }
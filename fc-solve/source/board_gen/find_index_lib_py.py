@@ -14,5 +14,6 @@ const long long start, const long long end, const uint_fast32_t *const ints);
 void * fc_solve_user__find_deal__alloc();
 void fc_solve_user__find_deal__free(void *);
 void fc_solve_user__find_deal__fill(void *, const char *);
+void fc_solve_user__find_deal__set_num_threads(void *, int);
 const char * fc_solve_user__find_deal__run(void *, const char *, const char *);
 ''')
@@ -22,24 +22,27 @@ static void __attribute__((noreturn)) print_help(void)
                    "\n"
                    "Generate the initial layouts of several arbitrary deal "
                    "indexes from the\n"
-                   "Microsoft/Freecell Pro deals.");
+                   "Microsoft/Freecell Pro deals, or from the PySolFC deals "
+                   "of the --variant.");
     exit(-1);
 }
 
 #define CARD_STR_LEN 3
 #define OUTPUT_LEN (CARD_STR_LEN * 4 * 13)
 #ifndef RINUTILS__IS_UNIX
-static inline void output_file(const char *const filename, const char *const s)
+static inline void output_file(
+    const char *const filename, const char *const s, const size_t len)
 {
     FILE *f = fopen(filename, "wt");
-    fwrite(s, OUTPUT_LEN, 1, f);
+    fwrite(s, len, 1, f);
     fclose(f);
 }
 #else
-static inline void output_file(const char *const filename, const char *const s)
+static inline void output_file(
+    const char *const filename, const char *const s, const size_t len)
 {
     const int fh = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
-    write(fh, s, OUTPUT_LEN);
+    write(fh, s, len);
     close(fh);
 }
 #endif
@@ -51,6 +54,7 @@ int main(int argc, char *argv[])
     char dir[DIR_LEN + 1] = "";
 #define SUFFIX_LEN 19
     char suffix[SUFFIX_LEN + 1] = "";
+    fcs_pysol_game_type game = FCS_PYSOL_GAME_UNKNOWN;
     for (; arg < argc; ++arg)
     {
         const char *param;
@@ -72,6 +76,15 @@ int main(int argc, char *argv[])
             }
             strcpy(suffix, param);
         }
+        else if ((param = TRY_P("--variant")))
+        {
+            if ((game = fc_solve_pysol_game_by_name(param)) ==
+                FCS_PYSOL_GAME_UNKNOWN)
+            {
+                fprintf(stderr, "Unknown --variant \"%s\"!\n", param);
+                print_help();
+            }
+        }
         else
         {
             break;
@@ -87,13 +100,21 @@ int main(int argc, char *argv[])
 #define MARGIN 5
     char filename[DIR_LEN + SUFFIX_LEN + MAX_NUM_DIGITS + MARGIN];
     char *const fn_suffix = filename + sprintf(filename, "%s/", dir);
-    fcs_state_string s;
+    fcs_pysol_board_string s;
     get_board__setup_string(s);
 
     DEALS_ITERATE__START(board_num)
     sprintf(fn_suffix, "%lu%s", board_num, suffix);
-    get_board_l__without_setup(board_num, s);
-    output_file(filename, s);
+    if (game == FCS_PYSOL_GAME_UNKNOWN)
+    {
+        get_board_l__without_setup(board_num, s);
+        output_file(filename, s, OUTPUT_LEN);
+    }
+    else
+    {
+        fc_solve_get_pysol_board(game, FCS_PYSOL_DEALS_PYSOLFC, board_num, s);
+        output_file(filename, s, strlen(s));
+    }
     DEALS_ITERATE__END()
     deals_ranges__free();
 
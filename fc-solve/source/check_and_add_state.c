@@ -48,6 +48,19 @@ static inline void fc_solve_cache_stacks(
 
         var_AUTO(column, fcs_state_get_col(*(new_state_key), i));
         const size_t col_len = (fcs_col_len(column) + 1);
+#if FCS_STACK_STORAGE == FCS_STACK_STORAGE_INTERNAL_HASH
+        // The hash is probed with the copy of the column in the buffer, so it
+        // is only copied to the allocator if it is new.
+        const fcs_hash_value hash_value = DO_XXH(column, col_len);
+        hash_item **placeholder = NULL;
+        void *const cached_stack = fc_solve_hash_find(
+            &(instance->stacks_hash), column, hash_value, &placeholder);
+        if (cached_stack)
+        {
+            *(current_stack) = cached_stack;
+            continue;
+        }
+#endif
 
         fcs_cards_column new_ptr =
             (fcs_cards_column)fcs_compact_alloc_ptr(stacks_allocator, col_len);
@@ -55,14 +68,12 @@ static inline void fc_solve_cache_stacks(
         *(current_stack) = new_ptr;
         column = fcs_state_get_col(*new_state_key, i);
 
-        void *cached_stack;
 #if FCS_STACK_STORAGE == FCS_STACK_STORAGE_INTERNAL_HASH
-
-        cached_stack = fc_solve_hash_insert(&(instance->stacks_hash), column,
-            DO_XXH(*(current_stack), col_len));
-        REPLACE_WITH_CACHED(cached_stack);
-
-#elif (FCS_STACK_STORAGE == FCS_STACK_STORAGE_GOOGLE_DENSE_HASH)
+        fc_solve_hash_insert_at(
+            &(instance->stacks_hash), placeholder, column, hash_value);
+#else
+        void *cached_stack;
+#if (FCS_STACK_STORAGE == FCS_STACK_STORAGE_GOOGLE_DENSE_HASH)
         REPLACE_WITH_CACHED(fc_solve_columns_google_hash_insert(
             instance->stacks_hash, column, &cached_stack));
 #elif (FCS_STACK_STORAGE == FCS_STACK_STORAGE_LIBAVL2_TREE)
@@ -111,6 +122,7 @@ static inline void fc_solve_cache_stacks(
         }
 #else
 #error FCS_STACK_STORAGE is not set to a good value.
+#endif
 #endif
     }
 }
@@ -155,20 +167,8 @@ guint fc_solve_hash_function(gconstpointer key)
 
 static inline void upon_new_state(fcs_instance *const instance GCC_UNUSED,
     fcs_hard_thread *const hard_thread GCC_UNUSED,
-    fcs_state_extra_info *const new_state_info)
+    fcs_collectible_state *const new_state GCC_UNUSED)
 {
-    fcs_collectible_state *const parent_state = new_state_info->parent;
-    // The new state was not found in the cache, and it was already inserted
-    if (likely(parent_state))
-    {
-        (FCS_S_NUM_ACTIVE_CHILDREN(parent_state))++;
-#ifdef FCS_WITH_MOVES
-        // If parent_val is defined, so is moves_to_parent
-        new_state_info->moves_to_parent = fc_solve_move_stack_compact_allocate(
-            hard_thread, new_state_info->moves_to_parent);
-#endif
-    }
-
 #ifndef FCS_DISABLE_NUM_STORED_STATES
 #ifndef FCS_WITHOUT_TRIM_MAX_STORED_STATES
     ++instance->active_num_states_in_collection;
@@ -188,7 +188,8 @@ static inline bool handle_existing_void(fcs_instance *const instance,
     }
     else
     {
-        upon_new_state(instance, hard_thread, new_state->val);
+        upon_new_state(
+            instance, hard_thread, FCS_STATE_kv_to_collectible(new_state));
 #ifdef DEBUG
         if (getenv("FCS_DEBUG2"))
         {
@@ -207,6 +208,23 @@ static inline bool handle_existing_void(fcs_instance *const instance,
     handle_existing_void(                                                      \
         instance, hard_thread, new_state, existing_state_raw, (existing_void))
 
+#ifdef FCS_WITH_DEAD_ENDS_RECYCLING
+// A state whose fingerprint is found was recycled as a dead end, so it is
+// reported as an existing state that is a dead end.
+static inline bool is_recycled_dead_end(fcs_instance *const instance,
+    const fcs_hash_value hash_value, fcs_kv_state *const existing_state_raw)
+{
+    if (likely(!fc_solve_dead_end_fingerprints_lookup(
+            &(instance->dead_end_fingerprints), hash_value)))
+    {
+        return false;
+    }
+    FCS_STATE_collectible_to_kv(
+        existing_state_raw, &(instance->dead_end_state));
+    return true;
+}
+#endif
+
 bool fc_solve_check_and_add_state(fcs_hard_thread *const hard_thread,
     fcs_kv_state *const new_state, fcs_kv_state *const existing_state_raw)
 {
@@ -229,8 +247,26 @@ bool fc_solve_check_and_add_state(fcs_hard_thread *const hard_thread,
 #else
 #define FCS_MY_STATE FCS_STATE_kv_to_collectible(new_state)
 #endif
-    return HANDLE_existing_void(fc_solve_hash_insert(&(instance->hash),
-        FCS_MY_STATE, DO_XXH(new_state_key, sizeof(*new_state_key))));
+    // The derived state is already in its slot, so it is probed in place and
+    // inserted at the end of the chain that the probe walked.
+    const fcs_hash_value hash_value =
+        DO_XXH(new_state_key, sizeof(*new_state_key));
+    hash_item **placeholder = NULL;
+    void *const existing_void = fc_solve_hash_find(
+        &(instance->hash), FCS_MY_STATE, hash_value, &placeholder);
+    if (existing_void)
+    {
+        return HANDLE_existing_void(existing_void);
+    }
+#ifdef FCS_WITH_DEAD_ENDS_RECYCLING
+    if (is_recycled_dead_end(instance, hash_value, existing_state_raw))
+    {
+        return false;
+    }
+#endif
+    fc_solve_hash_insert_at(
+        &(instance->hash), placeholder, FCS_MY_STATE, hash_value);
+    return HANDLE_existing_void(NULL);
 #elif (FCS_STATE_STORAGE == FCS_STATE_STORAGE_GOOGLE_DENSE_HASH)
     void *existing_void;
     if (!fc_solve_states_google_hash_insert(instance->hash,
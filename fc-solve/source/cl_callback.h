@@ -46,8 +46,81 @@ static inline FILE *fc_solve_calc_file_handle(
     }
 }
 
+#ifndef FCS_USE_PRECOMPILED_CMD_LINE_THEME
+// "fc-solve --save-theme theme_file [options]" - writes the expanded options
+// to theme_file, which --load-theme then parses.
+static int save_theme_main(const int argc, char **const argv)
+{
+    if (argc < 3)
+    {
+        fprintf(stderr, "%s",
+            "Usage: fc-solve --save-theme theme_file [options]\n");
+        return -1;
+    }
+    display_context = INITIAL_DISPLAY_CONTEXT;
+    void *const instance = freecell_solver_user_alloc();
+    FCS__DECL_ERR_PTR(error_string);
+    int last_arg = 3;
+    char *theme_blob;
+    size_t theme_blob_len;
+    const int ret = freecell_solver_user_cmd_line_save_theme(instance, argc,
+        (freecell_solver_str_t *)(void *)argv, 3, known_parameters,
+        fc_solve__cmd_line_callback,
+        &display_context FCS__PASS_ERR_STR(&error_string), &last_arg, -1,
+        NULL, &theme_blob, &theme_blob_len);
+    freecell_solver_user_free(instance);
+    if (ret != FCS_CMD_LINE_OK)
+    {
+        free(theme_blob);
+#ifdef FCS_WITH_ERROR_STRS
+        if (error_string)
+        {
+            fprintf(stderr, "%s", error_string);
+            free(error_string);
+            return -1;
+        }
+#endif
+        fprintf(stderr, "Error in command line arg \"%s\".\n",
+            ((last_arg < argc) ? argv[last_arg] : ""));
+        return -1;
+    }
+    FILE *const f = fopen(argv[2], "wb");
+    if (!f)
+    {
+        free(theme_blob);
+        fprintf(stderr, "Could not open \"%s\" for writing!\n", argv[2]);
+        return -1;
+    }
+    const bool was_written =
+        (fwrite(theme_blob, 1, theme_blob_len, f) == theme_blob_len);
+    free(theme_blob);
+    if ((fclose(f) != 0) || (!was_written))
+    {
+        fprintf(stderr, "Could not write \"%s\"!\n", argv[2]);
+        return -1;
+    }
+    return 0;
+}
+#endif
+
 int main(const int argc, char **const argv)
 {
+#ifndef FCS_USE_PRECOMPILED_CMD_LINE_THEME
+    if ((argc > 1) && (!strcmp(argv[1], "--save-theme")))
+    {
+        return save_theme_main(argc, argv);
+    }
+#endif
+#ifdef FC_SOLVE_WITH_SERVE
+    if ((argc > 1) && (!strcmp(argv[1], "--serve")))
+    {
+        return fc_solve_serve_main(argc, argv);
+    }
+    if ((argc > 1) && (!strcmp(argv[1], "--stream")))
+    {
+        return fc_solve_stream_main(argc, argv);
+    }
+#endif
     display_context = INITIAL_DISPLAY_CONTEXT;
     int arg = 1;
     instance = alloc_instance_and_parse(argc, argv, &arg, known_parameters,
@@ -109,6 +182,7 @@ int main(const int argc, char **const argv)
 
         fc_solve_output_result_to_file(
             output_fh, instance, ret, &display_context);
+        fc_solve_output_trace_to_file(output_fh, instance);
 
         if (display_context.output_filename)
         {
@@ -192,11 +192,99 @@ static inline __attribute__((format(printf, 1, 2))) char *calc_errstr_s(
     ASSIGN_ERR_STR_AND_FREE(__VA_ARGS__);                                      \
     RET_ERROR_IN_ARG()
 
-DLLEXPORT int freecell_solver_user_cmd_line_read_cmd_line_preset(
-    void *const instance, const char *const preset_name,
+// A theme blob is this header followed by num_args NUL-terminated arguments,
+// in which the presets and the files that were read are already expanded,
+// so it is loaded without searching for, reading or splitting any files. The
+// arguments themselves are parsed like those of the command line.
+#define FCS_THEME_BLOB_MAGIC "FCSTHEME"
+#define FCS_THEME_BLOB_FORMAT_VERSION 1
+typedef struct
+{
+    char magic[8];
+    uint32_t format_version;
+    uint32_t num_args;
+    uint32_t args_len;
+} fcs_theme_blob_header;
+
+static void theme_push_args(fcs_args_man *const theme,
+    const freecell_solver_str_t *const start,
+    const freecell_solver_str_t *const end)
+{
+    for (const freecell_solver_str_t *arg = start; arg < end; ++arg)
+    {
+        if (!(theme->argc % FC_SOLVE__ARGS_MAN_GROW_BY))
+        {
+            theme->argv = SREALLOC(
+                theme->argv, (size_t)theme->argc + FC_SOLVE__ARGS_MAN_GROW_BY);
+        }
+        theme->argv[theme->argc++] = strdup(*arg);
+    }
+}
+
+static int parse_args(void *instance, int argc, freecell_solver_str_t argv[],
+    const int start_arg, freecell_solver_str_t *known_parameters,
+    freecell_solver_user_cmd_line_known_commands_callback_t callback,
+    void *const callback_context FCS__PASS_ERR_STR(char **error_string),
+    int *last_arg, const int file_nesting_count,
+    freecell_solver_str_t opened_files_dir, fcs_args_man *const theme);
+
+static int load_theme(void *const instance, const char *const theme_blob,
+    const size_t theme_blob_len FCS__PASS_ERR_STR(char **const error_string),
+    fcs_args_man *const theme)
+{
+    fcs_theme_blob_header header;
+    if (theme_blob_len < sizeof(header))
+    {
+        ASSIGN_ERR_STR(error_string, "%s", "The theme is truncated.\n");
+        return FCS_CMD_LINE_ERROR_IN_ARG;
+    }
+    memcpy(&header, theme_blob, sizeof(header));
+    if (memcmp(header.magic, FCS_THEME_BLOB_MAGIC, sizeof(header.magic)) ||
+        (header.format_version != FCS_THEME_BLOB_FORMAT_VERSION))
+    {
+        ASSIGN_ERR_STR(error_string, "%s",
+            "Not a theme of this version of Freecell Solver.\n");
+        return FCS_CMD_LINE_ERROR_IN_ARG;
+    }
+    const char *const args = theme_blob + sizeof(header);
+    const char *const args_end = args + header.args_len;
+    if ((theme_blob_len - sizeof(header) != header.args_len) ||
+        (header.args_len && args_end[-1]))
+    {
+        ASSIGN_ERR_STR(error_string, "%s", "The theme is truncated.\n");
+        return FCS_CMD_LINE_ERROR_IN_ARG;
+    }
+    freecell_solver_str_t *const argv =
+        SMALLOC(argv, (size_t)header.num_args + 1);
+    int argc = 0;
+    for (const char *s = args; s < args_end; s += strlen(s) + 1)
+    {
+        if (argc == (int)header.num_args)
+        {
+            break;
+        }
+        argv[argc++] = s;
+    }
+    if (argc != (int)header.num_args)
+    {
+        free(argv);
+        ASSIGN_ERR_STR(error_string, "%s", "The theme is truncated.\n");
+        return FCS_CMD_LINE_ERROR_IN_ARG;
+    }
+    argv[argc] = NULL;
+    int last_arg = 0;
+    const int ret = parse_args(instance, argc, argv, 0, NULL, NULL,
+        NULL FCS__PASS_ERR_STR(error_string), &last_arg, 0, NULL, theme);
+    free(argv);
+    return ret;
+}
+
+static int read_cmd_line_preset(void *const instance,
+    const char *const preset_name,
     freecell_solver_str_t *const known_parameters FCS__PASS_ERR_STR(
         char **const error_string),
-    const int file_nesting_count, freecell_solver_str_t opened_files_dir)
+    const int file_nesting_count, freecell_solver_str_t opened_files_dir,
+    fcs_args_man *const theme)
 {
     fcs_args_man preset_args;
     char dir[MAX_PATH_LEN + 1];
@@ -210,28 +298,36 @@ DLLEXPORT int freecell_solver_user_cmd_line_read_cmd_line_preset(
     }
     int last_arg = 0;
 
-    const int ret =
-        freecell_solver_user_cmd_line_parse_args_with_file_nesting_count(
-            instance, preset_args.argc,
-            (freecell_solver_str_t *)(void *)(preset_args.argv), 0,
-            known_parameters, NULL, NULL FCS__PASS_ERR_STR(error_string),
-            &(last_arg),
-            ((file_nesting_count < 0) ? file_nesting_count
-                                      : (file_nesting_count - 1)),
-            dir[0] ? dir : opened_files_dir);
+    const int ret = parse_args(instance, preset_args.argc,
+        (freecell_solver_str_t *)(void *)(preset_args.argv), 0,
+        known_parameters, NULL, NULL FCS__PASS_ERR_STR(error_string),
+        &(last_arg),
+        ((file_nesting_count < 0) ? file_nesting_count
+                                  : (file_nesting_count - 1)),
+        dir[0] ? dir : opened_files_dir, theme);
 
     fc_solve_args_man_free(&preset_args);
 
     return ret;
 }
 
-DLLEXPORT int freecell_solver_user_cmd_line_parse_args_with_file_nesting_count(
-    void *instance, int argc, freecell_solver_str_t argv[], const int start_arg,
-    freecell_solver_str_t *known_parameters,
+DLLEXPORT int freecell_solver_user_cmd_line_read_cmd_line_preset(
+    void *const instance, const char *const preset_name,
+    freecell_solver_str_t *const known_parameters FCS__PASS_ERR_STR(
+        char **const error_string),
+    const int file_nesting_count, freecell_solver_str_t opened_files_dir)
+{
+    return read_cmd_line_preset(instance, preset_name,
+        known_parameters FCS__PASS_ERR_STR(error_string), file_nesting_count,
+        opened_files_dir, NULL);
+}
+
+static int parse_args(void *instance, int argc, freecell_solver_str_t argv[],
+    const int start_arg, freecell_solver_str_t *known_parameters,
     freecell_solver_user_cmd_line_known_commands_callback_t callback,
     void *const callback_context FCS__PASS_ERR_STR(char **error_string),
     int *last_arg, const int file_nesting_count,
-    freecell_solver_str_t opened_files_dir)
+    freecell_solver_str_t opened_files_dir, fcs_args_man *const theme)
 {
 #ifdef FCS_WITH_ERROR_STRS
     char *fcs_user_errstr;
@@ -266,6 +362,7 @@ DLLEXPORT int freecell_solver_user_cmd_line_parse_args_with_file_nesting_count(
             }
         }
 
+        const freecell_solver_str_t *const opt_arg = arg;
         // OPT-PARSE-START
         const int opt = ({
             const_AUTO(p, (*arg));
@@ -475,11 +572,92 @@ DLLEXPORT int freecell_solver_user_cmd_line_parse_args_with_file_nesting_count(
 #endif
             break;
 
+        case FCS_OPT_LOCAL_OPT_WINDOW: // STRINGS=--local-opt-window;
+            PROCESS_OPT_ARG();
+            if (freecell_solver_user_set_local_opt_window(instance, atoi(*arg)))
+            {
+                RET_ERR_STR(error_string,
+                    "Invalid local optimizer window \"%s\" - it should not "
+                    "be negative.\n",
+                    (*arg));
+            }
+            break;
+
+        case FCS_OPT_LOCAL_OPT_MAX_ITERS: // STRINGS=--local-opt-max-iters;
+            PROCESS_OPT_ARG();
+            if (freecell_solver_user_set_local_opt_max_iters(
+                    instance, (fcs_int_limit_t)atol(*arg)))
+            {
+                RET_ERR_STR(error_string,
+                    "Invalid local optimizer iterations \"%s\" - it should "
+                    "be positive.\n",
+                    (*arg));
+            }
+            break;
+
+        case FCS_OPT_LOCAL_OPT_THREADS: // STRINGS=--local-opt-threads;
+            PROCESS_OPT_ARG();
+            if (freecell_solver_user_set_local_opt_threads(
+                    instance, atoi(*arg)))
+            {
+                RET_ERR_STR(error_string,
+                    "Invalid local optimizer threads' count \"%s\" - it "
+                    "should be positive.\n",
+                    (*arg));
+            }
+            break;
+
         case FCS_OPT_SEED: // STRINGS=-seed;
             PROCESS_OPT_ARG();
             freecell_solver_user_set_random_seed(instance, atoi(*arg));
             break;
 
+        case FCS_OPT_DFS_RESTARTS: // STRINGS=--dfs-restarts;
+        {
+            PROCESS_OPT_ARG();
+            const_AUTO(s, (*arg));
+            int policy = -1;
+            long unit = 0;
+            double factor = 1;
+            int len;
+            if (!strcmp(s, "none"))
+            {
+                policy = FCS_DFS_RESTARTS_NONE;
+            }
+            else if ((sscanf(s, "luby:%ld%n", &unit, &len) == 1) && (!s[len]))
+            {
+                policy = FCS_DFS_RESTARTS_LUBY;
+            }
+            else if ((sscanf(s, "geometric:%ld:%lf%n", &unit, &factor, &len) ==
+                         2) &&
+                     (!s[len]))
+            {
+                policy = FCS_DFS_RESTARTS_GEOMETRIC;
+            }
+
+            if (freecell_solver_user_set_dfs_restarts(
+                    instance, policy, unit, factor))
+            {
+                RET_ERR_STR(error_string,
+                    "Invalid restarts policy \"%s\" - should be \"none\", "
+                    "\"luby:UNIT\" or \"geometric:UNIT:FACTOR\".\n",
+                    s);
+            }
+        }
+        break;
+
+        case FCS_OPT_SEEDS_PORTFOLIO: // STRINGS=--seeds-portfolio;
+            PROCESS_OPT_ARG();
+            if (freecell_solver_user_set_seeds_portfolio(instance, atoi(*arg)))
+            {
+                RET_ERR_STR(error_string,
+                    "Could not set a portfolio of %s seeds - the current "
+                    "scan should be a DFS one, and the number of scans may "
+                    "not exceed the maximum.\n",
+                    (*arg));
+            }
+            break;
+
         case FCS_OPT_MAX_STORED_STATES: // STRINGS=-mss|--max-stored-states;
             PROCESS_OPT_ARG();
 
@@ -499,6 +677,27 @@ DLLEXPORT int freecell_solver_user_cmd_line_parse_args_with_file_nesting_count(
 #endif
             break;
 
+        case FCS_OPT_RECYCLE_DEAD_ENDS: // STRINGS=--recycle-dead-ends;
+            PROCESS_OPT_ARG();
+#ifndef FCS_DISABLE_NUM_STORED_STATES
+#ifndef FCS_WITHOUT_TRIM_MAX_STORED_STATES
+            freecell_solver_set_dead_ends_recycling(instance, atol((*arg)));
+#endif
+#endif
+            break;
+
+        case FCS_OPT_ENDGAME_TABLEBASE: // STRINGS=--endgame-tablebase;
+            PROCESS_OPT_ARG();
+            if (freecell_solver_user_set_endgame_tablebase(instance, (*arg)))
+            {
+                RET_ERR_STR(error_string,
+                    "Could not load the endgame tablebase \"%s\" - it "
+                    "should have been written by "
+                    "fc-solve-endgame-tablebase-gen.\n",
+                    (*arg));
+            }
+            break;
+
         case FCS_OPT_NEXT_INSTANCE: // STRINGS=-ni|--next-instance;
             freecell_solver_user_next_instance(instance);
             break;
@@ -672,18 +871,16 @@ DLLEXPORT int freecell_solver_user_cmd_line_parse_args_with_file_nesting_count(
 
                 if (num_file_args_to_skip < args_man.argc)
                 {
-                    const int ret =
-                        freecell_solver_user_cmd_line_parse_args_with_file_nesting_count(
-                            instance, args_man.argc - num_file_args_to_skip,
-                            (freecell_solver_str_t *)(void
-                                    *)(args_man.argv + num_file_args_to_skip),
-                            0, known_parameters, callback,
-                            callback_context FCS__PASS_ERR_STR(error_string),
-                            last_arg,
-                            ((file_nesting_count < 0)
-                                    ? file_nesting_count
-                                    : (file_nesting_count - 1)),
-                            opened_files_dir);
+                    const int ret = parse_args(instance,
+                        args_man.argc - num_file_args_to_skip,
+                        (freecell_solver_str_t *)(void
+                                *)(args_man.argv + num_file_args_to_skip),
+                        0, known_parameters, callback,
+                        callback_context FCS__PASS_ERR_STR(error_string),
+                        last_arg,
+                        ((file_nesting_count < 0) ? file_nesting_count
+                                                  : (file_nesting_count - 1)),
+                        opened_files_dir, theme);
 
                     if (ret != FCS_CMD_LINE_OK)
                     {
@@ -707,10 +904,9 @@ DLLEXPORT int freecell_solver_user_cmd_line_parse_args_with_file_nesting_count(
         {
             PROCESS_OPT_ARG();
 
-            const int ret =
-                freecell_solver_user_cmd_line_read_cmd_line_preset(instance,
-                    (*arg), known_parameters FCS__PASS_ERR_STR(error_string),
-                    file_nesting_count, opened_files_dir);
+            const int ret = read_cmd_line_preset(instance, (*arg),
+                known_parameters FCS__PASS_ERR_STR(error_string),
+                file_nesting_count, opened_files_dir, theme);
 
             switch (ret)
             {
@@ -728,6 +924,36 @@ DLLEXPORT int freecell_solver_user_cmd_line_parse_args_with_file_nesting_count(
         }
         break;
 
+        case FCS_OPT_LOAD_THEME: // STRINGS=--load-theme;
+            PROCESS_OPT_ARG();
+
+            if (file_nesting_count != 0)
+            {
+                FILE *const f = fopen((*arg), "rb");
+                if (!f)
+                {
+                    RET_ERR_STR(error_string,
+                        "Could not open file \"%s\"!\nQuitting.\n", (*arg));
+                }
+                fseek(f, 0, SEEK_END);
+                const long file_len = ftell(f);
+                char *const buffer = SMALLOC(buffer, (size_t)(file_len + 1));
+                fseek(f, 0, SEEK_SET);
+                const size_t theme_blob_len =
+                    fread(buffer, 1, (size_t)(file_len), f);
+                fclose(f);
+
+                const int ret = load_theme(instance, buffer,
+                    theme_blob_len FCS__PASS_ERR_STR(error_string), theme);
+                free(buffer);
+                if (ret != FCS_CMD_LINE_OK)
+                {
+                    *last_arg = (int)(arg - &(argv[0]));
+                    return ret;
+                }
+            }
+            break;
+
         case FCS_OPT_DEPTH_TESTS_ORDER:   // STRINGS=-dto|--depth-tests-order;
         case FCS_OPT_DEPTH_TESTS_ORDER_2: // STRINGS=-dto2|--depth-tests-order2;
         {
@@ -840,7 +1066,12 @@ DLLEXPORT int freecell_solver_user_cmd_line_parse_args_with_file_nesting_count(
         break;
         }
 
-    // OPT-PARSE-END
+        // OPT-PARSE-END
+        if (theme && (opt != FCS_OPT_READ_FROM_FILE) &&
+            (opt != FCS_OPT_LOAD_CONFIG) && (opt != FCS_OPT_LOAD_THEME))
+        {
+            theme_push_args(theme, opt_arg, arg + 1);
+        }
     end_of_arg_loop:;
     }
 
@@ -848,6 +1079,71 @@ DLLEXPORT int freecell_solver_user_cmd_line_parse_args_with_file_nesting_count(
     return FCS_CMD_LINE_OK;
 }
 
+DLLEXPORT int freecell_solver_user_cmd_line_parse_args_with_file_nesting_count(
+    void *instance, int argc, freecell_solver_str_t argv[], const int start_arg,
+    freecell_solver_str_t *known_parameters,
+    freecell_solver_user_cmd_line_known_commands_callback_t callback,
+    void *const callback_context FCS__PASS_ERR_STR(char **error_string),
+    int *last_arg, const int file_nesting_count,
+    freecell_solver_str_t opened_files_dir)
+{
+    return parse_args(instance, argc, argv, start_arg, known_parameters,
+        callback, callback_context FCS__PASS_ERR_STR(error_string), last_arg,
+        file_nesting_count, opened_files_dir, NULL);
+}
+
+DLLEXPORT int freecell_solver_user_cmd_line_save_theme(void *instance,
+    int argc, freecell_solver_str_t argv[], const int start_arg,
+    freecell_solver_str_t *known_parameters,
+    freecell_solver_user_cmd_line_known_commands_callback_t callback,
+    void *const callback_context FCS__PASS_ERR_STR(char **error_string),
+    int *last_arg, const int file_nesting_count,
+    freecell_solver_str_t opened_files_dir, char **const theme_blob,
+    size_t *const theme_blob_len)
+{
+    fcs_args_man theme = {.argc = 0, .argv = NULL};
+    const int ret = parse_args(instance, argc, argv, start_arg,
+        known_parameters, callback,
+        callback_context FCS__PASS_ERR_STR(error_string), last_arg,
+        file_nesting_count, opened_files_dir, &theme);
+
+    size_t args_len = 0;
+    for (int i = 0; i < theme.argc; ++i)
+    {
+        args_len += strlen(theme.argv[i]) + 1;
+    }
+    fcs_theme_blob_header header = {.format_version =
+                                        FCS_THEME_BLOB_FORMAT_VERSION,
+        .num_args = (uint32_t)theme.argc,
+        .args_len = (uint32_t)args_len};
+    memcpy(header.magic, FCS_THEME_BLOB_MAGIC, sizeof(header.magic));
+    char *const blob = SMALLOC(blob, sizeof(header) + args_len);
+    memcpy(blob, &header, sizeof(header));
+    char *s = blob + sizeof(header);
+    for (int i = 0; i < theme.argc; ++i)
+    {
+        const size_t len = strlen(theme.argv[i]) + 1;
+        memcpy(s, theme.argv[i], len);
+        s += len;
+    }
+    fc_solve_args_man_free(&theme);
+
+    *theme_blob = blob;
+    *theme_blob_len = sizeof(header) + args_len;
+    return ret;
+}
+
+DLLEXPORT int freecell_solver_user_load_theme(void *instance,
+    const char *const theme_blob,
+    const size_t theme_blob_len FCS__PASS_ERR_STR(char **error_string))
+{
+#ifdef FCS_WITH_ERROR_STRS
+    *error_string = NULL;
+#endif
+    return load_theme(instance, theme_blob,
+        theme_blob_len FCS__PASS_ERR_STR(error_string), NULL);
+}
+
 #ifndef FC_SOLVE__REMOVE_OLD_API_1
 DLLEXPORT int freecell_solver_user_cmd_line_parse_args(void *instance, int argc,
     freecell_solver_str_t argv[], const int start_arg,
@@ -0,0 +1,124 @@
+// This file is part of Freecell Solver. It is subject to the license terms in
+// the COPYING.txt file found in the top-level directory of this distribution
+// and at http://fc-solve.shlomifish.org/docs/distro/COPYING.html . No part of
+// Freecell Solver, including this file, may be copied, modified, propagated,
+// or distributed except according to the terms contained in the COPYING file.
+//
+// Copyright (c) 2026 Shlomi Fish
+// dbm_bloom.h - a Bloom filter of the keys that were handed to the DBM
+// store, which allows the solvers to skip the store lookup (a B-tree walk
+// or a LevelDB read) for states that were definitely never inserted.
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "rinutils/alloc_wrap.h"
+#include "delta_states.h"
+
+// About 1% false positives at the nominal capacity.
+#define FCS_DBM_BLOOM_BITS_PER_KEY 10
+#define FCS_DBM_BLOOM_NUM_HASHES 7
+
+typedef struct
+{
+    unsigned long lookups, negatives, false_positives;
+} fcs_dbm_bloom_stats;
+
+typedef struct
+{
+    uint64_t *bits;
+    uint64_t num_bits;
+} fcs_dbm_bloom;
+
+static inline void fcs_dbm_bloom_init(
+    fcs_dbm_bloom *const bloom, const unsigned long max_count)
+{
+    if (max_count == 0)
+    {
+        bloom->bits = NULL;
+        bloom->num_bits = 0;
+        return;
+    }
+    const size_t num_words =
+        ((size_t)max_count * FCS_DBM_BLOOM_BITS_PER_KEY + 63) / 64;
+    bloom->num_bits = (uint64_t)num_words * 64;
+    bloom->bits = SMALLOC(bloom->bits, num_words);
+    memset(bloom->bits, '\0', num_words * sizeof(bloom->bits[0]));
+}
+
+static inline void fcs_dbm_bloom_destroy(fcs_dbm_bloom *const bloom)
+{
+    free(bloom->bits);
+    bloom->bits = NULL;
+}
+
+static inline bool fcs_dbm_bloom_is_enabled(const fcs_dbm_bloom *const bloom)
+{
+    return (bloom->bits != NULL);
+}
+
+// The keys are already well mixed by the delta encoding, so folding the
+// words through a 64-bit finalizer is enough to derive the two hashes for
+// the Kirsch-Mitzenmacher double hashing scheme.
+static inline uint64_t fcs_dbm_bloom__mix(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+static inline void fcs_dbm_bloom__hash(
+    const fcs_encoded_state_buffer *const key, uint64_t *const h1,
+    uint64_t *const h2)
+{
+    uint64_t h = 0x9e3779b97f4a7c15ULL;
+    for (size_t i = 0; i < sizeof(key->s); i += sizeof(uint64_t))
+    {
+        uint64_t word = 0;
+        const size_t len = ((sizeof(key->s) - i) < sizeof(word))
+                               ? (sizeof(key->s) - i)
+                               : sizeof(word);
+        memcpy(&word, key->s + i, len);
+        h = fcs_dbm_bloom__mix(h ^ word);
+    }
+    *h1 = h;
+    // Must be odd so that all the probes are distinct.
+    *h2 = fcs_dbm_bloom__mix(h ^ 0x6a09e667f3bcc909ULL) | 1;
+}
+
+static inline void fcs_dbm_bloom_insert(
+    fcs_dbm_bloom *const bloom, const fcs_encoded_state_buffer *const key)
+{
+    uint64_t h1, h2;
+    fcs_dbm_bloom__hash(key, &h1, &h2);
+    for (int i = 0; i < FCS_DBM_BLOOM_NUM_HASHES; ++i, h1 += h2)
+    {
+        const uint64_t bit = h1 % bloom->num_bits;
+        bloom->bits[bit >> 6] |= ((uint64_t)1 << (bit & 63));
+    }
+}
+
+static inline bool fcs_dbm_bloom_may_contain(
+    const fcs_dbm_bloom *const bloom, const fcs_encoded_state_buffer *const key)
+{
+    uint64_t h1, h2;
+    fcs_dbm_bloom__hash(key, &h1, &h2);
+    for (int i = 0; i < FCS_DBM_BLOOM_NUM_HASHES; ++i, h1 += h2)
+    {
+        const uint64_t bit = h1 % bloom->num_bits;
+        if (!(bloom->bits[bit >> 6] & ((uint64_t)1 << (bit & 63))))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -43,7 +43,7 @@ dict_t *__attribute__((pure)) fc_solve_dbm_store_get_dict(fcs_dbm_store store)
 // Returns true if the key was added (it didn't already exist.)
 fcs_dbm_record *fc_solve_dbm_store_insert_key_value(fcs_dbm_store store,
     const fcs_encoded_state_buffer *key, fcs_dbm_store_val parent,
-    const bool should_modify_parent GCC_UNUSED)
+    const uint8_t move GCC_UNUSED, const bool should_modify_parent GCC_UNUSED)
 {
 #ifdef FCS_LIBAVL_STORE_WHOLE_KEYS
     fcs_dbm_record record_on_stack;
@@ -71,6 +71,7 @@ fcs_dbm_record *fc_solve_dbm_store_insert_key_value(fcs_dbm_store store,
     to_check->ancestor = parent;
 #else
     fcs_dbm_record_set_parent_ptr(to_check, parent);
+    fcs_dbm_record_set_move(to_check, move);
 #endif
 
 #else
@@ -0,0 +1,492 @@
+// This file is part of Freecell Solver. It is subject to the license terms in
+// the COPYING.txt file found in the top-level directory of this distribution
+// and at http://fc-solve.shlomifish.org/docs/distro/COPYING.html . No part of
+// Freecell Solver, including this file, may be copied, modified, propagated,
+// or distributed except according to the terms contained in the COPYING file.
+//
+// Copyright (c) 2026 Shlomi Fish
+// dbm_lsm.c - a self-contained log-structured DBM store.
+//
+// The store is a directory of immutable sorted run files. Every offloaded
+// pre-cache becomes a new run, lookups binary search the mmap()ed runs from
+// the newest to the oldest, and a background thread merges the runs once
+// there are too many of them. Since the keys and the parents are fixed-width
+// fcs_encoded_state_buffer-s, a run is a plain sorted array of records.
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "dbm_solver.h"
+
+#define FCS_DBM_LSM_MAX_RUNS 8
+#define FCS_DBM_LSM_MAGIC "FCSLSM01"
+
+typedef struct
+{
+    fcs_encoded_state_buffer key, parent;
+} fcs_dbm_lsm_record;
+
+typedef struct
+{
+    char magic[8];
+    uint64_t count;
+} fcs_dbm_lsm_header;
+
+typedef struct
+{
+    unsigned long seq;
+    void *map;
+    size_t map_len;
+    const fcs_dbm_lsm_record *records;
+    size_t count;
+} fcs_dbm_lsm_run;
+
+typedef struct
+{
+    char *dir;
+    // Guards runs and num_runs. The runs are ordered from the oldest to the
+    // newest.
+    fcs_lock lock;
+    fcs_dbm_lsm_run *runs;
+    size_t num_runs, max_num_runs;
+    unsigned long next_seq;
+#ifndef FCS_DBM_SINGLE_THREAD
+    fcs_condvar cond;
+    bool should_quit;
+    pthread_t compactor;
+#endif
+} fcs_dbm_lsm;
+
+static inline void lsm__run_path(const fcs_dbm_lsm *const db,
+    const unsigned long seq, const char *const ext, char *const path)
+{
+    snprintf(path, PATH_MAX, "%s/run-%010lu.%s", db->dir, seq, ext);
+}
+
+static inline int lsm__compare_keys(
+    const void *const key, const fcs_dbm_lsm_record *const record)
+{
+    return memcmp(key, record->key.s, sizeof(record->key));
+}
+
+static fcs_dbm_lsm_run lsm__map_run(
+    const fcs_dbm_lsm *const db, const unsigned long seq)
+{
+    char path[PATH_MAX];
+    lsm__run_path(db, seq, "dat", path);
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        exit_error("Cannot open the run file \"%s\".\n", path);
+    }
+    struct stat st;
+    if (fstat(fd, &st))
+    {
+        exit_error("Cannot stat the run file \"%s\".\n", path);
+    }
+    fcs_dbm_lsm_run run = {.seq = seq, .map_len = (size_t)st.st_size};
+    if ((run.map_len < sizeof(fcs_dbm_lsm_header)) ||
+        ((run.map = mmap(NULL, run.map_len, PROT_READ, MAP_SHARED, fd, 0)) ==
+            MAP_FAILED))
+    {
+        exit_error("Cannot map the run file \"%s\".\n", path);
+    }
+    close(fd);
+
+    const fcs_dbm_lsm_header *const header = run.map;
+    run.count = (size_t)header->count;
+    if (memcmp(header->magic, FCS_DBM_LSM_MAGIC, sizeof(header->magic)) ||
+        (run.map_len !=
+            sizeof(*header) + run.count * sizeof(fcs_dbm_lsm_record)))
+    {
+        exit_error("The run file \"%s\" is corrupt.\n", path);
+    }
+    run.records = (const fcs_dbm_lsm_record *)(header + 1);
+    madvise(run.map, run.map_len, MADV_RANDOM);
+
+    return run;
+}
+
+static inline void lsm__unmap_run(fcs_dbm_lsm_run *const run)
+{
+    munmap(run->map, run->map_len);
+}
+
+typedef struct
+{
+    FILE *fh;
+    uint64_t count;
+    char tmp_path[PATH_MAX];
+} fcs_dbm_lsm_writer;
+
+// A short write (e.g. on ENOSPC) would leave a run whose header counts more
+// records than the file holds, so it is fatal.
+static inline void lsm__writer_write(fcs_dbm_lsm_writer *const w,
+    const void *const ptr, const size_t size)
+{
+    if (fwrite(ptr, size, 1, w->fh) != 1)
+    {
+        exit_error("Failed writing \"%s\": %s.\n", w->tmp_path,
+            strerror(errno));
+    }
+}
+
+static void lsm__writer_start(fcs_dbm_lsm_writer *const w,
+    const fcs_dbm_lsm *const db, const unsigned long seq)
+{
+    lsm__run_path(db, seq, "tmp", w->tmp_path);
+    if (!(w->fh = fopen(w->tmp_path, "wb")))
+    {
+        exit_error("Cannot write to \"%s\".\n", w->tmp_path);
+    }
+    w->count = 0;
+    // The count is filled in by lsm__writer_finish().
+    fcs_dbm_lsm_header header = {.count = 0};
+    memcpy(header.magic, FCS_DBM_LSM_MAGIC, sizeof(header.magic));
+    lsm__writer_write(w, &header, sizeof(header));
+}
+
+static inline void lsm__writer_add(
+    fcs_dbm_lsm_writer *const w, const fcs_dbm_lsm_record *const record)
+{
+    lsm__writer_write(w, record, sizeof(*record));
+    ++w->count;
+}
+
+// Renames the run into place, possibly replacing an older file with the
+// same sequence number.
+static void lsm__writer_finish(fcs_dbm_lsm_writer *const w,
+    const fcs_dbm_lsm *const db, const unsigned long seq)
+{
+    if (fseek(w->fh, (long)offsetof(fcs_dbm_lsm_header, count), SEEK_SET))
+    {
+        exit_error("Cannot seek in \"%s\".\n", w->tmp_path);
+    }
+    lsm__writer_write(w, &(w->count), sizeof(w->count));
+    if (fclose(w->fh))
+    {
+        exit_error("Failed writing \"%s\".\n", w->tmp_path);
+    }
+    char path[PATH_MAX];
+    lsm__run_path(db, seq, "dat", path);
+    if (rename(w->tmp_path, path))
+    {
+        exit_error("Cannot rename \"%s\" to \"%s\".\n", w->tmp_path, path);
+    }
+}
+
+static void lsm__append_run(fcs_dbm_lsm *const db, const fcs_dbm_lsm_run run)
+{
+    if (db->num_runs == db->max_num_runs)
+    {
+        db->runs = SREALLOC(db->runs, (db->max_num_runs += 16));
+    }
+    db->runs[db->num_runs++] = run;
+}
+
+// Merges all the runs that exist when it is called into one run. The
+// offloads which happen meanwhile only append newer runs, so the merged run
+// takes the place of its inputs at the start of the list.
+static void lsm__compact(fcs_dbm_lsm *const db)
+{
+    fcs_lock_lock(&db->lock);
+    const size_t num_inputs = db->num_runs;
+    if (num_inputs < 2)
+    {
+        fcs_lock_unlock(&db->lock);
+        return;
+    }
+    fcs_dbm_lsm_run *const inputs = SMALLOC(inputs, num_inputs);
+    memcpy(inputs, db->runs, sizeof(inputs[0]) * num_inputs);
+    fcs_lock_unlock(&db->lock);
+
+    size_t *const positions = SMALLOC(positions, num_inputs);
+    memset(positions, '\0', sizeof(positions[0]) * num_inputs);
+    // The merged run reuses the sequence number of its newest input, so it
+    // sorts correctly against the runs which are newer than it.
+    const unsigned long seq = inputs[num_inputs - 1].seq;
+    fcs_dbm_lsm_writer w;
+    lsm__writer_start(&w, db, seq);
+    while (true)
+    {
+        const fcs_dbm_lsm_record *min = NULL;
+        for (size_t i = 0; i < num_inputs; ++i)
+        {
+            if (positions[i] == inputs[i].count)
+            {
+                continue;
+            }
+            const fcs_dbm_lsm_record *const rec =
+                &(inputs[i].records[positions[i]]);
+            // On equal keys the newer run wins.
+            if ((!min) || (lsm__compare_keys(rec->key.s, min) <= 0))
+            {
+                min = rec;
+            }
+        }
+        if (!min)
+        {
+            break;
+        }
+        const fcs_dbm_lsm_record record = *min;
+        lsm__writer_add(&w, &record);
+        for (size_t i = 0; i < num_inputs; ++i)
+        {
+            if ((positions[i] < inputs[i].count) &&
+                (!lsm__compare_keys(
+                    record.key.s, &(inputs[i].records[positions[i]]))))
+            {
+                ++positions[i];
+            }
+        }
+    }
+    free(positions);
+    lsm__writer_finish(&w, db, seq);
+    const_AUTO(merged, lsm__map_run(db, seq));
+
+    fcs_lock_lock(&db->lock);
+    db->runs[0] = merged;
+    memmove(db->runs + 1, db->runs + num_inputs,
+        sizeof(db->runs[0]) * (db->num_runs - num_inputs));
+    db->num_runs -= num_inputs - 1;
+    fcs_lock_unlock(&db->lock);
+
+    for (size_t i = 0; i < num_inputs; ++i)
+    {
+        lsm__unmap_run(&inputs[i]);
+        if (inputs[i].seq != seq)
+        {
+            char path[PATH_MAX];
+            lsm__run_path(db, inputs[i].seq, "dat", path);
+            unlink(path);
+        }
+    }
+    free(inputs);
+}
+
+#ifndef FCS_DBM_SINGLE_THREAD
+static void *lsm__compactor_thread(void *const void_db)
+{
+    fcs_dbm_lsm *const db = (fcs_dbm_lsm *)void_db;
+    while (true)
+    {
+        fcs_lock_lock(&db->lock);
+        while ((!db->should_quit) && (db->num_runs <= FCS_DBM_LSM_MAX_RUNS))
+        {
+            fcs_condvar__wait_on(&db->cond, &db->lock);
+        }
+        const bool should_quit = db->should_quit;
+        fcs_lock_unlock(&db->lock);
+        if (should_quit)
+        {
+            return NULL;
+        }
+        lsm__compact(db);
+    }
+}
+#endif
+
+static int lsm__compare_seqs(const void *const a, const void *const b)
+{
+    const unsigned long x = *(const unsigned long *)a,
+                        y = *(const unsigned long *)b;
+    return ((x < y) ? -1 : (x > y) ? 1 : 0);
+}
+
+void fc_solve_dbm_store_init(fcs_dbm_store *const store, const char *const path,
+    void **const recycle_bin_ptr GCC_UNUSED)
+{
+    fcs_dbm_lsm *const db = SMALLOC1(db);
+    db->dir = strdup(path);
+    db->runs = NULL;
+    db->num_runs = db->max_num_runs = 0;
+    db->next_seq = 0;
+    fcs_lock_init(&db->lock);
+    if (mkdir(path, 0775) && (errno != EEXIST))
+    {
+        exit_error("Cannot create the store directory \"%s\".\n", path);
+    }
+
+    DIR *const dh = opendir(path);
+    if (!dh)
+    {
+        exit_error("Cannot open the store directory \"%s\".\n", path);
+    }
+    unsigned long *seqs = NULL;
+    size_t num_seqs = 0;
+    const struct dirent *entry;
+    while ((entry = readdir(dh)))
+    {
+        unsigned long seq;
+        char ext[4];
+        if (sscanf(entry->d_name, "run-%10lu.%3s", &seq, ext) != 2)
+        {
+            continue;
+        }
+        if (!strcmp(ext, "dat"))
+        {
+            seqs = SREALLOC(seqs, num_seqs + 1);
+            seqs[num_seqs++] = seq;
+        }
+        else if (!strcmp(ext, "tmp"))
+        {
+            // A leftover of an interrupted offload or compaction.
+            char tmp_path[PATH_MAX];
+            lsm__run_path(db, seq, "tmp", tmp_path);
+            unlink(tmp_path);
+        }
+    }
+    closedir(dh);
+
+    if (num_seqs)
+    {
+        qsort(seqs, num_seqs, sizeof(seqs[0]), lsm__compare_seqs);
+    }
+    for (size_t i = 0; i < num_seqs; ++i)
+    {
+        lsm__append_run(db, lsm__map_run(db, seqs[i]));
+        db->next_seq = seqs[i] + 1;
+    }
+    free(seqs);
+
+#ifndef FCS_DBM_SINGLE_THREAD
+    fcs_condvar_init(&db->cond);
+    db->should_quit = false;
+    if (pthread_create(&db->compactor, NULL, lsm__compactor_thread, db))
+    {
+        exit_error("Cannot start the compaction thread.\n");
+    }
+#endif
+    *store = (fcs_dbm_store)db;
+}
+
+static inline const fcs_dbm_lsm_record *lsm__find(
+    const fcs_dbm_lsm *const db, const unsigned char *const key_raw)
+{
+    for (size_t run_idx = db->num_runs; run_idx-- > 0;)
+    {
+        const fcs_dbm_lsm_run *const run = &(db->runs[run_idx]);
+        size_t low = 0, high = run->count;
+        while (low < high)
+        {
+            const size_t mid = low + ((high - low) >> 1);
+            const int cmp = lsm__compare_keys(key_raw, &(run->records[mid]));
+            if (!cmp)
+            {
+                return &(run->records[mid]);
+            }
+            else if (cmp < 0)
+            {
+                high = mid;
+            }
+            else
+            {
+                low = mid + 1;
+            }
+        }
+    }
+    return NULL;
+}
+
+bool fc_solve_dbm_store_does_key_exist(
+    fcs_dbm_store store, const unsigned char *const key_raw)
+{
+    fcs_dbm_lsm *const db = (fcs_dbm_lsm *)store;
+    fcs_lock_lock(&db->lock);
+    const bool ret = (lsm__find(db, key_raw) != NULL);
+    fcs_lock_unlock(&db->lock);
+
+    return ret;
+}
+
+bool fc_solve_dbm_store_lookup_parent(fcs_dbm_store store,
+    const unsigned char *const key_raw, unsigned char *const parent)
+{
+    fcs_dbm_lsm *const db = (fcs_dbm_lsm *)store;
+    fcs_lock_lock(&db->lock);
+    const fcs_dbm_lsm_record *const record = lsm__find(db, key_raw);
+    if (record)
+    {
+        memcpy(parent, record->parent.s, sizeof(record->parent));
+    }
+    fcs_lock_unlock(&db->lock);
+
+    return (record != NULL);
+}
+
+extern void fc_solve_dbm_store_offload_pre_cache(
+    fcs_dbm_store store, fcs_pre_cache *const pre_cache)
+{
+    fcs_dbm_lsm *const db = (fcs_dbm_lsm *)store;
+    if (!pre_cache->count_elements)
+    {
+        return;
+    }
+    const unsigned long seq = db->next_seq++;
+    fcs_dbm_lsm_writer w;
+    lsm__writer_start(&w, db, seq);
+    // The pre-cache tree is ordered by the same memcmp() of the keys, so the
+    // run comes out sorted.
+    dict_t *const kaz_tree = pre_cache->kaz_tree;
+#ifdef FCS_DBM_USE_LIBAVL
+    struct rb_traverser trav;
+    rb_t_init(&trav, kaz_tree);
+    for (dict_key_t item = rb_t_first(&trav, kaz_tree); item;
+         item = rb_t_next(&trav))
+    {
+        const_AUTO(kv, (pre_cache_key_val_pair *)item);
+#else
+    for (dnode_t *node = fc_solve_kaz_tree_first(kaz_tree); node;
+         node = fc_solve_kaz_tree_next(kaz_tree, node))
+    {
+        const_AUTO(kv, (pre_cache_key_val_pair *)(node->dict_key));
+#endif
+        const fcs_dbm_lsm_record record = {
+            .key = kv->key, .parent = kv->parent};
+        lsm__writer_add(&w, &record);
+    }
+    lsm__writer_finish(&w, db, seq);
+    const_AUTO(run, lsm__map_run(db, seq));
+
+    fcs_lock_lock(&db->lock);
+    lsm__append_run(db, run);
+    const bool should_compact = (db->num_runs > FCS_DBM_LSM_MAX_RUNS);
+#ifndef FCS_DBM_SINGLE_THREAD
+    if (should_compact)
+    {
+        fcs_condvar_signal(&db->cond);
+    }
+#endif
+    fcs_lock_unlock(&db->lock);
+#ifdef FCS_DBM_SINGLE_THREAD
+    if (should_compact)
+    {
+        lsm__compact(db);
+    }
+#endif
+}
+
+extern void fc_solve_dbm_store_destroy(fcs_dbm_store store)
+{
+    fcs_dbm_lsm *const db = (fcs_dbm_lsm *)store;
+#ifndef FCS_DBM_SINGLE_THREAD
+    fcs_lock_lock(&db->lock);
+    db->should_quit = true;
+    fcs_condvar_signal(&db->cond);
+    fcs_lock_unlock(&db->lock);
+    pthread_join(db->compactor, NULL);
+    fcs_condvar_destroy(&db->cond);
+#endif
+    for (size_t i = 0; i < db->num_runs; ++i)
+    {
+        lsm__unmap_run(&(db->runs[i]));
+    }
+    free(db->runs);
+    fcs_lock_destroy(&db->lock);
+    free(db->dir);
+    free(db);
+}
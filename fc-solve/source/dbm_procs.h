@@ -139,6 +139,25 @@ typedef struct
     dbm_solver_thread *thread;
 } thread_arg;
 
+// Encodes the keys of all the derived states in a batch of lists, before they
+// are checked against the store. The delta stater's layout tables are shared
+// by the whole batch.
+static inline void fcs_dbm__encode_derived_states(
+    fcs_delta_stater *const delta_stater,
+    const fcs_dbm_variant_type local_variant, fcs_derived_state **const lists,
+    const size_t batch_size)
+{
+    for (size_t batch_i = 0; batch_i < batch_size; ++batch_i)
+    {
+        for (var_AUTO(derived_iter, lists[batch_i]); derived_iter;
+             derived_iter = derived_iter->next)
+        {
+            fcs_init_and_encode_state(delta_stater, local_variant,
+                &(derived_iter->state), &(derived_iter->key));
+        }
+    }
+}
+
 static inline void instance_check_key(
     dbm_solver_thread *const thread, dbm_solver_instance *const instance,
     const size_t key_depth, fcs_encoded_state_buffer *const key,
@@ -222,6 +241,24 @@ static void instance_print_stats(dbm_solver_instance *const instance)
         instance->common.num_states_in_collection,
         instance->common.count_of_items_in_queue,
         instance->common.count_num_processed);
+#if !defined(FCS_DBM_WITHOUT_CACHES) && !defined(FCS_DBM_CACHE_ONLY)
+    const_AUTO(bloom_stats, &(instance->common.bloom_stats));
+    if (bloom_stats->lookups)
+    {
+        const unsigned long not_in_store =
+            bloom_stats->negatives + bloom_stats->false_positives;
+        fprintf(out_fh,
+            ">>>Bloom Stats: lookups=%lu negatives=%lu false_positives=%lu "
+            "hit_rate=%.2f%% false_positive_rate=%.2f%%\n",
+            bloom_stats->lookups, bloom_stats->negatives,
+            bloom_stats->false_positives,
+            100.0 * (double)bloom_stats->negatives /
+                (double)bloom_stats->lookups,
+            (not_in_store ? (100.0 * (double)bloom_stats->false_positives /
+                                (double)not_in_store)
+                          : 0.0));
+    }
+#endif
     fflush(out_fh);
 }
 
@@ -252,20 +289,23 @@ static inline void instance_debug_out_state(
 #endif
 
 #ifndef FCS_DBM__VAL_IS_ANCESTOR
+// Collects copies of the records from ptr_initial_record up to the initial
+// state. Each copy retains the move that leads to it from the next one in the
+// trace (see fcs_dbm_record_get_move()).
 static void calc_trace(fcs_dbm_record *const ptr_initial_record,
-    fcs_encoded_state_buffer **const ptr_trace, size_t *const ptr_trace_num)
+    fcs_dbm_record **const ptr_trace, size_t *const ptr_trace_num)
 {
 #define GROW_BY 100
     size_t trace_num = 0;
     size_t trace_max_num = GROW_BY;
-    fcs_encoded_state_buffer *trace = SMALLOC(trace, trace_max_num);
-    fcs_encoded_state_buffer *key_ptr = trace;
+    fcs_dbm_record *trace = SMALLOC(trace, trace_max_num);
+    fcs_dbm_record *key_ptr = trace;
     fcs_dbm_record *record = ptr_initial_record;
 
     while (record)
     {
 #if 1
-        *(key_ptr) = record->key;
+        *(key_ptr) = *record;
         if ((++trace_num) == trace_max_num)
         {
             trace = SREALLOC(trace, trace_max_num += GROW_BY);
@@ -353,10 +393,17 @@ static inline void mark_and_sweep_old_states(
 #endif
 
 #ifndef FCS_DBM_WITHOUT_CACHES
+#ifndef FCS_DBM_CACHE_ONLY
+#define DESTROY_BLOOM(instance)                                                \
+    fcs_dbm_bloom_destroy(&((instance)->cache_store.bloom))
+#else
+#define DESTROY_BLOOM(instance)
+#endif
 #define DESTROY_CACHE(instance)                                                \
     {                                                                          \
         PRE_CACHE_OFFLOAD(instance);                                           \
         cache_destroy(&(instance->cache_store.cache));                         \
+        DESTROY_BLOOM(instance);                                               \
         DESTROY_STORE(instance);                                               \
     }
 #else
@@ -386,11 +433,14 @@ static inline void fcs_dbm__cache_store__init(
     meta_allocator *const meta_alloc GCC_UNUSED,
     const char *const dbm_store_path,
     const unsigned long pre_cache_max_count GCC_UNUSED,
-    const unsigned long caches_delta GCC_UNUSED)
+    const unsigned long caches_delta GCC_UNUSED,
+    const unsigned long bloom_filter_max_count GCC_UNUSED)
 {
 #ifndef FCS_DBM_WITHOUT_CACHES
 #ifndef FCS_DBM_CACHE_ONLY
     pre_cache_init(&(cache_store->pre_cache), meta_alloc);
+    fcs_dbm_bloom_init(&(cache_store->bloom), bloom_filter_max_count);
+    cache_store->bloom_stats = &(common->bloom_stats);
 #endif
     cache_init(
         &(cache_store->cache), pre_cache_max_count + caches_delta, meta_alloc);
@@ -406,7 +456,7 @@ typedef struct
     fcs_dbm_variant_type local_variant;
     const char *offload_dir_path, *dbm_store_path;
     unsigned long iters_delta_limit, max_num_states_in_collection;
-    unsigned long pre_cache_max_count, caches_delta;
+    unsigned long pre_cache_max_count, caches_delta, bloom_filter_max_count;
     size_t num_threads;
 } fcs_dbm_common_input;
 
@@ -418,6 +468,7 @@ static const fcs_dbm_common_input fcs_dbm_common_input_init = {
     .iters_delta_limit = ULONG_MAX,
     .max_num_states_in_collection = ULONG_MAX,
     .caches_delta = 1000000,
+    .bloom_filter_max_count = 0,
     .num_threads = 2};
 
 static inline bool fcs_dbm__extract_common_from_argv(const int argc,
@@ -479,6 +530,16 @@ static inline bool fcs_dbm__extract_common_from_argv(const int argc,
         }
         return true;
     }
+    else if ((param = TRY_PARAM("--bloom-filter-max-count")))
+    {
+        inp->bloom_filter_max_count = (unsigned long)atol(param);
+        if (inp->bloom_filter_max_count && inp->bloom_filter_max_count < 1000)
+        {
+            exit_error("--bloom-filter-max-count must be 0 (disabled) or at "
+                       "least 1,000.\n");
+        }
+        return true;
+    }
     else if ((param = TRY_PARAM("--dbm-store-path")))
     {
         inp->dbm_store_path = param;
@@ -489,7 +550,8 @@ static inline bool fcs_dbm__extract_common_from_argv(const int argc,
 
 static inline fcs_dbm_record *cache_store__has_key(
     fcs_dbm__cache_store__common *const cache_store,
-    fcs_encoded_state_buffer *const key, fcs_dbm_store_val parent)
+    fcs_encoded_state_buffer *const key, fcs_dbm_store_val parent,
+    const uint8_t move GCC_UNUSED)
 {
 #ifndef FCS_DBM_WITHOUT_CACHES
     if (cache_does_key_exist(&(cache_store->cache), key))
@@ -501,16 +563,35 @@ static inline fcs_dbm_record *cache_store__has_key(
     {
         return NULL;
     }
-    else if (fc_solve_dbm_store_does_key_exist(cache_store->store, key->s))
+    else
     {
-        cache_insert(&(cache_store->cache), key, NULL, '\0');
-        return NULL;
+        // Every key that can be in the store went through the pre-cache, and
+        // so was added to the filter by cache_store__insert_key().
+        const bool use_bloom = fcs_dbm_bloom_is_enabled(&(cache_store->bloom));
+        if (use_bloom)
+        {
+            ++cache_store->bloom_stats->lookups;
+            if (!fcs_dbm_bloom_may_contain(&(cache_store->bloom), key))
+            {
+                ++cache_store->bloom_stats->negatives;
+                return ((fcs_dbm_record *)key);
+            }
+        }
+        if (fc_solve_dbm_store_does_key_exist(cache_store->store, key->s))
+        {
+            cache_insert(&(cache_store->cache), key, NULL, '\0');
+            return NULL;
+        }
+        if (use_bloom)
+        {
+            ++cache_store->bloom_stats->false_positives;
+        }
     }
 #endif
     return ((fcs_dbm_record *)key);
 #else
     return fc_solve_dbm_store_insert_key_value(
-        cache_store->store, key, parent, true);
+        cache_store->store, key, parent, move, true);
 #endif
 }
 
@@ -522,6 +603,10 @@ static inline fcs_cache_key_info *cache_store__insert_key(
 {
 #ifndef FCS_DBM_CACHE_ONLY
     pre_cache_insert(&(cache_store->pre_cache), key, &(parent->key));
+    if (fcs_dbm_bloom_is_enabled(&(cache_store->bloom)))
+    {
+        fcs_dbm_bloom_insert(&(cache_store->bloom), key);
+    }
     return NULL;
 #else
     return cache_insert(&(cache_store->cache), key, moves_to_parent, move);
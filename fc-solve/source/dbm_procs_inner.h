@@ -61,50 +61,13 @@ static inline void dbm__free_threads(dbm_solver_instance *const instance,
 }
 
 #ifndef FCS_DBM__VAL_IS_ANCESTOR
-static uint8_t get_move_from_parent_to_child(
-    dbm_solver_instance *const instance, fcs_delta_stater *delta,
-    fcs_encoded_state_buffer parent, fcs_encoded_state_buffer child)
-{
-    fcs_state_keyval_pair parent_state;
-    fcs_derived_state *derived_list = NULL, *derived_list_recycle_bin = NULL;
-    DECLARE_IND_BUF_T(indirect_stacks_buffer)
-    const_AUTO(local_variant, instance->common.variant);
-
-    meta_allocator meta_alloc;
-    fc_solve_meta_compact_allocator_init(&meta_alloc);
-    compact_allocator derived_list_allocator;
-    fc_solve_compact_allocator_init(&(derived_list_allocator), &meta_alloc);
-    fc_solve_delta_stater_decode_into_state(
-        delta, parent.s, &parent_state, indirect_stacks_buffer);
-
-    instance_solver_thread_calc_derived_states(local_variant, &parent_state,
-        NULL, &derived_list, &derived_list_recycle_bin, &derived_list_allocator,
-        true);
-
-    for (var_AUTO(derived_iter, derived_list); derived_iter;
-         derived_iter = derived_iter->next)
-    {
-        fcs_encoded_state_buffer got_child;
-        fcs_init_and_encode_state(
-            delta, local_variant, &(derived_iter->state), &got_child);
-        if (compare_enc_states(&got_child, &child) == 0)
-        {
-            const_AUTO(move_to_return, derived_iter->move);
-            fc_solve_compact_allocator_finish(&(derived_list_allocator));
-            fc_solve_meta_compact_allocator_finish(&meta_alloc);
-            return move_to_return;
-        }
-    }
-    exit_error("%s\n", "Failed to find move. Terminating.");
-}
-
 static void trace_solution(dbm_solver_instance *const instance,
     FILE *const out_fh, fcs_delta_stater *const delta)
 {
     fprintf(out_fh, "%s\n", "Success!");
     fflush(out_fh);
 #ifdef FCS_DBM_WITHOUT_CACHES
-    fcs_encoded_state_buffer *trace;
+    fcs_dbm_record *trace;
     size_t trace_num;
     fcs_state_keyval_pair state;
     uint8_t move = '\0';
@@ -118,11 +81,10 @@ static void trace_solution(dbm_solver_instance *const instance,
     for (ssize_t i = (ssize_t)trace_num - 1; i >= 0; i--)
     {
         fc_solve_delta_stater_decode_into_state(
-            delta, trace[i].s, &state, indirect_stacks_buffer);
+            delta, trace[i].key.s, &state, indirect_stacks_buffer);
         if (i > 0)
         {
-            move = get_move_from_parent_to_child(
-                instance, delta, trace[i], trace[i - 1]);
+            move = fcs_dbm_record_get_move(&(trace[i - 1]));
             move_to_string(move, move_buffer);
         }
 
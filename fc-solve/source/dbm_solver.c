@@ -42,7 +42,7 @@ static inline void instance_init(dbm_solver_instance *const instance,
         max_num_states_in_collection, inp->local_variant, out_fh);
     fcs_dbm__cache_store__init(&(instance->cache_store), &(instance->common),
         &(instance->meta_alloc), inp->dbm_store_path, inp->pre_cache_max_count,
-        inp->caches_delta);
+        inp->caches_delta, inp->bloom_filter_max_count);
 }
 
 static inline void instance_recycle(dbm_solver_instance *const instance)
@@ -74,7 +74,7 @@ static inline void instance_check_key(
     dbm_solver_thread *const thread GCC_UNUSED,
     dbm_solver_instance *const instance, const size_t key_depth GCC_UNUSED,
     fcs_encoded_state_buffer *const key, fcs_dbm_record *const parent,
-    const uint8_t move GCC_UNUSED,
+    const uint8_t move,
     const fcs_which_moves_bitmask *const which_irreversible_moves_bitmask
         GCC_UNUSED
 #ifdef FCS_DBM_CACHE_ONLY
@@ -84,7 +84,8 @@ static inline void instance_check_key(
 )
 {
     fcs_dbm_record *token;
-    if ((token = cache_store__has_key(&instance->cache_store, key, parent)))
+    if ((token = cache_store__has_key(
+             &instance->cache_store, key, parent, move)))
     {
 #ifndef FCS_DBM_WITHOUT_CACHES
         fcs_cache_key_info *cache_key = cache_store__insert_key(
@@ -193,12 +194,8 @@ static void *instance_run_solver_thread(void *const void_arg)
             }
 
             // Encode all the states.
-            for (var_AUTO(derived_iter, derived_list); derived_iter;
-                 derived_iter = derived_iter->next)
-            {
-                fcs_init_and_encode_state(delta_stater, local_variant,
-                    &(derived_iter->state), &(derived_iter->key));
-            }
+            fcs_dbm__encode_derived_states(
+                delta_stater, local_variant, &derived_list, 1);
 
             instance_check_multiple_keys(
                 thread, instance, &(instance->cache_store),
@@ -279,7 +276,8 @@ static bool populate_instance_with_intermediate_input_line(
         &running_parent, running_moves, '\0');
 #else
     running_parent = fc_solve_dbm_store_insert_key_value(
-        instance->cache_store.store, &(running_key), running_parent, true);
+        instance->cache_store.store, &(running_key), running_parent, '\0',
+        true);
 #endif
     ++instance->common.num_states_in_collection;
 
@@ -356,8 +354,8 @@ static bool populate_instance_with_intermediate_input_line(
             running_moves = cache_ret->moves_to_key;
         }
 #else
-        token = fc_solve_dbm_store_insert_key_value(
-            instance->cache_store.store, &(running_key), running_parent, true);
+        token = fc_solve_dbm_store_insert_key_value(instance->cache_store.store,
+            &(running_key), running_parent, move, true);
         if (!token)
         {
             return false;
@@ -484,7 +482,7 @@ static bool handle_and_destroy_instance_solution(
                 }
 #else
                 size_t trace_num;
-                fcs_encoded_state_buffer *trace;
+                fcs_dbm_record *trace;
                 calc_trace(token, &trace, &trace_num);
 
 // We stop at 1 because the deepest state does not contain a move (as it is the
@@ -493,8 +491,7 @@ static bool handle_and_destroy_instance_solution(
                 for (int i = (int)trace_num - 1; i >= PENULTIMATE_DEPTH; i--)
                 {
                     fprintf(out_fh, "%.2X,",
-                        get_move_from_parent_to_child(
-                            instance, delta, trace[i], trace[i - 1]));
+                        (int)fcs_dbm_record_get_move(&(trace[i - 1])));
                 }
 #undef PENULTIMATE_DEPTH
                 free(trace);
@@ -743,7 +740,7 @@ int main(int argc, char *argv[])
             &(instance.cache_store), KEY_PTR(), &parent_state_enc, NULL, '\0');
 #else
         token = fc_solve_dbm_store_insert_key_value(
-            instance.cache_store.store, KEY_PTR(), NULL, true);
+            instance.cache_store.store, KEY_PTR(), NULL, '\0', true);
 #endif
 
         fcs_offloading_queue__insert(
@@ -21,6 +21,9 @@ extern "C" {
 #ifndef FCS_DBM_WITHOUT_CACHES
 
 #include "dbm_lru_cache.h"
+#ifndef FCS_DBM_CACHE_ONLY
+#include "dbm_bloom.h"
+#endif
 
 typedef union fcs_pre_cache_key_val_pair_struct {
     struct
@@ -50,7 +53,7 @@ bool fc_solve_dbm_store_lookup_parent(
 
 fcs_dbm_record *fc_solve_dbm_store_insert_key_value(fcs_dbm_store store,
     const fcs_encoded_state_buffer *key, fcs_dbm_store_val parent,
-    const bool should_modify_parent);
+    const uint8_t move, const bool should_modify_parent);
 
 #ifndef FCS_DBM_WITHOUT_CACHES
 void fc_solve_dbm_store_offload_pre_cache(
@@ -99,6 +102,9 @@ typedef struct
     fcs_encoded_state_buffer queue_solution;
 #endif
     void *tree_recycle_bin;
+#if !defined(FCS_DBM_WITHOUT_CACHES) && !defined(FCS_DBM_CACHE_ONLY)
+    fcs_dbm_bloom_stats bloom_stats;
+#endif
 } dbm_instance_common_elems;
 
 static inline void fcs_dbm__found_solution(
@@ -130,6 +136,10 @@ static inline void fcs_dbm__common_init(dbm_instance_common_elems *const common,
     common->max_count_num_processed = iters_delta_limit;
     common->count_of_items_in_queue = 0;
     common->tree_recycle_bin = NULL;
+#if !defined(FCS_DBM_WITHOUT_CACHES) && !defined(FCS_DBM_CACHE_ONLY)
+    common->bloom_stats = (fcs_dbm_bloom_stats){
+        .lookups = 0, .negatives = 0, .false_positives = 0};
+#endif
     fcs_lock_init(&common->storage_lock);
 }
 
@@ -138,6 +148,8 @@ typedef struct
 #ifndef FCS_DBM_WITHOUT_CACHES
 #ifndef FCS_DBM_CACHE_ONLY
     fcs_pre_cache pre_cache;
+    fcs_dbm_bloom bloom;
+    fcs_dbm_bloom_stats *bloom_stats;
 #endif
     fcs_lru_cache cache;
 #endif
@@ -0,0 +1,133 @@
+// This file is part of Freecell Solver. It is subject to the license terms in
+// the COPYING.txt file found in the top-level directory of this distribution
+// and at http://fc-solve.shlomifish.org/docs/distro/COPYING.html . No part of
+// Freecell Solver, including this file, may be copied, modified, propagated,
+// or distributed except according to the terms contained in the COPYING file.
+//
+// Copyright (c) 2026 Shlomi Fish
+// dead_end_fingerprints.h - a compact set of the hash values of the dead-end
+// states that were recycled out of the states' collection. A derived state
+// whose hash value is found there is not added to the collection again.
+//
+// Only the hash values (64 bits wide on 64-bit platforms) are kept, and not
+// the states themselves, so a live state whose hash value collides with that
+// of a recycled dead end is wrongly skipped as well. The chance of that is
+// about n*m/2^64 for n recycled dead ends and m derived states, but when it
+// happens the solver may miss a solution, or report a board that has one as
+// unsolvable.
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "fcs_hash.h"
+
+typedef struct
+{
+    // An open addressing table, where 0 marks a vacant entry.
+    fcs_hash_value *entries;
+    size_t size_bitmask;
+    size_t num_elems;
+} fcs_dead_end_fingerprints;
+
+#define FCS_DEAD_END_FINGERPRINTS_INITIAL_SIZE 4096
+
+static inline fcs_hash_value fcs_dead_end_fingerprint(
+    const fcs_hash_value hash_value)
+{
+    return (hash_value ? hash_value : 1);
+}
+
+static inline void fc_solve_dead_end_fingerprints_init(
+    fcs_dead_end_fingerprints *const fingerprints)
+{
+    *fingerprints = (fcs_dead_end_fingerprints){
+        .entries = NULL, .size_bitmask = 0, .num_elems = 0};
+}
+
+static inline void fc_solve_dead_end_fingerprints_free(
+    fcs_dead_end_fingerprints *const fingerprints)
+{
+    free(fingerprints->entries);
+    fc_solve_dead_end_fingerprints_init(fingerprints);
+}
+
+static inline bool fc_solve_dead_end_fingerprints_lookup(
+    const fcs_dead_end_fingerprints *const fingerprints,
+    const fcs_hash_value hash_value)
+{
+    if (fingerprints->num_elems == 0)
+    {
+        return false;
+    }
+    const fcs_hash_value fingerprint = fcs_dead_end_fingerprint(hash_value);
+    const_SLOT(entries, fingerprints);
+    const_SLOT(size_bitmask, fingerprints);
+    for (size_t i = (fingerprint & size_bitmask); entries[i];
+         i = ((i + 1) & size_bitmask))
+    {
+        if (entries[i] == fingerprint)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static inline void fc_solve_dead_end_fingerprints__place(
+    fcs_hash_value *const entries, const size_t size_bitmask,
+    const fcs_hash_value fingerprint)
+{
+    size_t i = (fingerprint & size_bitmask);
+    while (entries[i])
+    {
+        i = ((i + 1) & size_bitmask);
+    }
+    entries[i] = fingerprint;
+}
+
+// Returns false if there was no memory to add the fingerprint, in which case
+// the state should not be recycled.
+static inline bool fc_solve_dead_end_fingerprints_insert(
+    fcs_dead_end_fingerprints *const fingerprints,
+    const fcs_hash_value hash_value)
+{
+    const fcs_hash_value fingerprint = fcs_dead_end_fingerprint(hash_value);
+    // Keep the table at most half full.
+    if (((fingerprints->num_elems + 1) << 1) > fingerprints->size_bitmask)
+    {
+        const size_t old_size =
+            (fingerprints->entries ? (fingerprints->size_bitmask + 1) : 0);
+        const size_t new_size =
+            (old_size ? (old_size << 1)
+                      : FCS_DEAD_END_FINGERPRINTS_INITIAL_SIZE);
+        fcs_hash_value *const new_entries =
+            (fcs_hash_value *)calloc(new_size, sizeof(new_entries[0]));
+        if (!new_entries)
+        {
+            return false;
+        }
+        for (size_t i = 0; i < old_size; ++i)
+        {
+            if (fingerprints->entries[i])
+            {
+                fc_solve_dead_end_fingerprints__place(
+                    new_entries, new_size - 1, fingerprints->entries[i]);
+            }
+        }
+        free(fingerprints->entries);
+        fingerprints->entries = new_entries;
+        fingerprints->size_bitmask = new_size - 1;
+    }
+    fc_solve_dead_end_fingerprints__place(
+        fingerprints->entries, fingerprints->size_bitmask, fingerprint);
+    ++fingerprints->num_elems;
+
+    return true;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -18,8 +18,7 @@ extern "C" {
 #include "dbm_common.h"
 
 #ifdef FCS_DEBONDT_DELTA_STATES
-#include "var_base_writer.h"
-#include "var_base_reader.h"
+#include "var_base_table.h"
 #define FCS_ENCODED_STATE_COUNT_CHARS 16
 #define CARD_ARRAY_LEN ((RANK_KING + 1) * FCS_NUM_SUITS)
 
@@ -32,8 +31,11 @@ typedef struct
     size_t bits_per_orig_cards_in_column;
     int card_states[CARD_ARRAY_LEN];
     int8_t bakers_dozen_topmost_cards_lookup[((1 << 6) / 8) + 1];
-    fcs_var_base_reader r;
-    fcs_var_base_writer w;
+    // The sequence of bases is fixed for a given variant and initial state,
+    // so it is laid out once in fc_solve_delta_stater_init().
+    fcs_var_base_table table;
+    fcs_var_base_table_reader r;
+    fcs_var_base_table_writer w;
 } fcs_delta_stater;
 
 #else
@@ -74,18 +76,25 @@ typedef struct
 } fcs_dbm_record;
 #else
 
+// The move from the parent to this record is kept inside the record, so
+// tracing the solution does not need to recalculate the derived states of
+// every parent. On 64-bit builds, the refcount occupies the topmost byte of
+// parent_and_refcount and the move occupies the byte below it (user-space
+// pointers fit inside the lower 48 bits), so the record does not grow.
 typedef struct
 {
     fcs_encoded_state_buffer key;
     uintptr_t parent_and_refcount;
 #ifdef FCS_EXPLICIT_REFCOUNT
     uint8_t refcount;
+    uint8_t move;
 #endif
 } fcs_dbm_record;
 
 typedef fcs_dbm_record *fcs_dbm_store_val;
 #endif
 #define FCS_DBM_RECORD_SHIFT ((sizeof(rec->parent_and_refcount) - 1) * 8)
+#define FCS_DBM_RECORD_MOVE_SHIFT ((sizeof(rec->parent_and_refcount) - 2) * 8)
 
 #ifndef FCS_DBM__VAL_IS_ANCESTOR
 #ifdef FCS_EXPLICIT_REFCOUNT
@@ -99,7 +108,8 @@ static inline fcs_dbm_record *fcs_dbm_record_get_parent_ptr(
     fcs_dbm_record *const rec)
 {
     return (fcs_dbm_record *)(rec->parent_and_refcount &
-                              (~(((uintptr_t)0xFF) << FCS_DBM_RECORD_SHIFT)));
+                              (~(((uintptr_t)0xFFFF)
+                                  << FCS_DBM_RECORD_MOVE_SHIFT)));
 }
 #endif
 
@@ -109,9 +119,37 @@ static inline void fcs_dbm_record_set_parent_ptr(
     rec->parent_and_refcount = ((uintptr_t)parent_ptr);
 #ifdef FCS_EXPLICIT_REFCOUNT
     rec->refcount = 0;
+    rec->move = 0;
 #endif
 }
 
+#ifdef FCS_EXPLICIT_REFCOUNT
+static inline uint8_t fcs_dbm_record_get_move(const fcs_dbm_record *const rec)
+{
+    return rec->move;
+}
+
+static inline void fcs_dbm_record_set_move(
+    fcs_dbm_record *const rec, const uint8_t move)
+{
+    rec->move = move;
+}
+#else
+static inline uint8_t fcs_dbm_record_get_move(const fcs_dbm_record *const rec)
+{
+    return (uint8_t)(rec->parent_and_refcount >> FCS_DBM_RECORD_MOVE_SHIFT);
+}
+
+static inline void fcs_dbm_record_set_move(
+    fcs_dbm_record *const rec, const uint8_t move)
+{
+    rec->parent_and_refcount &=
+        (~(((const uintptr_t)0xFF) << FCS_DBM_RECORD_MOVE_SHIFT));
+    rec->parent_and_refcount |=
+        (((const uintptr_t)move) << FCS_DBM_RECORD_MOVE_SHIFT);
+}
+#endif
+
 #ifdef FCS_EXPLICIT_REFCOUNT
 static inline uint8_t fcs_dbm_record_get_refcount(
     const fcs_dbm_record *const rec)
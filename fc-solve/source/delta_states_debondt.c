@@ -44,12 +44,14 @@ DLLEXPORT char *fc_solve_user_INTERNAL_delta_states_enc_and_dec(
     fc_solve_state_init(
         &new_derived_state, STACKS_NUM, new_derived_indirect_stacks_buffer);
 
-    fc_solve_var_base_writer_start(&(delta.w));
+    fc_solve_var_base_table_writer_start(&(delta.w));
     fc_solve_delta_stater_encode_composite(&delta, local_variant, &(delta.w));
     memset(enc_state, '\0', sizeof(enc_state));
-    fc_solve_var_base_writer_get_data(&(delta.w), enc_state);
+    fc_solve_var_base_table_writer_get_data(
+        &(delta.w), &(delta.table), enc_state);
 
-    fc_solve_var_base_reader_start(&(delta.r), enc_state, sizeof(enc_state));
+    fc_solve_var_base_table_reader_start(
+        &(delta.r), &(delta.table), enc_state, sizeof(enc_state));
     fc_solve_delta_stater_decode(
         &delta, local_variant, &(delta.r), &(new_derived_state.s));
 
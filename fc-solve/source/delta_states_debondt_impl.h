@@ -36,6 +36,62 @@ enum
 
 #define IS_BAKERS_DOZEN() (local_variant == FCS_DBM_VARIANT_BAKERS_DOZEN)
 
+static inline int get_top_rank_for_iter(
+    const fcs_dbm_variant_type local_variant)
+{
+    return (IS_BAKERS_DOZEN() ? (RANK_KING - 1) : RANK_KING);
+}
+
+// Returns the base in which the state of the card is encoded, or 0 if the
+// card is not encoded at all.
+static inline unsigned long delta_stater__calc_card_base(
+    const fcs_delta_stater *const self,
+    const fcs_dbm_variant_type local_variant, const int rank,
+    const int suit_idx)
+{
+    if (IS_BAKERS_DOZEN())
+    {
+        const_AUTO(card,
+            fcs_card2char(fcs_make_card((fcs_card)rank, (fcs_card)suit_idx)));
+
+        return ((self->bakers_dozen_topmost_cards_lookup[card >> 3] &
+                    (1 << (card & (8 - 1))))
+                    ? 0
+                    : NUM__BAKERS_DOZEN__OPTS);
+    }
+    else
+    {
+        return ((rank == RANK_KING) ? NUM_KING_OPTS : NUM_OPTS);
+    }
+}
+
+// Lays out the bases in the same order in which
+// fc_solve_delta_stater_encode_composite() writes the digits.
+static inline void fc_solve_delta_stater__init_table(
+    fcs_delta_stater *const self, const fcs_dbm_variant_type local_variant)
+{
+    fcs_var_base_table *const table = &(self->table);
+    fc_solve_var_base_table_init(table);
+
+    for (size_t suit_idx = 0; suit_idx < FCS_NUM_SUITS; ++suit_idx)
+    {
+        fc_solve_var_base_table_add_digit(table, FOUNDATION_BASE);
+    }
+    const int top_rank_for_iter = get_top_rank_for_iter(local_variant);
+    for (int rank = 2; rank <= top_rank_for_iter; ++rank)
+    {
+        for (int suit_idx = 0; suit_idx < FCS_NUM_SUITS; ++suit_idx)
+        {
+            const unsigned long base = delta_stater__calc_card_base(
+                self, local_variant, rank, suit_idx);
+            if (base)
+            {
+                fc_solve_var_base_table_add_digit(table, base);
+            }
+        }
+    }
+}
+
 static inline void fc_solve_delta_stater_init(fcs_delta_stater *const self,
     const fcs_dbm_variant_type local_variant, fcs_state *const init_state,
     const size_t num_columns,
@@ -50,8 +106,8 @@ static inline void fc_solve_delta_stater_init(fcs_delta_stater *const self,
     memset(self->bakers_dozen_topmost_cards_lookup, '\0',
         sizeof(self->bakers_dozen_topmost_cards_lookup));
 
-    fc_solve_var_base_writer_init(&self->w);
-    fc_solve_var_base_reader_init(&self->r);
+    fc_solve_var_base_table_writer_init(&self->w);
+    fc_solve_var_base_table_reader_init(&self->r);
 
     if (IS_BAKERS_DOZEN())
     {
@@ -73,6 +129,8 @@ static inline void fc_solve_delta_stater_init(fcs_delta_stater *const self,
         }
 #pragma GCC diagnostic pop
     }
+
+    fc_solve_delta_stater__init_table(self, local_variant);
 }
 
 static inline void fc_solve_delta_stater__init_card_states(
@@ -90,8 +148,8 @@ static inline void fc_solve_delta_stater__init_card_states(
 #else
 static inline void fc_solve_delta_stater_release(fcs_delta_stater *const self)
 {
-    fc_solve_var_base_reader_release(&(self->r));
-    fc_solve_var_base_writer_release(&(self->w));
+    fc_solve_var_base_table_reader_release(&(self->r));
+    fc_solve_var_base_table_writer_release(&(self->w));
 }
 #endif
 
@@ -137,14 +195,9 @@ static inline int calc_child_card_option(
     }
 }
 
-static inline int get_top_rank_for_iter(
-    const fcs_dbm_variant_type local_variant)
-{
-    return (IS_BAKERS_DOZEN() ? (RANK_KING - 1) : RANK_KING);
-}
-
 static void fc_solve_delta_stater_encode_composite(fcs_delta_stater *const self,
-    const fcs_dbm_variant_type local_variant, fcs_var_base_writer *const writer)
+    const fcs_dbm_variant_type local_variant,
+    fcs_var_base_table_writer *const writer)
 {
     fcs_state *const derived = self->derived_state;
 
@@ -154,7 +207,8 @@ static void fc_solve_delta_stater_encode_composite(fcs_delta_stater *const self,
     {
         const unsigned long rank = fcs_foundation_value(*derived, suit_idx);
 
-        fc_solve_var_base_writer_write(writer, FOUNDATION_BASE, rank);
+        fc_solve_var_base_table_writer_write(
+            writer, &(self->table), FOUNDATION_BASE, rank);
 
         const unsigned long max_rank = ((rank < 1) ? 1 : rank);
 
@@ -262,30 +316,19 @@ static void fc_solve_delta_stater_encode_composite(fcs_delta_stater *const self,
     {
         for (int suit_idx = 0; suit_idx < FCS_NUM_SUITS; ++suit_idx)
         {
-            const unsigned long opt =
-                (unsigned long)RS_STATE((fcs_card)rank, (fcs_card)suit_idx);
-            unsigned long base;
-
-            if (IS_BAKERS_DOZEN())
-            {
-                const_AUTO(card, fcs_card2char(fcs_make_card(
-                                     (fcs_card)rank, (fcs_card)suit_idx)));
-
-                if (self->bakers_dozen_topmost_cards_lookup[card >> 3] &
-                    (1 << (card & (8 - 1))))
-                {
-                    continue;
-                }
-                base = NUM__BAKERS_DOZEN__OPTS;
-            }
-            else
+            const unsigned long base = delta_stater__calc_card_base(
+                self, local_variant, rank, suit_idx);
+            if (!base)
             {
-                base = ((rank == RANK_KING) ? NUM_KING_OPTS : NUM_OPTS);
+                continue;
             }
+            const unsigned long opt =
+                (unsigned long)RS_STATE((fcs_card)rank, (fcs_card)suit_idx);
 
             assert(opt < base);
 
-            fc_solve_var_base_writer_write(writer, base, opt);
+            fc_solve_var_base_table_writer_write(
+                writer, &(self->table), base, opt);
         }
     }
 }
@@ -328,8 +371,8 @@ static inline void delta_stater__fill_column_with_descendent_cards(
 }
 
 static void fc_solve_delta_stater_decode(fcs_delta_stater *const self,
-    const fcs_dbm_variant_type local_variant, fcs_var_base_reader *const reader,
-    fcs_state *const ret)
+    const fcs_dbm_variant_type local_variant,
+    fcs_var_base_table_reader *const reader, fcs_state *const ret)
 {
     fcs_card new_top_most_cards[MAX_NUM_STACKS];
 
@@ -338,7 +381,8 @@ static void fc_solve_delta_stater_decode(fcs_delta_stater *const self,
     for (int suit_idx = 0; suit_idx < FCS_NUM_SUITS; ++suit_idx)
     {
         const unsigned long foundation_rank =
-            fc_solve_var_base_reader_read(reader, FOUNDATION_BASE);
+            fc_solve_var_base_table_reader_read(
+                reader, &(self->table), FOUNDATION_BASE);
 
         for (unsigned long rank = 1; rank <= foundation_rank; ++rank)
         {
@@ -428,7 +472,8 @@ static void fc_solve_delta_stater_decode(fcs_delta_stater *const self,
                             ? NUM__BAKERS_DOZEN__OPTS
                             : ((rank == RANK_KING) ? NUM_KING_OPTS : NUM_OPTS));
                 const unsigned long item_opt =
-                    fc_solve_var_base_reader_read(reader, base);
+                    fc_solve_var_base_table_reader_read(
+                        reader, &(self->table), base);
 
                 if (existing_opt < 0)
                 {
@@ -534,8 +579,8 @@ static inline void fc_solve_delta_stater_decode_into_state_proto(
     fcs_delta_stater *const delta_stater, const rin_uchar *const enc_state,
     fcs_state_keyval_pair *const ret IND_BUF_T_PARAM(indirect_stacks_buffer))
 {
-    fc_solve_var_base_reader_start(
-        &(delta_stater->r), enc_state, sizeof(fcs_encoded_state_buffer));
+    fc_solve_var_base_table_reader_start(&(delta_stater->r),
+        &(delta_stater->table), enc_state, sizeof(fcs_encoded_state_buffer));
 
     fc_solve_state_init(ret, STACKS_NUM, indirect_stacks_buffer);
 
@@ -548,10 +593,11 @@ static inline void fc_solve_delta_stater_encode_into_buffer(
     const fcs_dbm_variant_type local_variant,
     fcs_state_keyval_pair *const state, unsigned char *const out_enc_state)
 {
-    fc_solve_var_base_writer_start(&(delta_stater->w));
+    fc_solve_var_base_table_writer_start(&(delta_stater->w));
     fc_solve_delta_stater_set_derived(delta_stater, &(state->s));
     fc_solve_delta_stater_encode_composite(
         delta_stater, local_variant, &(delta_stater->w));
-    fc_solve_var_base_writer_get_data(&(delta_stater->w), out_enc_state);
+    fc_solve_var_base_table_writer_get_data(
+        &(delta_stater->w), &(delta_stater->table), out_enc_state);
 }
 #endif
@@ -62,7 +62,8 @@ static inline void instance_init(dbm_solver_instance *const instance,
 
         fcs_dbm__cache_store__init(&(coll->cache_store), &(instance->common),
             &(coll->queue_meta_alloc), inp->dbm_store_path,
-            inp->pre_cache_max_count, inp->caches_delta);
+            inp->pre_cache_max_count, inp->caches_delta,
+            inp->bloom_filter_max_count);
     }
     fcs_condvar_init(&(instance->monitor));
 }
@@ -198,15 +199,8 @@ static void *instance_run_solver_thread(void *const void_arg)
         }
 
         // Encode all the states.
-        for (fcs_batch_size batch_i = 0; batch_i < batch_size; ++batch_i)
-        {
-            for (var_AUTO(derived_iter, derived_lists[batch_i]); derived_iter;
-                 derived_iter = derived_iter->next)
-            {
-                fcs_init_and_encode_state(delta_stater, local_variant,
-                    &(derived_iter->state), &(derived_iter->key));
-            }
-        }
+        fcs_dbm__encode_derived_states(
+            delta_stater, local_variant, derived_lists, batch_size);
 
         instance_check_multiple_keys(thread, instance, &(coll->cache_store),
             &(thread->thread_meta_alloc), derived_lists, batch_size
@@ -236,7 +230,7 @@ static inline void instance_check_key(
     dbm_solver_thread *const thread GCC_UNUSED,
     dbm_solver_instance *const instance, const size_t key_depth,
     fcs_encoded_state_buffer *const key, fcs_dbm_record *const parent,
-    const unsigned char move GCC_UNUSED,
+    const unsigned char move,
     const fcs_which_moves_bitmask *const which_irreversible_moves_bitmask
         GCC_UNUSED
 #ifdef FCS_DBM_CACHE_ONLY
@@ -248,7 +242,7 @@ static inline void instance_check_key(
     const_AUTO(coll, &(instance->colls_by_depth[key_depth]));
     fcs_dbm_record *token;
 
-    if ((token = cache_store__has_key(&coll->cache_store, key, parent)))
+    if ((token = cache_store__has_key(&coll->cache_store, key, parent, move)))
     {
 #ifndef FCS_DBM_WITHOUT_CACHES
         fcs_cache_key_info *cache_key = cache_store__insert_key(
@@ -361,7 +355,8 @@ int main(int argc, char *argv[])
         &(instance.cache_store), KEY_PTR(), &parent_state_enc, NULL, '\0');
 #else
     token = fc_solve_dbm_store_insert_key_value(
-        instance.colls_by_depth[0].cache_store.store, KEY_PTR(), NULL, true);
+        instance.colls_by_depth[0].cache_store.store, KEY_PTR(), NULL, '\0',
+        true);
 #endif
 
     fcs_offloading_queue__insert(&(instance.colls_by_depth[0].queue),
@@ -0,0 +1,390 @@
+// This file is part of Freecell Solver. It is subject to the license terms in
+// the COPYING.txt file found in the top-level directory of this distribution
+// and at http://fc-solve.shlomifish.org/docs/distro/COPYING.html . No part of
+// Freecell Solver, including this file, may be copied, modified, propagated,
+// or distributed except according to the terms contained in the COPYING file.
+//
+// Copyright (c) 2026 Shlomi Fish
+// endgame_tablebase.h - an endgame tablebase: the exact distances to the
+// solution of all the winnable positions with at most a few cards left outside
+// the foundations. A position that is small enough but is absent from the
+// tablebase cannot be won.
+//
+// The tablebase is generated by a retrograde breadth-first search that starts
+// at the solved position (see endgame_tablebase_gen.c), and is written as a
+// header followed by the records sorted by their keys, so the solver can
+// mmap() it and look up positions using a binary search.
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "rinutils/bit_rw.h"
+#include "plain_position.h"
+
+#define FCS_ETB_MAGIC "FCSETB01"
+// The generator keeps the whole table in memory, and every card more makes it
+// about 12 times larger: 7 cards take about 1.4GB at the peak, and 8 cards
+// would take over 10GB.
+#define FCS_ETB_MAX_CARDS 7
+#define FCS_ETB_KEY_LEN 24
+#define FCS_ETB_MAX_DISTANCE 254
+#define FCS_ETB_NO_DISTANCE 255
+// The return values of fc_solve_etb_lookup() and fc_solve_etb_probe() that
+// are not distances.
+#define FCS_ETB_LOSS (-1)
+#define FCS_ETB_NOT_APPLICABLE (-2)
+
+// A canonical encoding of a position, which does not depend on the order of
+// the columns and the freecells. Unlike the delta states of the DBM solvers,
+// it is not relative to the initial layout of a deal, so a single tablebase
+// can serve all the deals.
+typedef struct
+{
+    uint8_t s[FCS_ETB_KEY_LEN];
+} fcs_etb_key;
+
+typedef struct
+{
+    fcs_etb_key key;
+    uint8_t distance;
+} fcs_etb_record;
+
+typedef struct
+{
+    char magic[8];
+    uint8_t max_cards;
+    uint8_t num_freecells;
+    uint8_t num_columns;
+    uint8_t sequences_are_built_by;
+    uint8_t empty_stacks_fill;
+    uint8_t unlimited_sequence_move;
+    uint8_t padding[2];
+    uint64_t num_records;
+} fcs_etb_header;
+
+typedef struct
+{
+    fcs_plain_rules game;
+    size_t max_cards;
+} fcs_etb_rules;
+
+typedef struct
+{
+    void *map;
+    size_t map_len;
+    fcs_etb_rules rules;
+    const fcs_etb_record *records;
+    size_t num_records;
+} fcs_endgame_tablebase;
+
+static inline size_t fc_solve_etb__num_bits(const fcs_etb_rules *const rules)
+{
+    const size_t max_cards = rules->max_cards;
+    return 6 * rules->game.num_freecells + 4 +
+           5 * min(rules->game.num_columns, max_cards) + 6 * max_cards;
+}
+
+static inline bool fc_solve_etb_rules_are_valid(
+    const fcs_etb_rules *const rules)
+{
+    return ((rules->max_cards >= 1) &&
+            (rules->max_cards <= FCS_ETB_MAX_CARDS) &&
+            (rules->game.num_freecells <= MAX_NUM_FREECELLS) &&
+            (rules->game.num_columns >= 1) &&
+            (rules->game.num_columns <= MAX_NUM_STACKS) &&
+            // The number of the non-empty columns is encoded in 4 bits.
+            (min(rules->game.num_columns, rules->max_cards) <= 15) &&
+            (fc_solve_etb__num_bits(rules) <= FCS_ETB_KEY_LEN * 8));
+}
+
+static inline int fc_solve_etb__compare_cols(
+    const fcs_plain_position *const pos, const size_t a_idx, const size_t b_idx)
+{
+    const size_t a_len = pos->cols_lens[a_idx];
+    const size_t b_len = pos->cols_lens[b_idx];
+    const int ret =
+        memcmp(pos->cols[a_idx], pos->cols[b_idx], min(a_len, b_len));
+    return (ret ? ret : ((int)a_len - (int)b_len));
+}
+
+// The freecells are sorted by their cards and the non-empty columns are
+// sorted by their sequences of cards. The foundations are implied by the
+// cards that remain outside them.
+static inline void fc_solve_etb_encode(const fcs_plain_rules *const rules,
+    const fcs_plain_position *const pos, fcs_etb_key *const key)
+{
+    // One spare byte, because the writer clears the byte after the last one
+    // that it filled.
+    rin_uchar buffer[FCS_ETB_KEY_LEN + 1];
+    rin_bit_writer writer;
+    rin_bit_writer_init_and_clear(&writer, buffer);
+
+    fcs_card freecells[MAX_NUM_FREECELLS];
+    const size_t num_freecells = rules->num_freecells;
+    for (size_t i = 0; i < num_freecells; ++i)
+    {
+        const fcs_card card = pos->freecells[i];
+        size_t j = i;
+        for (; (j > 0) && (freecells[j - 1] > card); --j)
+        {
+            freecells[j] = freecells[j - 1];
+        }
+        freecells[j] = card;
+    }
+    for (size_t i = 0; i < num_freecells; ++i)
+    {
+        rin_bit_writer_write(&writer, 6, freecells[i]);
+    }
+
+    size_t cols_indexes[MAX_NUM_STACKS];
+    size_t num_cols = 0;
+    for (size_t i = 0; i < rules->num_columns; ++i)
+    {
+        if (!pos->cols_lens[i])
+        {
+            continue;
+        }
+        size_t j = num_cols++;
+        for (; (j > 0) && (fc_solve_etb__compare_cols(
+                               pos, cols_indexes[j - 1], i) > 0);
+             --j)
+        {
+            cols_indexes[j] = cols_indexes[j - 1];
+        }
+        cols_indexes[j] = i;
+    }
+    rin_bit_writer_write(&writer, 4, num_cols);
+    for (size_t i = 0; i < num_cols; ++i)
+    {
+        const size_t col_idx = cols_indexes[i];
+        const size_t col_len = pos->cols_lens[col_idx];
+        rin_bit_writer_write(&writer, 5, col_len);
+        for (size_t c = 0; c < col_len; ++c)
+        {
+            rin_bit_writer_write(&writer, 6, pos->cols[col_idx][c]);
+        }
+    }
+    memset(key, '\0', sizeof(*key));
+    memcpy(key->s, buffer,
+        (size_t)(writer.current - buffer) + (writer.bit_in_char_idx ? 1 : 0));
+}
+
+static inline void fc_solve_etb_decode(const fcs_plain_rules *const rules,
+    const fcs_etb_key *const key, fcs_plain_position *const pos)
+{
+    memset(pos, '\0', sizeof(*pos));
+    uint8_t lowest_ranks[FCS_NUM_SUITS] = {14, 14, 14, 14};
+#define PROCESS_CARD(card)                                                     \
+    if (fcs_card_rank(card) < lowest_ranks[fcs_card_suit(card)])               \
+    {                                                                          \
+        lowest_ranks[fcs_card_suit(card)] = fcs_card_rank(card);               \
+    }
+    rin_bit_reader reader;
+    rin_bit_reader_init(&reader, key->s);
+    for (size_t i = 0; i < rules->num_freecells; ++i)
+    {
+        const fcs_card card = (fcs_card)rin_bit_reader_read(&reader, 6);
+        if (fcs_card_is_valid(card))
+        {
+            PROCESS_CARD(card);
+        }
+        pos->freecells[i] = card;
+    }
+    const size_t num_cols = rin_bit_reader_read(&reader, 4);
+    for (size_t i = 0; i < num_cols; ++i)
+    {
+        const size_t col_len = rin_bit_reader_read(&reader, 5);
+        pos->cols_lens[i] = (uint8_t)col_len;
+        for (size_t c = 0; c < col_len; ++c)
+        {
+            const fcs_card card = (fcs_card)rin_bit_reader_read(&reader, 6);
+            PROCESS_CARD(card);
+            pos->cols[i][c] = card;
+        }
+    }
+#undef PROCESS_CARD
+    for (size_t suit = 0; suit < FCS_NUM_SUITS; ++suit)
+    {
+        pos->foundations[suit] = (uint8_t)(lowest_ranks[suit] - 1);
+    }
+}
+
+static inline int fc_solve_etb_lookup(
+    const fcs_endgame_tablebase *const etb, const fcs_etb_key *const key)
+{
+    size_t low = 0, high = etb->num_records;
+    while (low < high)
+    {
+        const size_t mid = low + ((high - low) >> 1);
+        const int cmp = memcmp(key, &(etb->records[mid].key), sizeof(*key));
+        if (cmp == 0)
+        {
+            return etb->records[mid].distance;
+        }
+        if (cmp < 0)
+        {
+            high = mid;
+        }
+        else
+        {
+            low = mid + 1;
+        }
+    }
+
+    return FCS_ETB_LOSS;
+}
+
+// Returns false if the position has more cards than the tablebase covers.
+static inline bool fc_solve_etb_position_from_state(
+    const fcs_etb_rules *const rules, const fcs_state *const s,
+    fcs_plain_position *const pos)
+{
+    size_t num_cards = 0;
+    for (size_t i = 0; i < rules->game.num_freecells; ++i)
+    {
+        num_cards += fcs_freecell_is_empty(*s, i) ? 0 : 1;
+    }
+    for (size_t i = 0; i < rules->game.num_columns; ++i)
+    {
+        num_cards +=
+            (size_t)fcs_col_len(fcs_state_get_col(*(fcs_state *)s, i));
+    }
+    if (num_cards > rules->max_cards)
+    {
+        return false;
+    }
+    fc_solve_plain_position_from_state(&(rules->game), s, pos);
+
+    return true;
+}
+
+// Returns the distance of the state to the solution, FCS_ETB_LOSS if it
+// cannot be won, or FCS_ETB_NOT_APPLICABLE if it has too many cards.
+static inline int fc_solve_etb_probe(
+    const fcs_endgame_tablebase *const etb, const fcs_state *const s)
+{
+    fcs_plain_position pos;
+    if (!fc_solve_etb_position_from_state(&(etb->rules), s, &pos))
+    {
+        return FCS_ETB_NOT_APPLICABLE;
+    }
+    fcs_etb_key key;
+    fc_solve_etb_encode(&(etb->rules.game), &pos, &key);
+
+    return fc_solve_etb_lookup(etb, &key);
+}
+
+// Follows the tablebase from a winnable position to the solution. Returns
+// the number of moves placed in moves, or -1 if the position is not in
+// the tablebase.
+static inline int fc_solve_etb_solve(const fcs_endgame_tablebase *const etb,
+    fcs_plain_position pos, fcs_plain_move moves[FCS_ETB_MAX_DISTANCE])
+{
+    const fcs_plain_rules *const rules = &(etb->rules.game);
+    fcs_etb_key key;
+    fc_solve_etb_encode(rules, &pos, &key);
+    int distance = fc_solve_etb_lookup(etb, &key);
+    if (distance < 0)
+    {
+        return -1;
+    }
+    const int num_moves = distance;
+    fcs_plain_move derived_moves[FCS_PLAIN_MAX_NUM_MOVES];
+    for (int i = 0; i < num_moves; ++i)
+    {
+        const size_t num_derived =
+            fc_solve_plain_gen_moves(rules, &pos, derived_moves);
+        size_t m = 0;
+        for (; m < num_derived; ++m)
+        {
+            fcs_plain_position derived_pos = pos;
+            fc_solve_plain_apply_move(&derived_pos, derived_moves[m]);
+            fc_solve_etb_encode(rules, &derived_pos, &key);
+            if (fc_solve_etb_lookup(etb, &key) == distance - 1)
+            {
+                pos = derived_pos;
+                break;
+            }
+        }
+        if (m == num_derived)
+        {
+            return -1;
+        }
+        moves[i] = derived_moves[m];
+        --distance;
+    }
+
+    return num_moves;
+}
+
+static inline bool fc_solve_etb_load(
+    fcs_endgame_tablebase *const etb, const char *const filename)
+{
+    const int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat st;
+    if ((fstat(fd, &st) != 0) || ((size_t)st.st_size < sizeof(fcs_etb_header)))
+    {
+        close(fd);
+        return false;
+    }
+    const size_t map_len = (size_t)st.st_size;
+    void *const map = mmap(NULL, map_len, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        return false;
+    }
+    const fcs_etb_header *const header = (const fcs_etb_header *)map;
+    const fcs_etb_rules rules = {
+        .game =
+            {
+                .num_freecells = header->num_freecells,
+                .num_columns = header->num_columns,
+                .sequences_are_built_by = header->sequences_are_built_by,
+                .empty_stacks_fill = header->empty_stacks_fill,
+                .unlimited_sequence_move =
+                    (header->unlimited_sequence_move != 0),
+            },
+        .max_cards = header->max_cards,
+    };
+    if (memcmp(header->magic, FCS_ETB_MAGIC, sizeof(header->magic)) ||
+        (!fc_solve_etb_rules_are_valid(&rules)) ||
+        (header->num_records !=
+            (map_len - sizeof(*header)) / sizeof(fcs_etb_record)))
+    {
+        munmap(map, map_len);
+        return false;
+    }
+    *etb = (fcs_endgame_tablebase){
+        .map = map,
+        .map_len = map_len,
+        .rules = rules,
+        .records = (const fcs_etb_record *)(header + 1),
+        .num_records = (size_t)header->num_records,
+    };
+
+    return true;
+}
+
+static inline void fc_solve_etb_unload(fcs_endgame_tablebase *const etb)
+{
+    if (etb->map)
+    {
+        munmap(etb->map, etb->map_len);
+    }
+    *etb = (fcs_endgame_tablebase){.map = NULL};
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,142 @@
+// This file is part of Freecell Solver. It is subject to the license terms in
+// the COPYING.txt file found in the top-level directory of this distribution
+// and at http://fc-solve.shlomifish.org/docs/distro/COPYING.html . No part of
+// Freecell Solver, including this file, may be copied, modified, propagated,
+// or distributed except according to the terms contained in the COPYING file.
+//
+// Copyright (c) 2026 Shlomi Fish
+// endgame_tablebase_gen.c - generates an endgame tablebase for use with
+// fc-solve's --endgame-tablebase flag.
+#include "endgame_tablebase_gen.h"
+
+int main(int argc, char *argv[])
+{
+    fcs_etb_rules rules = {
+        .game =
+            {
+                .num_freecells = 4,
+                .num_columns = 8,
+                .sequences_are_built_by = FCS_SEQ_BUILT_BY_ALTERNATE_COLOR,
+                .empty_stacks_fill = FCS_ES_FILLED_BY_ANY_CARD,
+                .unlimited_sequence_move = false,
+            },
+        .max_cards = 6,
+    };
+    fcs_plain_rules *const game = &(rules.game);
+    const char *output_filename = NULL;
+
+    for (int arg = 1; arg < argc; ++arg)
+    {
+        const char *const param = argv[arg];
+        if (arg + 1 == argc)
+        {
+            exit_error("An option is missing its argument!\n");
+        }
+        const char *const val = argv[++arg];
+        if (!strcmp(param, "--max-cards"))
+        {
+            rules.max_cards = (size_t)atol(val);
+        }
+        else if (!strcmp(param, "--freecells-num"))
+        {
+            game->num_freecells = (size_t)atol(val);
+        }
+        else if (!strcmp(param, "--stacks-num"))
+        {
+            game->num_columns = (size_t)atol(val);
+        }
+        else if (!strcmp(param, "--sequences-are-built-by"))
+        {
+            if (!strcmp(val, "alternate_color"))
+            {
+                game->sequences_are_built_by = FCS_SEQ_BUILT_BY_ALTERNATE_COLOR;
+            }
+            else if (!strcmp(val, "suit"))
+            {
+                game->sequences_are_built_by = FCS_SEQ_BUILT_BY_SUIT;
+            }
+            else if (!strcmp(val, "rank"))
+            {
+                game->sequences_are_built_by = FCS_SEQ_BUILT_BY_RANK;
+            }
+            else
+            {
+                exit_error("Unknown --sequences-are-built-by argument!\n");
+            }
+        }
+        else if (!strcmp(param, "--empty-stacks-filled-by"))
+        {
+            if (!strcmp(val, "any"))
+            {
+                game->empty_stacks_fill = FCS_ES_FILLED_BY_ANY_CARD;
+            }
+            else if (!strcmp(val, "kings"))
+            {
+                game->empty_stacks_fill = FCS_ES_FILLED_BY_KINGS_ONLY;
+            }
+            else if (!strcmp(val, "none"))
+            {
+                game->empty_stacks_fill = FCS_ES_FILLED_BY_NONE;
+            }
+            else
+            {
+                exit_error("Unknown --empty-stacks-filled-by argument!\n");
+            }
+        }
+        else if (!strcmp(param, "--sequence-move"))
+        {
+            if (!strcmp(val, "limited"))
+            {
+                game->unlimited_sequence_move = false;
+            }
+            else if (!strcmp(val, "unlimited"))
+            {
+                game->unlimited_sequence_move = true;
+            }
+            else
+            {
+                exit_error("Unknown --sequence-move argument!\n");
+            }
+        }
+        else if (!strcmp(param, "-o") || !strcmp(param, "--output"))
+        {
+            output_filename = val;
+        }
+        else
+        {
+            exit_error("Unknown option \"%s\"!\n", param);
+        }
+    }
+    if (!output_filename)
+    {
+        exit_error("Usage: fc-solve-endgame-tablebase-gen [--max-cards N] "
+                   "[--freecells-num N] [--stacks-num N] "
+                   "[--sequences-are-built-by TYPE] "
+                   "[--empty-stacks-filled-by TYPE] [--sequence-move TYPE] "
+                   "-o OUTPUT_FILE\n");
+    }
+    if ((rules.max_cards < 1) || (rules.max_cards > FCS_ETB_MAX_CARDS))
+    {
+        exit_error("--max-cards must be between 1 and %d!\n",
+            FCS_ETB_MAX_CARDS);
+    }
+    if (!fc_solve_etb_rules_are_valid(&rules))
+    {
+        exit_error("The positions of these game parameters do not fit into a "
+                   "key!\n");
+    }
+
+    FILE *const out = fopen(output_filename, "wb");
+    if (!out)
+    {
+        exit_error("Cannot open \"%s\" for writing!\n", output_filename);
+    }
+    const bool success = fc_solve_etb_generate(&rules, out);
+    if ((fclose(out) != 0) || (!success))
+    {
+        exit_error(
+            "Could not write the tablebase to \"%s\"!\n", output_filename);
+    }
+
+    return 0;
+}
@@ -0,0 +1,335 @@
+// This file is part of Freecell Solver. It is subject to the license terms in
+// the COPYING.txt file found in the top-level directory of this distribution
+// and at http://fc-solve.shlomifish.org/docs/distro/COPYING.html . No part of
+// Freecell Solver, including this file, may be copied, modified, propagated,
+// or distributed except according to the terms contained in the COPYING file.
+//
+// Copyright (c) 2026 Shlomi Fish
+// endgame_tablebase_gen.h - the generation of an endgame tablebase by a
+// retrograde breadth-first search. Cards never leave the foundations, so
+// every winnable position with at most max_cards cards outside the
+// foundations is reached by undoing moves from the solved position without
+// exceeding max_cards, and the depth at which it is first reached is its
+// exact distance to the solution.
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "endgame_tablebase.h"
+
+typedef struct
+{
+    // An open addressing table, where FCS_ETB_NO_DISTANCE marks a vacant
+    // entry.
+    fcs_etb_record *entries;
+    size_t size_bitmask;
+    size_t num_elems;
+} fcs_etb_gen_table;
+
+typedef struct
+{
+    fcs_etb_key *keys;
+    size_t num_keys;
+    size_t max_num_keys;
+} fcs_etb_gen_frontier;
+
+static inline size_t fc_solve_etb_gen__hash(const fcs_etb_key *const key)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < FCS_ETB_KEY_LEN; ++i)
+    {
+        hash = (hash ^ key->s[i]) * 1099511628211ULL;
+    }
+
+    return (size_t)hash;
+}
+
+static inline void fc_solve_etb_gen__place(fcs_etb_record *const entries,
+    const size_t size_bitmask, const fcs_etb_record *const record)
+{
+    size_t i = (fc_solve_etb_gen__hash(&(record->key)) & size_bitmask);
+    while (entries[i].distance != FCS_ETB_NO_DISTANCE)
+    {
+        i = ((i + 1) & size_bitmask);
+    }
+    entries[i] = *record;
+}
+
+// Returns false if the key was already present.
+static inline bool fc_solve_etb_gen__insert(fcs_etb_gen_table *const table,
+    const fcs_etb_key *const key, const uint8_t distance)
+{
+    if (((table->num_elems + 1) << 1) > table->size_bitmask)
+    {
+        const size_t old_size =
+            (table->entries ? (table->size_bitmask + 1) : 0);
+        const size_t new_size = (old_size ? (old_size << 1) : 1024);
+        fcs_etb_record *const new_entries =
+            SMALLOC(new_entries, new_size);
+        if (!new_entries)
+        {
+            exit_error("Could not allocate %zu bytes for a table of %zu "
+                       "positions! Try a smaller --max-cards.\n",
+                new_size * sizeof(new_entries[0]), table->num_elems);
+        }
+        memset(new_entries, FCS_ETB_NO_DISTANCE,
+            new_size * sizeof(new_entries[0]));
+        for (size_t i = 0; i < old_size; ++i)
+        {
+            if (table->entries[i].distance != FCS_ETB_NO_DISTANCE)
+            {
+                fc_solve_etb_gen__place(
+                    new_entries, new_size - 1, &(table->entries[i]));
+            }
+        }
+        free(table->entries);
+        table->entries = new_entries;
+        table->size_bitmask = new_size - 1;
+    }
+    const_SLOT(entries, table);
+    const_SLOT(size_bitmask, table);
+    size_t i = (fc_solve_etb_gen__hash(key) & size_bitmask);
+    for (; entries[i].distance != FCS_ETB_NO_DISTANCE;
+         i = ((i + 1) & size_bitmask))
+    {
+        if (!memcmp(&(entries[i].key), key, sizeof(*key)))
+        {
+            return false;
+        }
+    }
+    entries[i] = (fcs_etb_record){.key = *key, .distance = distance};
+    ++table->num_elems;
+
+    return true;
+}
+
+static inline void fc_solve_etb_gen__push(
+    fcs_etb_gen_frontier *const frontier, const fcs_etb_key *const key)
+{
+    if (frontier->num_keys == frontier->max_num_keys)
+    {
+        frontier->max_num_keys =
+            (frontier->max_num_keys ? (frontier->max_num_keys << 1) : 1024);
+        frontier->keys = SREALLOC(frontier->keys, frontier->max_num_keys);
+        if (!frontier->keys)
+        {
+            exit_error("Could not allocate %zu bytes for a frontier! Try a "
+                       "smaller --max-cards.\n",
+                frontier->max_num_keys * sizeof(frontier->keys[0]));
+        }
+    }
+    frontier->keys[frontier->num_keys++] = *key;
+}
+
+static int fc_solve_etb_gen__compare_records(
+    const void *const a, const void *const b)
+{
+    return memcmp(&(((const fcs_etb_record *)a)->key),
+        &(((const fcs_etb_record *)b)->key), sizeof(fcs_etb_key));
+}
+
+static inline void fc_solve_etb_gen__try_predecessor(
+    const fcs_etb_rules *const rules, const fcs_plain_position *const prev,
+    const fcs_plain_move move, const uint8_t distance,
+    fcs_etb_gen_table *const table, fcs_etb_gen_frontier *const next_frontier)
+{
+    if (!fc_solve_plain_is_move_legal(&(rules->game), prev, move))
+    {
+        return;
+    }
+    fcs_etb_key key;
+    fc_solve_etb_encode(&(rules->game), prev, &key);
+    if (fc_solve_etb_gen__insert(table, &key, distance))
+    {
+        fc_solve_etb_gen__push(next_frontier, &key);
+    }
+}
+
+// Adds all the positions from which a single legal move leads to pos, and
+// that have at most rules->max_cards cards outside the foundations.
+static inline void fc_solve_etb_gen__expand(const fcs_etb_rules *const rules,
+    const fcs_plain_position *const pos, const uint8_t distance,
+    fcs_etb_gen_table *const table, fcs_etb_gen_frontier *const next_frontier)
+{
+    const size_t num_freecells = rules->game.num_freecells;
+    const size_t num_columns = rules->game.num_columns;
+    size_t empty_fc = num_freecells;
+    for (size_t i = 0; i < num_freecells; ++i)
+    {
+        if (fcs_card_is_empty(pos->freecells[i]))
+        {
+            empty_fc = i;
+            break;
+        }
+    }
+    fcs_plain_position prev;
+#define TRY(t, s, d, n)                                                        \
+    fc_solve_etb_gen__try_predecessor(rules, &prev,                            \
+        (fcs_plain_move){.type = (t),                                          \
+            .src = (uint8_t)(s),                                               \
+            .dest = (uint8_t)(d),                                              \
+            .num_cards = (uint8_t)(n)},                                        \
+        distance, table, next_frontier)
+
+    // Take a card back from the foundations.
+    if (fc_solve_plain_count_cards(&(rules->game), pos) < rules->max_cards)
+    {
+        for (size_t suit = 0; suit < FCS_NUM_SUITS; ++suit)
+        {
+            const uint8_t rank = pos->foundations[suit];
+            if (!rank)
+            {
+                continue;
+            }
+            const fcs_card card = fcs_make_card(rank, (fcs_card)suit);
+            for (size_t col = 0; col < num_columns; ++col)
+            {
+                prev = *pos;
+                --prev.foundations[suit];
+                prev.cols[col][prev.cols_lens[col]++] = card;
+                TRY(FCS_MOVE_TYPE_STACK_TO_FOUNDATION, col, suit, 1);
+            }
+            if (empty_fc < num_freecells)
+            {
+                prev = *pos;
+                --prev.foundations[suit];
+                prev.freecells[empty_fc] = card;
+                TRY(FCS_MOVE_TYPE_FREECELL_TO_FOUNDATION, empty_fc, suit, 1);
+            }
+        }
+    }
+    // Put a freecell card back on a column.
+    for (size_t fc = 0; fc < num_freecells; ++fc)
+    {
+        if (fcs_card_is_empty(pos->freecells[fc]))
+        {
+            continue;
+        }
+        for (size_t col = 0; col < num_columns; ++col)
+        {
+            prev = *pos;
+            prev.cols[col][prev.cols_lens[col]++] = prev.freecells[fc];
+            prev.freecells[fc] = fc_solve_empty_card;
+            TRY(FCS_MOVE_TYPE_STACK_TO_FREECELL, col, fc, 1);
+        }
+    }
+    for (size_t col = 0; col < num_columns; ++col)
+    {
+        // Put the top card of a column back in a freecell.
+        if (pos->cols_lens[col] && (empty_fc < num_freecells))
+        {
+            prev = *pos;
+            prev.freecells[empty_fc] = prev.cols[col][--prev.cols_lens[col]];
+            TRY(FCS_MOVE_TYPE_FREECELL_TO_STACK, empty_fc, col, 1);
+        }
+        // Move a sequence back to another column.
+        const size_t seq_len =
+            fc_solve_plain_seq_len(&(rules->game), pos, col);
+        for (size_t n = 1; n <= seq_len; ++n)
+        {
+            for (size_t src = 0; src < num_columns; ++src)
+            {
+                if (src == col)
+                {
+                    continue;
+                }
+                prev = *pos;
+                prev.cols_lens[col] -= (uint8_t)n;
+                memcpy(prev.cols[src] + prev.cols_lens[src],
+                    prev.cols[col] + prev.cols_lens[col], n);
+                prev.cols_lens[src] += (uint8_t)n;
+                TRY(FCS_MOVE_TYPE_STACK_TO_STACK, src, col, n);
+            }
+        }
+    }
+#undef TRY
+}
+
+// Writes the tablebase of the rules to out. Returns false on an error.
+static inline bool fc_solve_etb_generate(
+    const fcs_etb_rules *const rules, FILE *const out)
+{
+    if (!fc_solve_etb_rules_are_valid(rules))
+    {
+        return false;
+    }
+    fcs_etb_gen_table table = {
+        .entries = NULL, .size_bitmask = 0, .num_elems = 0};
+    fcs_etb_gen_frontier frontiers[2] = {
+        {.keys = NULL, .num_keys = 0, .max_num_keys = 0},
+        {.keys = NULL, .num_keys = 0, .max_num_keys = 0},
+    };
+    bool ret = true;
+
+    fcs_plain_position pos;
+    memset(&pos, '\0', sizeof(pos));
+    for (size_t suit = 0; suit < FCS_NUM_SUITS; ++suit)
+    {
+        pos.foundations[suit] = 13;
+    }
+    fcs_etb_key key;
+    fc_solve_etb_encode(&(rules->game), &pos, &key);
+    fc_solve_etb_gen__insert(&table, &key, 0);
+    fc_solve_etb_gen__push(&frontiers[0], &key);
+
+    for (size_t distance = 0; frontiers[distance & 0x1].num_keys; ++distance)
+    {
+        fcs_etb_gen_frontier *const frontier = &frontiers[distance & 0x1];
+        fcs_etb_gen_frontier *const next_frontier =
+            &frontiers[(distance + 1) & 0x1];
+        next_frontier->num_keys = 0;
+        if (distance + 1 > FCS_ETB_MAX_DISTANCE)
+        {
+            ret = false;
+            break;
+        }
+        for (size_t k = 0; k < frontier->num_keys; ++k)
+        {
+            fc_solve_etb_decode(&(rules->game), &(frontier->keys[k]), &pos);
+            fc_solve_etb_gen__expand(rules, &pos, (uint8_t)(distance + 1),
+                &table, next_frontier);
+        }
+        frontier->num_keys = 0;
+    }
+    free(frontiers[0].keys);
+    free(frontiers[1].keys);
+
+    if (ret)
+    {
+        // Compact the table into a sorted array of records.
+        size_t num_records = 0;
+        for (size_t i = 0; i <= table.size_bitmask; ++i)
+        {
+            if (table.entries[i].distance != FCS_ETB_NO_DISTANCE)
+            {
+                table.entries[num_records++] = table.entries[i];
+            }
+        }
+        qsort(table.entries, num_records, sizeof(table.entries[0]),
+            fc_solve_etb_gen__compare_records);
+
+        fcs_etb_header header;
+        memset(&header, '\0', sizeof(header));
+        memcpy(header.magic, FCS_ETB_MAGIC, sizeof(header.magic));
+        header.max_cards = (uint8_t)rules->max_cards;
+        header.num_freecells = (uint8_t)rules->game.num_freecells;
+        header.num_columns = (uint8_t)rules->game.num_columns;
+        header.sequences_are_built_by =
+            (uint8_t)rules->game.sequences_are_built_by;
+        header.empty_stacks_fill = (uint8_t)rules->game.empty_stacks_fill;
+        header.unlimited_sequence_move = rules->game.unlimited_sequence_move;
+        header.num_records = num_records;
+        ret = ((fwrite(&header, sizeof(header), 1, out) == 1) &&
+               (fwrite(table.entries, sizeof(table.entries[0]), num_records,
+                    out) == num_records));
+    }
+    free(table.entries);
+
+    return ret;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -81,6 +81,7 @@ static inline int range_solvers_main(int argc, char *argv[], int arg,
     bin_init(&binary_output, &start_board, &end_board,
         &total_iterations_limit_per_board);
     const bool variant_is_freecell = (!strcmp(variant, "freecell"));
+    const fcs_pysol_game_type pysol_game = fc_solve_pysol_game_by_name(variant);
 #ifndef FCS_FREECELL_ONLY
     if (!variant_is_freecell)
     {
@@ -111,12 +112,17 @@ static inline int range_solvers_main(int argc, char *argv[], int arg,
             fc_pro_get_board(board_num, buffer,
                 &(pos)PASS_IND_BUF_T(indirect_stacks_buffer));
         }
+        else if (pysol_game != FCS_PYSOL_GAME_UNKNOWN)
+        {
+            fc_solve_get_pysol_board(
+                pysol_game, FCS_PYSOL_DEALS_PYSOLFC, board_num, buffer);
+        }
         else
         {
             char command[1000];
 
             sprintf(command,
-                "make_pysol_freecell_board.py -F -t " RIN_ULL_FMT "%s",
+                "make_pysol_freecell_board.py -F -t " RIN_ULL_FMT " %s",
                 board_num, variant);
 
             FILE *const from_make_pysol = popen(command, "r");
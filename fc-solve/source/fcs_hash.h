@@ -25,6 +25,8 @@ enum FCS_INLINED_HASH_DATA_TYPE
 
 typedef size_t fcs_hash_value;
 
+#define FCS_HASH_INITIAL_SIZE 2048
+
 struct fc_solve_hash_symlink_item_struct
 {
     void *key;
@@ -107,7 +109,7 @@ static inline void fc_solve_hash_init(
 #endif
 )
 {
-    const typeof(hash->size) initial_hash_size = 2048;
+    const typeof(hash->size) initial_hash_size = FCS_HASH_INITIAL_SIZE;
 
     hash->size = initial_hash_size;
     hash->size_bitmask = initial_hash_size - 1;
@@ -117,6 +119,8 @@ static inline void fc_solve_hash_init(
 
     hash->entries =
         (hash_table_entry *)calloc(initial_hash_size, sizeof(hash->entries[0]));
+    fc_solve_meta_alloc_charge(
+        meta_alloc, initial_hash_size * sizeof(hash->entries[0]));
 
 #ifndef FCS_WITHOUT_TRIM_MAX_STORED_STATES
     hash->list_of_vacant_items = NULL;
@@ -139,11 +143,36 @@ static inline void fc_solve_hash_recycle(hash_table *const hash)
     fc_solve_compact_allocator_recycle(&(hash->allocator));
     memset(hash->entries, '\0', sizeof(hash->entries[0]) * hash->size);
     hash->num_elems = 0;
+#ifndef FCS_WITHOUT_TRIM_MAX_STORED_STATES
+    // They were allocated by the recycled allocator.
+    hash->list_of_vacant_items = NULL;
+#endif
+}
+
+// Shrinks the table back to its initial size, and discharges the entries that
+// it gives up. It drops the items, so it should be followed by
+// fc_solve_hash_recycle().
+static inline void fc_solve_hash_shrink(hash_table *const hash)
+{
+    if (hash->size == FCS_HASH_INITIAL_SIZE)
+    {
+        return;
+    }
+    fc_solve_meta_alloc_discharge(hash->allocator.meta,
+        (hash->size - FCS_HASH_INITIAL_SIZE) * sizeof(hash->entries[0]));
+    free(hash->entries);
+    hash->entries = (hash_table_entry *)calloc(
+        FCS_HASH_INITIAL_SIZE, sizeof(hash->entries[0]));
+    hash->size = FCS_HASH_INITIAL_SIZE;
+    hash->size_bitmask = FCS_HASH_INITIAL_SIZE - 1;
+    fcs_hash_set_max_num_elems(hash, FCS_HASH_INITIAL_SIZE);
 }
 
 static inline void fc_solve_hash_free(hash_table *const hash)
 {
     fc_solve_compact_allocator_finish(&(hash->allocator));
+    fc_solve_meta_alloc_discharge(
+        hash->allocator.meta, hash->size * sizeof(hash->entries[0]));
     free(hash->entries);
     hash->entries = NULL;
 }
@@ -36,6 +36,8 @@ static inline void fc_solve_hash_rehash(hash_table *const hash)
     const_SLOT(entries, hash);
     hash_table_entry *const new_entries =
         calloc(new_size, sizeof(new_entries[0]));
+    fc_solve_meta_alloc_charge(
+        hash->allocator.meta, (new_size - old_size) * sizeof(new_entries[0]));
 
     // Copy the items to the new hash while not allocating them again
     for (size_t i = 0; i < old_size; ++i)
@@ -62,30 +64,6 @@ static inline void fc_solve_hash_rehash(hash_table *const hash)
     fcs_hash_set_max_num_elems(hash, new_size);
 }
 
-// Returns NULL if the key is new and the key/val pair was inserted.
-// Returns the existing key if the key is not new (= a truthy pointer).
-static inline void *fc_solve_hash_insert(hash_table *const hash,
-    void *const key,
-#ifdef FCS_RCS_STATES
-    void *const key_id,
-#endif
-    const fcs_hash_value hash_value)
-{
-#if defined(FCS_INLINED_HASH_COMPARISON) && defined(INDIRECT_STACK_STATES)
-    const_SLOT(hash_type, hash);
-#endif
-    typeof(hash->entries[0]) *const list =
-        (hash->entries + (hash_value & (hash->size_bitmask)));
-    hash_item **item_placeholder;
-    if (!list->first_item)
-    {
-        item_placeholder = &(list->first_item);
-    }
-    else
-    {
-        hash_item *item = list->first_item;
-        hash_item *last_valid_item = NULL;
-
 // MY_HASH_COMPARE_PROTO() returns -1/0/+1 depending on the compared
 // states order. We need to negate it for the desired condition of equality.
 #define MY_HASH_COMPARE() (!MY_HASH_COMPARE_PROTO())
@@ -120,23 +98,49 @@ static inline void *fc_solve_hash_insert(hash_table *const hash,
     (hash->compare_function(item->key, key MY_HASH_CONTEXT_VAR))
 
 #endif
-        // End of MY_HASH_COMPARE_PROTO()
-
-        while (item != NULL)
+// End of MY_HASH_COMPARE_PROTO()
+
+// Returns the existing key if it is found. Otherwise, returns NULL and sets
+// *placeholder to the link where fc_solve_hash_insert_at() can add the key, so
+// the caller may check or materialize the key in between without walking the
+// chain again. It never modifies the hash, so the key may point to a
+// temporary.
+static inline void *fc_solve_hash_find(hash_table *const hash,
+    void *const key,
+#ifdef FCS_RCS_STATES
+    void *const key_id,
+#endif
+    const fcs_hash_value hash_value, hash_item ***const placeholder)
+{
+#if defined(FCS_INLINED_HASH_COMPARISON) && defined(INDIRECT_STACK_STATES)
+    const_SLOT(hash_type, hash);
+#endif
+    hash_item **item_placeholder =
+        &(hash->entries[hash_value & (hash->size_bitmask)].first_item);
+    for (hash_item *item; (item = *item_placeholder) != NULL;
+         item_placeholder = &(item->next))
+    {
+        // We first compare the hash values, because it is faster than
+        // comparing the entire data structure.
+        if ((item->hash_value == hash_value) && MY_HASH_COMPARE())
         {
-            // We first compare the hash values, because it is faster than
-            // comparing the entire data structure.
-            if ((item->hash_value == hash_value) && MY_HASH_COMPARE())
-            {
-                return item->key;
-            }
-            last_valid_item = item;
-            item = item->next;
+            return item->key;
         }
-
-        item_placeholder = &(last_valid_item->next);
     }
+    *placeholder = item_placeholder;
 
+    return NULL;
+}
+
+// Adds the key at the placeholder that fc_solve_hash_find() returned. The hash
+// must not have been modified since.
+static inline void fc_solve_hash_insert_at(hash_table *const hash,
+    hash_item **const placeholder, void *const key,
+#ifdef FCS_RCS_STATES
+    void *const key_id GCC_UNUSED,
+#endif
+    const fcs_hash_value hash_value)
+{
 #define ITEM_ALLOC() fcs_compact_alloc_ptr(&(hash->allocator), sizeof(*item))
 #ifdef FCS_WITHOUT_TRIM_MAX_STORED_STATES
     hash_item *const item = ITEM_ALLOC();
@@ -153,7 +157,7 @@ static inline void *fc_solve_hash_insert(hash_table *const hash,
     }
 #endif
 
-    *(*(item_placeholder) = item) = (typeof(*item)){
+    *((*placeholder) = item) = (typeof(*item)){
         .key = key,
         .hash_value = hash_value,
         .next = NULL,
@@ -163,8 +167,33 @@ static inline void *fc_solve_hash_insert(hash_table *const hash,
     {
         fc_solve_hash_rehash(hash);
     }
+}
 
-    return NULL;
+// Returns NULL if the key is new and the key/val pair was inserted.
+// Returns the existing key if the key is not new (= a truthy pointer).
+static inline void *fc_solve_hash_insert(hash_table *const hash,
+    void *const key,
+#ifdef FCS_RCS_STATES
+    void *const key_id,
+#endif
+    const fcs_hash_value hash_value)
+{
+    hash_item **placeholder = NULL;
+    void *const existing = fc_solve_hash_find(hash, key,
+#ifdef FCS_RCS_STATES
+        key_id,
+#endif
+        hash_value, &placeholder);
+    if (!existing)
+    {
+        fc_solve_hash_insert_at(hash, placeholder, key,
+#ifdef FCS_RCS_STATES
+            key_id,
+#endif
+            hash_value);
+    }
+
+    return existing;
 }
 
 #endif
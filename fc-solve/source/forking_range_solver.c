@@ -13,10 +13,12 @@
 //      - serial_range_solver.c
 //      - threaded_range_solver.c
 #ifdef __linux__
-#define USE_EPOLL
-#include <sys/epoll.h>
+#include <sched.h>
 #endif
+#include <signal.h>
+#include <sys/mman.h>
 #include <sys/wait.h>
+#include <time.h>
 #include "range_solvers.h"
 #include "try_param.h"
 #include "print_time.h"
@@ -26,91 +28,263 @@ static void print_help(void)
 {
     printf("\n%s",
         "freecell-solver-fork-solve start end print_step\n"
-        "    [--num-workers n] [--worker-step step] [fc-solve Arguments...]\n"
+        "    [--num-workers n] [--worker-step step] [--variant variant_str]\n"
+        "    [--pin-cpus] [--hang-timeout seconds] [--max-respawns n]\n"
+        "    [fc-solve Arguments...]\n"
         "\n"
         "Solves a sequence of boards from the Microsoft/Freecell Pro Deals\n"
         "\n"
         "start - the first board in the sequence\n"
         "end - the last board in the sequence (inclusive)\n"
-        "print_step - at which division to print a status line\n");
+        "print_step - at which division to print a status line\n"
+        "--pin-cpus - pin every worker to a CPU of its own\n"
+        "--hang-timeout - respawn a worker that did not finish a board in\n"
+        "    that many seconds\n"
+        "--max-respawns - do not respawn the workers after they crashed or\n"
+        "    hung that many times in total (default: 1000)\n");
 }
 #endif
 
 static fcs_iters_int total_num_iters = 0;
 static fc_solve_ms_deal_idx_type total_num_finished_boards = 0;
 
-#define READ_FD 0
-#define WRITE_FD 1
+// The workers pull the chunks of deals from a counter in a shared memory
+// region, and report the verdict of every deal through a ring of their own
+// there, which the parent drains. They do not make any system calls to
+// coordinate, unless their ring is full or the counter is contended.
+#define FORK_RESULTS_RING_SIZE 256
+
 typedef struct
 {
-    int child_to_parent_pipe[2], parent_to_child_pipe[2];
-} fcs_worker;
+    fc_solve_ms_deal_idx_type board_num;
+    fcs_iters_int num_iters;
+    int verdict;
+} fork_result;
+
+// Only the worker writes its chunk, its heartbeat and the head of its ring,
+// and only the parent writes the tail of the ring, and the chunk while the
+// worker is dead.
+typedef struct __attribute__((aligned(64)))
+{
+    fc_solve_ms_deal_idx_type chunk_start, chunk_end;
+    // The CLOCK_MONOTONIC time, in nanoseconds, of the last finished deal or
+    // claimed chunk.
+    int64_t heartbeat;
+    size_t ring_head, ring_tail;
+    fork_result ring[FORK_RESULTS_RING_SIZE];
+} fork_worker_shm;
+
+// The counter is guarded by a spin lock, whose word is the index of the
+// worker that holds it. A worker publishes the chunk in its slot before it
+// advances the counter, so if it is killed while it holds the lock, the
+// parent can tell whether the chunk was taken.
+#define FORK_NO_CLAIMER (-1)
 
 typedef struct
 {
-    fc_solve_ms_deal_idx_type board_num, quota_end;
-} request_type;
+    fc_solve_ms_deal_idx_type next_board_num;
+    int claimer;
+    fork_worker_shm workers[];
+} fork_shm;
 
 typedef struct
 {
-    fcs_iters_int num_iters;
-    fc_solve_ms_deal_idx_type num_finished_boards;
-} response_type;
+    pid_t pid;
+    int cpu;
+    int idx;
+    bool has_results;
+    fc_solve_ms_deal_idx_type last_board_num;
+} fork_worker;
+
+static fork_shm *shm;
+static fc_solve_ms_deal_idx_type end_board, board_num_step = 1;
+static size_t num_respawns_left = 1000;
+static void *instance;
 
-static inline void write_request(const fc_solve_ms_deal_idx_type end_board,
-    const fc_solve_ms_deal_idx_type board_num_step,
-    fc_solve_ms_deal_idx_type *const next_board_num_ptr,
-    const fcs_worker *const worker)
+static inline int64_t fork_now(void)
 {
-    if ((*next_board_num_ptr) > end_board)
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000000 + (int64_t)now.tv_nsec;
+}
+
+static inline void fork_nap(void)
+{
+    const struct timespec nap = {.tv_sec = 0, .tv_nsec = 1000000};
+    nanosleep(&nap, NULL);
+}
+
+static inline void fork_push_result(
+    fork_worker_shm *const w, const fork_result result)
+{
+    const size_t head = w->ring_head;
+    while (head - __atomic_load_n(&w->ring_tail, __ATOMIC_ACQUIRE) ==
+           FORK_RESULTS_RING_SIZE)
     {
-        close(worker->parent_to_child_pipe[WRITE_FD]);
-        return;
+        fork_nap();
     }
-    request_type req;
-    req.board_num = *(next_board_num_ptr);
-    if (((*next_board_num_ptr) += board_num_step) > end_board)
+    w->ring[head % FORK_RESULTS_RING_SIZE] = result;
+    __atomic_store_n(&w->ring_head, head + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&w->heartbeat, fork_now(), __ATOMIC_RELAXED);
+}
+
+// Claims the next chunk into the slot of the worker. Returns false if there
+// are no more deals.
+static inline bool fork_claim_chunk(fork_worker_shm *const w, const int idx)
+{
+    int claimer = FORK_NO_CLAIMER;
+    while (!__atomic_compare_exchange_n(&shm->claimer, &claimer, idx, false,
+               __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
     {
-        (*next_board_num_ptr) = end_board + 1;
+        claimer = FORK_NO_CLAIMER;
+        fork_nap();
     }
-    req.quota_end = (*next_board_num_ptr) - 1;
-    const_AUTO(
-        ret, write(worker->parent_to_child_pipe[WRITE_FD], &req, sizeof(req)));
-    if (ret != sizeof(req))
+    const_AUTO(board_num, shm->next_board_num);
+    const bool ret = (board_num <= end_board);
+    if (ret)
     {
-        exit(-1);
+        __atomic_store_n(&w->chunk_start, board_num, __ATOMIC_RELAXED);
+        __atomic_store_n(&w->chunk_end,
+            min(board_num + board_num_step - 1, end_board), __ATOMIC_RELEASE);
+        __atomic_store_n(&shm->next_board_num, board_num + board_num_step,
+            __ATOMIC_RELEASE);
+        __atomic_store_n(&w->heartbeat, fork_now(), __ATOMIC_RELAXED);
     }
+    __atomic_store_n(&shm->claimer, FORK_NO_CLAIMER, __ATOMIC_RELEASE);
+    return ret;
 }
 
-static inline void transaction(const fcs_worker *const worker,
-    const int read_fd, const fc_solve_ms_deal_idx_type end_board,
-    const fc_solve_ms_deal_idx_type board_num_step,
-    fc_solve_ms_deal_idx_type *const next_board_num_ptr)
+static void __attribute__((noreturn)) fork_worker_main(
+    fork_worker_shm *const w, const int idx, const int cpu GCC_UNUSED)
 {
-    response_type response;
-    if (read(read_fd, &response, sizeof(response)) <
-        (ssize_t)(sizeof(response)))
+#ifdef __linux__
+    if (cpu >= 0)
     {
-        return;
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(cpu, &cpus);
+        sched_setaffinity(0, sizeof(cpus), &cpus);
     }
-    total_num_iters += response.num_iters;
-    total_num_finished_boards += response.num_finished_boards;
+#endif
+    fcs_pysol_board_string state_string;
+    get_board__setup_string(state_string);
+    // A respawned worker first finishes the chunk of the one that it
+    // replaces.
+    do
+    {
+        for (fc_solve_ms_deal_idx_type board_num = w->chunk_start;
+             board_num <= w->chunk_end; ++board_num)
+        {
+            const int verdict =
+                range_solvers__solve_board(state_string, instance, board_num);
+            if (verdict == FCS_STATE_FLARES_PLAN_ERROR)
+            {
+                print_flares_plan_error(instance);
+            }
+            fork_push_result(w,
+                (fork_result){.board_num = board_num,
+                    .num_iters =
+                        freecell_solver_user_get_num_times_long(instance),
+                    .verdict = verdict});
+            freecell_solver_user_recycle(instance);
+        }
+    } while (fork_claim_chunk(w, idx));
+    freecell_solver_user_free(instance);
+    exit(0);
+}
+
+static void fork_spawn(const size_t idx, fork_worker *const worker)
+{
+    fork_worker_shm *const w = &shm->workers[idx];
+    w->heartbeat = fork_now();
+    worker->has_results = false;
+    // So the worker does not inherit the unflushed output of the parent.
+    fflush(stdout);
+    switch ((worker->pid = fork()))
+    {
+    case -1:
+        exit_error(
+            "Fork for worker No. %lu failed! Exiting.\n", (unsigned long)idx);
 
-    write_request(end_board, board_num_step, next_board_num_ptr, worker);
+    case 0:
+        fork_worker_main(w, worker->idx, worker->cpu);
+
+    default:
+        break;
+    }
 }
 
-static inline int read_fd(const fcs_worker *const worker)
+static size_t fork_drain(fork_worker_shm *const w, fork_worker *const worker)
 {
-    return worker->child_to_parent_pipe[READ_FD];
+    const size_t head = __atomic_load_n(&w->ring_head, __ATOMIC_ACQUIRE);
+    const size_t tail = w->ring_tail;
+    for (size_t i = tail; i != head; ++i)
+    {
+        const_AUTO(result, w->ring[i % FORK_RESULTS_RING_SIZE]);
+        range_solvers__print_verdict(result.board_num, result.verdict);
+        total_num_iters += result.num_iters;
+        ++total_num_finished_boards;
+        worker->has_results = true;
+        worker->last_board_num = result.board_num;
+    }
+    __atomic_store_n(&w->ring_tail, head, __ATOMIC_RELEASE);
+    return head - tail;
+}
+
+// Returns if the worker was respawned.
+static bool fork_reap(
+    const size_t idx, fork_worker *const worker, const int status)
+{
+    fork_worker_shm *const w = &shm->workers[idx];
+    fork_drain(w, worker);
+    worker->pid = -1;
+    if (WIFEXITED(status) && (WEXITSTATUS(status) == 0))
+    {
+        return false;
+    }
+    // If the worker was killed after it published its chunk and before it
+    // advanced the counter, the chunk is still its own.
+    if (__atomic_load_n(&shm->claimer, __ATOMIC_ACQUIRE) == worker->idx)
+    {
+        if ((w->chunk_start == shm->next_board_num) &&
+            (w->chunk_start <= w->chunk_end))
+        {
+            shm->next_board_num += board_num_step;
+        }
+        __atomic_store_n(&shm->claimer, FORK_NO_CLAIMER, __ATOMIC_RELEASE);
+    }
+    // The deal that the worker crashed or hung on is reported as intractable
+    // and skipped, and the rest of its chunk is solved by its replacement.
+    fc_solve_ms_deal_idx_type resume_at = w->chunk_start;
+    if (worker->has_results && (worker->last_board_num >= w->chunk_start))
+    {
+        resume_at = worker->last_board_num + 1;
+    }
+    if (resume_at <= w->chunk_end)
+    {
+        fc_solve_print_intractable(resume_at);
+        ++total_num_finished_boards;
+        ++resume_at;
+    }
+    w->chunk_start = resume_at;
+    if (!num_respawns_left)
+    {
+        return false;
+    }
+    --num_respawns_left;
+    fork_spawn(idx, worker);
+    return true;
 }
 
 static inline int range_solvers_main(int argc, char *argv[], int arg,
     fc_solve_ms_deal_idx_type next_board_num,
-    const fc_solve_ms_deal_idx_type end_board,
+    const fc_solve_ms_deal_idx_type par__end_board,
     const fc_solve_ms_deal_idx_type stop_at)
 {
     size_t num_workers = 3;
-    fc_solve_ms_deal_idx_type board_num_step = 1;
+    bool pin_cpus = false;
+    int64_t hang_timeout = 0;
+    end_board = par__end_board;
     for (; arg < argc; ++arg)
     {
         const char *param;
@@ -122,173 +296,130 @@ static inline int range_solvers_main(int argc, char *argv[], int arg,
         {
             board_num_step = fcs_str2msdeal(param);
         }
-        else
+        else if ((param = TRY_P("--variant")))
         {
-            break;
+            range_solvers__set_variant(param);
         }
-    }
-
-    fc_solve_print_started_at();
-    void *const instance = simple_alloc_and_parse(argc, argv, arg);
-    fcs_worker workers[num_workers];
-
-    for (size_t idx = 0; idx < num_workers; ++idx)
-    {
-        if (pipe(workers[idx].child_to_parent_pipe))
+        else if (!strcmp(argv[arg], "--pin-cpus"))
         {
-            exit_error("C->P Pipe for worker No. %lu failed! Exiting.\n",
-                (unsigned long)idx);
+            pin_cpus = true;
         }
-        if (pipe(workers[idx].parent_to_child_pipe))
+        else if ((param = TRY_P("--hang-timeout")))
         {
-            exit_error("P->C Pipe for worker No. %lu failed! Exiting.\n",
-                (unsigned long)idx);
+            hang_timeout = (int64_t)(atof(param) * 1e9);
         }
-
-        switch (fork())
+        else if ((param = TRY_P("--max-respawns")))
         {
-        case -1:
-            exit_error("Fork for worker No. %lu failed! Exiting.\n",
-                (unsigned long)idx);
-
-        case 0: {
-            // I'm the child.
-            const_AUTO(w, workers[idx]);
-            close(w.parent_to_child_pipe[WRITE_FD]);
-            close(w.child_to_parent_pipe[READ_FD]);
-            // I'm one of the workers
-            request_type req;
-            fcs_state_string state_string;
-            get_board__setup_string(state_string);
-            while (read(w.parent_to_child_pipe[READ_FD], &req, sizeof(req)) ==
-                   sizeof(req))
-            {
-                response_type response = {
-                    .num_iters = 0,
-                    .num_finished_boards = req.quota_end - req.board_num + 1,
-                };
-                for (; req.board_num <= req.quota_end; ++req.board_num)
-                {
-                    range_solvers__solve(state_string, instance, req.board_num,
-                        &response.num_iters);
-                    freecell_solver_user_recycle(instance);
-                }
-                if (sizeof(response) != write(w.child_to_parent_pipe[WRITE_FD],
-                                            &response, sizeof(response)))
-                {
-                    abort();
-                }
-            }
-            freecell_solver_user_free(instance);
-            close(w.child_to_parent_pipe[WRITE_FD]);
-            close(w.parent_to_child_pipe[READ_FD]);
-            return 0;
+            num_respawns_left = (size_t)atol(param);
         }
-
-        default:
-            // I'm the parent.
-            close(workers[idx].parent_to_child_pipe[READ_FD]);
-            close(workers[idx].child_to_parent_pipe[WRITE_FD]);
+        else
+        {
             break;
         }
     }
 
-    freecell_solver_user_free(instance);
+    fc_solve_print_started_at();
+    instance = simple_alloc_and_parse(argc, argv, arg);
+    range_solvers__apply_variant(instance);
 
-// I'm the master.
-#ifdef USE_EPOLL
-    const int epollfd = epoll_create1(0);
-    if (epollfd == -1)
+    const size_t shm_size =
+        sizeof(fork_shm) + num_workers * sizeof(fork_worker_shm);
+    if ((shm = mmap(NULL, shm_size, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_ANONYMOUS, -1, 0)) == MAP_FAILED)
     {
-        perror("epoll_create1");
-        exit(EXIT_FAILURE);
+        exit_error("Could not map the shared memory! Exiting.\n");
     }
-#else
-    fd_set initial_readers;
-    FD_ZERO(&initial_readers);
-    int mymax = -1;
-#endif
+    shm->next_board_num = next_board_num;
+    shm->claimer = FORK_NO_CLAIMER;
 
-    for (size_t idx = 0; idx < num_workers; ++idx)
+#ifdef __linux__
+    int cpus[CPU_SETSIZE];
+    size_t num_cpus = 0;
+    cpu_set_t allowed_cpus;
+    if (pin_cpus &&
+        (!sched_getaffinity(0, sizeof(allowed_cpus), &allowed_cpus)))
     {
-        const int fd = read_fd(&workers[idx]);
-#ifdef USE_EPOLL
-        struct epoll_event ev = {
-            .events = EPOLLIN,
-            .data.ptr = &(workers[idx]),
-        };
-        if (epoll_ctl(epollfd, EPOLL_CTL_ADD, fd, &ev) == -1)
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
         {
-            perror("epoll_ctl: listen_sock");
-            exit(EXIT_FAILURE);
-        }
-#else
-        FD_SET(fd, &initial_readers);
-        if (fd > mymax)
-        {
-            mymax = fd;
+            if (CPU_ISSET(cpu, &allowed_cpus))
+            {
+                cpus[num_cpus++] = cpu;
+            }
         }
-#endif
     }
-#ifndef USE_EPOLL
-    ++mymax;
+#else
+    const int *const cpus = NULL;
+    const size_t num_cpus = 0;
+    (void)pin_cpus;
 #endif
-    const fc_solve_ms_deal_idx_type total_num_boards_to_check =
-        end_board - next_board_num + 1;
-
-    fc_solve_ms_deal_idx_type next_milestone = stop_at;
+    fork_worker workers[num_workers];
     for (size_t idx = 0; idx < num_workers; ++idx)
     {
-        write_request(
-            end_board, board_num_step, &next_board_num, &(workers[idx]));
+        shm->workers[idx].chunk_start = 1;
+        shm->workers[idx].chunk_end = 0;
+        workers[idx].cpu = (num_cpus ? cpus[idx % num_cpus] : -1);
+        workers[idx].idx = (int)idx;
+        fork_spawn(idx, &workers[idx]);
     }
 
-    while (total_num_finished_boards < total_num_boards_to_check)
+    // I'm the master.
+    const fc_solve_ms_deal_idx_type total_num_boards_to_check =
+        end_board - next_board_num + 1;
+    fc_solve_ms_deal_idx_type next_milestone = stop_at;
+    size_t num_running = num_workers;
+    while ((total_num_finished_boards < total_num_boards_to_check) &&
+           num_running)
     {
+        bool is_idle = true;
+        for (size_t idx = 0; idx < num_workers; ++idx)
+        {
+            if (fork_drain(&shm->workers[idx], &workers[idx]))
+            {
+                is_idle = false;
+            }
+        }
         while (total_num_finished_boards >= next_milestone)
         {
             fc_solve_print_reached(next_milestone, total_num_iters);
             next_milestone += stop_at;
         }
-#ifdef USE_EPOLL
-        struct epoll_event events[4];
-        const int nfds = epoll_wait(epollfd, events, COUNT(events), -1);
-        if (nfds == -1)
-        {
-            perror("epoll_pwait");
-            exit(EXIT_FAILURE);
-        }
 
-        for (int i = 0; i < nfds; ++i)
+        int status;
+        pid_t pid;
+        while ((pid = waitpid(-1, &status, WNOHANG)) > 0)
         {
-            const fcs_worker *const worker = events[i].data.ptr;
-            transaction(worker, read_fd(worker), end_board, board_num_step,
-                &next_board_num);
+            for (size_t idx = 0; idx < num_workers; ++idx)
+            {
+                if (workers[idx].pid == pid)
+                {
+                    if (!fork_reap(idx, &workers[idx], status))
+                    {
+                        --num_running;
+                    }
+                    break;
+                }
+            }
+            is_idle = false;
         }
-#else
-        fd_set readers = initial_readers;
-        // I'm the master.
-        const int select_ret = select(mymax, &readers, NULL, NULL, NULL);
 
-        if (select_ret == -1)
-        {
-            perror("select()");
-        }
-        else if (select_ret)
+        if (hang_timeout)
         {
+            const int64_t now = fork_now();
             for (size_t idx = 0; idx < num_workers; ++idx)
             {
-                const int fd = read_fd(&workers[idx]);
-
-                if (FD_ISSET(fd, &readers))
+                if ((workers[idx].pid > 0) &&
+                    (now - __atomic_load_n(&shm->workers[idx].heartbeat,
+                                 __ATOMIC_RELAXED) >
+                        hang_timeout))
                 {
-                    // FD_ISSET can be set on EOF, so we check if read failed.
-                    transaction(&(workers[idx]), fd, end_board, board_num_step,
-                        &next_board_num);
+                    kill(workers[idx].pid, SIGKILL);
                 }
             }
         }
-#endif
+        if (is_idle)
+        {
+            fork_nap();
+        }
     }
     while (total_num_finished_boards >= next_milestone)
     {
@@ -298,8 +429,22 @@ static inline int range_solvers_main(int argc, char *argv[], int arg,
 
     for (size_t idx = 0; idx < num_workers; ++idx)
     {
-        wait(NULL);
+        if (workers[idx].pid > 0)
+        {
+            waitpid(workers[idx].pid, NULL, 0);
+        }
     }
+    munmap(shm, shm_size);
+    freecell_solver_user_free(instance);
     fc_solve_print_finished(total_num_iters);
+    if (total_num_finished_boards < total_num_boards_to_check)
+    {
+        fprintf(stderr,
+            "%lu deals were not solved, because the workers crashed or hung "
+            "too many times.\n",
+            (unsigned long)(total_num_boards_to_check -
+                            total_num_finished_boards));
+        return -1;
+    }
     return 0;
 }
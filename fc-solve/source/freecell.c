@@ -539,15 +539,33 @@ DECLARE_MOVE_FUNCTION(
 #define CALC_num_virtual_vacant_stacks()                                       \
     (tests__is_filled_by_any_card() ? num_vacant_stacks : 0)
 
+#ifdef FCS_WITH_COLS_SEQ_BREAKS
+#define CALC_COLS_SEQ_BREAKS()                                                 \
+    const fcs_col_seq_breaks *const cols_seq_breaks =                          \
+        fc_solve_calc_cols_seq_breaks_location(soft_thread)
+#else
+#define CALC_COLS_SEQ_BREAKS()
+#endif
+
 typedef struct
 {
     fcs_cards_column col;
     int_fast16_t col_len, col_len_minus_1, c, seq_end;
+#ifdef FCS_WITH_COLS_SEQ_BREAKS
+    fcs_col_seq_breaks seq_breaks;
+#else
     FCS_ON_NOT_FC_ONLY(int sequences_are_built_by;)
+#endif
 } col_seqs_iter;
 
 static inline void col_seqs_iter__calc_end(col_seqs_iter *const iter)
 {
+#ifdef FCS_WITH_COLS_SEQ_BREAKS
+    // The lowest set bit at or above c is the end of the sequence.
+    const fcs_col_seq_breaks rest =
+        (iter->c < iter->col_len) ? (iter->seq_breaks >> iter->c) : 0;
+    iter->seq_end = iter->c + (rest ? __builtin_ctzll(rest) : 0);
+#else
     FCS_ON_NOT_FC_ONLY(const_SLOT(sequences_are_built_by, iter));
     const_SLOT(col, iter);
     for ((*iter).seq_end = (*iter).c; (*iter).seq_end < (*iter).col_len_minus_1;
@@ -559,14 +577,21 @@ static inline void col_seqs_iter__calc_end(col_seqs_iter *const iter)
             break;
         }
     }
+#endif
 }
 
 static inline col_seqs_iter __attribute__((pure)) col_seqs_iter__create(
-    fcs_state *const s, const stack_i stack_idx PASS_sequences_are_built_by(
-                            const int sequences_are_built_by))
+    fcs_state *const s,
+    const stack_i stack_idx PASS_sequences_are_built_by(
+        const int sequences_are_built_by GCC_UNUSED)
+        PASS_COLS_SEQ_BREAKS(const fcs_col_seq_breaks *const cols_seq_breaks))
 {
     col_seqs_iter ret;
+#ifdef FCS_WITH_COLS_SEQ_BREAKS
+    ret.seq_breaks = cols_seq_breaks[stack_idx];
+#else
     FCS_ON_NOT_FC_ONLY(ret.sequences_are_built_by = sequences_are_built_by);
+#endif
     ret.col = fcs_state_get_col(*s, stack_idx);
     ret.col_len_minus_1 = (ret.col_len = fcs_col_len(ret.col)) - 1;
     ret.c = 0;
@@ -584,7 +609,7 @@ static inline bool check_if_can_relocate(const fcs_game_limit start,
     const fcs_game_limit num_virtual_vacant_freecells,
     const fcs_game_limit num_virtual_vacant_stacks,
     const col_seqs_iter *const iter PASS_sequences_are_built_by(
-        const fcs_instance *const instance))
+        const fcs_instance *const instance GCC_UNUSED))
 {
     MOVE_FUNCS__define_empty_stacks_fill();
     fcs_game_limit num_cards_to_relocate = start;
@@ -620,6 +645,7 @@ DECLARE_MOVE_FUNCTION(fc_solve_sfs_move_stack_cards_to_different_stacks)
 #endif
 
     CALC_POSITIONS_BY_RANK();
+    CALC_COLS_SEQ_BREAKS();
     // Now let's try to move a card from one stack to the other
     // Note that it does not involve moving cards lower than king
     // to empty stacks
@@ -627,7 +653,8 @@ DECLARE_MOVE_FUNCTION(fc_solve_sfs_move_stack_cards_to_different_stacks)
     for (stack_i stack_idx = 0; stack_idx < LOCAL_STACKS_NUM; ++stack_idx)
     {
         col_seqs_iter iter = col_seqs_iter__create(&state_key,
-            stack_idx PASS_sequences_are_built_by(sequences_are_built_by));
+            stack_idx PASS_sequences_are_built_by(sequences_are_built_by)
+                PASS_COLS_SEQ_BREAKS(cols_seq_breaks));
         for (; iter.c < iter.col_len; col_seqs_iter__advance(&iter))
         {
             if (MOVE_FUNCS__should_not_empty_columns() && (iter.c == 0))
@@ -712,12 +739,14 @@ DECLARE_MOVE_FUNCTION(fc_solve_sfs_move_sequences_to_free_stacks)
     const size_t max_sequence_len = (size_t)calc_max_sequence_move(
         num_vacant_freecells, num_vacant_stacks - 1);
 
+    CALC_COLS_SEQ_BREAKS();
     // Now try to move sequences to empty stacks
     const int ds = find_empty_stack(raw_state_raw, 0, LOCAL_STACKS_NUM);
     for (stack_i stack_idx = 0; stack_idx < LOCAL_STACKS_NUM; stack_idx++)
     {
         col_seqs_iter iter = col_seqs_iter__create(&state_key,
-            stack_idx PASS_sequences_are_built_by(sequences_are_built_by));
+            stack_idx PASS_sequences_are_built_by(sequences_are_built_by)
+                PASS_COLS_SEQ_BREAKS(cols_seq_breaks));
         for (; iter.c < iter.col_len; col_seqs_iter__advance(&iter))
         {
             if (IS_FILLED_BY_KINGS_ONLY() &&
@@ -868,6 +897,7 @@ DECLARE_MOVE_FUNCTION(fc_solve_sfs_move_fc_to_empty_and_put_on_top)
         return;
     }
     SET_empty_stack_idx(empty_stack_idx);
+    CALC_COLS_SEQ_BREAKS();
 
 #ifdef RAR2
     for (int fc = LOCAL_FREECELLS_NUM - 1; fc >= 0; --fc)
@@ -912,7 +942,8 @@ DECLARE_MOVE_FUNCTION(fc_solve_sfs_move_fc_to_empty_and_put_on_top)
         for (stack_i stack_idx = 0; stack_idx < LOCAL_STACKS_NUM; ++stack_idx)
         {
             col_seqs_iter iter = col_seqs_iter__create(&state_key,
-                stack_idx PASS_sequences_are_built_by(sequences_are_built_by));
+                stack_idx PASS_sequences_are_built_by(sequences_are_built_by)
+                    PASS_COLS_SEQ_BREAKS(cols_seq_breaks));
             for (; iter.c < iter.col_len; col_seqs_iter__advance(&iter))
             {
                 if (MOVE_FUNCS__should_not_empty_columns() && (iter.c == 0))
@@ -1361,6 +1392,9 @@ DECLARE_MOVE_FUNCTION(fc_solve_sfs_atomic_move_freecell_card_to_empty_stack)
 #define CALC_FOUNDATION_TO_PUT_CARD_ON()                                       \
     calc_foundation_to_put_card_on(soft_thread, pass_new_state.key, card)
 
+// The Raymond prune is not a move function, so the specialized move
+// translation units use the generic one.
+#ifndef FCS_SPECIALIZED_MOVES
 #define CALC_FOUNDATION_ARG()                                                  \
     const fcs_soft_thread *const soft_thread GCC_UNUSED
 #define CALC_FOUNDATION__calc_sequences_are_built_by()                         \
@@ -1440,12 +1474,13 @@ extern fcs_collectible_state *fc_solve_sfs_raymond_prune(
         return NULL;
     }
     register const_AUTO(ptr_next_state,
-        fc_solve_sfs_check_state_end(soft_thread,
-            sfs_check_state_end__arg & pass_new_state FCS__pass_moves(moves)));
+        fc_solve_sfs_check_state_end(soft_thread, raw_state_raw,
+            &pass_new_state FCS__pass_moves(moves)));
     // Set the GENERATED_BY_PRUNING flag unconditionally. It won't
     // hurt if it's already there, and if it's a state that was
     // found by other means, we still shouldn't prune it, because
     // it is already "prune-perfect".
-    FCS_S_VISITED(ptr_next_state) |= FCS_VISITED_GENERATED_BY_PRUNING;
+    FCS_S_VISITED(instance, ptr_next_state) |= FCS_VISITED_GENERATED_BY_PRUNING;
     return ptr_next_state;
 }
+#endif
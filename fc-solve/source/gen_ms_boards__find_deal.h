@@ -7,5 +7,7 @@ extern DLLEXPORT void *fc_solve_user__find_deal__alloc(void);
 extern void DLLEXPORT fc_solve_user__find_deal__free(void *);
 extern void DLLEXPORT fc_solve_user__find_deal__fill(void *, const char *);
 extern DLLEXPORT void *fc_solve_user__find_deal__get_global_instance(void);
+// 0 (the default) runs one thread per online CPU.
+extern void DLLEXPORT fc_solve_user__find_deal__set_num_threads(void *, int);
 extern DLLEXPORT const char *fc_solve_user__find_deal__run(
     void *, const char *, const char *);
@@ -0,0 +1,139 @@
+// This file is part of Freecell Solver. It is subject to the license terms in
+// the COPYING.txt file found in the top-level directory of this distribution
+// and at http://fc-solve.shlomifish.org/docs/distro/COPYING.html . No part of
+// Freecell Solver, including this file, may be copied, modified, propagated,
+// or distributed except according to the terms contained in the COPYING file.
+//
+// Copyright (c) 2026 Shlomi Fish
+// gen_pysol_boards__rand.h - the random number generators which PySol and
+// PySolFC use for shuffling their deals: Python's Mersenne Twister (as
+// seeded by random.seed() with an integer) and the old PySol 64-bit LCG.
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "gen_ms_boards__rand.h"
+
+#define FCS_PYSOL_MT_N 624
+#define FCS_PYSOL_MT_M 397
+
+typedef struct
+{
+    uint32_t mt[FCS_PYSOL_MT_N];
+    size_t mti;
+} fcs_pysol_mt_rand;
+
+static inline void fcs_pysol_mt_rand__init_genrand(
+    fcs_pysol_mt_rand *const r, const uint32_t s)
+{
+    r->mt[0] = s;
+    for (size_t i = 1; i < FCS_PYSOL_MT_N; ++i)
+    {
+        r->mt[i] = (uint32_t)(1812433253U * (r->mt[i - 1] ^
+                                                (r->mt[i - 1] >> 30)) +
+                              (uint32_t)i);
+    }
+    r->mti = FCS_PYSOL_MT_N;
+}
+
+// Python's random.seed(n) for a non-negative integer n: init_by_array() with
+// the 32-bit words of n, least significant first.
+static inline void fcs_pysol_mt_rand__seed(
+    fcs_pysol_mt_rand *const r, const fc_solve_ms_deal_idx_type seed)
+{
+    uint32_t key[2] = {(uint32_t)seed, (uint32_t)(seed >> 32)};
+    const size_t key_len = (key[1] ? 2 : 1);
+    uint32_t *const mt = r->mt;
+
+    fcs_pysol_mt_rand__init_genrand(r, 19650218U);
+    size_t i = 1, j = 0;
+    for (size_t k = FCS_PYSOL_MT_N; k; --k)
+    {
+        mt[i] = (mt[i] ^ ((mt[i - 1] ^ (mt[i - 1] >> 30)) * 1664525U)) +
+                key[j] + (uint32_t)j;
+        if (++i >= FCS_PYSOL_MT_N)
+        {
+            mt[0] = mt[FCS_PYSOL_MT_N - 1];
+            i = 1;
+        }
+        if (++j >= key_len)
+        {
+            j = 0;
+        }
+    }
+    for (size_t k = FCS_PYSOL_MT_N - 1; k; --k)
+    {
+        mt[i] = (mt[i] ^ ((mt[i - 1] ^ (mt[i - 1] >> 30)) * 1566083941U)) -
+                (uint32_t)i;
+        if (++i >= FCS_PYSOL_MT_N)
+        {
+            mt[0] = mt[FCS_PYSOL_MT_N - 1];
+            i = 1;
+        }
+    }
+    mt[0] = 0x80000000U;
+}
+
+static inline uint32_t fcs_pysol_mt_rand__genrand(fcs_pysol_mt_rand *const r)
+{
+    uint32_t *const mt = r->mt;
+    if (r->mti >= FCS_PYSOL_MT_N)
+    {
+#define MT_MIX(a, b) (((a)&0x80000000U) | ((b)&0x7fffffffU))
+#define MT_MAG(y) (((y)&1U) ? 0x9908b0dfU : 0U)
+        size_t kk;
+        for (kk = 0; kk < FCS_PYSOL_MT_N - FCS_PYSOL_MT_M; ++kk)
+        {
+            const uint32_t y = MT_MIX(mt[kk], mt[kk + 1]);
+            mt[kk] = mt[kk + FCS_PYSOL_MT_M] ^ (y >> 1) ^ MT_MAG(y);
+        }
+        for (; kk < FCS_PYSOL_MT_N - 1; ++kk)
+        {
+            const uint32_t y = MT_MIX(mt[kk], mt[kk + 1]);
+            mt[kk] = mt[kk + FCS_PYSOL_MT_M - FCS_PYSOL_MT_N] ^ (y >> 1) ^
+                     MT_MAG(y);
+        }
+        const uint32_t y = MT_MIX(mt[FCS_PYSOL_MT_N - 1], mt[0]);
+        mt[FCS_PYSOL_MT_N - 1] = mt[FCS_PYSOL_MT_M - 1] ^ (y >> 1) ^ MT_MAG(y);
+#undef MT_MIX
+#undef MT_MAG
+        r->mti = 0;
+    }
+    uint32_t y = mt[r->mti++];
+    y ^= (y >> 11);
+    y ^= (y << 7) & 0x9d2c5680U;
+    y ^= (y << 15) & 0xefc60000U;
+    y ^= (y >> 18);
+
+    return y;
+}
+
+// PySolFC's MTRandom.randint(0, max) is int(random() * (max + 1)), where
+// random() is Python's 53-bit resolution float.
+static inline size_t fcs_pysol_mt_rand__randint(
+    fcs_pysol_mt_rand *const r, const size_t max)
+{
+    const uint32_t a = fcs_pysol_mt_rand__genrand(r) >> 5,
+                   b = fcs_pysol_mt_rand__genrand(r) >> 6;
+    const double random = (a * 67108864.0 + b) * (1.0 / 9007199254740992.0);
+
+    return (size_t)(random * (double)(max + 1));
+}
+
+typedef uint64_t fcs_pysol_lc64_rand;
+
+// The old PySol LCG, whose random() is a 31-bit fraction.
+static inline size_t fcs_pysol_lc64_rand__randint(
+    fcs_pysol_lc64_rand *const r, const size_t max)
+{
+    *r = (*r) * 6364136223846793005ULL + 1;
+    const uint64_t fraction = ((*r) >> 21) & 0x7fffffff;
+
+    return (size_t)((fraction * (uint64_t)(max + 1)) >> 31);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -60,6 +60,31 @@ DLLEXPORT extern int freecell_solver_user_cmd_line_read_cmd_line_preset(
         char **error_string),
     int file_nesting_count, freecell_solver_str_t opened_files_dir);
 
+/*
+ * Parses the arguments like
+ * freecell_solver_user_cmd_line_parse_args_with_file_nesting_count() does,
+ * and also saves them in a theme blob, in which the presets and the files
+ * that were read are already expanded, and the known_parameters are left
+ * out. *theme_blob should be freed with free().
+ */
+DLLEXPORT extern int freecell_solver_user_cmd_line_save_theme(
+    void *instance, int argc, freecell_solver_str_t argv[], int start_arg,
+    freecell_solver_str_t *known_parameters,
+    freecell_solver_user_cmd_line_known_commands_callback_t callback,
+    void *callback_context FCS__PASS_ERR_STR(char **error_string),
+    int *last_arg, int file_nesting_count,
+    freecell_solver_str_t opened_files_dir, char **theme_blob,
+    size_t *theme_blob_len);
+
+/*
+ * Parses the arguments of a theme blob that was saved by
+ * freecell_solver_user_cmd_line_save_theme(), without accessing any
+ * files. The blob may be freed once it returns.
+ */
+DLLEXPORT extern int freecell_solver_user_load_theme(void *instance,
+    const char *theme_blob,
+    size_t theme_blob_len FCS__PASS_ERR_STR(char **error_string));
+
 #ifdef __cplusplus
 };
 #endif
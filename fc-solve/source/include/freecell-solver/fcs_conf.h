@@ -36,6 +36,20 @@ extern "C" {
 #define FCS_WITH_MOVES
 #endif
 
+// Unless FCS_RECONSTRUCT_MOVES is defined, every state keeps the moves that
+// lead to it from its parent. Otherwise, the moves of the solution are
+// reconstructed by running the move functions on its states again, which
+// requires the states to keep their keys.
+#ifndef FCS_WITH_MOVES
+#undef FCS_RECONSTRUCT_MOVES
+#elif !defined(FCS_RECONSTRUCT_MOVES)
+#define FCS_WITH_MOVES_TO_PARENT
+#endif
+
+#if defined(FCS_RECONSTRUCT_MOVES) && defined(FCS_RCS_STATES)
+#error FCS_RECONSTRUCT_MOVES cannot be used with FCS_RCS_STATES
+#endif
+
 #ifdef FCS_WITH_MOVES
 #define SFS__PASS_MOVE_STACK(arg) , arg
 #else
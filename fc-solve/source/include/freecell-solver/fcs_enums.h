@@ -77,6 +77,10 @@ enum
 
 #define FCS_NUM_BEFS_WEIGHTS 6
 
+#define FCS_DFS_RESTARTS_NONE 0
+#define FCS_DFS_RESTARTS_LUBY 1
+#define FCS_DFS_RESTARTS_GEOMETRIC 2
+
 #ifdef __cplusplus
 }
 #endif
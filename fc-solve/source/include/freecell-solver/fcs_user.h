@@ -37,6 +37,22 @@ DLLEXPORT extern void freecell_solver_user_limit_iterations_long(
 void DLLEXPORT freecell_solver_user_soft_limit_iterations_long(
     void *api_instance, fcs_int_limit_t max_iters);
 
+/*
+ * Suspend the solving, as if an iterations limit was reached, once the
+ * CLOCK_MONOTONIC time is deadline_ns nanoseconds or later. A deadline_ns
+ * of 0 or less clears the deadline.
+ */
+void DLLEXPORT freecell_solver_user_set_deadline(
+    void *api_instance, long long deadline_ns);
+
+/*
+ * Suspend the solving soon. It may be called from another thread while
+ * freecell_solver_user_solve_board() or freecell_solver_user_resume_solution()
+ * is running, which then return FCS_STATE_SUSPEND_PROCESS, and the solving
+ * may be resumed afterwards.
+ */
+void DLLEXPORT freecell_solver_user_request_cancel(void *api_instance);
+
 #ifndef FCS_BREAK_BACKWARD_COMPAT_1
 DLLEXPORT extern void freecell_solver_user_limit_iterations(
     void *user_instance, int max_iters);
@@ -199,6 +215,74 @@ DLLEXPORT extern void freecell_solver_user_set_iter_handler_long(
     void *user_instance, freecell_solver_user_long_iter_handler_t iter_handler,
     void *iter_handler_context);
 
+typedef struct
+{
+    unsigned long long iter_num, parent_iter_num;
+    /* Identifies the state for as long as the instance is not recycled. */
+    unsigned long long state_id;
+    int depth;
+    int soft_thread_id;
+} fcs_trace_record;
+
+/*
+ * Keep a record of the last num_records sampled iterations in a preallocated
+ * ring, which is appended to without calling back into the application. A
+ * num_records of 0 disables the tracing. Should not be called while solving.
+ */
+DLLEXPORT extern void freecell_solver_user_set_trace_ring_size(
+    void *user_instance, fcs_int_limit_t num_records);
+
+/*
+ * Record only every sample_step-th iteration. The default is 1.
+ */
+DLLEXPORT extern void freecell_solver_user_set_trace_sample_step(
+    void *user_instance, fcs_int_limit_t sample_step);
+
+/*
+ * Copy at most max_num_records trace records, beginning from *cursor (which
+ * should be initialised to 0), and advance *cursor past them. Records that
+ * were already overwritten are skipped. It may be called from another thread
+ * while solving. Returns the number of records that were copied.
+ */
+DLLEXPORT extern size_t freecell_solver_user_read_trace(void *user_instance,
+    fcs_trace_record *records, size_t max_num_records,
+    unsigned long long *cursor);
+
+/*
+ * Allocate a memory budget, which may be shared by several instances, which
+ * are possibly solving in different threads. Once the memory that they hold
+ * exceeds cap bytes (0 for no limit), the instance that holds the most
+ * memory suspends the solving, and the others wait for it to be recycled or
+ * freed, for up to a second, before they suspend as well. The memory that is
+ * accounted for is that of the allocated states and of the hash tables.
+ */
+DLLEXPORT extern void *freecell_solver_memory_budget_alloc(size_t cap);
+
+/*
+ * Free a budget, after all the instances that were registered with it were
+ * freed or unregistered.
+ */
+DLLEXPORT extern void freecell_solver_memory_budget_free(void *budget);
+
+/*
+ * Returns the number of bytes that are held by all the instances of budget.
+ */
+DLLEXPORT extern size_t freecell_solver_memory_budget_get_usage(
+    const void *budget);
+
+/*
+ * Register the instance with budget, or unregister it if budget is NULL.
+ * Should not be called while solving.
+ */
+DLLEXPORT extern void freecell_solver_user_set_memory_budget(
+    void *user_instance, void *budget);
+
+/*
+ * Returns the number of bytes that are held by the instance.
+ */
+DLLEXPORT extern size_t freecell_solver_user_get_memory_usage(
+    void *user_instance);
+
 #ifndef FCS_BREAK_BACKWARD_COMPAT_1
 DLLEXPORT extern char *freecell_solver_user_iter_state_as_string(
     void *const user_instance, void *const ptr_state
@@ -232,6 +316,13 @@ DLLEXPORT extern void freecell_solver_user_iter_state_stringify(
 DLLEXPORT extern void freecell_solver_user_set_random_seed(
     void *const user_instance, const int seed);
 
+DLLEXPORT extern int freecell_solver_user_set_dfs_restarts(
+    void *const user_instance, const int policy, const fcs_int_limit_t unit,
+    const double factor);
+
+DLLEXPORT extern int freecell_solver_user_set_seeds_portfolio(
+    void *const user_instance, const int num_seeds);
+
 #ifndef FCS_DISABLE_NUM_STORED_STATES
 DLLEXPORT fcs_int_limit_t
 freecell_solver_user_get_num_states_in_collection_long(
@@ -252,8 +343,34 @@ DLLEXPORT extern void freecell_solver_user_limit_num_states_in_collection(
 
 DLLEXPORT extern void freecell_solver_set_stored_states_trimming_limit(
     void *user_instance, long max_num_states);
+
+DLLEXPORT extern void freecell_solver_set_dead_ends_recycling(
+    void *user_instance, long from_num_states);
 #endif
 
+/*
+ * Loads the endgame tablebase that was written by
+ * fc-solve-endgame-tablebase-gen from filename, and lets all the instances
+ * probe it. A NULL filename unloads the current one. Returns 0 on success.
+ */
+DLLEXPORT extern int freecell_solver_user_set_endgame_tablebase(
+    void *user_instance, const char *filename);
+
+/*
+ * Shortens the traced solutions by searching for shortcuts inside a window of
+ * window moves that slides over them, while collecting at most max_iters
+ * positions per window, and searching num_threads windows in parallel. A
+ * window of 0 (the default) disables it. Return 0 on success.
+ */
+DLLEXPORT extern int freecell_solver_user_set_local_opt_window(
+    void *user_instance, int window);
+
+DLLEXPORT extern int freecell_solver_user_set_local_opt_max_iters(
+    void *user_instance, fcs_int_limit_t max_iters);
+
+DLLEXPORT extern int freecell_solver_user_set_local_opt_threads(
+    void *user_instance, int num_threads);
+
 DLLEXPORT extern int freecell_solver_user_next_soft_thread(void *user_instance);
 
 DLLEXPORT extern void freecell_solver_user_set_soft_thread_step(
@@ -140,6 +140,25 @@ static inline void soft_thread_run_cb(fcs_soft_thread *const soft_thread,
     }
 #endif
     break;
+
+    case FOREACH_SOFT_THREAD_FREE_MOVES_LISTS:
+#ifndef FCS_ZERO_FREECELLS_MODE
+        fcs_free_moves_list(soft_thread);
+#endif
+        break;
+
+#ifdef FCS_RECONSTRUCT_MOVES
+    case FOREACH_SOFT_THREAD_ACCUM_ALL_DEPTHS_TESTS_ORDER:
+#ifndef FCS_ZERO_FREECELLS_MODE
+        for (size_t i = 0; i < soft_thread->by_depth_moves_order.num; ++i)
+        {
+            accumulate_tests_by_ptr((size_t *)context,
+                &(soft_thread->by_depth_moves_order.by_depth_moves[i]
+                        .moves_order));
+        }
+#endif
+        break;
+#endif
     }
 }
 
@@ -195,6 +214,14 @@ static inline
                             },
 #endif
                         .rand_seed = 24,
+                        .restarts =
+                            {
+                                .policy = FCS_DFS_RESTARTS_NONE,
+                                .unit = 0,
+                                .factor = 1,
+                                .num_restarts = 0,
+                                .iters_left = 0,
+                            },
                     },
                 .befs =
                     {
@@ -339,7 +366,64 @@ static inline find_card_ret find_card_src_string(
 }
 #endif
 
-extern void fc_solve_trace_solution(fcs_instance *const instance)
+#ifdef FCS_RECONSTRUCT_MOVES
+// Puts the moves that lead from the parent of state to it in moves, by
+// running the move functions of the scans (whose indexes are set in
+// move_funcs_bitmask) on the parent again. The first soft thread is made to
+// look like a BeFS scan, which recalculates the positions by rank of every
+// state that it checks anyway. Returns false if none of the moves derived the
+// state.
+static bool reconstruct_moves_to_parent(fcs_instance *const instance,
+    const size_t move_funcs_bitmask GCC_UNUSED,
+    fcs_collectible_state *const state, fcs_move_stack *const moves)
+{
+    fcs_hard_thread *const hard_thread = instance;
+    fcs_soft_thread *const soft_thread =
+        &(HT_FIELD(hard_thread, soft_threads)[0]);
+    fcs_kv_state pass;
+    FCS_STATE_collectible_to_kv(&pass, FCS_S_PARENT(instance, state));
+    const fcs_state *const parent_key = pass.key;
+
+    const_AUTO(super_method_type, soft_thread->super_method_type);
+    soft_thread->super_method_type = FCS_SUPER_METHOD_BEFS_BRFS;
+    soft_thread->num_vacant_freecells =
+        count_num_vacant_freecells(INSTANCE_FREECELLS_NUM, parent_key);
+    soft_thread->num_vacant_stacks =
+        count_num_vacant_stacks(INSTANCE_STACKS_NUM, parent_key);
+    fc_solve__calc_positions_by_rank_data(soft_thread, parent_key,
+        BEFS_M_VAR(soft_thread, befs_positions_by_rank)
+            PASS_COLS_SEQ_BREAKS(
+                BEFS_M_VAR(soft_thread, befs_cols_seq_breaks)));
+
+    HT_FIELD(hard_thread, reconstruction_target) = &(state->s);
+    fcs_move_stack_reset(moves);
+    HT_FIELD(hard_thread, reconstructed_moves) = moves;
+    HT_FIELD(hard_thread, was_reconstructed) = false;
+    fcs_derived_states_list derived = {
+        .num_states = 0, .states = NULL, .max_num_states = 0};
+#ifdef FCS_ZERO_FREECELLS_MODE
+    fc_solve_sfs_zerofc_0AB_atomic_all_moves(soft_thread, pass, &derived);
+#else
+    const_AUTO(move_funcs, INSTANCE_MOVE_FUNCS(instance));
+    for (size_t idx = 0; (move_funcs_bitmask >> idx) != 0; ++idx)
+    {
+        if ((move_funcs_bitmask >> idx) & 0x1)
+        {
+            move_funcs[idx](soft_thread, pass, &derived);
+        }
+    }
+#endif
+    fc_solve_sfs_raymond_prune(soft_thread, pass);
+    free(derived.states);
+
+    HT_FIELD(hard_thread, reconstruction_target) = NULL;
+    soft_thread->super_method_type = super_method_type;
+    return HT_FIELD(hard_thread, was_reconstructed);
+}
+#endif
+
+// Returns false if the moves to the solution could not be recovered.
+extern bool fc_solve_trace_solution(fcs_instance *const instance)
 {
     fcs_internal_move canonize_move = fc_solve_empty_move;
     fcs_int_move_set_type(canonize_move, FCS_MOVE_TYPE_CANONIZE);
@@ -474,18 +558,61 @@ extern void fc_solve_trace_solution(fcs_instance *const instance)
 #endif
     {
         fcs_collectible_state *s1 = instance->final_state;
+#ifdef FCS_WITH_ENDGAME_TABLEBASE
+        // The scans stop at the first position that the tablebase knows how
+        // to win, so the moves from it to the solution come first.
+        const_AUTO(endgame_tablebase, fcs_instance_endgame_tablebase(instance));
+        fcs_plain_position pos;
+        if (endgame_tablebase &&
+            fc_solve_etb_position_from_state(
+                &(endgame_tablebase->rules), &(s1->s), &pos))
+        {
+            fcs_plain_move moves[FCS_ETB_MAX_DISTANCE];
+            const int num_moves =
+                fc_solve_etb_solve(endgame_tablebase, pos, moves);
+            if (num_moves < 0)
+            {
+                // The tablebase rated the final state as winnable, but does
+                // not lead from it to the solution, so it is inconsistent.
+                return false;
+            }
+            for (int i = num_moves - 1; i >= 0; --i)
+            {
+                fcs_move_stack_params_push(solution_moves_ptr, moves[i].type,
+                    moves[i].src, moves[i].dest, moves[i].num_cards);
+            }
+        }
+#endif
 
+#ifdef FCS_RECONSTRUCT_MOVES
+        fcs_move_stack reconstructed_moves = fcs_move_stack__new();
+        size_t move_funcs_bitmask = 0;
+        fc_solve_foreach_soft_thread(instance,
+            FOREACH_SOFT_THREAD_ACCUM_ALL_DEPTHS_TESTS_ORDER,
+            &move_funcs_bitmask);
+#endif
         // Retrace the path from the current state to its parents
-        while (FCS_S_PARENT(s1) != NULL)
+        while (FCS_S_PARENT(instance, s1) != NULL)
         {
             // Mark the state as part of the non-optimized solution
-            FCS_S_VISITED(s1) |= FCS_VISITED_IN_SOLUTION_PATH;
+            FCS_S_VISITED(instance, s1) |= FCS_VISITED_IN_SOLUTION_PATH;
 
             // Each state->parent_state stack has an implicit CANONIZE move.
             fcs_move_stack_push(solution_moves_ptr, canonize_move);
 
             // Merge the move stack
-            const fcs_move_stack *const stack = FCS_S_MOVES_TO_PARENT(s1);
+#ifdef FCS_RECONSTRUCT_MOVES
+            if (unlikely(!reconstruct_moves_to_parent(
+                    instance, move_funcs_bitmask, s1, &reconstructed_moves)))
+            {
+                fcs_move_stack_static_destroy(reconstructed_moves);
+                return false;
+            }
+            const fcs_move_stack *const stack = &reconstructed_moves;
+#else
+            const fcs_move_stack *const stack =
+                FCS_S_MOVES_TO_PARENT(instance, s1);
+#endif
             const fcs_internal_move *const moves = stack->moves;
             for (long move_idx = (long)stack->num_moves - 1; move_idx >= 0;
                  --move_idx)
@@ -493,11 +620,15 @@ extern void fc_solve_trace_solution(fcs_instance *const instance)
                 fcs_move_stack_push(solution_moves_ptr, moves[move_idx]);
             }
 
-            s1 = FCS_S_PARENT(s1);
+            s1 = FCS_S_PARENT(instance, s1);
         }
         // There's one more state than there are move stacks
-        FCS_S_VISITED(s1) |= FCS_VISITED_IN_SOLUTION_PATH;
+        FCS_S_VISITED(instance, s1) |= FCS_VISITED_IN_SOLUTION_PATH;
+#ifdef FCS_RECONSTRUCT_MOVES
+        fcs_move_stack_static_destroy(reconstructed_moves);
+#endif
     }
+    return true;
 }
 #endif
 
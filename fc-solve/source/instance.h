@@ -111,6 +111,19 @@ typedef struct
 
 typedef int8_t fcs__positions_by_rank[FCS_BOTH__POS_BY_RANK__SIZE];
 
+// A run-length descriptor of the natural sequences of a column: bit i is
+// set if card i ends a sequence, i.e: it is the top card or the card above
+// it is not its child. It is calculated together with the positions by rank
+// and lets the move functions find the sequence ends without rescanning.
+typedef uint64_t fcs_col_seq_breaks;
+#if MAX_NUM_CARDS_IN_A_STACK <= 64
+#define FCS_WITH_COLS_SEQ_BREAKS
+typedef fcs_col_seq_breaks fcs__cols_seq_breaks[MAX_NUM_STACKS];
+#define PASS_COLS_SEQ_BREAKS(param) , param
+#else
+#define PASS_COLS_SEQ_BREAKS(param)
+#endif
+
 // This is a linked list item that is used to implement a queue for the BFS
 // scan.
 typedef struct fcs_states_linked_list_item_struct
@@ -119,6 +132,63 @@ typedef struct fcs_states_linked_list_item_struct
     struct fcs_states_linked_list_item_struct *next;
 } fcs_states_linked_list_item;
 
+// Soft-DFS may recycle the states of the sub-trees that were marked as dead
+// ends, while keeping their fingerprints (see dead_end_fingerprints.h). That
+// requires the internal hash, which can be swept, and states that are hashed
+// as they are.
+#if (FCS_STATE_STORAGE == FCS_STATE_STORAGE_INTERNAL_HASH) &&                  \
+    !defined(FCS_RCS_STATES) && !defined(FCS_DISABLE_NUM_STORED_STATES) &&     \
+    !defined(FCS_WITHOUT_TRIM_MAX_STORED_STATES)
+#define FCS_WITH_DEAD_ENDS_RECYCLING
+#include "dead_end_fingerprints.h"
+#endif
+
+#ifndef FCS_WITHOUT_MAX_NUM_STATES
+#include "stop_request.h"
+#ifndef FCS_WITHOUT_MEMORY_BUDGET
+#include "memory_budget.h"
+#endif
+#endif
+
+#ifndef FCS_WITHOUT_TRACE_RING
+#include "trace_ring.h"
+#endif
+
+// The endgame tablebase and the local optimizer of the solutions work on
+// plain positions (see plain_position.h), which only cover a single deck.
+#if defined(FCS_WITH_MOVES) && !defined(FCS_ZERO_FREECELLS_MODE) &&            \
+    (MAX_NUM_DECKS == 1)
+#define FCS_WITH_PLAIN_POSITIONS
+#include "plain_position.h"
+#endif
+
+// The scans may probe an endgame tablebase (see endgame_tablebase.h) and
+// stop at the positions that it knows how to win. The rest of the solution is
+// read from the tablebase when it is traced, which requires the states to be
+// kept as they are.
+#if defined(FCS_WITH_PLAIN_POSITIONS) && !defined(FCS_RCS_STATES) &&           \
+    !defined(FCS_WITHOUT_ENDGAME_TABLEBASE) && !defined(WIN32)
+#define FCS_WITH_ENDGAME_TABLEBASE
+#include "endgame_tablebase.h"
+#endif
+
+// Shortens the traced solutions by searching for shortcuts inside a window
+// that slides over them (see local_optimizer.h).
+#if defined(FCS_WITH_PLAIN_POSITIONS) && !defined(FCS_WITHOUT_LOCAL_OPTIMIZER)
+#define FCS_WITH_LOCAL_OPTIMIZER
+#include "local_optimizer.h"
+#endif
+
+// The move functions are compiled a second time for a few popular game
+// variants, with their game parameters as compile-time constants (see
+// specialized_moves.h). That is only possible when the parameters are not
+// hard-coded already.
+#if !defined(FCS_FREECELL_ONLY) && !defined(FCS_ZERO_FREECELLS_MODE) &&        \
+    !defined(HARD_CODED_NUM_FREECELLS) && !defined(HARD_CODED_NUM_STACKS) &&   \
+    !defined(HARD_CODED_NUM_DECKS) && !defined(FCS_DISABLE_SPECIALIZED_MOVES)
+#define FCS_WITH_SPECIALIZED_MOVES
+#endif
+
 // Declare these structures because they will be used within
 // fc_solve_instance, and they will contain a pointer to it.
 struct fc_solve_hard_thread_struct;
@@ -148,6 +218,11 @@ extern guint fc_solve_hash_function(gconstpointer key);
 
 #ifndef FCS_ZERO_FREECELLS_MODE
 #include "move_funcs_maps.h"
+#ifdef FCS_WITH_SPECIALIZED_MOVES
+#define INSTANCE_MOVE_FUNCS(instance) ((instance)->move_funcs)
+#else
+#define INSTANCE_MOVE_FUNCS(instance) fc_solve_sfs_move_funcs
+#endif
 #endif
 
 // HT_LOOP == hard threads' loop - macros to abstract it.
@@ -280,6 +355,17 @@ struct fc_solve_hard_thread_struct
     // duplicated state.
     DECLARE_IND_BUF_T(indirect_stacks_buffer)
 
+#ifdef FCS_RECONSTRUCT_MOVES
+    // While it is not NULL, the move functions derive their states into
+    // reconstruction_state instead of the collection, and the first moves
+    // that lead to reconstruction_target are kept in reconstructed_moves -
+    // see fc_solve_trace_solution() .
+    const fcs_state *reconstruction_target;
+    fcs_move_stack *reconstructed_moves;
+    bool was_reconstructed;
+    fcs_state_keyval_pair reconstruction_state;
+#endif
+
     size_t prelude_num_items;
     size_t prelude_idx;
 #ifndef FCS_USE_PRECOMPILED_CMD_LINE_THEME
@@ -319,6 +405,12 @@ typedef struct
     rating_with_index *derived_states_random_indexes;
 #endif
     fcs__positions_by_rank positions_by_rank;
+#ifdef FCS_WITH_COLS_SEQ_BREAKS
+    fcs__cols_seq_breaks cols_seq_breaks;
+#endif
+    // Whether positions_by_rank was calculated for state, so the states
+    // one level deeper can derive theirs from it.
+    bool positions_by_rank_is_valid;
 } fcs_soft_dfs_stack_item;
 
 typedef struct
@@ -327,6 +419,19 @@ typedef struct
     fcs_moves_order move_funcs;
 } moves_by_depth_unit;
 
+// The restarts of a Soft-DFS scan. Once the scan has checked the number of
+// states that the policy allots to the current run, it backtracks to the
+// initial state and reseeds its random number generator. The state
+// collection is kept, so the dead ends that were found remain known.
+typedef struct
+{
+    int policy;
+    fcs_iters_int unit;
+    double factor;
+    size_t num_restarts;
+    fcs_iters_int iters_left;
+} fcs_dfs_restarts;
+
 typedef struct
 {
     size_t num_units;
@@ -397,6 +502,8 @@ struct fc_solve_soft_thread_struct
             // The initial seed of this random number generator
             fcs_rand_gen rand_seed;
 
+            fcs_dfs_restarts restarts;
+
 #ifndef FCS_ZERO_FREECELLS_MODE
             // The moves to be performed in a preprocessed form.
             fcs_moves_by_depth_array moves_by_depth;
@@ -406,6 +513,9 @@ struct fc_solve_soft_thread_struct
         struct
         {
             fcs__positions_by_rank befs_positions_by_rank;
+#ifdef FCS_WITH_COLS_SEQ_BREAKS
+            fcs__cols_seq_breaks befs_cols_seq_breaks;
+#endif
             fcs_move_func *moves_list, *moves_list_end;
             struct
             {
@@ -473,6 +583,12 @@ struct fc_solve_instance_struct
 // The parameters of the game - see the declaration of fcs_game_type_params_t .
 #ifndef FCS_FREECELL_ONLY
     fcs_game_type_params game_params;
+#ifdef FCS_WITH_SPECIALIZED_MOVES
+    // The table that the move functions' indexes are resolved against -
+    // either fc_solve_sfs_move_funcs or one that was specialized for
+    // game_params. It is selected when the instance starts solving a board.
+    const fc_solve_solve_for_state_move_func *move_funcs;
+#endif
 #ifndef FCS_DISABLE_PATSOLVE
     fcs_card game_variant_suit_mask;
     fcs_card game_variant_desired_suit_value;
@@ -490,6 +606,8 @@ struct fc_solve_instance_struct
     //
     // Normally should be used instead.
     fcs_iters_int effective_max_num_checked_states;
+    // The user's request to suspend the solving, or NULL.
+    fcs_stop_request *stop_request;
 #endif
 #ifndef FCS_DISABLE_NUM_STORED_STATES
     fcs_iters_int effective_max_num_states_in_collection;
@@ -542,6 +660,18 @@ struct fc_solve_instance_struct
 #endif
 
     fcs_collectible_state *list_of_vacant_states;
+#ifdef FCS_WITH_STATE_SIDE_TABLES
+    fcs_state_side_tables state_side_tables;
+#endif
+#ifdef FCS_WITH_DEAD_ENDS_RECYCLING
+    // The number of states in the collection from which the dead ends are
+    // recycled, or FCS_ITERS_INT_MAX if they are not.
+    fcs_iters_int recycle_dead_ends_from;
+    fcs_dead_end_fingerprints dead_end_fingerprints;
+    // The state that stands for the recycled dead ends, when they are
+    // derived again.
+    fcs_state_keyval_pair dead_end_state;
+#endif
 
 #ifndef FCS_HARD_CODE_CALC_REAL_DEPTH_AS_FALSE
     bool FCS_RUNTIME_CALC_REAL_DEPTH;
@@ -616,6 +746,10 @@ struct fc_solve_instance_struct
     instance_debug_iter_output_func debug_iter_output_func;
     void *debug_iter_output_context;
 #endif
+#ifndef FCS_WITHOUT_TRACE_RING
+    // The ring to which the scans append the trace records, or NULL.
+    fcs_trace_ring *trace_ring;
+#endif
 
     fastest_type_for_num_soft_threads__unsigned next_soft_thread_id;
 
@@ -653,6 +787,14 @@ struct fc_solve_instance_struct
     // Whether or not this is a Simple Simon-like game.
     bool is_simple_simon;
 #endif
+#ifdef FCS_WITH_ENDGAME_TABLEBASE
+    // The endgame tablebase, which is owned by the fcs_user, or NULL.
+    const fcs_endgame_tablebase *endgame_tablebase;
+#endif
+#ifdef FCS_WITH_LOCAL_OPTIMIZER
+    // The parameters of the local optimizer of the traced solution.
+    fcs_local_opt_params local_opt;
+#endif
 };
 
 #define fcs_st_instance(soft_thread) HT_INSTANCE((soft_thread)->hard_thread)
@@ -775,7 +917,11 @@ typedef enum
     FOREACH_SOFT_THREAD_CLEAN_SOFT_DFS,
     FOREACH_SOFT_THREAD_FREE_INSTANCE,
     FOREACH_SOFT_THREAD_ACCUM_TESTS_ORDER,
-    FOREACH_SOFT_THREAD_DETERMINE_SCAN_COMPLETENESS
+    FOREACH_SOFT_THREAD_DETERMINE_SCAN_COMPLETENESS,
+    FOREACH_SOFT_THREAD_FREE_MOVES_LISTS,
+#ifdef FCS_RECONSTRUCT_MOVES
+    FOREACH_SOFT_THREAD_ACCUM_ALL_DEPTHS_TESTS_ORDER,
+#endif
 } foreach_st_callback_choice;
 
 extern void fc_solve_foreach_soft_thread(fcs_instance *const instance,
@@ -811,8 +957,77 @@ static inline bool fcs_get_calc_real_depth(const fcs_instance *const instance)
 }
 #endif
 
+#ifdef FCS_WITH_PLAIN_POSITIONS
+// Fills rules with the game variant of the instance. Returns false if its
+// positions cannot be kept as plain positions.
+static inline bool fcs_instance_plain_rules(
+    const fcs_instance *const instance, fcs_plain_rules *const rules)
+{
+#ifndef FCS_DISABLE_SIMPLE_SIMON
+    if (instance->is_simple_simon)
+    {
+        return false;
+    }
+#endif
+    *rules = (fcs_plain_rules){
+        .num_freecells = INSTANCE_FREECELLS_NUM,
+        .num_columns = INSTANCE_STACKS_NUM,
+#ifdef FCS_FREECELL_ONLY
+        .sequences_are_built_by = FCS_SEQ_BUILT_BY_ALTERNATE_COLOR,
+        .empty_stacks_fill = FCS_ES_FILLED_BY_ANY_CARD,
+        .unlimited_sequence_move = false,
+#else
+        .sequences_are_built_by = GET_INSTANCE_SEQUENCES_ARE_BUILT_BY(instance),
+        .empty_stacks_fill = INSTANCE_EMPTY_STACKS_FILL,
+        .unlimited_sequence_move = (INSTANCE_UNLIMITED_SEQUENCE_MOVE != 0),
+#endif
+    };
+
+    return (INSTANCE_DECKS_NUM == 1);
+}
+#endif
+
+#ifndef FCS_WITHOUT_MAX_NUM_STATES
+static inline bool fcs_instance_is_stop_requested(
+    const fcs_instance *const instance)
+{
+    const_SLOT(stop_request, instance);
+    if (!stop_request)
+    {
+        return false;
+    }
+#ifndef FCS_WITHOUT_MEMORY_BUDGET
+    // A memory budget that is over its cap suspends the solving like a
+    // cancellation, so it may be resumed once the budget has room.
+    if (unlikely(fc_solve_memory_budget_should_suspend(
+            instance->meta_alloc, stop_request)))
+    {
+        fc_solve_stop_request_set_cancel(stop_request, true);
+        return true;
+    }
+#endif
+    return fc_solve_is_stop_requested(stop_request);
+}
+#endif
+
+#ifdef FCS_WITH_ENDGAME_TABLEBASE
+// Returns the endgame tablebase if it was generated for the game variant of
+// the instance, or NULL otherwise.
+static inline const fcs_endgame_tablebase *fcs_instance_endgame_tablebase(
+    const fcs_instance *const instance)
+{
+    const_SLOT(endgame_tablebase, instance);
+    fcs_plain_rules rules;
+    return ((endgame_tablebase && fcs_instance_plain_rules(instance, &rules) &&
+                fc_solve_plain_rules_match(
+                    &(endgame_tablebase->rules.game), &rules))
+                ? endgame_tablebase
+                : NULL);
+}
+#endif
+
 #ifdef FCS_WITH_MOVES
-extern void fc_solve_trace_solution(fcs_instance *const instance);
+extern bool fc_solve_trace_solution(fcs_instance *const instance);
 #endif
 #ifdef __cplusplus
 }
@@ -9,12 +9,24 @@
 #include "instance_for_lib.h"
 #include "freecell-solver/fcs_user.h"
 #include "fcs_user_internal.h"
+#include "memory_budget.h"
 #ifndef FCS_WITHOUT_FC_PRO_MOVES_COUNT
 #include "fc_pro_iface_pos.h"
 #endif
 #ifdef FCS_ZERO_FREECELLS_MODE
 #include "zerofc_freecell_moves.h"
 #endif
+#include "specialized_moves.h"
+#ifdef FCS_WITH_DEAD_ENDS_RECYCLING
+#include "wrap_xxhash.h"
+#endif
+
+#ifdef FCS_WITH_STATE_SIDE_TABLES
+// Stop before the ids of the states run out.
+#define MAX_NUM_STATES_IN_COLLECTION FCS_STATE_SIDE_TABLES_MAX_NUM_STATES
+#else
+#define MAX_NUM_STATES_IN_COLLECTION FCS_ITERS_INT_MAX
+#endif
 
 #ifdef DEBUG
 static void verify_state_sanity(const fcs_state *const ptr_state)
@@ -50,6 +62,9 @@ static inline void fc_solve_instance__init_hard_thread(
 #ifdef FCS_WITH_MOVES
     HT_FIELD(hard_thread, reusable_move_stack) = fcs_move_stack__new();
 #endif
+#ifdef FCS_RECONSTRUCT_MOVES
+    HT_FIELD(hard_thread, reconstruction_target) = NULL;
+#endif
 }
 
 #ifndef FCS_FREECELL_ONLY
@@ -85,13 +100,14 @@ static inline void alloc_instance(
         .i__stats = initial_stats,
 #ifndef FCS_WITHOUT_MAX_NUM_STATES
         .effective_max_num_checked_states = FCS_ITERS_INT_MAX,
+        .stop_request = NULL,
 #endif
 #ifndef FCS_DISABLE_NUM_STORED_STATES
 #ifndef FCS_WITHOUT_TRIM_MAX_STORED_STATES
         .active_num_states_in_collection = 0,
         .effective_trim_states_in_collection_from = FCS_ITERS_INT_MAX,
 #endif
-        .effective_max_num_states_in_collection = FCS_ITERS_INT_MAX,
+        .effective_max_num_states_in_collection = MAX_NUM_STATES_IN_COLLECTION,
 #endif
         .instance_moves_order =
             {
@@ -101,6 +117,12 @@ static inline void alloc_instance(
 #endif
             },
         .list_of_vacant_states = NULL,
+#ifdef FCS_WITH_DEAD_ENDS_RECYCLING
+        .recycle_dead_ends_from = FCS_ITERS_INT_MAX,
+#endif
+#ifdef FCS_WITH_SPECIALIZED_MOVES
+        .move_funcs = fc_solve_sfs_move_funcs,
+#endif
 #ifdef FCS_WITH_MOVES
         .opt_moves =
             {
@@ -120,6 +142,9 @@ static inline void alloc_instance(
         .next_soft_thread_id = 0,
 #ifndef FCS_WITHOUT_ITER_HANDLER
         .debug_iter_output_func = NULL,
+#endif
+#ifndef FCS_WITHOUT_TRACE_RING
+        .trace_ring = NULL,
 #endif
         .finished_hard_threads_count = 0,
 #ifndef FCS_HARD_CODE_CALC_REAL_DEPTH_AS_FALSE
@@ -137,6 +162,14 @@ static inline void alloc_instance(
 #endif
 #ifndef FCS_DISABLE_SIMPLE_SIMON
         .is_simple_simon = false,
+#endif
+#ifdef FCS_WITH_ENDGAME_TABLEBASE
+        .endgame_tablebase = NULL,
+#endif
+#ifdef FCS_WITH_LOCAL_OPTIMIZER
+        .local_opt = {.window = 0,
+            .max_iters = FCS_LOCAL_OPT_DEFAULT_MAX_ITERS,
+            .num_threads = 1},
 #endif
     };
 #if (FCS_STATE_STORAGE == FCS_STATE_STORAGE_INTERNAL_HASH)
@@ -275,6 +308,19 @@ static inline void init_instance(fcs_instance *const instance)
             &(HT_FIELD(hard_thread, st_idx)));
     }
 
+#ifdef FCS_WITH_SPECIALIZED_MOVES
+    // The game may have changed since the moves lists were built for the
+    // previous board, in which case they are rebuilt from the new table.
+    const_AUTO(
+        move_funcs, fc_solve_select_move_funcs(&(instance->game_params)));
+    if (move_funcs != instance->move_funcs)
+    {
+        instance->move_funcs = move_funcs;
+        fc_solve_foreach_soft_thread(
+            instance, FOREACH_SOFT_THREAD_FREE_MOVES_LISTS, NULL);
+    }
+#endif
+
     size_t total_move_funcs_bitmask = 0;
     fc_solve_foreach_soft_thread(instance,
         FOREACH_SOFT_THREAD_ACCUM_TESTS_ORDER, &total_move_funcs_bitmask);
@@ -542,20 +588,43 @@ static inline void start_process_with_board(fcs_instance *const instance,
             .stacks_copy_on_write_flags = ~0,
 #endif
 // Initialize the state to be a base state for the game tree
+#ifdef FCS_WITH_STATE_SIDE_TABLES
+            // The entries of a new id are cleared.
+            .id = fc_solve_state_side_tables_new_id(
+                &(instance->state_side_tables)),
+#else
 #ifdef FCS_WITH_DEPTH_FIELD
             .depth = 0,
 #endif
-#ifdef FCS_WITH_MOVES
+#ifdef FCS_WITH_MOVES_TO_PARENT
             .moves_to_parent = NULL,
 #endif
             .visited = 0,
             .parent = NULL,
-            .scan_visited = {0}}};
+            .scan_visited = {0}
+#endif
+        }};
     update_initial_cards_val(instance);
 
     fcs_kv_state no_use,
         pass_copy = FCS_STATE_keyval_pair_to_kv(&instance->state_copy);
     fc_solve_check_and_add_state(instance, &pass_copy, &no_use);
+#ifdef FCS_WITH_DEAD_ENDS_RECYCLING
+    instance->dead_end_state = instance->state_copy;
+#ifdef FCS_WITH_STATE_SIDE_TABLES
+    instance->dead_end_state.info.id =
+        fc_solve_state_side_tables_new_id(&(instance->state_side_tables));
+#endif
+    FCS_S_VISITED(instance, &(instance->dead_end_state)) =
+        (FCS_VISITED_DEAD_END | FCS_VISITED_ALL_TESTS_DONE);
+    memset(FCS_S_SCAN_VISITED(instance, &(instance->dead_end_state)), 0xff,
+        sizeof(FCS_S_SCAN_VISITED(instance, &(instance->dead_end_state))));
+#endif
+#if defined(FCS_RECONSTRUCT_MOVES) && defined(FCS_WITH_STATE_SIDE_TABLES)
+    // The moves to a parent are reconstructed in a state of its own.
+    HT_FIELD(instance, reconstruction_state).info.id =
+        fc_solve_state_side_tables_new_id(&(instance->state_side_tables));
+#endif
 
     {
         HT_LOOP_START()
@@ -707,15 +776,51 @@ static void fc_solve_finish_instance(fcs_instance *const instance)
         instance, FOREACH_SOFT_THREAD_CLEAN_SOFT_DFS, NULL);
 }
 
+#if ((FCS_STATE_STORAGE == FCS_STATE_STORAGE_INTERNAL_HASH) ||              \
+     (defined(INDIRECT_STACK_STATES) &&                                        \
+         (FCS_STACK_STORAGE == FCS_STACK_STORAGE_INTERNAL_HASH)))
+static inline void recycle_hash(
+    fcs_instance *const instance GCC_UNUSED, hash_table *const hash)
+{
+#ifndef FCS_WITHOUT_MEMORY_BUDGET
+    // A table that grew while solving is given back to the other members of
+    // the budget.
+    if (instance->meta_alloc->budget)
+    {
+        fc_solve_hash_shrink(hash);
+    }
+#endif
+    fc_solve_hash_recycle(hash);
+}
+#endif
+
 static inline void recycle_inst(fcs_instance *const instance)
 {
     fc_solve_finish_instance(instance);
 #if (FCS_STATE_STORAGE == FCS_STATE_STORAGE_INTERNAL_HASH)
-    fc_solve_hash_recycle(&(instance->hash));
+    recycle_hash(instance, &(instance->hash));
+#endif
+    // The vacant states were allocated by the recycled allocators.
+    instance->list_of_vacant_states = NULL;
+#ifdef FCS_WITH_STATE_SIDE_TABLES
+    fc_solve_state_side_tables_recycle(&(instance->state_side_tables));
+#endif
+#ifndef FCS_DISABLE_NUM_STORED_STATES
+#ifndef FCS_WITHOUT_TRIM_MAX_STORED_STATES
+    instance->active_num_states_in_collection = 0;
+#endif
+#endif
+#ifdef FCS_WITH_DEAD_ENDS_RECYCLING
+    fc_solve_dead_end_fingerprints_free(&(instance->dead_end_fingerprints));
+    if (instance->recycle_dead_ends_from != FCS_ITERS_INT_MAX)
+    {
+        instance->effective_trim_states_in_collection_from =
+            instance->recycle_dead_ends_from;
+    }
 #endif
 #ifdef INDIRECT_STACK_STATES
 #if (FCS_STACK_STORAGE == FCS_STACK_STORAGE_INTERNAL_HASH)
-    fc_solve_hash_recycle(&(instance->stacks_hash));
+    recycle_hash(instance, &(instance->stacks_hash));
 #endif
 #endif
 #ifdef FCS_WITH_MOVES
@@ -777,9 +882,12 @@ static inline fc_solve_solve_process_ret_t optimize_solution(
     fcs_soft_thread *const optimization_soft_thread =
         &(instance->optimization_soft_thread);
 
-    if (!instance->solution_moves.moves)
+    // If the solution cannot be traced, it is reported when the flare
+    // traces it again.
+    if (!instance->solution_moves.moves &&
+        !fc_solve_trace_solution(instance))
     {
-        fc_solve_trace_solution(instance);
+        return FCS_STATE_WAS_SOLVED;
     }
 
 #ifndef FCS_HARD_CODE_REPARENT_STATES_AS_FALSE
@@ -860,9 +968,10 @@ static void verify_soft_dfs_stack(fcs_soft_thread *soft_thread)
 #endif
 
 static inline bool fcs__is_state_a_dead_end(
+    fcs_instance *const instance GCC_UNUSED,
     const fcs_collectible_state *const ptr_state)
 {
-    return (FCS_S_VISITED(ptr_state) & FCS_VISITED_DEAD_END);
+    return (FCS_S_VISITED(instance, ptr_state) & FCS_VISITED_DEAD_END);
 }
 
 #ifndef FCS_DISABLE_NUM_STORED_STATES
@@ -875,8 +984,12 @@ static inline bool fcs__is_state_a_dead_end(
 static inline void free_states_handle_soft_dfs_soft_thread(
     fcs_soft_thread *const soft_thread)
 {
+    fcs_instance *const instance = fcs_st_instance(soft_thread);
     var_AUTO(soft_dfs_info, DFS_VAR(soft_thread, soft_dfs_info));
-    const_AUTO(end_soft_dfs_info, soft_dfs_info + DFS_VAR(soft_thread, depth));
+    // The current depth too, because another soft thread may be the one
+    // that is sweeping.
+    const_AUTO(
+        end_soft_dfs_info, soft_dfs_info + DFS_VAR(soft_thread, depth) + 1);
 
     for (; soft_dfs_info < end_soft_dfs_info; soft_dfs_info++)
     {
@@ -896,7 +1009,7 @@ static inline void free_states_handle_soft_dfs_soft_thread(
             soft_dfs_info->derived_states_list.states;
         for (; rand_index_ptr < end_rand_index_ptr; rand_index_ptr++)
         {
-            if (!fcs__is_state_a_dead_end(
+            if (!fcs__is_state_a_dead_end(instance,
                     states[rand_index_ptr->rating_with_index__idx].state_ptr))
             {
                 *(dest_rand_index_ptr++) = *(rand_index_ptr);
@@ -913,9 +1026,19 @@ static bool free_states_should_delete(void *const key, void *const context)
     fcs_instance *const instance = (fcs_instance *const)context;
     fcs_collectible_state *const ptr_state = (fcs_collectible_state *const)key;
 
-    if (fcs__is_state_a_dead_end(ptr_state))
+    if (fcs__is_state_a_dead_end(instance, ptr_state) &&
+        (!(FCS_S_VISITED(instance, ptr_state) & FCS_VISITED_PINNED)))
     {
-        FCS_S_NEXT(ptr_state) = instance->list_of_vacant_states;
+#ifdef FCS_WITH_DEAD_ENDS_RECYCLING
+        if ((instance->recycle_dead_ends_from != FCS_ITERS_INT_MAX) &&
+            (!fc_solve_dead_end_fingerprints_insert(
+                &(instance->dead_end_fingerprints),
+                DO_XXH(&(ptr_state->s), sizeof(ptr_state->s)))))
+        {
+            return false;
+        }
+#endif
+        FCS_S_NEXT(instance, ptr_state) = instance->list_of_vacant_states;
         instance->list_of_vacant_states = ptr_state;
 
         --instance->active_num_states_in_collection;
@@ -928,14 +1051,79 @@ static bool free_states_should_delete(void *const key, void *const context)
     }
 }
 
+// Pins (or unpins) a state along with its ancestors, which a dead end that
+// is pinned may still have.
+static inline void pin_state(fcs_instance *const instance GCC_UNUSED,
+    fcs_collectible_state *ptr_state, const bool pin)
+{
+    for (; ptr_state &&
+           ((!(FCS_S_VISITED(instance, ptr_state) & FCS_VISITED_PINNED)) ==
+               pin);
+         ptr_state = FCS_S_PARENT(instance, ptr_state))
+    {
+        FCS_S_VISITED(instance, ptr_state) ^= FCS_VISITED_PINNED;
+    }
+}
+
+// A state that one of the scans is positioned at may already be marked as a
+// dead end by another scan, so it is pinned while the dead ends are swept.
+static inline void pin_scans_states(
+    fcs_instance *const instance, const bool pin)
+{
+    HT_LOOP_START()
+    {
+        ST_LOOP_START()
+        {
+            if (!STRUCT_QUERY_FLAG(soft_thread, FCS_SOFT_THREAD_INITIALIZED))
+            {
+                continue;
+            }
+            // A BeFS or BFS thread has no Soft-DFS stack (soft_dfs_info is
+            // NULL while depth is 0), and a Soft-DFS thread never sets
+            // first_state_to_check, so only the thread's own method's
+            // positions are pinned.
+            if (soft_thread->super_method_type == FCS_SUPER_METHOD_DFS)
+            {
+                const_AUTO(soft_dfs_info, DFS_VAR(soft_thread, soft_dfs_info));
+                const_AUTO(depth, DFS_VAR(soft_thread, depth));
+                for (ssize_t i = 0; i <= depth; ++i)
+                {
+                    pin_state(instance, soft_dfs_info[i].state, pin);
+                }
+            }
+            else if (soft_thread->super_method_type ==
+                     FCS_SUPER_METHOD_BEFS_BRFS)
+            {
+                pin_state(instance,
+                    BEFS_M_VAR(soft_thread, first_state_to_check), pin);
+            }
+        }
+    }
+}
+
 static inline void free_states(fcs_instance *const instance)
 {
+#if defined(FCS_WITH_DEAD_ENDS_RECYCLING) &&                                   \
+    !defined(FCS_HARD_CODE_REPARENT_STATES_AS_FALSE)
+    // Reparenting may leave a state that is not a dead end with a parent that
+    // is one, so the dead ends cannot be recycled.
+    if ((instance->recycle_dead_ends_from != FCS_ITERS_INT_MAX) &&
+        STRUCT_QUERY_FLAG(instance, FCS_RUNTIME_TO_REPARENT_STATES_REAL))
+    {
+        instance->effective_trim_states_in_collection_from = FCS_ITERS_INT_MAX;
+        return;
+    }
+#endif
     // First of all, let's make sure the soft_threads will no longer
     // traverse to the freed states that are currently dead ends.
     HT_LOOP_START()
     {
         ST_LOOP_START()
         {
+            if (!STRUCT_QUERY_FLAG(soft_thread, FCS_SOFT_THREAD_INITIALIZED))
+            {
+                continue;
+            }
             if (soft_thread->super_method_type == FCS_SUPER_METHOD_DFS)
             {
 #ifndef FCS_ZERO_FREECELLS_MODE
@@ -952,7 +1140,8 @@ static inline void free_states(fcs_instance *const instance)
                 for (pq_element *next_element = elems + PQ_FIRST_ENTRY;
                      next_element <= end_element; next_element++)
                 {
-                    if (!fcs__is_state_a_dead_end((*next_element).val))
+                    if (!fcs__is_state_a_dead_end(
+                            instance, (*next_element).val))
                     {
                         fc_solve_pq_push(&new_pq, (*next_element).val,
                             (*next_element).rating);
@@ -961,16 +1150,49 @@ static inline void free_states(fcs_instance *const instance)
                 st_free_pq(soft_thread);
                 BEFS_VAR(soft_thread, pqueue) = new_pq;
             }
+            else if (soft_thread->super_method_type ==
+                     FCS_SUPER_METHOD_BEFS_BRFS)
+            {
+                fcs_states_linked_list_item *item =
+                    BRFS_VAR(soft_thread, bfs_queue);
+                const_AUTO(last_item, BRFS_VAR(soft_thread, bfs_queue_last_item));
+                while (item->next != last_item)
+                {
+                    fcs_states_linked_list_item *const next_item = item->next;
+                    if (fcs__is_state_a_dead_end(instance, next_item->s))
+                    {
+                        item->next = next_item->next;
+                        next_item->next = BRFS_VAR(soft_thread, recycle_bin);
+                        BRFS_VAR(soft_thread, recycle_bin) = next_item;
+                    }
+                    else
+                    {
+                        item = next_item;
+                    }
+                }
+            }
         }
     }
 
     // Now let's recycle the states.
+    pin_scans_states(instance, true);
 #if (FCS_STATE_STORAGE == FCS_STATE_STORAGE_INTERNAL_HASH)
     fc_solve_hash_foreach(
         &(instance->hash), free_states_should_delete, ((void *)instance));
 #elif (FCS_STATE_STORAGE == FCS_STATE_STORAGE_GOOGLE_DENSE_HASH)
     fc_solve_states_google_hash_foreach(
         instance->hash, free_states_should_delete, ((void *)instance));
+#endif
+    pin_scans_states(instance, false);
+#ifdef FCS_WITH_DEAD_ENDS_RECYCLING
+    // Sweep again only after the collection has grown to twice its live
+    // size, so the sweeps take an amortised constant time per state.
+    if (instance->recycle_dead_ends_from != FCS_ITERS_INT_MAX)
+    {
+        instance->effective_trim_states_in_collection_from =
+            max(instance->recycle_dead_ends_from,
+                (instance->active_num_states_in_collection << 1));
+    }
 #endif
 }
 #endif
@@ -1004,7 +1226,8 @@ static inline bool was_pruned(const bool enable_pruning,
     fcs_soft_dfs_stack_item *the_soft_dfs_info, fcs_kv_state *pass,
     fcs_derived_states_list *derived_list, fcs_moves_order *the_moves_list)
 {
-    if (!fcs__should_state_be_pruned(enable_pruning, ptr_state))
+    fcs_instance *const instance = fcs_st_instance(soft_thread);
+    if (!fcs__should_state_be_pruned(instance, enable_pruning, ptr_state))
     {
         return false;
     }
@@ -1119,7 +1342,8 @@ static inline void dfs_shuffle_states(fcs_soft_thread *const soft_thread,
 #else
                     &(derived_states[i].state_ptr->s),
 #endif
-                    BEFS_MAX_DEPTH - calc_depth(derived_states[i].state_ptr));
+                    BEFS_MAX_DEPTH -
+                        calc_depth(instance, derived_states[i].state_ptr));
             }
 
             const_AUTO(end, rand_array + num_states);
@@ -1145,6 +1369,84 @@ static inline void dfs_shuffle_states(fcs_soft_thread *const soft_thread,
 }
 #endif
 
+// The seeds of the runs of a restarted scan are spaced apart, so they do not
+// coincide with the seeds of the other scans of a seeds' portfolio.
+#define FCS_DFS_RESTARTS_SEED_STRIDE 1000003
+
+// The Luby sequence (1, 1, 2, 1, 1, 2, 4, 1, ...) for a 0-based index.
+static inline fcs_iters_int dfs_restarts_luby(size_t idx)
+{
+    size_t size = 1;
+    int seq = 0;
+    while (size < idx + 1)
+    {
+        ++seq;
+        size = (size << 1) + 1;
+    }
+    while (size - 1 != idx)
+    {
+        size >>= 1;
+        --seq;
+        idx %= size;
+    }
+    return ((fcs_iters_int)1) << seq;
+}
+
+static inline fcs_iters_int dfs_restarts_calc_budget(
+    const fcs_dfs_restarts *const restarts)
+{
+    double budget = (double)restarts->unit;
+    if (restarts->policy == FCS_DFS_RESTARTS_LUBY)
+    {
+        budget *= (double)dfs_restarts_luby(restarts->num_restarts);
+    }
+    else
+    {
+        for (size_t i = 0; (i < restarts->num_restarts) &&
+                           (budget < (double)FCS_ITERS_INT_MAX);
+             ++i)
+        {
+            budget *= restarts->factor;
+        }
+    }
+
+    return ((budget >= (double)FCS_ITERS_INT_MAX)
+                ? FCS_ITERS_INT_MAX
+                : max((fcs_iters_int)budget, (fcs_iters_int)1));
+}
+
+// Backtrack to the initial state and reseed the scan's random number
+// generator. Only the states on the DFS stack lose their visited mark: every
+// other state that the scan visited was backtracked from, so all the states
+// that are reachable from it were visited as well, or are reachable from a
+// state on the stack.
+static inline void dfs_restart(fcs_soft_thread *const soft_thread)
+{
+    fcs_instance *const instance GCC_UNUSED =
+        HT_INSTANCE(soft_thread->hard_thread);
+    var_AUTO(soft_dfs_info, DFS_VAR(soft_thread, soft_dfs_info));
+    const_AUTO(depth, DFS_VAR(soft_thread, depth));
+    const_SLOT(id, soft_thread);
+    for (ssize_t i = 1; i <= depth; ++i)
+    {
+        unset_scan_visited(instance, soft_dfs_info[i].state, id);
+    }
+    DFS_VAR(soft_thread, depth) = 0;
+    soft_dfs_info->move_func_list_idx = 0;
+    soft_dfs_info->move_func_idx = 0;
+    soft_dfs_info->current_state_index = 0;
+    soft_dfs_info->derived_states_list.num_states = 0;
+    soft_dfs_info->positions_by_rank_is_valid = false;
+
+    fcs_dfs_restarts *const restarts = &(DFS_VAR(soft_thread, restarts));
+    ++restarts->num_restarts;
+    restarts->iters_left = dfs_restarts_calc_budget(restarts);
+    fc_solve_rand_init(&(DFS_VAR(soft_thread, rand_gen)),
+        DFS_VAR(soft_thread, rand_seed) +
+            (fcs_rand_gen)(restarts->num_restarts *
+                           FCS_DFS_RESTARTS_SEED_STRIDE));
+}
+
 // dfs_solve() is the event loop of the Random-DFS scan. DFS, which is
 // recursive in nature, is handled here without procedural recursion by using
 // some dedicated stacks for the traversal.
@@ -1194,7 +1496,8 @@ static inline fc_solve_solve_process_ret_t dfs_solve(
 #ifndef FCS_ZERO_FREECELLS_MODE
     fcs_rand_gen *const rand_gen = &(DFS_VAR(soft_thread, rand_gen));
 #endif
-    calculate_real_depth(calc_real_depth, PTR_STATE);
+    fcs_dfs_restarts *const restarts = &(DFS_VAR(soft_thread, restarts));
+    calculate_real_depth(instance, calc_real_depth, PTR_STATE);
 #ifndef FCS_ZERO_FREECELLS_MODE
     const_AUTO(
         by_depth_units, DFS_VAR(soft_thread, moves_by_depth).by_depth_units);
@@ -1220,16 +1523,26 @@ static inline fc_solve_solve_process_ret_t dfs_solve(
     const_SLOT(debug_iter_output_func, instance);
     const_SLOT(debug_iter_output_context, instance);
 #endif
+#ifndef FCS_WITHOUT_TRACE_RING
+    const_SLOT(trace_ring, instance);
+#endif
+#ifdef FCS_WITH_ENDGAME_TABLEBASE
+    const_AUTO(endgame_tablebase, fcs_instance_endgame_tablebase(instance));
+#endif
 
 #ifndef FCS_ZERO_FREECELLS_MODE
-    const moves_by_depth_unit *curr_by_depth_unit = by_depth_units;
-    for (; (DEPTH() >= get_depth(curr_by_depth_unit)); ++curr_by_depth_unit)
-    {
-    }
-    RECALC_BY_DEPTH_LIMITS();
+#define FIND_BY_DEPTH_UNIT()                                                   \
+    for (curr_by_depth_unit = by_depth_units;                                  \
+         (DEPTH() >= get_depth(curr_by_depth_unit)); ++curr_by_depth_unit)     \
+    {                                                                          \
+    }                                                                          \
+    RECALC_BY_DEPTH_LIMITS()
+
+    const moves_by_depth_unit *curr_by_depth_unit;
+    FIND_BY_DEPTH_UNIT();
 #endif
 
-    set_scan_visited(PTR_STATE, soft_thread_id);
+    set_scan_visited(instance, PTR_STATE, soft_thread_id);
     // The main loop. We exit out of it when DEPTH() is decremented below zero.
     while (1)
     {
@@ -1257,8 +1570,9 @@ static inline fc_solve_solve_process_ret_t dfs_solve(
                 // Backtrack to the previous depth.
                 if (is_a_complete_scan)
                 {
-                    FCS_S_VISITED(PTR_STATE) |= FCS_VISITED_ALL_TESTS_DONE;
-                    MARK_AS_DEAD_END(PTR_STATE);
+                    FCS_S_VISITED(instance, PTR_STATE) |=
+                        FCS_VISITED_ALL_TESTS_DONE;
+                    MARK_AS_DEAD_END(instance, PTR_STATE);
                 }
 
                 // Set it now in case DEPTH() == 0 and we break
@@ -1305,14 +1619,33 @@ static inline fc_solve_solve_process_ret_t dfs_solve(
 #ifdef FCS_WITHOUT_VISITED_ITER
                         0
 #else
-                        ((DEPTH() == 0) ? 0
-                                        : (fcs_int_limit_t)FCS_S_VISITED_ITER(
-                                              DFS_VAR(soft_thread,
-                                                  soft_dfs_info)[DEPTH() - 1]
-                                                  .state))
+                        ((DEPTH() == 0)
+                                ? 0
+                                : (fcs_int_limit_t)FCS_S_VISITED_ITER(instance,
+                                      DFS_VAR(soft_thread,
+                                          soft_dfs_info)[DEPTH() - 1]
+                                          .state))
 #endif
                     );
                 }
+#endif
+#ifndef FCS_WITHOUT_TRACE_RING
+                if (trace_ring)
+                {
+                    fc_solve_trace_ring_sample(trace_ring,
+                        *(instance_num_checked_states_ptr), (int)DEPTH(),
+#ifdef FCS_WITHOUT_VISITED_ITER
+                        0,
+#else
+                        ((DEPTH() == 0)
+                                ? 0
+                                : FCS_S_VISITED_ITER(instance,
+                                      DFS_VAR(soft_thread,
+                                          soft_dfs_info)[DEPTH() - 1]
+                                          .state)),
+#endif
+                        PTR_STATE, (int)soft_thread_id);
+                }
 #endif
                 if (!was_pruned(enable_pruning, PTR_STATE, soft_thread,
                         the_soft_dfs_info, &pass, derived_list,
@@ -1333,12 +1666,55 @@ static inline fc_solve_solve_process_ret_t dfs_solve(
                         TRACE0("Returning FCS_STATE_WAS_SOLVED");
                         return FCS_STATE_WAS_SOLVED;
                     }
+#ifdef FCS_WITH_ENDGAME_TABLEBASE
+                    if (endgame_tablebase)
+                    {
+                        const int distance = fc_solve_etb_probe(
+                            endgame_tablebase, &FCS_SCANS_the_state);
+                        if (distance > 0)
+                        {
+                            // The rest of the solution is read from the
+                            // tablebase by fc_solve_trace_solution().
+                            FCS_SET_final_state();
+                            BUMP_NUM_CHECKED_STATES();
+                            return FCS_STATE_WAS_SOLVED;
+                        }
+                        if (distance == FCS_ETB_LOSS)
+                        {
+                            // Skip all the moves and backtrack.
+                            the_soft_dfs_info->move_func_list_idx =
+                                the_moves_list.num;
+                            continue;
+                        }
+                    }
+#endif
                     // Cache num_vacant_freecells and num_vacant_stacks.
                     soft_thread->num_vacant_freecells = num_vacant_freecells;
                     soft_thread->num_vacant_stacks = num_vacant_stacks;
-                    fc_solve__calc_positions_by_rank_data(soft_thread,
-                        &FCS_SCANS_the_state,
-                        (the_soft_dfs_info->positions_by_rank));
+#ifndef FCS_RCS_STATES
+                    if ((DEPTH() > 0) &&
+                        the_soft_dfs_info[-1].positions_by_rank_is_valid)
+                    {
+                        fc_solve__derive_positions_by_rank_data(soft_thread,
+                            &(the_soft_dfs_info[-1].state->s),
+                            the_soft_dfs_info[-1].positions_by_rank,
+                            &FCS_SCANS_the_state,
+                            (the_soft_dfs_info->positions_by_rank)
+                                PASS_COLS_SEQ_BREAKS(
+                                    the_soft_dfs_info[-1].cols_seq_breaks)
+                                    PASS_COLS_SEQ_BREAKS(
+                                        the_soft_dfs_info->cols_seq_breaks));
+                    }
+                    else
+#endif
+                    {
+                        fc_solve__calc_positions_by_rank_data(soft_thread,
+                            &FCS_SCANS_the_state,
+                            (the_soft_dfs_info->positions_by_rank)
+                                PASS_COLS_SEQ_BREAKS(
+                                    the_soft_dfs_info->cols_seq_breaks));
+                    }
+                    the_soft_dfs_info->positions_by_rank_is_valid = true;
                 }
             }
 
@@ -1394,14 +1770,16 @@ static inline fc_solve_solve_process_ret_t dfs_solve(
 
             VERIFY_PTR_STATE_AND_DERIVED_TRACE0("Verify [Before BUMP]");
 
-            if ((!fcs__is_state_a_dead_end(single_derived_state)) &&
-                (!is_scan_visited(single_derived_state, soft_thread_id)))
+            if ((!fcs__is_state_a_dead_end(instance, single_derived_state)) &&
+                (!is_scan_visited(
+                    instance, single_derived_state, soft_thread_id)))
             {
                 BUMP_NUM_CHECKED_STATES();
                 VERIFY_PTR_STATE_AND_DERIVED_TRACE0("Verify [After BUMP]");
-                set_scan_visited(single_derived_state, soft_thread_id);
+                set_scan_visited(
+                    instance, single_derived_state, soft_thread_id);
 #ifndef FCS_WITHOUT_VISITED_ITER
-                FCS_S_VISITED_ITER(single_derived_state) =
+                FCS_S_VISITED_ITER(instance, single_derived_state) =
                     instance->i__stats.num_checked_states;
 #endif
                 VERIFY_PTR_STATE_AND_DERIVED_TRACE0("Verify [aft set_visit]");
@@ -1425,10 +1803,24 @@ static inline fc_solve_solve_process_ret_t dfs_solve(
                 the_soft_dfs_info->move_func_list_idx = 0;
                 the_soft_dfs_info->move_func_idx = 0;
                 the_soft_dfs_info->current_state_index = 0;
+                the_soft_dfs_info->positions_by_rank_is_valid = false;
                 derived_list = &the_soft_dfs_info->derived_states_list;
                 derived_list->num_states = 0;
 
-                calculate_real_depth(calc_real_depth, PTR_STATE);
+                calculate_real_depth(instance, calc_real_depth, PTR_STATE);
+
+                if (unlikely((restarts->policy != FCS_DFS_RESTARTS_NONE) &&
+                             (--restarts->iters_left == 0)))
+                {
+                    dfs_restart(soft_thread);
+                    the_soft_dfs_info = DFS_VAR(soft_thread, soft_dfs_info);
+                    derived_list = &the_soft_dfs_info->derived_states_list;
+                    PTR_STATE = the_soft_dfs_info->state;
+                    FCS_ASSIGN_STATE_KEY();
+#ifndef FCS_ZERO_FREECELLS_MODE
+                    FIND_BY_DEPTH_UNIT();
+#endif
+                }
 
 #ifndef FCS_DISABLE_NUM_STORED_STATES
 #ifndef FCS_WITHOUT_TRIM_MAX_STORED_STATES
@@ -1467,8 +1859,12 @@ static inline void init_dfs(fcs_soft_thread *const soft_thread)
     increase_dfs_max_depth(soft_thread);
     DFS_VAR(soft_thread, soft_dfs_info)
     [0].state = FCS_STATE_keyval_pair_to_collectible(&instance->state_copy);
+    DFS_VAR(soft_thread, soft_dfs_info)[0].positions_by_rank_is_valid = false;
     fc_solve_rand_init(
         &(DFS_VAR(soft_thread, rand_gen)), DFS_VAR(soft_thread, rand_seed));
+    fcs_dfs_restarts *const restarts = &(DFS_VAR(soft_thread, restarts));
+    restarts->num_restarts = 0;
+    restarts->iters_left = dfs_restarts_calc_budget(restarts);
 
 #ifndef FCS_ZERO_FREECELLS_MODE
 
@@ -1506,8 +1902,8 @@ static inline void init_dfs(fcs_soft_thread *const soft_thread)
             {
                 size_t num = 0;
                 fcs_move_func *tests_list = NULL;
-                add_to_move_funcs_list(&tests_list, &num,
-                    tests_order_groups[group_idx].move_funcs,
+                add_to_move_funcs_list(INSTANCE_MOVE_FUNCS(instance),
+                    &tests_list, &num, tests_order_groups[group_idx].move_funcs,
                     tests_order_groups[group_idx].num);
                 const_AUTO(tests_list_struct_ptr,
                     &(moves_list_of_lists->groups[moves_list_of_lists->num++]));
@@ -1638,7 +2034,8 @@ static inline fc_solve_solve_process_ret_t solve(
     ((ret == FCS_STATE_SUSPEND_PROCESS) &&                                     \
         ((instance->i__stats.num_checked_states >=                             \
             instance->effective_max_num_checked_states)                        \
-                instance_check_exceeded__num_states(instance)))
+                instance_check_exceeded__num_states(instance) ||               \
+            fcs_instance_is_stop_requested(instance)))
 #endif
 
 static inline fc_solve_solve_process_ret_t run_hard_thread(
@@ -1929,6 +2326,10 @@ typedef struct
     fcs_int_limit_t current_iterations_limit;
     fcs_iters_int effective_current_iterations_limit;
     fcs_int_limit_t current_soft_iterations_limit;
+    fcs_stop_request stop_request;
+#endif
+#ifndef FCS_WITHOUT_TRACE_RING
+    fcs_trace_ring trace_ring;
 #endif
     fcs_stats iterations_board_started_at;
     // The number of iterations that the current instance started solving from.
@@ -1981,6 +2382,10 @@ typedef struct
 #ifndef FCS_USE_PRECOMPILED_CMD_LINE_THEME
     char *unrecognized_cmd_line_options[1];
 #endif
+#ifdef FCS_WITH_ENDGAME_TABLEBASE
+    // Shared by all the instances, which only read it.
+    fcs_endgame_tablebase endgame_tablebase;
+#endif
 } fcs_user;
 
 static inline fcs_instance *user_obj(fcs_user *const user)
@@ -2187,6 +2592,17 @@ static FLARE_INLINE void user_next_flare(fcs_user *const user)
                                             : NULL);
     instance->debug_iter_output_context = user;
 #endif
+#ifdef FCS_WITH_ENDGAME_TABLEBASE
+    instance->endgame_tablebase =
+        (user->endgame_tablebase.map ? &(user->endgame_tablebase) : NULL);
+#endif
+#ifndef FCS_WITHOUT_MAX_NUM_STATES
+    instance->stop_request = &(user->stop_request);
+#endif
+#ifndef FCS_WITHOUT_TRACE_RING
+    instance->trace_ring =
+        (user->trace_ring.records ? &(user->trace_ring) : NULL);
+#endif
 
 #ifdef FCS_WITH_MOVES
     flare->moves_seq.num_moves = 0;
@@ -2267,6 +2683,9 @@ static MYINLINE void user_initialize(fcs_user *const user)
 #endif
 
     fc_solve_meta_compact_allocator_init(&(user->meta_alloc));
+#ifdef FCS_WITH_ENDGAME_TABLEBASE
+    user->endgame_tablebase.map = NULL;
+#endif
 
     user->instances_list = NULL;
     user->end_of_instances_list = NULL;
@@ -2280,6 +2699,10 @@ static MYINLINE void user_initialize(fcs_user *const user)
     user->current_iterations_limit = -1;
     user->effective_current_iterations_limit = FCS_ITERS_INT_MAX;
     user->current_soft_iterations_limit = -1;
+    fc_solve_stop_request_init(&(user->stop_request));
+#endif
+#ifndef FCS_WITHOUT_TRACE_RING
+    fc_solve_trace_ring_init(&(user->trace_ring));
 #endif
 
     user->iterations_board_started_at = initial_stats;
@@ -2364,6 +2787,108 @@ void DLLEXPORT freecell_solver_user_soft_limit_iterations_long(
     ((fcs_user *const)api_instance)->current_soft_iterations_limit = max_iters;
 }
 
+void DLLEXPORT freecell_solver_user_set_deadline(
+    void *const api_instance GCC_UNUSED, const long long deadline_ns GCC_UNUSED)
+{
+#ifndef FCS_WITHOUT_MAX_NUM_STATES
+    ((fcs_user *const)api_instance)->stop_request.deadline =
+        ((deadline_ns > 0) ? (int64_t)deadline_ns : 0);
+#endif
+}
+
+void DLLEXPORT freecell_solver_user_request_cancel(
+    void *const api_instance GCC_UNUSED)
+{
+#ifndef FCS_WITHOUT_MAX_NUM_STATES
+    fc_solve_stop_request_set_cancel(
+        &(((fcs_user *const)api_instance)->stop_request), true);
+#endif
+}
+
+void DLLEXPORT freecell_solver_user_set_trace_ring_size(
+    void *const api_instance GCC_UNUSED,
+    const fcs_int_limit_t num_records GCC_UNUSED)
+{
+#ifndef FCS_WITHOUT_TRACE_RING
+    fcs_user *const user = (fcs_user *)api_instance;
+    fc_solve_trace_ring_resize(
+        &(user->trace_ring), (size_t)max(num_records, 0));
+    fcs_trace_ring *const trace_ring =
+        (user->trace_ring.records ? &(user->trace_ring) : NULL);
+    FLARES_LOOP_START()
+    flare->obj.trace_ring = trace_ring;
+    INSTANCE_ITEM_FLARES_LOOP_END()
+    INSTANCES_LOOP_END()
+#endif
+}
+
+void DLLEXPORT freecell_solver_user_set_trace_sample_step(
+    void *const api_instance GCC_UNUSED,
+    const fcs_int_limit_t sample_step GCC_UNUSED)
+{
+#ifndef FCS_WITHOUT_TRACE_RING
+    fc_solve_trace_ring_set_sample_step(
+        &(((fcs_user *const)api_instance)->trace_ring),
+        (fcs_iters_int)max(sample_step, 1));
+#endif
+}
+
+size_t DLLEXPORT freecell_solver_user_read_trace(
+    void *const api_instance GCC_UNUSED,
+    fcs_trace_record *const records GCC_UNUSED,
+    const size_t max_num_records GCC_UNUSED,
+    unsigned long long *const cursor GCC_UNUSED)
+{
+#ifdef FCS_WITHOUT_TRACE_RING
+    return 0;
+#else
+    return fc_solve_trace_ring_read(
+        &(((fcs_user *const)api_instance)->trace_ring), records,
+        max_num_records, cursor);
+#endif
+}
+
+void DLLEXPORT *freecell_solver_memory_budget_alloc(const size_t cap)
+{
+    fcs_memory_budget *budget = SMALLOC1(budget);
+    fc_solve_memory_budget_init(budget, cap);
+    return budget;
+}
+
+void DLLEXPORT freecell_solver_memory_budget_free(void *const budget)
+{
+    free(budget);
+}
+
+size_t DLLEXPORT freecell_solver_memory_budget_get_usage(
+    const void *const budget)
+{
+    return fc_solve_memory_budget_get_usage(
+        (const fcs_memory_budget *)budget);
+}
+
+void DLLEXPORT freecell_solver_user_set_memory_budget(
+    void *const api_instance GCC_UNUSED, void *const budget GCC_UNUSED)
+{
+#ifndef FCS_WITHOUT_MEMORY_BUDGET
+    fc_solve_memory_budget_register(
+        &(((fcs_user *const)api_instance)->meta_alloc),
+        (fcs_memory_budget *)budget);
+#endif
+}
+
+size_t DLLEXPORT freecell_solver_user_get_memory_usage(
+    void *const api_instance GCC_UNUSED)
+{
+#ifdef FCS_WITHOUT_MEMORY_BUDGET
+    return 0;
+#else
+    return __atomic_load_n(
+        &(((fcs_user *const)api_instance)->meta_alloc.num_bytes),
+        __ATOMIC_RELAXED);
+#endif
+}
+
 #ifndef FCS_BREAK_BACKWARD_COMPAT_1
 void DLLEXPORT freecell_solver_user_limit_iterations(
     void *const api_instance, const int max_iters)
@@ -2835,19 +3360,59 @@ static inline void calc_moves_seq(const fcs_move_stack *const solution_moves,
 #endif
 
 #ifdef FCS_WITH_MOVES
-static void trace_flare_solution(fcs_user *const user, flare_item *const flare)
+#ifdef FCS_WITH_LOCAL_OPTIMIZER
+// Shortens the normalized solution of the instance with the local optimizer,
+// starting from the initial position in the user's order of the columns and
+// freecells.
+static void local_optimize_solution(
+    fcs_user *const user, fcs_instance *const instance)
 {
-    if (flare->was_solution_traced)
+    fcs_plain_rules rules;
+    if ((!instance->local_opt.window) ||
+        (!fcs_instance_plain_rules(instance, &rules)))
     {
         return;
     }
+    fcs_plain_position canonized, init_pos;
+    fc_solve_plain_position_from_state(&rules, &(user->state.s), &canonized);
+    init_pos = canonized;
+    for (size_t i = 0; i < rules.num_columns; ++i)
+    {
+        const size_t loc = (size_t)user->state_locs.stack_locs[i];
+        init_pos.cols_lens[loc] = canonized.cols_lens[i];
+        memcpy(init_pos.cols[loc], canonized.cols[i], canonized.cols_lens[i]);
+    }
+    for (size_t i = 0; i < rules.num_freecells; ++i)
+    {
+        init_pos.freecells[(size_t)user->state_locs.fc_locs[i]] =
+            canonized.freecells[i];
+    }
+    fc_solve_local_optimize(&rules, &init_pos, &(instance->solution_moves),
+        &(instance->local_opt));
+}
+#endif
+
+// Returns false if the moves to the solution could not be recovered.
+static bool trace_flare_solution(fcs_user *const user, flare_item *const flare)
+{
+    if (flare->was_solution_traced)
+    {
+        return true;
+    }
 
     fcs_instance *const instance = &(flare->obj);
-    fc_solve_trace_solution(instance);
+    if (unlikely(!fc_solve_trace_solution(instance)))
+    {
+        instance_free_solution_moves(instance);
+        return false;
+    }
     flare->trace_solution_state_locs = user->state_locs;
     fc_solve_move_stack_normalize(&(instance->solution_moves), &(user->state),
         &(flare->trace_solution_state_locs)PASS_FREECELLS(
             INSTANCE_FREECELLS_NUM) PASS_STACKS(INSTANCE_STACKS_NUM));
+#ifdef FCS_WITH_LOCAL_OPTIMIZER
+    local_optimize_solution(user, instance);
+#endif
 
     calc_moves_seq(&(instance->solution_moves), &(flare->moves_seq));
     instance_free_solution_moves(instance);
@@ -2855,6 +3420,7 @@ static void trace_flare_solution(fcs_user *const user, flare_item *const flare)
     flare->obj_stats = instance->i__stats;
     recycle_flare(flare);
     flare->was_solution_traced = true;
+    return true;
 }
 #endif
 
@@ -2908,6 +3474,12 @@ static inline fc_solve_solve_process_ret_t eval_resume_ret_code(
 #ifndef FCS_WITHOUT_MAX_NUM_STATES
     if (ret == FCS_STATE_SUSPEND_PROCESS)
     {
+        // A cancellation only suspends the solving once.
+        if (fc_solve_is_stop_requested(&(user->stop_request)))
+        {
+            fc_solve_stop_request_set_cancel(&(user->stop_request), false);
+            return FCS_STATE_SUSPEND_PROCESS;
+        }
         if (process_ret && (user->effective_current_iterations_limit >
                                get_num_times_long(user)))
         {
@@ -3211,11 +3783,26 @@ static inline fc_solve_solve_process_ret_t resume_solution(fcs_user *const user)
 #endif
         );
 
+#if defined(FCS_WITH_MOVES)
         if (ret == FCS_STATE_WAS_SOLVED)
         {
-#if defined(FCS_WITH_MOVES)
             flare->was_solution_traced = false;
+            // The solution is traced right away, so a flare whose moves
+            // cannot be recovered (e.g. due to an inconsistent endgame
+            // tablebase) fails with an error, instead of yielding a
+            // truncated solution.
+            if (unlikely(!trace_flare_solution(user, flare)))
+            {
+                SET_ERROR("The moves to the solution could not be traced.");
+                ret = FCS_STATE_IS_NOT_SOLVEABLE;
+#ifndef FCS_WITHOUT_MAX_NUM_STATES
+                SET_flare_ret(flare, ret);
+#endif
+            }
+        }
 #endif
+        if (ret == FCS_STATE_WAS_SOLVED)
+        {
 #ifdef FCS_WITH_FLARES
             if ((!(instance_item->minimal_flare)) ||
                 (get_flare_move_count(user, instance_item->minimal_flare) >
@@ -3259,7 +3846,7 @@ static inline fc_solve_solve_process_ret_t resume_solution(fcs_user *const user)
                 || (instance->i__stats.num_states_in_collection >=
                        instance->effective_max_num_states_in_collection)
 #endif
-            )
+                || fc_solve_is_stop_requested(&(user->stop_request)))
             {
 // Bug fix:
 // We need to resume from the last flare in case we exceed
@@ -3445,6 +4032,12 @@ static MYINLINE void user_free_resources(fcs_user *const user)
 #if (FCS_STATE_STORAGE == FCS_STATE_STORAGE_INTERNAL_HASH)
         fc_solve_hash_free(&(instance->hash));
 #endif
+#ifdef FCS_WITH_STATE_SIDE_TABLES
+        fc_solve_state_side_tables_free(&(instance->state_side_tables));
+#endif
+#ifdef FCS_WITH_DEAD_ENDS_RECYCLING
+        fc_solve_dead_end_fingerprints_free(&(instance->dead_end_fingerprints));
+#endif
 #ifdef INDIRECT_STACK_STATES
 #if (FCS_STACK_STORAGE == FCS_STACK_STORAGE_INTERNAL_HASH)
         fc_solve_hash_free(&(instance->stacks_hash));
@@ -3482,12 +4075,21 @@ static MYINLINE void user_free_resources(fcs_user *const user)
 
     free(user->instances_list);
     fc_solve_meta_compact_allocator_finish(&(user->meta_alloc));
+#ifndef FCS_WITHOUT_MEMORY_BUDGET
+    fc_solve_memory_budget_unregister(&(user->meta_alloc));
+#endif
 #ifndef FCS_USE_PRECOMPILED_CMD_LINE_THEME
     for (size_t i = 0; i < COUNT(user->unrecognized_cmd_line_options); ++i)
     {
         free(user->unrecognized_cmd_line_options[i]);
     }
 #endif
+#ifdef FCS_WITH_ENDGAME_TABLEBASE
+    fc_solve_etb_unload(&(user->endgame_tablebase));
+#endif
+#ifndef FCS_WITHOUT_TRACE_RING
+    fc_solve_trace_ring_free(&(user->trace_ring));
+#endif
 }
 
 void DLLEXPORT freecell_solver_user_free(void *const api_instance)
@@ -3851,7 +4453,48 @@ void DLLEXPORT freecell_solver_user_set_solution_optimization(
     STRUCT_SET_FLAG_TO(
         active_obj(api_instance), FCS_RUNTIME_OPTIMIZE_SOLUTION_PATH, optimize);
 }
+#endif
 
+DLLEXPORT extern int freecell_solver_user_set_local_opt_window(
+    void *const api_instance GCC_UNUSED, const int window)
+{
+    if (window < 0)
+    {
+        return 1;
+    }
+#ifdef FCS_WITH_LOCAL_OPTIMIZER
+    active_obj(api_instance)->local_opt.window = (size_t)window;
+#endif
+    return 0;
+}
+
+DLLEXPORT extern int freecell_solver_user_set_local_opt_max_iters(
+    void *const api_instance GCC_UNUSED, const fcs_int_limit_t max_iters)
+{
+    if (max_iters < 1)
+    {
+        return 1;
+    }
+#ifdef FCS_WITH_LOCAL_OPTIMIZER
+    active_obj(api_instance)->local_opt.max_iters = (fcs_iters_int)max_iters;
+#endif
+    return 0;
+}
+
+DLLEXPORT extern int freecell_solver_user_set_local_opt_threads(
+    void *const api_instance GCC_UNUSED, const int num_threads)
+{
+    if (num_threads < 1)
+    {
+        return 1;
+    }
+#ifdef FCS_WITH_LOCAL_OPTIMIZER
+    active_obj(api_instance)->local_opt.num_threads = (size_t)num_threads;
+#endif
+    return 0;
+}
+
+#ifdef FCS_WITH_MOVES
 DLLEXPORT extern void freecell_solver_user_stringify_move_w_state(
     void *const api_instance, char *const output_string, const fcs_move_t move,
     const int standard_notation)
@@ -4195,6 +4838,97 @@ void DLLEXPORT freecell_solver_user_set_random_seed(
     DFS_VAR(api_soft_thread(api_instance), rand_seed) = seed;
 }
 
+int DLLEXPORT freecell_solver_user_set_dfs_restarts(void *const api_instance,
+    const int policy, const fcs_int_limit_t unit, const double factor)
+{
+    switch (policy)
+    {
+    case FCS_DFS_RESTARTS_NONE:
+        break;
+
+    case FCS_DFS_RESTARTS_LUBY:
+    case FCS_DFS_RESTARTS_GEOMETRIC:
+        if ((unit <= 0) || (!(factor >= 1)))
+        {
+            return 1;
+        }
+        break;
+
+    default:
+        return 1;
+    }
+
+    fcs_dfs_restarts *const restarts =
+        &DFS_VAR(api_soft_thread(api_instance), restarts);
+    restarts->policy = policy;
+    restarts->unit = (fcs_iters_int)max(unit, 0);
+    restarts->factor = factor;
+
+    return 0;
+}
+
+// Clones the current Soft-DFS scan so there will be num_seeds scans which
+// differ only in their random seeds. The scans are run interleaved by the
+// instance, and share the states' collection and the dead-end marks.
+int DLLEXPORT freecell_solver_user_set_seeds_portfolio(
+    void *const api_instance, const int num_seeds)
+{
+    fcs_user *const user = (fcs_user *)api_instance;
+    fcs_hard_thread *const hard_thread = user->soft_thread->hard_thread;
+    const size_t src_idx =
+        (size_t)(user->soft_thread - HT_FIELD(hard_thread, soft_threads));
+
+    if ((num_seeds < 1) ||
+        (user->soft_thread->super_method_type != FCS_SUPER_METHOD_DFS))
+    {
+        return 1;
+    }
+
+    for (int i = 1; i < num_seeds; ++i)
+    {
+        fcs_soft_thread *const clone = fc_solve_new_soft_thread(hard_thread);
+        if (clone == NULL)
+        {
+            return 1;
+        }
+        // fc_solve_new_soft_thread() may have moved the soft threads array.
+        fcs_soft_thread *const src =
+            &(HT_FIELD(hard_thread, soft_threads)[src_idx]);
+
+        clone->super_method_type = src->super_method_type;
+        clone->master_to_randomize = src->master_to_randomize;
+        clone->checked_states_step = src->checked_states_step;
+#ifndef FCS_ENABLE_PRUNE__R_TF__UNCOND
+        clone->enable_pruning = src->enable_pruning;
+#endif
+        DFS_VAR(clone, rand_seed) = DFS_VAR(src, rand_seed) + i;
+        DFS_VAR(clone, restarts) = DFS_VAR(src, restarts);
+#ifndef FCS_ZERO_FREECELLS_MODE
+        fc_solve_free_soft_thread_by_depth_move_array(clone);
+        const_AUTO(num, src->by_depth_moves_order.num);
+        const_AUTO(by_depth_moves,
+            SMALLOC(clone->by_depth_moves_order.by_depth_moves, num));
+        clone->by_depth_moves_order.by_depth_moves = by_depth_moves;
+        for (size_t depth_idx = 0; depth_idx < num; ++depth_idx)
+        {
+            by_depth_moves[depth_idx] =
+                (typeof(by_depth_moves[depth_idx])){
+                    .max_depth = src->by_depth_moves_order
+                                     .by_depth_moves[depth_idx]
+                                     .max_depth,
+                    .moves_order = moves_order_dup(
+                        &(src->by_depth_moves_order.by_depth_moves[depth_idx]
+                                .moves_order)),
+                };
+        }
+        clone->by_depth_moves_order.num = num;
+#endif
+        user->soft_thread = clone;
+    }
+
+    return 0;
+}
+
 #ifndef FCS_DISABLE_NUM_STORED_STATES
 fcs_int_limit_t DLLEXPORT __attribute__((pure))
 freecell_solver_user_get_num_states_in_collection_long(void *api_instance)
@@ -4221,8 +4955,10 @@ void DLLEXPORT freecell_solver_user_limit_num_states_in_collection_long(
     void *api_instance, fcs_int_limit_t max_num_states)
 {
     active_obj(api_instance)->effective_max_num_states_in_collection =
-        ((max_num_states < 0) ? FCS_ITERS_INT_MAX
-                              : (fcs_iters_int)max_num_states);
+        (((max_num_states < 0) ||
+             ((fcs_iters_int)max_num_states > MAX_NUM_STATES_IN_COLLECTION))
+                ? MAX_NUM_STATES_IN_COLLECTION
+                : (fcs_iters_int)max_num_states);
 }
 
 #ifndef FCS_BREAK_BACKWARD_COMPAT_1
@@ -4242,9 +4978,42 @@ DLLEXPORT extern void freecell_solver_set_stored_states_trimming_limit(
         ((max_num_states < 0) ? FCS_ITERS_INT_MAX
                               : (fcs_iters_int)max_num_states);
 }
+
+DLLEXPORT extern void freecell_solver_set_dead_ends_recycling(
+    void *const api_instance GCC_UNUSED, const long from_num_states GCC_UNUSED)
+{
+#ifdef FCS_WITH_DEAD_ENDS_RECYCLING
+    fcs_instance *const instance = active_obj(api_instance);
+    instance->effective_trim_states_in_collection_from =
+        instance->recycle_dead_ends_from =
+            ((from_num_states < 0) ? FCS_ITERS_INT_MAX
+                                   : (fcs_iters_int)from_num_states);
+#endif
+}
 #endif
 #endif
 
+DLLEXPORT extern int freecell_solver_user_set_endgame_tablebase(
+    void *const api_instance GCC_UNUSED, const char *const filename)
+{
+#ifdef FCS_WITH_ENDGAME_TABLEBASE
+    fcs_user *const user = (fcs_user *)api_instance;
+    fc_solve_etb_unload(&(user->endgame_tablebase));
+    const bool is_loaded =
+        (filename && fc_solve_etb_load(&(user->endgame_tablebase), filename));
+
+    FLARES_LOOP_START()
+    flare->obj.endgame_tablebase =
+        (is_loaded ? &(user->endgame_tablebase) : NULL);
+    INSTANCE_ITEM_FLARES_LOOP_END()
+    INSTANCES_LOOP_END()
+
+    return ((filename && !is_loaded) ? 1 : 0);
+#else
+    return (filename ? 1 : 0);
+#endif
+}
+
 int DLLEXPORT freecell_solver_user_next_soft_thread(void *const api_instance)
 {
     fcs_user *const user = (fcs_user *const)api_instance;
@@ -4361,6 +5130,14 @@ void DLLEXPORT freecell_solver_user_recycle(void *api_instance)
     user__recycle_instance_item(user, instance_item);
     INSTANCES_LOOP_END()
     user->iterations_board_started_at = initial_stats;
+#ifndef FCS_WITHOUT_MEMORY_BUDGET
+    // Return the recycled buffers to the system, so the other members of the
+    // budget may use them.
+    if (user->meta_alloc.budget)
+    {
+        fc_solve_meta_compact_allocator_finish(&(user->meta_alloc));
+    }
+#endif
 }
 
 #ifdef FCS_WITH_MOVES
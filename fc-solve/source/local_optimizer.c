@@ -0,0 +1,475 @@
+// This file is part of Freecell Solver. It is subject to the license terms in
+// the COPYING.txt file found in the top-level directory of this distribution
+// and at http://fc-solve.shlomifish.org/docs/distro/COPYING.html . No part of
+// Freecell Solver, including this file, may be copied, modified, propagated,
+// or distributed except according to the terms contained in the COPYING file.
+//
+// Copyright (c) 2026 Shlomi Fish
+// local_optimizer.c - the windowed local optimizer of the solutions.
+//
+// Each window starts at a position of the solution and covers the positions
+// of its next moves. A breadth-first search from its first position looks
+// for the position of the window that is the furthest along the solution
+// and can be reached in fewer moves, up to a budget of collected positions.
+// The positions are compared as they are (and not canonized), so the rest of
+// the solution can still be played after the shortcut is spliced in. The
+// moves cannot be taken back, and there is no admissible estimate of the
+// number of moves between two positions, so neither an A* search nor a
+// backward one from the end of the window pays off.
+#include "instance.h"
+#include "wrap_xxhash.h"
+
+#ifdef FCS_WITH_LOCAL_OPTIMIZER
+#ifdef FCS_HAVE_PTHREADS
+#include <pthread.h>
+#endif
+
+// The freecells, and then the length of every column followed by its cards.
+#define LOPT_KEY_LEN (MAX_NUM_FREECELLS + MAX_NUM_STACKS + FCS_NUM_SUITS * 13)
+
+typedef struct
+{
+    uint8_t s[LOPT_KEY_LEN];
+} lopt_key;
+
+typedef struct
+{
+    lopt_key key;
+    uint32_t parent;
+    uint32_t depth;
+    fcs_plain_move move;
+} lopt_node;
+
+// The shortcut that was found for a window.
+typedef struct
+{
+    // Identifies the positions of the window.
+    uint64_t signature;
+    bool to_search;
+    size_t end;
+    size_t num_moves;
+    fcs_plain_move *moves;
+} lopt_shortcut;
+
+// The signatures of the windows that had no shortcut. The search is
+// deterministic, so they are not searched again in the next passes.
+typedef struct
+{
+    uint64_t *signatures;
+    size_t num;
+} lopt_fruitless;
+
+#define LOPT_FRUITLESS_GROW_BY 64
+
+typedef struct
+{
+    const fcs_plain_rules *rules;
+    const fcs_local_opt_params *params;
+    // The positions of the solution.
+    const lopt_key *keys;
+    const uint32_t *hashes;
+    size_t num_moves;
+    size_t step;
+    size_t num_windows;
+    size_t num_threads;
+    size_t thread_idx;
+    lopt_shortcut *shortcuts;
+} lopt_worker;
+
+static inline void lopt_encode(const fcs_plain_rules *const rules,
+    const fcs_plain_position *const pos, lopt_key *const key)
+{
+    memset(key, '\0', sizeof(*key));
+    uint8_t *p = key->s;
+    for (size_t i = 0; i < rules->num_freecells; ++i)
+    {
+        *(p++) = pos->freecells[i];
+    }
+    for (size_t i = 0; i < rules->num_columns; ++i)
+    {
+        const size_t col_len = pos->cols_lens[i];
+        *(p++) = (uint8_t)col_len;
+        memcpy(p, pos->cols[i], col_len);
+        p += col_len;
+    }
+}
+
+// The foundations are not kept in the key: every card that is not in the
+// position is in the foundations.
+static inline void lopt_decode(const fcs_plain_rules *const rules,
+    const lopt_key *const key, fcs_plain_position *const pos)
+{
+    uint8_t lowest[FCS_NUM_SUITS] = {14, 14, 14, 14};
+#define NOTE_CARD(card)                                                        \
+    if (fcs_card_is_valid(card) &&                                             \
+        (fcs_card_rank(card) < lowest[fcs_card_suit(card)]))                   \
+    {                                                                          \
+        lowest[fcs_card_suit(card)] = (uint8_t)fcs_card_rank(card);            \
+    }
+    const uint8_t *p = key->s;
+    for (size_t i = 0; i < rules->num_freecells; ++i)
+    {
+        const fcs_card card = *(p++);
+        pos->freecells[i] = card;
+        NOTE_CARD(card);
+    }
+    for (size_t i = 0; i < rules->num_columns; ++i)
+    {
+        const size_t col_len = *(p++);
+        pos->cols_lens[i] = (uint8_t)col_len;
+        for (size_t c = 0; c < col_len; ++c)
+        {
+            const fcs_card card = pos->cols[i][c] = *(p++);
+            NOTE_CARD(card);
+        }
+    }
+#undef NOTE_CARD
+    for (size_t suit = 0; suit < FCS_NUM_SUITS; ++suit)
+    {
+        pos->foundations[suit] = (uint8_t)(lowest[suit] - 1);
+    }
+}
+
+static inline uint32_t lopt_hash(const lopt_key *const key)
+{
+    return (uint32_t)DO_XXH(key, sizeof(*key));
+}
+
+// Searches for the shortcut of the window that starts at the start position.
+static void lopt_search_window(const lopt_worker *const w,
+    const size_t start, lopt_node *const nodes, uint32_t *const table,
+    const size_t table_mask, lopt_shortcut *const shortcut)
+{
+    const fcs_plain_rules *const rules = w->rules;
+    const size_t end = min(start + w->params->window, w->num_moves);
+    const size_t max_num_nodes = (size_t)w->params->max_iters + 1;
+    size_t best_gain = 0;
+    size_t best_node = 0;
+
+    memset(table, 0xFF, sizeof(table[0]) * (table_mask + 1));
+    nodes[0].key = w->keys[start];
+    nodes[0].depth = 0;
+    table[w->hashes[start] & table_mask] = 0;
+    size_t num_nodes = 1;
+    fcs_plain_move moves[FCS_PLAIN_MAX_NUM_MOVES];
+    fcs_plain_position pos;
+
+    for (size_t idx = 0; (idx < num_nodes) && (num_nodes < max_num_nodes);
+         ++idx)
+    {
+        const size_t depth = nodes[idx].depth;
+        // A position that is deeper cannot reach a position of the window
+        // with a larger gain.
+        if (best_gain + depth + 1 >= end - start)
+        {
+            break;
+        }
+        lopt_decode(rules, &(nodes[idx].key), &pos);
+        const size_t num_moves = fc_solve_plain_gen_moves(rules, &pos, moves);
+        // Playing a move only changes the lengths of the columns, the
+        // freecells and the foundations, so the position is restored from
+        // them instead of being copied for every move.
+        uint8_t cols_lens[MAX_NUM_STACKS];
+        fcs_card freecells[MAX_NUM_FREECELLS];
+        uint8_t foundations[FCS_NUM_SUITS];
+        memcpy(cols_lens, pos.cols_lens, sizeof(cols_lens));
+        memcpy(freecells, pos.freecells, sizeof(freecells));
+        memcpy(foundations, pos.foundations, sizeof(foundations));
+        for (size_t m = 0; m < num_moves; ++m)
+        {
+            fc_solve_plain_apply_move(&pos, moves[m]);
+            lopt_node *const node = &(nodes[num_nodes]);
+            lopt_encode(rules, &pos, &(node->key));
+            memcpy(pos.cols_lens, cols_lens, sizeof(cols_lens));
+            memcpy(pos.freecells, freecells, sizeof(freecells));
+            memcpy(pos.foundations, foundations, sizeof(foundations));
+            const uint32_t hash = lopt_hash(&(node->key));
+            size_t bucket = hash & table_mask;
+            bool is_new = true;
+            while (table[bucket] != UINT32_MAX)
+            {
+                if (!memcmp(&(nodes[table[bucket]].key), &(node->key),
+                        sizeof(node->key)))
+                {
+                    is_new = false;
+                    break;
+                }
+                bucket = (bucket + 1) & table_mask;
+            }
+            if (!is_new)
+            {
+                continue;
+            }
+            node->parent = (uint32_t)idx;
+            node->depth = (uint32_t)(depth + 1);
+            node->move = moves[m];
+            table[bucket] = (uint32_t)num_nodes;
+            for (size_t k = end; k > start + depth + 1 + best_gain; --k)
+            {
+                if ((w->hashes[k] == hash) &&
+                    !memcmp(&(w->keys[k]), &(node->key), sizeof(node->key)))
+                {
+                    best_gain = k - start - depth - 1;
+                    best_node = num_nodes;
+                    shortcut->end = k;
+                    break;
+                }
+            }
+            if (++num_nodes == max_num_nodes)
+            {
+                break;
+            }
+        }
+    }
+    if (!best_gain)
+    {
+        return;
+    }
+    const size_t num_shortcut_moves = nodes[best_node].depth;
+    shortcut->num_moves = num_shortcut_moves;
+    for (size_t i = num_shortcut_moves, idx = best_node; i > 0; --i)
+    {
+        shortcut->moves[i - 1] = nodes[idx].move;
+        idx = nodes[idx].parent;
+    }
+}
+
+static void *lopt_worker_thread(void *const void_arg)
+{
+    const lopt_worker *const w = (const lopt_worker *)void_arg;
+    const size_t max_num_nodes = (size_t)w->params->max_iters + 1;
+    size_t table_mask = 1;
+    while (table_mask < (max_num_nodes << 1))
+    {
+        table_mask <<= 1;
+    }
+    --table_mask;
+    lopt_node *const nodes = SMALLOC(nodes, max_num_nodes);
+    uint32_t *const table = SMALLOC(table, table_mask + 1);
+    if (nodes && table)
+    {
+        for (size_t i = w->thread_idx; i < w->num_windows;
+             i += w->num_threads)
+        {
+            if (!w->shortcuts[i].to_search)
+            {
+                continue;
+            }
+            lopt_search_window(w, i * w->step, nodes, table, table_mask,
+                &(w->shortcuts[i]));
+        }
+    }
+    free(nodes);
+    free(table);
+
+    return NULL;
+}
+
+// Searches all the windows and returns the number of moves that their
+// shortcuts save.
+static size_t lopt_search_windows(const fcs_plain_rules *const rules,
+    const fcs_local_opt_params *const params, const lopt_key *const keys,
+    const uint32_t *const hashes, const size_t num_moves,
+    lopt_shortcut *const shortcuts, const size_t num_windows,
+    lopt_fruitless *const fruitless)
+{
+    const size_t step = max(params->window >> 1, 1);
+    const size_t num_threads =
+        max(min(params->num_threads, num_windows), (size_t)1);
+    for (size_t i = 0; i < num_windows; ++i)
+    {
+        const size_t start = i * step;
+        const size_t end = min(start + params->window, num_moves);
+        lopt_shortcut *const shortcut = &(shortcuts[i]);
+        shortcut->signature =
+            DO_XXH(hashes + start, sizeof(hashes[0]) * (end - start + 1));
+        shortcut->to_search = true;
+        for (size_t j = 0; j < fruitless->num; ++j)
+        {
+            if (fruitless->signatures[j] == shortcut->signature)
+            {
+                shortcut->to_search = false;
+                break;
+            }
+        }
+        shortcut->end = start;
+        shortcut->num_moves = 0;
+    }
+    lopt_worker workers[num_threads];
+    for (size_t i = 0; i < num_threads; ++i)
+    {
+        workers[i] = (lopt_worker){.rules = rules,
+            .params = params,
+            .keys = keys,
+            .hashes = hashes,
+            .num_moves = num_moves,
+            .step = step,
+            .num_windows = num_windows,
+            .num_threads = num_threads,
+            .thread_idx = i,
+            .shortcuts = shortcuts};
+    }
+#ifdef FCS_HAVE_PTHREADS
+    pthread_t threads[num_threads];
+    bool is_running[num_threads];
+    for (size_t i = 1; i < num_threads; ++i)
+    {
+        is_running[i] = !pthread_create(
+            &threads[i], NULL, lopt_worker_thread, &workers[i]);
+        if (!is_running[i])
+        {
+            lopt_worker_thread(&workers[i]);
+        }
+    }
+    lopt_worker_thread(&workers[0]);
+    for (size_t i = 1; i < num_threads; ++i)
+    {
+        if (is_running[i])
+        {
+            pthread_join(threads[i], NULL);
+        }
+    }
+#else
+    for (size_t i = 0; i < num_threads; ++i)
+    {
+        lopt_worker_thread(&workers[i]);
+    }
+#endif
+
+    size_t gain = 0;
+    for (size_t i = 0; i < num_windows; ++i)
+    {
+        const lopt_shortcut *const shortcut = &(shortcuts[i]);
+        if (shortcut->end > i * step)
+        {
+            gain += shortcut->end - i * step - shortcut->num_moves;
+        }
+        else if (shortcut->to_search)
+        {
+            if (!(fruitless->num & (LOPT_FRUITLESS_GROW_BY - 1)))
+            {
+                fruitless->signatures = SREALLOC(fruitless->signatures,
+                    fruitless->num + LOPT_FRUITLESS_GROW_BY);
+            }
+            fruitless->signatures[fruitless->num++] = shortcut->signature;
+        }
+    }
+
+    return gain;
+}
+
+void fc_solve_local_optimize(const fcs_plain_rules *const rules,
+    const fcs_plain_position *const init_pos, fcs_move_stack *const moves,
+    const fcs_local_opt_params *const params)
+{
+    size_t num_moves = moves->num_moves;
+    if ((params->window < 2) || (!params->max_iters) || (num_moves < 2))
+    {
+        return;
+    }
+    fcs_plain_move *solution = SMALLOC(solution, num_moves);
+    fcs_plain_move *spliced = SMALLOC(spliced, num_moves);
+    lopt_key *const keys = SMALLOC(keys, num_moves + 1);
+    uint32_t *const hashes = SMALLOC(hashes, num_moves + 1);
+    const size_t max_num_windows = num_moves;
+    lopt_shortcut *const shortcuts = SMALLOC(shortcuts, max_num_windows);
+    fcs_plain_move *const shortcuts_moves =
+        SMALLOC(shortcuts_moves, max_num_windows * params->window);
+    if (!(solution && spliced && keys && hashes && shortcuts &&
+            shortcuts_moves))
+    {
+        goto cleanup;
+    }
+    for (size_t i = 0; i < max_num_windows; ++i)
+    {
+        shortcuts[i].moves = shortcuts_moves + i * params->window;
+    }
+
+    // Read the moves and check that they can all be played.
+    fcs_plain_position pos = *init_pos;
+    for (size_t i = 0; i < num_moves; ++i)
+    {
+        const_AUTO(move, moves->moves[num_moves - 1 - i]);
+        const int type = fcs_int_move_get_type(move);
+        solution[i] = (fcs_plain_move){.type = (uint8_t)type,
+            .src = (uint8_t)fcs_int_move_get_src(move),
+            .dest = (uint8_t)fcs_int_move_get_dest(move),
+            .num_cards = (uint8_t)((type == FCS_MOVE_TYPE_STACK_TO_STACK)
+                                       ? fcs_int_move_get_num_cards_in_seq(move)
+                                       : 1)};
+        if (!fc_solve_plain_is_move_legal(rules, &pos, solution[i]))
+        {
+            goto cleanup;
+        }
+        fc_solve_plain_apply_move(&pos, solution[i]);
+    }
+
+    const size_t step = max(params->window >> 1, 1);
+    lopt_fruitless fruitless = {.signatures = NULL, .num = 0};
+    while (true)
+    {
+        pos = *init_pos;
+        lopt_encode(rules, &pos, &keys[0]);
+        hashes[0] = lopt_hash(&keys[0]);
+        for (size_t i = 0; i < num_moves; ++i)
+        {
+            fc_solve_plain_apply_move(&pos, solution[i]);
+            lopt_encode(rules, &pos, &keys[i + 1]);
+            hashes[i + 1] = lopt_hash(&keys[i + 1]);
+        }
+        const size_t num_windows = (num_moves + step - 2) / step;
+        if (!lopt_search_windows(rules, params, keys, hashes, num_moves,
+                shortcuts, num_windows, &fruitless))
+        {
+            break;
+        }
+
+        // Splice the shortcuts in the order of their windows, while skipping
+        // the ones that overlap the previous shortcut.
+        size_t num_spliced = 0;
+        size_t next = 0;
+        for (size_t i = 0; i < num_windows; ++i)
+        {
+            const size_t start = i * step;
+            const lopt_shortcut *const shortcut = &(shortcuts[i]);
+            if ((start < next) || (shortcut->end == start))
+            {
+                continue;
+            }
+            memcpy(spliced + num_spliced, solution + next,
+                sizeof(solution[0]) * (start - next));
+            num_spliced += start - next;
+            memcpy(spliced + num_spliced, shortcut->moves,
+                sizeof(solution[0]) * shortcut->num_moves);
+            num_spliced += shortcut->num_moves;
+            next = shortcut->end;
+        }
+        memcpy(spliced + num_spliced, solution + next,
+            sizeof(solution[0]) * (num_moves - next));
+        num_moves = num_spliced + num_moves - next;
+        const_AUTO(temp, solution);
+        solution = spliced;
+        spliced = temp;
+    }
+
+    if (num_moves < moves->num_moves)
+    {
+        fcs_move_stack_reset(moves);
+        for (size_t i = num_moves; i > 0; --i)
+        {
+            const_AUTO(move, solution[i - 1]);
+            fcs_move_stack_params_push(
+                moves, move.type, move.src, move.dest, move.num_cards);
+        }
+    }
+    free(fruitless.signatures);
+
+cleanup:
+    free(solution);
+    free(spliced);
+    free(keys);
+    free(hashes);
+    free(shortcuts);
+    free(shortcuts_moves);
+}
+#endif
@@ -0,0 +1,44 @@
+// This file is part of Freecell Solver. It is subject to the license terms in
+// the COPYING.txt file found in the top-level directory of this distribution
+// and at http://fc-solve.shlomifish.org/docs/distro/COPYING.html . No part of
+// Freecell Solver, including this file, may be copied, modified, propagated,
+// or distributed except according to the terms contained in the COPYING file.
+//
+// Copyright (c) 2026 Shlomi Fish
+// local_optimizer.h - shortens a traced solution by sliding a window over its
+// positions and searching for a shorter way between the first position of the
+// window and one of the later ones. The windows are independent of each other
+// and may be searched in several threads.
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "plain_position.h"
+#include "move.h"
+
+typedef struct
+{
+    // The number of moves in a window, or 0 if the solutions should not be
+    // optimized.
+    size_t window;
+    // The maximal number of positions that the search of a single window
+    // may collect.
+    fcs_iters_int max_iters;
+    size_t num_threads;
+} fcs_local_opt_params;
+
+#define FCS_LOCAL_OPT_DEFAULT_MAX_ITERS 20000
+
+// moves holds the normalized solution from init_pos in reverse order (as
+// fc_solve_move_stack_normalize() leaves it), and is replaced by the
+// shortened one. It is left as it is if it contains moves that cannot be
+// played as plain moves.
+extern void fc_solve_local_optimize(const fcs_plain_rules *rules,
+    const fcs_plain_position *init_pos, fcs_move_stack *moves,
+    const fcs_local_opt_params *params);
+
+#ifdef __cplusplus
+}
+#endif
@@ -9,5 +9,8 @@
 //
 // It is documented in the documents "README", "USAGE", etc. in the
 // Freecell Solver distribution from http://fc-solve.shlomifish.org/ .
+#include "main_cl_callback_common.h"
+#include "serve.h"
+#include "stream.h"
 #include "cl_callback.h"
 #include "default_iter_handler.h"
@@ -39,6 +39,26 @@ static help_screen help_screens[] = {
                 "\n"
                 "If board_file is - or unspecified reads standard input\n"
                 "\n"
+                "fc-solve --serve [--socket path] [--workers n] "
+                "[--pool-size n] [options]\n"
+                "\n"
+                "Solves the boards that are sent to it over a Unix domain "
+                "socket or the\n"
+                "standard input\n"
+                "\n"
+                "fc-solve --stream [--workers n] [--delimiter line] "
+                "[--binary] [options]\n"
+                "\n"
+                "Solves the boards of the standard input in parallel, and "
+                "prints their\n"
+                "solutions in order\n"
+                "\n"
+                "fc-solve --save-theme theme_file [options]\n"
+                "\n"
+                "Writes the options, with the presets expanded, to "
+                "theme_file, which\n"
+                "--load-theme reads\n"
+                "\n"
                 "See http://fc-solve.shlomifish.org/docs/distro/USAGE.html .\n"
                 "\n"
                 "Freecell Solver was written by Shlomi Fish.\n"
@@ -166,6 +186,30 @@ static int fc_solve__cmd_line_callback(void *const instance, const int argc,
         display_context->iters_display_step = (size_t)atol(argv[next_arg]);
         return FCS_CMD_LINE_SKIP;
     }
+    else if (IS_ARG("--trace-ring-size"))
+    {
+        const int next_arg = arg + 1;
+        if (next_arg == argc)
+        {
+            return FCS_CMD_LINE_STOP;
+        }
+        *num_to_skip = 2;
+        freecell_solver_user_set_trace_ring_size(
+            instance, (fcs_int_limit_t)atol(argv[next_arg]));
+        return FCS_CMD_LINE_SKIP;
+    }
+    else if (IS_ARG("--trace-sample-step"))
+    {
+        const int next_arg = arg + 1;
+        if (next_arg == argc)
+        {
+            return FCS_CMD_LINE_STOP;
+        }
+        *num_to_skip = 2;
+        freecell_solver_user_set_trace_sample_step(
+            instance, (fcs_int_limit_t)atol(argv[next_arg]));
+        return FCS_CMD_LINE_SKIP;
+    }
     else if (IS_ARG("--reset"))
     {
         *display_context = INITIAL_DISPLAY_CONTEXT;
@@ -247,8 +291,8 @@ static freecell_solver_str_t known_parameters[] = {"-h", "--help",
     "--display-moves", "-sn", "--standard-notation", "-snx",
     "--standard-notation-extended", "-sam", "--display-states-and-moves", "-pi",
     "--display-parent-iter", "-sel", "--show-exceeded-limits", "-o", "--output",
-    "-hoi", "--hint-on-intractable", "--iter-output-step", "--reset",
-    "--version", NULL};
+    "-hoi", "--hint-on-intractable", "--iter-output-step",
+    "--trace-ring-size", "--trace-sample-step", "--reset", "--version", NULL};
 
 typedef enum
 {
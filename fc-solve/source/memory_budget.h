@@ -0,0 +1,163 @@
+// This file is part of Freecell Solver. It is subject to the license terms in
+// the COPYING.txt file found in the top-level directory of this distribution
+// and at http://fc-solve.shlomifish.org/docs/distro/COPYING.html . No part of
+// Freecell Solver, including this file, may be copied, modified, propagated,
+// or distributed except according to the terms contained in the COPYING file.
+//
+// Copyright (c) 2026 Shlomi Fish
+// memory_budget.h - a process-wide memory budget for several instances that
+// run side by side. The meta allocators of the instances register with it,
+// and the buffers and hash tables that they allocate are charged to it.
+//
+// Once it is over its cap, the largest member suspends when it checks its
+// stop request, and the other members wait for it to release its memory,
+// for up to FCS_MEMORY_BUDGET_MAX_PAUSE_NS, before they suspend as well.
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "meta_alloc.h"
+#include "stop_request.h"
+
+#define FCS_MEMORY_BUDGET_MAX_PAUSE_NS ((int64_t)1000000000)
+
+static inline void fc_solve_memory_budget_init(
+    fcs_memory_budget *const budget, const size_t cap)
+{
+    *budget = (fcs_memory_budget){
+        .cap = cap, .num_bytes = 0, .lock = false, .members = NULL};
+}
+
+static inline void memory_budget_lock(fcs_memory_budget *const budget)
+{
+    while (__atomic_test_and_set(&(budget->lock), __ATOMIC_ACQUIRE))
+    {
+    }
+}
+
+static inline void memory_budget_unlock(fcs_memory_budget *const budget)
+{
+    __atomic_clear(&(budget->lock), __ATOMIC_RELEASE);
+}
+
+static inline size_t fc_solve_memory_budget_get_usage(
+    const fcs_memory_budget *const budget)
+{
+    return __atomic_load_n(&(budget->num_bytes), __ATOMIC_RELAXED);
+}
+
+#ifndef FCS_WITHOUT_MEMORY_BUDGET
+static inline void fc_solve_memory_budget_unregister(meta_allocator *const meta)
+{
+    fcs_memory_budget *const budget = meta->budget;
+    if (!budget)
+    {
+        return;
+    }
+    memory_budget_lock(budget);
+    meta_allocator **member = &(budget->members);
+    while (*member != meta)
+    {
+        member = &((*member)->next_in_budget);
+    }
+    *member = meta->next_in_budget;
+    __atomic_sub_fetch(&(budget->num_bytes),
+        __atomic_load_n(&(meta->num_bytes), __ATOMIC_RELAXED),
+        __ATOMIC_RELAXED);
+    meta->budget = NULL;
+    meta->next_in_budget = NULL;
+    memory_budget_unlock(budget);
+}
+
+// Should not be called while the instance of meta is solving.
+static inline void fc_solve_memory_budget_register(
+    meta_allocator *const meta, fcs_memory_budget *const budget)
+{
+    fc_solve_memory_budget_unregister(meta);
+    if (!budget)
+    {
+        return;
+    }
+    memory_budget_lock(budget);
+    meta->next_in_budget = budget->members;
+    budget->members = meta;
+    meta->budget = budget;
+    __atomic_add_fetch(&(budget->num_bytes),
+        __atomic_load_n(&(meta->num_bytes), __ATOMIC_RELAXED),
+        __ATOMIC_RELAXED);
+    memory_budget_unlock(budget);
+}
+
+static inline bool fc_solve_memory_budget_is_over_cap(
+    const meta_allocator *const meta)
+{
+    const fcs_memory_budget *const budget = meta->budget;
+    return (budget && budget->cap &&
+            (fc_solve_memory_budget_get_usage(budget) > budget->cap));
+}
+
+static inline bool memory_budget_is_largest_member(
+    const meta_allocator *const meta)
+{
+    fcs_memory_budget *const budget = meta->budget;
+    const size_t num_bytes =
+        __atomic_load_n(&(meta->num_bytes), __ATOMIC_RELAXED);
+    bool ret = true;
+    memory_budget_lock(budget);
+    for (const meta_allocator *member = budget->members; member;
+         member = member->next_in_budget)
+    {
+        if (__atomic_load_n(&(member->num_bytes), __ATOMIC_RELAXED) >
+            num_bytes)
+        {
+            ret = false;
+            break;
+        }
+    }
+    memory_budget_unlock(budget);
+    return ret;
+}
+
+static inline void memory_budget_pause(void)
+{
+#ifdef _WIN32
+    Sleep(1);
+#else
+    const struct timespec pause = {.tv_sec = 0, .tv_nsec = 1000000};
+    nanosleep(&pause, NULL);
+#endif
+}
+
+// Returns whether the instance of meta should suspend because the budget is
+// over its cap, after waiting for the largest member if meta is not it.
+static inline bool fc_solve_memory_budget_should_suspend(
+    const meta_allocator *const meta, const fcs_stop_request *const stop)
+{
+    if (likely(!fc_solve_memory_budget_is_over_cap(meta)))
+    {
+        return false;
+    }
+    const int64_t deadline =
+        fc_solve_monotonic_ns() + FCS_MEMORY_BUDGET_MAX_PAUSE_NS;
+    while (!memory_budget_is_largest_member(meta))
+    {
+        if ((stop && fc_solve_is_stop_requested(stop)) ||
+            (fc_solve_monotonic_ns() >= deadline))
+        {
+            return true;
+        }
+        memory_budget_pause();
+        if (!fc_solve_memory_budget_is_over_cap(meta))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+#endif
+
+#ifdef __cplusplus
+}
+#endif
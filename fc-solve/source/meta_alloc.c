@@ -25,8 +25,13 @@ void fc_solve_meta_compact_allocator_finish(meta_allocator *const meta_alloc)
     for (; iter_next; iter = iter_next, iter_next = OLD_LIST_NEXT(iter))
     {
         free(iter);
+        fc_solve_meta_alloc_discharge(meta_alloc, FCS_METAALLOC_ALLOCED_SIZE);
+    }
+    if (iter)
+    {
+        free(iter);
+        fc_solve_meta_alloc_discharge(meta_alloc, FCS_METAALLOC_ALLOCED_SIZE);
     }
-    free(iter);
     meta_alloc->recycle_bin = NULL;
 #ifdef FCS_DBM_USE_APR
     if (meta_alloc->apr_pool)
@@ -39,6 +44,10 @@ void fc_solve_meta_compact_allocator_finish(meta_allocator *const meta_alloc)
 
 void fc_solve_compact_allocator_finish(compact_allocator *const allocator)
 {
+    if (!allocator->old_list)
+    {
+        return;
+    }
     char *iter, *iter_next;
     meta_allocator *const meta = allocator->meta;
     var_AUTO(bin, meta->recycle_bin);
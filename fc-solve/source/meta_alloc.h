@@ -20,14 +20,64 @@ extern "C" {
 
 #include "state.h"
 
+struct meta_allocator_struct;
+
+// A memory budget that is shared by the meta allocators that were registered
+// with it, possibly from several threads - see memory_budget.h .
 typedef struct
+{
+    // The number of bytes above which the consumers are suspended, or 0 for
+    // no limit.
+    size_t cap;
+    // It is updated from several threads, so it is only accessed atomically.
+    size_t num_bytes;
+    // Guards the list of members.
+    bool lock;
+    struct meta_allocator_struct *members;
+} fcs_memory_budget;
+
+typedef struct meta_allocator_struct
 {
     char *recycle_bin;
 #ifdef FCS_DBM_USE_APR
     apr_pool_t *apr_pool;
 #endif
+#ifndef FCS_WITHOUT_MEMORY_BUDGET
+    // The number of bytes that are held by the buffers and by the hash tables
+    // that were allocated through it. The other members of its budget read
+    // it, so it is only accessed atomically.
+    size_t num_bytes;
+    fcs_memory_budget *budget;
+    struct meta_allocator_struct *next_in_budget;
+#endif
 } meta_allocator;
 
+static inline void fc_solve_meta_alloc_charge(
+    meta_allocator *const meta GCC_UNUSED, const size_t num_bytes GCC_UNUSED)
+{
+#ifndef FCS_WITHOUT_MEMORY_BUDGET
+    __atomic_add_fetch(&(meta->num_bytes), num_bytes, __ATOMIC_RELAXED);
+    if (meta->budget)
+    {
+        __atomic_add_fetch(
+            &(meta->budget->num_bytes), num_bytes, __ATOMIC_RELAXED);
+    }
+#endif
+}
+
+static inline void fc_solve_meta_alloc_discharge(
+    meta_allocator *const meta GCC_UNUSED, const size_t num_bytes GCC_UNUSED)
+{
+#ifndef FCS_WITHOUT_MEMORY_BUDGET
+    __atomic_sub_fetch(&(meta->num_bytes), num_bytes, __ATOMIC_RELAXED);
+    if (meta->budget)
+    {
+        __atomic_sub_fetch(
+            &(meta->budget->num_bytes), num_bytes, __ATOMIC_RELAXED);
+    }
+#endif
+}
+
 typedef struct
 {
     char *old_list;
@@ -50,6 +100,7 @@ static inline char *meta_request_new_buffer(meta_allocator *const meta_alloc)
     }
     else
     {
+        fc_solve_meta_alloc_charge(meta_alloc, FCS_METAALLOC_ALLOCED_SIZE);
         return malloc(FCS_METAALLOC_ALLOCED_SIZE);
     }
 }
@@ -65,12 +116,14 @@ static inline void fc_solve_compact_allocator_extend(
     allocator->max_ptr = new_data + FCS_METAALLOC_ALLOCED_SIZE;
 }
 
-// Call this after allocator->meta was initialized
+// Call this after allocator->meta was initialized. The first buffer is only
+// requested by the first allocation, so that the instances which never get
+// to solve, such as most of the flares of a preset, are cheap to set up.
 static inline void fc_solve_compact_allocator_init_helper(
     compact_allocator *const allocator)
 {
     allocator->old_list = NULL;
-    fc_solve_compact_allocator_extend(allocator);
+    allocator->ptr = allocator->max_ptr = allocator->rollback_ptr = NULL;
 }
 
 static inline void fc_solve_meta_compact_allocator_init(
@@ -80,6 +133,11 @@ static inline void fc_solve_meta_compact_allocator_init(
 #ifdef FCS_DBM_USE_APR
     meta->apr_pool = NULL;
 #endif
+#ifndef FCS_WITHOUT_MEMORY_BUDGET
+    meta->num_bytes = 0;
+    meta->budget = NULL;
+    meta->next_in_budget = NULL;
+#endif
 }
 
 extern void fc_solve_meta_compact_allocator_finish(meta_allocator *);
@@ -47,16 +47,10 @@ static inline size_t calc_max_simple_simon_seq_move(const int num_empty_cols)
     fc_solve_sfs_check_state_begin(hard_thread, &pass_new_state,               \
         raw_state_raw SFS__PASS_MOVE_STACK(moves))
 
-#ifdef FCS_HARD_CODE_REPARENT_STATES_AS_FALSE
-#define sfs_check_state_end__arg
-#else
-#define sfs_check_state_end__arg raw_state_raw,
-#endif
-
 #define sfs_check_state_end()                                                  \
     fc_solve_derived_states_list_add_state(derived_states_list,                \
-        fc_solve_sfs_check_state_end(soft_thread,                              \
-            sfs_check_state_end__arg &pass_new_state FCS__pass_moves(moves)),  \
+        fc_solve_sfs_check_state_end(soft_thread, raw_state_raw,               \
+            &pass_new_state FCS__pass_moves(moves)),                           \
         state_context_value)
 
 static inline void fc_solve_move_sequence_function(
@@ -223,6 +217,42 @@ static inline void fc_solve_move_sequence_function(
 #define CALC_num_cards_in_col_threshold()                                      \
     (MOVE_FUNCS__should_not_empty_columns() ? 1 : 0)
 
+// A translation unit that compiles the moves for one specific game variant
+// (see specialized_moves.h) defines FCS_SPECIALIZED_MOVES and the variant's
+// parameters before including freecell.c or simpsim.c. The game parameters
+// are then compile-time constants, and the move functions become static
+// functions with a "__specialized" suffix.
+#ifdef FCS_SPECIALIZED_MOVES
+#undef SET_GAME_PARAMS
+#define SET_GAME_PARAMS()
+#undef SET_INSTANCE_GAME_PARAMS
+#define SET_INSTANCE_GAME_PARAMS(instance)
+#undef LOCAL_FREECELLS_NUM
+#define LOCAL_FREECELLS_NUM FCS_SPECIALIZED_FREECELLS_NUM
+#undef LOCAL_STACKS_NUM
+#define LOCAL_STACKS_NUM FCS_SPECIALIZED_STACKS_NUM
+#undef LOCAL_DECKS_NUM
+#define LOCAL_DECKS_NUM FCS_SPECIALIZED_DECKS_NUM
+#undef INSTANCE_DECKS_NUM
+#define INSTANCE_DECKS_NUM FCS_SPECIALIZED_DECKS_NUM
+#undef INSTANCE_UNLIMITED_SEQUENCE_MOVE
+#define INSTANCE_UNLIMITED_SEQUENCE_MOVE FCS_SPECIALIZED_UNLIMITED_SEQUENCE_MOVE
+
+#undef MOVE_FUNCS__define_seqs_built_by
+#define MOVE_FUNCS__define_seqs_built_by()                                     \
+    const int sequences_are_built_by = FCS_SPECIALIZED_SEQS_BUILT_BY;
+#undef MOVE_FUNCS__define_empty_stacks_fill
+#define MOVE_FUNCS__define_empty_stacks_fill()                                 \
+    const int empty_stacks_fill = FCS_SPECIALIZED_EMPTY_STACKS_FILL;
+#undef tests_define_accessors_freecell_only
+#define tests_define_accessors_freecell_only()                                 \
+    fcs_instance *const instance GCC_UNUSED = hard_thread;
+
+#undef DECLARE_MOVE_FUNCTION
+#define DECLARE_MOVE_FUNCTION(name)                                            \
+    static void name##__specialized(MOVE_FUNC_ARGS)
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -142,6 +142,17 @@ static inline void fc_solve_output_result_to_file(FILE *const output_fh,
                   ? "Iterations count exceeded.\n"
                   : "I could not solve this game.\n"),
         output_fh);
+#ifdef FCS_WITH_ERROR_STRS
+    if (!was_solved)
+    {
+        const char *const error_string =
+            freecell_solver_user_get_last_error_string(instance);
+        if (error_string[0])
+        {
+            fprintf(stderr, "%s\n", error_string);
+        }
+    }
+#endif
 
     fprintf(output_fh, "Total number of states checked is %ld.\n",
         (long)freecell_solver_user_get_num_times_long(instance));
@@ -151,6 +162,28 @@ static inline void fc_solve_output_result_to_file(FILE *const output_fh,
 #endif
 }
 
+// Outputs the records that are left in the trace ring, if there is one.
+static inline void fc_solve_output_trace_to_file(
+    FILE *const output_fh, void *const instance)
+{
+    fcs_trace_record records[64];
+    unsigned long long cursor = 0;
+    size_t num_records;
+    while ((num_records = freecell_solver_user_read_trace(
+                instance, records, COUNT(records), &cursor)))
+    {
+        for (size_t i = 0; i < num_records; ++i)
+        {
+            fprintf(output_fh,
+                "Trace: Iteration: %llu Depth: %d Parent Iteration: %llu "
+                "Soft Thread: %d State: %llx\n",
+                records[i].iter_num, records[i].depth,
+                records[i].parent_iter_num, records[i].soft_thread_id,
+                records[i].state_id);
+        }
+    }
+}
+
 #ifdef __cplusplus
 }
 #endif
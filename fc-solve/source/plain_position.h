@@ -0,0 +1,369 @@
+// This file is part of Freecell Solver. It is subject to the license terms in
+// the COPYING.txt file found in the top-level directory of this distribution
+// and at http://fc-solve.shlomifish.org/docs/distro/COPYING.html . No part of
+// Freecell Solver, including this file, may be copied, modified, propagated,
+// or distributed except according to the terms contained in the COPYING file.
+//
+// Copyright (c) 2026 Shlomi Fish
+// plain_position.h - a single-deck position that is kept in plain arrays,
+// with its columns and freecells in their actual places, and the moves that
+// are legal in it under the rules of a game variant. It is used by the
+// endgame tablebase and the local optimizer of the solutions, which do not
+// need the states collection of an instance.
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "state.h"
+
+typedef struct
+{
+    size_t num_freecells;
+    size_t num_columns;
+    int sequences_are_built_by;
+    int empty_stacks_fill;
+    bool unlimited_sequence_move;
+} fcs_plain_rules;
+
+static inline bool fc_solve_plain_rules_match(
+    const fcs_plain_rules *const a, const fcs_plain_rules *const b)
+{
+    return ((a->num_freecells == b->num_freecells) &&
+            (a->num_columns == b->num_columns) &&
+            (a->sequences_are_built_by == b->sequences_are_built_by) &&
+            (a->empty_stacks_fill == b->empty_stacks_fill) &&
+            (a->unlimited_sequence_move == b->unlimited_sequence_move));
+}
+
+typedef struct
+{
+    fcs_card cols[MAX_NUM_STACKS][MAX_NUM_CARDS_IN_A_STACK];
+    uint8_t cols_lens[MAX_NUM_STACKS];
+    fcs_card freecells[MAX_NUM_FREECELLS];
+    uint8_t foundations[FCS_NUM_SUITS];
+} fcs_plain_position;
+
+// The type is one of FCS_MOVE_TYPE_*, and the destination of a move to
+// the foundations is the suit.
+typedef struct
+{
+    uint8_t type;
+    uint8_t src;
+    uint8_t dest;
+    uint8_t num_cards;
+} fcs_plain_move;
+
+// A sequence has at most 13 cards.
+#define FCS_PLAIN_MAX_NUM_MOVES                                                \
+    (MAX_NUM_STACKS * (MAX_NUM_STACKS * 13 + 2) +                              \
+        MAX_NUM_FREECELLS * (MAX_NUM_STACKS + 1))
+
+static inline bool fc_solve_plain_is_parent(const fcs_plain_rules *const rules,
+    const fcs_card child, const fcs_card parent)
+{
+    if (fcs_card_rank(child) + 1 != fcs_card_rank(parent))
+    {
+        return false;
+    }
+    switch (rules->sequences_are_built_by)
+    {
+    case FCS_SEQ_BUILT_BY_RANK:
+        return true;
+    case FCS_SEQ_BUILT_BY_SUIT:
+        return (fcs_card_suit(child) == fcs_card_suit(parent));
+    default:
+        return ((fcs_card_suit(child) & 0x1) != (fcs_card_suit(parent) & 0x1));
+    }
+}
+
+static inline size_t fc_solve_plain_count_cards(
+    const fcs_plain_rules *const rules, const fcs_plain_position *const pos)
+{
+    size_t num_cards = 0;
+    for (size_t i = 0; i < rules->num_freecells; ++i)
+    {
+        num_cards += fcs_card_is_valid(pos->freecells[i]);
+    }
+    for (size_t i = 0; i < rules->num_columns; ++i)
+    {
+        num_cards += pos->cols_lens[i];
+    }
+
+    return num_cards;
+}
+
+// Returns the number of cards at the top of the column that form a sequence.
+static inline size_t fc_solve_plain_seq_len(const fcs_plain_rules *const rules,
+    const fcs_plain_position *const pos, const size_t col_idx)
+{
+    const fcs_card *const col = pos->cols[col_idx];
+    const size_t col_len = pos->cols_lens[col_idx];
+    if (!col_len)
+    {
+        return 0;
+    }
+    size_t ret = 1;
+    while ((ret < col_len) &&
+           fc_solve_plain_is_parent(
+               rules, col[col_len - ret], col[col_len - ret - 1]))
+    {
+        ++ret;
+    }
+
+    return ret;
+}
+
+static inline bool fc_solve_plain_can_put(const fcs_plain_rules *const rules,
+    const fcs_plain_position *const pos, const size_t col_idx,
+    const fcs_card card)
+{
+    const size_t col_len = pos->cols_lens[col_idx];
+    if (col_len)
+    {
+        return fc_solve_plain_is_parent(
+            rules, card, pos->cols[col_idx][col_len - 1]);
+    }
+    switch (rules->empty_stacks_fill)
+    {
+    case FCS_ES_FILLED_BY_ANY_CARD:
+        return true;
+    case FCS_ES_FILLED_BY_KINGS_ONLY:
+        return (fcs_card_rank(card) == 13);
+    default:
+        return false;
+    }
+}
+
+// The same limit as calc_max_sequence_move() in meta_move_funcs_helpers.h .
+static inline size_t fc_solve_plain_max_seq_move(
+    const fcs_plain_rules *const rules, const fcs_plain_position *const pos,
+    const size_t dest_col_idx)
+{
+    if (rules->unlimited_sequence_move)
+    {
+        return SIZE_MAX;
+    }
+    size_t num_vacant_freecells = 0;
+    for (size_t i = 0; i < rules->num_freecells; ++i)
+    {
+        num_vacant_freecells += fcs_card_is_empty(pos->freecells[i]);
+    }
+    if (rules->empty_stacks_fill != FCS_ES_FILLED_BY_ANY_CARD)
+    {
+        return num_vacant_freecells + 1;
+    }
+    size_t num_vacant_stacks = 0;
+    for (size_t i = 0; i < rules->num_columns; ++i)
+    {
+        num_vacant_stacks += ((i != dest_col_idx) && (!pos->cols_lens[i]));
+    }
+
+    return ((num_vacant_freecells + 1) << num_vacant_stacks);
+}
+
+static inline bool fc_solve_plain_is_move_legal(
+    const fcs_plain_rules *const rules, const fcs_plain_position *const pos,
+    const fcs_plain_move move)
+{
+    switch (move.type)
+    {
+    case FCS_MOVE_TYPE_STACK_TO_FOUNDATION:
+    case FCS_MOVE_TYPE_FREECELL_TO_FOUNDATION: {
+        fcs_card card;
+        if (move.type == FCS_MOVE_TYPE_STACK_TO_FOUNDATION)
+        {
+            const size_t col_len = pos->cols_lens[move.src];
+            if (!col_len)
+            {
+                return false;
+            }
+            card = pos->cols[move.src][col_len - 1];
+        }
+        else
+        {
+            card = pos->freecells[move.src];
+            if (fcs_card_is_empty(card))
+            {
+                return false;
+            }
+        }
+        return ((fcs_card_suit(card) == move.dest) &&
+                (fcs_card_rank(card) == pos->foundations[move.dest] + 1));
+    }
+
+    case FCS_MOVE_TYPE_STACK_TO_FREECELL:
+        return (pos->cols_lens[move.src] &&
+                fcs_card_is_empty(pos->freecells[move.dest]));
+
+    case FCS_MOVE_TYPE_FREECELL_TO_STACK:
+        return (fcs_card_is_valid(pos->freecells[move.src]) &&
+                fc_solve_plain_can_put(
+                    rules, pos, move.dest, pos->freecells[move.src]));
+
+    case FCS_MOVE_TYPE_STACK_TO_STACK: {
+        const size_t num_cards = move.num_cards;
+        if ((move.src == move.dest) || (num_cards < 1) ||
+            (num_cards > fc_solve_plain_seq_len(rules, pos, move.src)))
+        {
+            return false;
+        }
+        const fcs_card base_card =
+            pos->cols[move.src][pos->cols_lens[move.src] - num_cards];
+        return (fc_solve_plain_can_put(rules, pos, move.dest, base_card) &&
+                (num_cards <=
+                    fc_solve_plain_max_seq_move(rules, pos, move.dest)));
+    }
+
+    default:
+        return false;
+    }
+}
+
+static inline void fc_solve_plain_apply_move(
+    fcs_plain_position *const pos, const fcs_plain_move move)
+{
+    switch (move.type)
+    {
+    case FCS_MOVE_TYPE_STACK_TO_FOUNDATION:
+        --pos->cols_lens[move.src];
+        ++pos->foundations[move.dest];
+        break;
+
+    case FCS_MOVE_TYPE_FREECELL_TO_FOUNDATION:
+        pos->freecells[move.src] = fc_solve_empty_card;
+        ++pos->foundations[move.dest];
+        break;
+
+    case FCS_MOVE_TYPE_STACK_TO_FREECELL:
+        pos->freecells[move.dest] =
+            pos->cols[move.src][--pos->cols_lens[move.src]];
+        break;
+
+    case FCS_MOVE_TYPE_FREECELL_TO_STACK:
+        pos->cols[move.dest][pos->cols_lens[move.dest]++] =
+            pos->freecells[move.src];
+        pos->freecells[move.src] = fc_solve_empty_card;
+        break;
+
+    case FCS_MOVE_TYPE_STACK_TO_STACK:
+        pos->cols_lens[move.src] -= move.num_cards;
+        memcpy(pos->cols[move.dest] + pos->cols_lens[move.dest],
+            pos->cols[move.src] + pos->cols_lens[move.src], move.num_cards);
+        pos->cols_lens[move.dest] += move.num_cards;
+        break;
+    }
+}
+
+// Fills moves with all the legal moves in the position and returns their
+// number.
+static inline size_t fc_solve_plain_gen_moves(
+    const fcs_plain_rules *const rules, const fcs_plain_position *const pos,
+    fcs_plain_move *const moves)
+{
+    size_t num_moves = 0;
+    const size_t num_freecells = rules->num_freecells;
+    const size_t num_columns = rules->num_columns;
+    size_t empty_fc = num_freecells;
+    for (size_t i = 0; i < num_freecells; ++i)
+    {
+        if (fcs_card_is_empty(pos->freecells[i]))
+        {
+            empty_fc = i;
+            break;
+        }
+    }
+#define ADD_MOVE(t, s, d, n)                                                   \
+    {                                                                          \
+        const fcs_plain_move move = {.type = (t),                              \
+            .src = (uint8_t)(s),                                               \
+            .dest = (uint8_t)(d),                                              \
+            .num_cards = (uint8_t)(n)};                                        \
+        if (fc_solve_plain_is_move_legal(rules, pos, move))                    \
+        {                                                                      \
+            moves[num_moves++] = move;                                         \
+        }                                                                      \
+    }
+    for (size_t i = 0; i < num_columns; ++i)
+    {
+        const size_t col_len = pos->cols_lens[i];
+        if (!col_len)
+        {
+            continue;
+        }
+        ADD_MOVE(FCS_MOVE_TYPE_STACK_TO_FOUNDATION, i,
+            fcs_card_suit(pos->cols[i][col_len - 1]), 1);
+        if (empty_fc < num_freecells)
+        {
+            ADD_MOVE(FCS_MOVE_TYPE_STACK_TO_FREECELL, i, empty_fc, 1);
+        }
+        const size_t seq_len = fc_solve_plain_seq_len(rules, pos, i);
+        const int top_rank = fcs_card_rank(pos->cols[i][col_len - 1]);
+        for (size_t dest = 0; dest < num_columns; ++dest)
+        {
+            const size_t dest_len = pos->cols_lens[dest];
+            if (dest_len)
+            {
+                // Only the sequence whose base card is one rank below the
+                // top card of dest may be put there.
+                const int n =
+                    fcs_card_rank(pos->cols[dest][dest_len - 1]) - top_rank;
+                if ((n >= 1) && ((size_t)n <= seq_len))
+                {
+                    ADD_MOVE(FCS_MOVE_TYPE_STACK_TO_STACK, i, dest, n);
+                }
+                continue;
+            }
+            for (size_t n = 1; n <= seq_len; ++n)
+            {
+                ADD_MOVE(FCS_MOVE_TYPE_STACK_TO_STACK, i, dest, n);
+            }
+        }
+    }
+    for (size_t i = 0; i < num_freecells; ++i)
+    {
+        const fcs_card card = pos->freecells[i];
+        if (fcs_card_is_empty(card))
+        {
+            continue;
+        }
+        ADD_MOVE(
+            FCS_MOVE_TYPE_FREECELL_TO_FOUNDATION, i, fcs_card_suit(card), 1);
+        for (size_t dest = 0; dest < num_columns; ++dest)
+        {
+            ADD_MOVE(FCS_MOVE_TYPE_FREECELL_TO_STACK, i, dest, 1);
+        }
+    }
+#undef ADD_MOVE
+
+    return num_moves;
+}
+
+static inline void fc_solve_plain_position_from_state(
+    const fcs_plain_rules *const rules, const fcs_state *const s,
+    fcs_plain_position *const pos)
+{
+    for (size_t i = 0; i < rules->num_freecells; ++i)
+    {
+        pos->freecells[i] = fcs_freecell_card(*s, i);
+    }
+    for (size_t i = 0; i < rules->num_columns; ++i)
+    {
+        const_AUTO(col, fcs_state_get_col(*(fcs_state *)s, i));
+        const int col_len = fcs_col_len(col);
+        pos->cols_lens[i] = (uint8_t)col_len;
+        for (int c = 0; c < col_len; ++c)
+        {
+            pos->cols[i][c] = fcs_col_get_card(col, c);
+        }
+    }
+    for (size_t suit = 0; suit < FCS_NUM_SUITS; ++suit)
+    {
+        pos->foundations[suit] = (uint8_t)fcs_foundation_value(*s, suit);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -28,22 +28,67 @@ help_err(const char *const msg, ...)
 }
 #endif
 
-static inline bool range_solvers__solve(char *const state_string,
-    void *const instance, const fc_solve_ms_deal_idx_type board_num,
-    fcs_iters_int *const total_num_iters_temp)
+// The --variant whose PySolFC deals are solved, or NULL for the Microsoft
+// Freecell deals.
+static const char *range_solvers__variant = NULL;
+static fcs_pysol_game_type range_solvers__pysol_game = FCS_PYSOL_GAME_UNKNOWN;
+
+static inline void range_solvers__set_variant(const char *const variant)
+{
+    if (!strcmp(variant, "freecell"))
+    {
+        range_solvers__variant = NULL;
+        return;
+    }
+#ifdef FCS_FREECELL_ONLY
+    exit_error("This build only supports Freecell.\n");
+#else
+    if ((range_solvers__pysol_game = fc_solve_pysol_game_by_name(variant)) ==
+        FCS_PYSOL_GAME_UNKNOWN)
+    {
+        exit_error("Unknown or unsupported variant \"%s\"!\n", variant);
+    }
+    range_solvers__variant = variant;
+#endif
+}
+
+static inline void range_solvers__apply_variant(void *const instance)
 {
-    get_board_l__without_setup(board_num, state_string);
+#ifndef FCS_FREECELL_ONLY
+    if (range_solvers__variant)
+    {
+        freecell_solver_user_apply_preset(instance, range_solvers__variant);
+    }
+#endif
+}
 
-    switch (freecell_solver_user_solve_board(instance, state_string))
+// state_string must be able to hold a fcs_pysol_board_string if a variant
+// was set. Returns the verdict of freecell_solver_user_solve_board().
+static inline int range_solvers__solve_board(char *const state_string,
+    void *const instance, const fc_solve_ms_deal_idx_type board_num)
+{
+    if (range_solvers__variant)
+    {
+        fc_solve_get_pysol_board(range_solvers__pysol_game,
+            FCS_PYSOL_DEALS_PYSOLFC, board_num, state_string);
+    }
+    else
+    {
+        get_board_l__without_setup(board_num, state_string);
+    }
+
+    return freecell_solver_user_solve_board(instance, state_string);
+}
+
+static inline void range_solvers__print_verdict(
+    const fc_solve_ms_deal_idx_type board_num, const int verdict)
+{
+    switch (verdict)
     {
     case FCS_STATE_SUSPEND_PROCESS:
         fc_solve_print_intractable(board_num);
         break;
 
-    case FCS_STATE_FLARES_PLAN_ERROR:
-        print_flares_plan_error(instance);
-        return true;
-
     case FCS_STATE_IS_NOT_SOLVEABLE:
         fc_solve_print_unsolved(board_num);
         break;
@@ -53,6 +98,20 @@ static inline bool range_solvers__solve(char *const state_string,
         break;
 #endif
     }
+}
+
+static inline bool range_solvers__solve(char *const state_string,
+    void *const instance, const fc_solve_ms_deal_idx_type board_num,
+    fcs_iters_int *const total_num_iters_temp)
+{
+    const int verdict =
+        range_solvers__solve_board(state_string, instance, board_num);
+    if (verdict == FCS_STATE_FLARES_PLAN_ERROR)
+    {
+        print_flares_plan_error(instance);
+        return true;
+    }
+    range_solvers__print_verdict(board_num, verdict);
 
     *total_num_iters_temp += freecell_solver_user_get_num_times_long(instance);
     return false;
@@ -15,6 +15,7 @@ extern "C" {
 #endif
 
 #include "gen_ms_boards__rand.h"
+#include "gen_pysol_boards__rand.h"
 #include "board_gen_lookup1.h"
 
 typedef size_t fcs_board_gen_card;
@@ -124,6 +125,359 @@ static inline void get_board(unsigned long deal_idx, char *ret)
 
 typedef char fcs_state_string[52 * 3 + 8 + 1];
 
+// PySol's and PySolFC's deals of the variants which Freecell Solver can
+// solve. The layouts are identical to the -t output of
+// make_pysol_freecell_board.py, so they can be generated in-process
+// instead of running it for every deal.
+typedef enum
+{
+    FCS_PYSOL_DEALS_PYSOL,
+    FCS_PYSOL_DEALS_PYSOLFC,
+    FCS_PYSOL_DEALS_MS,
+} fcs_pysol_deals_type;
+
+typedef enum
+{
+    FCS_PYSOL_GAME_FREECELL,
+    FCS_PYSOL_GAME_FORECELL,
+    FCS_PYSOL_GAME_EIGHT_OFF,
+    FCS_PYSOL_GAME_SEAHAVEN,
+    FCS_PYSOL_GAME_BAKERS_DOZEN,
+    FCS_PYSOL_GAME_SIMPLE_SIMON,
+    FCS_PYSOL_GAME_BELEAGUERED_CASTLE,
+    FCS_PYSOL_GAME_CITADEL,
+    FCS_PYSOL_GAME_STREETS_AND_ALLEYS,
+    FCS_PYSOL_GAME_FAN,
+    FCS_PYSOL_GAME_UNKNOWN,
+} fcs_pysol_game_type;
+
+static const struct
+{
+    const char *name;
+    fcs_pysol_game_type game;
+} fcs_pysol_games[] = {
+    {"freecell", FCS_PYSOL_GAME_FREECELL},
+    {"bakers_game", FCS_PYSOL_GAME_FREECELL},
+    {"ko_bakers_game", FCS_PYSOL_GAME_FREECELL},
+    {"kings_only_bakers_game", FCS_PYSOL_GAME_FREECELL},
+    {"relaxed_freecell", FCS_PYSOL_GAME_FREECELL},
+    {"forecell", FCS_PYSOL_GAME_FORECELL},
+    {"eight_off", FCS_PYSOL_GAME_EIGHT_OFF},
+    {"seahaven_towers", FCS_PYSOL_GAME_SEAHAVEN},
+    {"seahaven", FCS_PYSOL_GAME_SEAHAVEN},
+    {"relaxed_seahaven_towers", FCS_PYSOL_GAME_SEAHAVEN},
+    {"relaxed_seahaven", FCS_PYSOL_GAME_SEAHAVEN},
+    {"bakers_dozen", FCS_PYSOL_GAME_BAKERS_DOZEN},
+    {"simple_simon", FCS_PYSOL_GAME_SIMPLE_SIMON},
+    {"beleaguered_castle", FCS_PYSOL_GAME_BELEAGUERED_CASTLE},
+    {"citadel", FCS_PYSOL_GAME_CITADEL},
+    {"streets_and_alleys", FCS_PYSOL_GAME_STREETS_AND_ALLEYS},
+    {"fan", FCS_PYSOL_GAME_FAN},
+};
+
+static inline fcs_pysol_game_type fc_solve_pysol_game_by_name(
+    const char *const variant)
+{
+    for (size_t i = 0; i < COUNT(fcs_pysol_games); ++i)
+    {
+        if (!strcmp(variant, fcs_pysol_games[i].name))
+        {
+            return fcs_pysol_games[i].game;
+        }
+    }
+    return FCS_PYSOL_GAME_UNKNOWN;
+}
+
+// A PySol card is suit * 13 + rank with the suits ordered as "CSHD".
+typedef uint8_t fcs_pysol_card;
+#define PYSOL_RANK(card) ((card) % 13)
+#define PYSOL_SUIT(card) ((card) / 13)
+#define PYSOL_NO_CARD 0xff
+
+// Fills cards with the deck in the order in which it is dealt (PySol's
+// talon order reversed).
+static inline void fc_solve_pysol_shuffle(const fcs_pysol_deals_type deals,
+    const fc_solve_ms_deal_idx_type deal_idx, fcs_pysol_card *const cards)
+{
+    const bool is_ms = ((deals == FCS_PYSOL_DEALS_MS) || (deal_idx <= 32000));
+    for (size_t i = 0; i < 52; ++i)
+    {
+        // MS deals arrange the new deck by rank with the suits as "CDHS".
+        cards[i] =
+            (fcs_pysol_card)(is_ms ? ("\0\3\2\1"[i & 3] * 13 + (i >> 2)) : i);
+    }
+    union {
+        microsoft_rand ms;
+        fcs_pysol_mt_rand mt;
+        fcs_pysol_lc64_rand lc64;
+    } r;
+    if (is_ms)
+    {
+        r.ms = microsoft_rand__calc_init_seedx((microsoft_rand)deal_idx);
+    }
+    else if (deals == FCS_PYSOL_DEALS_PYSOLFC)
+    {
+        fcs_pysol_mt_rand__seed(&r.mt, deal_idx);
+    }
+    else
+    {
+        r.lc64 = deal_idx;
+    }
+    // random.shuffle() followed by the reversal of the talon.
+    for (size_t n = 51; n > 0; --n)
+    {
+        const size_t j =
+            (is_ms ? (microsoft_rand__game_num_rand(&r.ms, deal_idx) % (n + 1))
+                : (deals == FCS_PYSOL_DEALS_PYSOLFC)
+                    ? fcs_pysol_mt_rand__randint(&r.mt, n)
+                    : fcs_pysol_lc64_rand__randint(&r.lc64, n));
+        const fcs_pysol_card temp = cards[n];
+        cards[n] = cards[j];
+        cards[j] = temp;
+    }
+    for (size_t i = 0; i < 26; ++i)
+    {
+        const fcs_pysol_card temp = cards[i];
+        cards[i] = cards[51 - i];
+        cards[51 - i] = temp;
+    }
+}
+
+#define PYSOL_MAX_NUM_COLS 18
+
+typedef struct
+{
+    fcs_pysol_card cols[PYSOL_MAX_NUM_COLS][52];
+    size_t col_lens[PYSOL_MAX_NUM_COLS];
+    size_t num_cols;
+    fcs_pysol_card freecells[8];
+    size_t num_freecells;
+    // The number of cards in each suit's foundation, if there are any.
+    int founds[4];
+    bool with_founds;
+} fcs_pysol_board;
+
+static inline void pysol_board__add(fcs_pysol_board *const board,
+    const size_t col, const fcs_pysol_card card)
+{
+    board->cols[col][board->col_lens[col]++] = card;
+}
+
+static inline bool pysol_board__put_into_founds(
+    fcs_pysol_board *const board, const fcs_pysol_card card)
+{
+    int *const found = &(board->founds[PYSOL_SUIT(card)]);
+    if (PYSOL_RANK(card) != *found)
+    {
+        return false;
+    }
+    ++(*found);
+    return true;
+}
+
+static inline char *pysol_card_to_string(
+    char *const s, const fcs_pysol_card card)
+{
+    s[0] = card_to_string_values[PYSOL_RANK(card)];
+    s[1] = "CSHD"[PYSOL_SUIT(card)];
+    return s + 2;
+}
+
+static inline void pysol_board__render(
+    const fcs_pysol_board *const board, char *s)
+{
+    if (board->with_founds)
+    {
+        s += sprintf(s, "Foundations:");
+        for (size_t i = 0; i < 4; ++i)
+        {
+            // Listed as "HCDS", the order in which PySol prints them.
+            const int suit = "\2\0\3\1"[i];
+            const int rank = board->founds[suit];
+            s += sprintf(s, " %c-%c", "CSHD"[suit],
+                (rank ? card_to_string_values[rank - 1] : '0'));
+        }
+        *(s++) = '\n';
+    }
+    if (board->num_freecells)
+    {
+        s += sprintf(s, "Freecells:");
+        for (size_t i = 0; i < board->num_freecells; ++i)
+        {
+            *(s++) = ' ';
+            const fcs_pysol_card card = board->freecells[i];
+            if (card == PYSOL_NO_CARD)
+            {
+                *(s++) = '-';
+            }
+            else
+            {
+                s = pysol_card_to_string(s, card);
+            }
+        }
+        *(s++) = '\n';
+    }
+    for (size_t col = 0; col < board->num_cols; ++col)
+    {
+        for (size_t i = 0; i < board->col_lens[col]; ++i)
+        {
+            if (i)
+            {
+                *(s++) = ' ';
+            }
+            s = pysol_card_to_string(s, board->cols[col][i]);
+        }
+        *(s++) = '\n';
+    }
+    *s = '\0';
+}
+
+// Enough for 52 cards and the foundations or freecells line.
+typedef char fcs_pysol_board_string[52 * 3 + 64];
+
+static inline void fc_solve_get_pysol_board(const fcs_pysol_game_type game,
+    const fcs_pysol_deals_type deals, const fc_solve_ms_deal_idx_type deal_idx,
+    char *const ret)
+{
+    fcs_pysol_card cards[52];
+    fc_solve_pysol_shuffle(deals, deal_idx, cards);
+    fcs_pysol_board board = {
+        .col_lens = {0}, .num_freecells = 0, .with_founds = false};
+    size_t card_idx = 0;
+#define NEXT() (cards[card_idx++])
+#define CYCLICAL_DEAL(num_cards, num_cols)                                     \
+    for (size_t i = 0; i < (num_cards); ++i)                                   \
+    {                                                                          \
+        pysol_board__add(&board, i % (num_cols), NEXT());                      \
+    }
+
+    switch (game)
+    {
+    case FCS_PYSOL_GAME_FREECELL:
+        board.num_cols = 8;
+        CYCLICAL_DEAL(52, 8);
+        break;
+
+    case FCS_PYSOL_GAME_FORECELL:
+    case FCS_PYSOL_GAME_EIGHT_OFF:
+        board.num_cols = 8;
+        CYCLICAL_DEAL(48, 8);
+        while (card_idx < 52)
+        {
+            board.freecells[board.num_freecells++] = NEXT();
+            if (game == FCS_PYSOL_GAME_EIGHT_OFF)
+            {
+                board.freecells[board.num_freecells++] = PYSOL_NO_CARD;
+            }
+        }
+        break;
+
+    case FCS_PYSOL_GAME_SEAHAVEN:
+        board.num_cols = 10;
+        board.freecells[board.num_freecells++] = PYSOL_NO_CARD;
+        CYCLICAL_DEAL(50, 10);
+        while (card_idx < 52)
+        {
+            board.freecells[board.num_freecells++] = NEXT();
+        }
+        break;
+
+    case FCS_PYSOL_GAME_BAKERS_DOZEN: {
+        // PySol's shuffle hook, which moves every king under the other
+        // cards of its column, works on the talon order.
+        fcs_pysol_card talon[52];
+        for (size_t i = 0; i < 52; ++i)
+        {
+            talon[i] = cards[51 - i];
+        }
+        for (size_t i = 0; i < 52; ++i)
+        {
+            if (PYSOL_RANK(talon[i]) != 12)
+            {
+                continue;
+            }
+            for (size_t j = i % 13; j < i; j += 13)
+            {
+                if (PYSOL_RANK(talon[j]) != 12)
+                {
+                    const fcs_pysol_card temp = talon[i];
+                    talon[i] = talon[j];
+                    talon[j] = temp;
+                    break;
+                }
+            }
+        }
+        memcpy(cards, talon, sizeof(cards));
+        board.num_cols = 13;
+        CYCLICAL_DEAL(52, 13);
+    }
+    break;
+
+    case FCS_PYSOL_GAME_SIMPLE_SIMON:
+        board.num_cols = 10;
+        for (size_t num_cards = 9; num_cards >= 3; --num_cards)
+        {
+            for (size_t col = 0; col < num_cards; ++col)
+            {
+                pysol_board__add(&board, col, NEXT());
+            }
+        }
+        CYCLICAL_DEAL(10, 10);
+        break;
+
+    case FCS_PYSOL_GAME_BELEAGUERED_CASTLE:
+    case FCS_PYSOL_GAME_CITADEL:
+    case FCS_PYSOL_GAME_STREETS_AND_ALLEYS: {
+        board.num_cols = 8;
+        size_t num_cards = 52;
+        if (game != FCS_PYSOL_GAME_STREETS_AND_ALLEYS)
+        {
+            // The aces start on the foundations.
+            board.with_founds = true;
+            num_cards = 0;
+            for (size_t i = 0; i < 52; ++i)
+            {
+                if (PYSOL_RANK(cards[i]) == 0)
+                {
+                    pysol_board__put_into_founds(&board, cards[i]);
+                }
+                else
+                {
+                    cards[num_cards++] = cards[i];
+                }
+            }
+        }
+        for (size_t row = 0; row < 6; ++row)
+        {
+            for (size_t col = 0; col < 8; ++col)
+            {
+                const fcs_pysol_card card = NEXT();
+                if (!((game == FCS_PYSOL_GAME_CITADEL) &&
+                        pysol_board__put_into_founds(&board, card)))
+                {
+                    pysol_board__add(&board, col, card);
+                }
+            }
+        }
+        const size_t num_left = num_cards - card_idx;
+        CYCLICAL_DEAL(num_left, 4);
+    }
+    break;
+
+    case FCS_PYSOL_GAME_FAN:
+        board.num_cols = 18;
+        CYCLICAL_DEAL(51, 17);
+        pysol_board__add(&board, 17, NEXT());
+        break;
+
+    case FCS_PYSOL_GAME_UNKNOWN:
+        break;
+    }
+#undef NEXT
+#undef CYCLICAL_DEAL
+    pysol_board__render(&board, ret);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -15,8 +15,8 @@
 #include "scans_impl.h"
 
 // GCC does not handle inline functions as well as macros.
-#define kv_calc_depth(ptr_state)                                               \
-    calc_depth(FCS_STATE_kv_to_collectible(ptr_state))
+#define kv_calc_depth(instance, ptr_state)                                     \
+    calc_depth(instance, FCS_STATE_kv_to_collectible(ptr_state))
 
 #ifdef FCS_RCS_STATES
 // TODO : Unit-test this function as it had had a bug beforehand
@@ -123,7 +123,8 @@ fcs_state *fc_solve_lookup_state_key_from_val(fcs_instance *const instance,
         new_cache_state->lower_pri = new_cache_state->higher_pri = NULL;
         ++cache->count_elements_in_cache;
 
-        if (!FCS_S_PARENT(parents_stack[parents_stack_len - 1].state_val))
+        if (!FCS_S_PARENT(
+                instance, parents_stack[parents_stack_len - 1].state_val))
         {
             new_cache_state->key = instance->state_copy.s;
             break;
@@ -131,7 +132,8 @@ fcs_state *fc_solve_lookup_state_key_from_val(fcs_instance *const instance,
         else
         {
             parents_stack[parents_stack_len].state_val =
-                FCS_S_PARENT(parents_stack[parents_stack_len - 1].state_val);
+                FCS_S_PARENT(instance,
+                    parents_stack[parents_stack_len - 1].state_val);
             if (++parents_stack_len == parents_stack_max_len)
             {
                 parents_stack_max_len += 16;
@@ -294,7 +296,9 @@ void fc_solve_soft_thread_init_befs_or_bfs(fcs_soft_thread *const soft_thread)
                              .moves_order.num;
              ++group_idx)
         {
-            add_to_move_funcs_list(&moves_list, &num,
+            add_to_move_funcs_list(
+                INSTANCE_MOVE_FUNCS(fcs_st_instance(soft_thread)), &moves_list,
+                &num,
                 soft_thread->by_depth_moves_order.by_depth_moves[0]
                     .moves_order.groups[group_idx]
                     .move_funcs,
@@ -335,7 +339,8 @@ static inline void befs__insert_derived_states(
 #endif
             fc_solve_pq_push(pqueue, scans_ptr_new_state,
                 befs_rate_state(soft_thread, WEIGHTING(soft_thread),
-                    new_pass.key, BEFS_MAX_DEPTH - kv_calc_depth(&(new_pass))));
+                    new_pass.key,
+                    BEFS_MAX_DEPTH - kv_calc_depth(instance, &(new_pass))));
         }
         else
         {
@@ -419,6 +424,12 @@ fc_solve_solve_process_ret_t fc_solve_befs_or_bfs_do_solve(
     const_SLOT(debug_iter_output_func, instance);
     const_SLOT(debug_iter_output_context, instance);
 #endif
+#ifndef FCS_WITHOUT_TRACE_RING
+    const_SLOT(trace_ring, instance);
+#endif
+#ifdef FCS_WITH_ENDGAME_TABLEBASE
+    const_AUTO(endgame_tablebase, fcs_instance_endgame_tablebase(instance));
+#endif
 
     int8_t *const befs_positions_by_rank =
         (BEFS_M_VAR(soft_thread, befs_positions_by_rank));
@@ -432,7 +443,7 @@ fc_solve_solve_process_ret_t fc_solve_befs_or_bfs_do_solve(
         // was suspended) and another time for the uninterrupted state.
         //
         // Therefore, we prune before checking for the visited flags.
-        if (fcs__should_state_be_pruned(enable_pruning, PTR_STATE))
+        if (fcs__should_state_be_pruned(instance, enable_pruning, PTR_STATE))
         {
             fcs_collectible_state *const after_pruning_state =
                 fc_solve_sfs_raymond_prune(soft_thread, pass);
@@ -442,7 +453,7 @@ fc_solve_solve_process_ret_t fc_solve_befs_or_bfs_do_solve(
             }
         }
 
-        register const int temp_visited = FCS_S_VISITED(PTR_STATE);
+        register const int temp_visited = FCS_S_VISITED(instance, PTR_STATE);
 
         // If this is an optimization scan and the state being checked is
         // not in the original solution path - move on to the next state
@@ -456,7 +467,7 @@ fc_solve_solve_process_ret_t fc_solve_befs_or_bfs_do_solve(
                 :
 #endif
                 ((temp_visited & FCS_VISITED_DEAD_END) ||
-                    (is_scan_visited(PTR_STATE, soft_thread_id))))
+                    (is_scan_visited(instance, PTR_STATE, soft_thread_id))))
         {
             goto next_state;
         }
@@ -476,18 +487,35 @@ fc_solve_solve_process_ret_t fc_solve_befs_or_bfs_do_solve(
         {
             debug_iter_output_func(debug_iter_output_context,
                 (fcs_int_limit_t) * (instance_num_checked_states_ptr),
-                calc_depth(PTR_STATE), (void *)instance, &pass,
+                calc_depth(instance, PTR_STATE), (void *)instance, &pass,
 #ifdef FCS_WITHOUT_VISITED_ITER
                 0
 #else
-                ((FCS_S_PARENT(PTR_STATE) == NULL)
+                ((FCS_S_PARENT(instance, PTR_STATE) == NULL)
                         ? 0
-                        : (fcs_int_limit_t)FCS_S_VISITED_ITER(
-                              FCS_S_PARENT(PTR_STATE)))
+                        : (fcs_int_limit_t)FCS_S_VISITED_ITER(instance,
+                              FCS_S_PARENT(instance, PTR_STATE)))
 #endif
             );
         }
 #endif
+#ifndef FCS_WITHOUT_TRACE_RING
+        if (trace_ring)
+        {
+            fc_solve_trace_ring_sample(trace_ring,
+                *(instance_num_checked_states_ptr),
+                calc_depth(instance, PTR_STATE),
+#ifdef FCS_WITHOUT_VISITED_ITER
+                0,
+#else
+                ((FCS_S_PARENT(instance, PTR_STATE) == NULL)
+                        ? 0
+                        : FCS_S_VISITED_ITER(
+                              instance, FCS_S_PARENT(instance, PTR_STATE))),
+#endif
+                PTR_STATE, (int)soft_thread_id);
+        }
+#endif
 
         const fcs_game_limit num_vacant_freecells = count_num_vacant_freecells(
             LOCAL_FREECELLS_NUM, &FCS_SCANS_the_state);
@@ -500,27 +528,50 @@ fc_solve_solve_process_ret_t fc_solve_befs_or_bfs_do_solve(
             error_code = FCS_STATE_WAS_SOLVED;
             goto my_return_label;
         }
+#ifdef FCS_WITH_ENDGAME_TABLEBASE
+        const int endgame_distance =
+            (endgame_tablebase
+                    ? fc_solve_etb_probe(
+                          endgame_tablebase, &FCS_SCANS_the_state)
+                    : FCS_ETB_NOT_APPLICABLE);
+        if (endgame_distance > 0)
+        {
+            // The rest of the solution is read from the tablebase by
+            // fc_solve_trace_solution().
+            BUMP_NUM_CHECKED_STATES();
+            error_code = FCS_STATE_WAS_SOLVED;
+            goto my_return_label;
+        }
+#endif
 
-        calculate_real_depth(calc_real_depth, PTR_STATE);
+        calculate_real_depth(instance, calc_real_depth, PTR_STATE);
 
         soft_thread->num_vacant_freecells = num_vacant_freecells;
         soft_thread->num_vacant_stacks = num_vacant_stacks;
-        fc_solve__calc_positions_by_rank_data(
-            soft_thread, &FCS_SCANS_the_state, befs_positions_by_rank);
+        fc_solve__calc_positions_by_rank_data(soft_thread,
+            &FCS_SCANS_the_state,
+            befs_positions_by_rank PASS_COLS_SEQ_BREAKS(
+                BEFS_M_VAR(soft_thread, befs_cols_seq_breaks)));
 
         TRACE0("perform_moves");
         // Do all the tests at one go, because that is the way it should be
         // done for BFS and BeFS.
         derived.num_states = 0;
-        for (const fcs_move_func *move_func_ptr = moves_list;
-             move_func_ptr < moves_list_end; move_func_ptr++)
+#ifdef FCS_WITH_ENDGAME_TABLEBASE
+        // A loss according to the tablebase has no moves worth trying.
+        if (endgame_distance != FCS_ETB_LOSS)
+#endif
         {
-            move_func_ptr->f(soft_thread, pass, &derived);
+            for (const fcs_move_func *move_func_ptr = moves_list;
+                 move_func_ptr < moves_list_end; move_func_ptr++)
+            {
+                move_func_ptr->f(soft_thread, pass, &derived);
+            }
         }
 
         if (is_a_complete_scan)
         {
-            FCS_S_VISITED(PTR_STATE) |= FCS_VISITED_ALL_TESTS_DONE;
+            FCS_S_VISITED(instance, PTR_STATE) |= FCS_VISITED_ALL_TESTS_DONE;
         }
 
         BUMP_NUM_CHECKED_STATES();
@@ -530,24 +581,25 @@ fc_solve_solve_process_ret_t fc_solve_befs_or_bfs_do_solve(
 #ifdef FCS_WITH_MOVES
         if (is_optimize_scan)
         {
-            FCS_S_VISITED(PTR_STATE) |= FCS_VISITED_IN_OPTIMIZED_PATH;
+            FCS_S_VISITED(instance, PTR_STATE) |= FCS_VISITED_IN_OPTIMIZED_PATH;
         }
         else
 #endif
         {
-            set_scan_visited(PTR_STATE, soft_thread_id);
+            set_scan_visited(instance, PTR_STATE, soft_thread_id);
 
             if (derived.num_states == 0)
             {
                 if (is_a_complete_scan)
                 {
-                    MARK_AS_DEAD_END(PTR_STATE);
+                    MARK_AS_DEAD_END(instance, PTR_STATE);
                 }
             }
         }
 
 #ifndef FCS_WITHOUT_VISITED_ITER
-        FCS_S_VISITED_ITER(PTR_STATE) = *(instance_num_checked_states_ptr)-1;
+        FCS_S_VISITED_ITER(instance, PTR_STATE) =
+            *(instance_num_checked_states_ptr)-1;
 #endif
 
     next_state:
@@ -598,12 +650,19 @@ int fc_solve_sfs_check_state_begin(fcs_hard_thread *const hard_thread,
     fcs_collectible_state *raw_ptr_new_state;
     fcs_instance *const instance = HT_INSTANCE(hard_thread);
 
-    if ((HT_FIELD(hard_thread, allocated_from_list) =
-                (instance->list_of_vacant_states != NULL)))
+#ifdef FCS_RECONSTRUCT_MOVES
+    if (unlikely(HT_FIELD(hard_thread, reconstruction_target) != NULL))
+    {
+        raw_ptr_new_state = &(HT_FIELD(hard_thread, reconstruction_state));
+    }
+    else
+#endif
+        if ((HT_FIELD(hard_thread, allocated_from_list) =
+                    (instance->list_of_vacant_states != NULL)))
     {
         raw_ptr_new_state = instance->list_of_vacant_states;
         instance->list_of_vacant_states =
-            FCS_S_NEXT(instance->list_of_vacant_states);
+            FCS_S_NEXT(instance, instance->list_of_vacant_states);
     }
     else
     {
@@ -612,46 +671,105 @@ int fc_solve_sfs_check_state_begin(fcs_hard_thread *const hard_thread,
     }
 
     FCS_STATE_collectible_to_kv(out_new_state_out, raw_ptr_new_state);
-    fcs_duplicate_kv_state(out_new_state_out, &raw_state_raw);
+    // Only the key is derived before the collection is probed. The extra info
+    // (and, with the side tables, the id) is filled in by
+    // init_derived_state_info() if the state turns out to be new.
+    *(out_new_state_out->key) = *(raw_state_raw.key);
+    fcs_duplicate_state_extra(*(out_new_state_out->val));
+    fcs_move_stack_reset(moves);
+
+    return 0;
+}
+
 #ifdef FCS_RCS_STATES
 #define INFO_STATE_PTR(kv_ptr) ((kv_ptr)->val)
 #else
 // TODO : That's very hacky - get rid of it.
 #define INFO_STATE_PTR(kv_ptr) ((fcs_state_keyval_pair *)((kv_ptr)->key))
 #endif
-    // Some BeFS and BFS parameters that need to be initialized in
-    // the derived state.
-    FCS_S_PARENT(raw_ptr_new_state) = INFO_STATE_PTR(&raw_state_raw);
-#ifdef FCS_WITH_MOVES
-    FCS_S_MOVES_TO_PARENT(raw_ptr_new_state) = moves;
+
+// Fills in the extra info of a derived state that was added to the
+// collection, and counts it as an active child of its parent.
+static inline void init_derived_state_info(fcs_hard_thread *const hard_thread,
+    fcs_kv_state *const raw_state_raw,
+    fcs_kv_state *const raw_ptr_new_state_raw FCS__pass_moves(
+        fcs_move_stack *const moves GCC_UNUSED))
+{
+    fcs_instance *const instance GCC_UNUSED = HT_INSTANCE(hard_thread);
+    fcs_collectible_state *const new_state =
+        FCS_STATE_kv_to_collectible(raw_ptr_new_state_raw);
+    fcs_collectible_state *const parent =
+        FCS_STATE_kv_to_collectible(raw_state_raw);
+#ifdef FCS_WITH_STATE_SIDE_TABLES
+    // A slot from the list of vacant states keeps its id.
+    if (!HT_FIELD(hard_thread, allocated_from_list))
+    {
+        FCS_S_ACCESSOR(new_state, id) =
+            fc_solve_state_side_tables_new_id(&(instance->state_side_tables));
+    }
+#endif
+    FCS_S_PARENT(instance, new_state) = INFO_STATE_PTR(raw_state_raw);
+#ifdef FCS_WITH_MOVES_TO_PARENT
+    FCS_S_MOVES_TO_PARENT(instance, new_state) =
+        fc_solve_move_stack_compact_allocate(hard_thread, moves);
 #endif
 // Make sure depth is consistent with the game graph.
 // I.e: the depth of every newly discovered state is derived from
 // the state from which it was discovered.
 #ifdef FCS_WITH_DEPTH_FIELD
-    (FCS_S_DEPTH(raw_ptr_new_state))++;
+    FCS_S_DEPTH(instance, new_state) = FCS_S_DEPTH(instance, parent) + 1;
+#endif
+#ifndef FCS_WITHOUT_VISITED_ITER
+    FCS_S_VISITED_ITER(instance, new_state) =
+        FCS_S_VISITED_ITER(instance, parent);
 #endif
     // Mark this state as a state that was not yet visited
-    FCS_S_VISITED(raw_ptr_new_state) = 0;
+    FCS_S_VISITED(instance, new_state) = 0;
     // It's a newly created state which does not have children yet.
-    FCS_S_NUM_ACTIVE_CHILDREN(raw_ptr_new_state) = 0;
-    memset(&(FCS_S_SCAN_VISITED(raw_ptr_new_state)), '\0',
-        sizeof(FCS_S_SCAN_VISITED(raw_ptr_new_state)));
-    fcs_move_stack_reset(moves);
+    FCS_S_NUM_ACTIVE_CHILDREN(instance, new_state) = 0;
+    memset(&(FCS_S_SCAN_VISITED(instance, new_state)), '\0',
+        sizeof(FCS_S_SCAN_VISITED(instance, new_state)));
+    ++FCS_S_NUM_ACTIVE_CHILDREN(instance, parent);
+}
 
-    return 0;
+#ifdef FCS_RECONSTRUCT_MOVES
+// Keeps the moves to the derived state if it is the reconstruction target,
+// and no moves to it were found yet. The scans keep the moves of the first
+// derivation of a state as well, so the solution comes out the same as when
+// the moves are stored.
+static inline void reconstruct_moves(fcs_hard_thread *const hard_thread,
+    fcs_kv_state *const new_state, const fcs_move_stack *const moves)
+{
+    fcs_instance *const instance = HT_INSTANCE(hard_thread);
+    fc_solve_canonize_state(new_state->key PASS_FREECELLS(
+        INSTANCE_FREECELLS_NUM) PASS_STACKS(INSTANCE_STACKS_NUM));
+    if (!fc_solve_state_is_equal(
+            new_state->key, HT_FIELD(hard_thread, reconstruction_target)))
+    {
+        return;
+    }
+    fcs_move_stack *const reconstructed_moves =
+        HT_FIELD(hard_thread, reconstructed_moves);
+    if (HT_FIELD(hard_thread, was_reconstructed))
+    {
+        return;
+    }
+    HT_FIELD(hard_thread, was_reconstructed) = true;
+    fcs_move_stack_reset(reconstructed_moves);
+    for (size_t i = 0; i < moves->num_moves; ++i)
+    {
+        fcs_move_stack_push(reconstructed_moves, moves->moves[i]);
+    }
 }
+#endif
 
 extern fcs_collectible_state *fc_solve_sfs_check_state_end(
-    fcs_soft_thread *const soft_thread,
-#ifndef FCS_HARD_CODE_REPARENT_STATES_AS_FALSE
-    fcs_kv_state raw_state_raw,
-#endif
+    fcs_soft_thread *const soft_thread, fcs_kv_state raw_state_raw,
     fcs_kv_state *const raw_ptr_new_state_raw FCS__pass_moves(
-        fcs_move_stack *const moves GCC_UNUSED))
+        fcs_move_stack *const moves))
 {
     const_SLOT(hard_thread, soft_thread);
-    const_AUTO(instance, HT_INSTANCE(hard_thread));
+    fcs_instance *const instance GCC_UNUSED = HT_INSTANCE(hard_thread);
 #if defined(FCS_WITH_DEPTH_FIELD) &&                                           \
     !defined(FCS_HARD_CODE_CALC_REAL_DEPTH_AS_FALSE)
     const bool calc_real_depth = fcs_get_calc_real_depth(instance);
@@ -665,12 +783,20 @@ extern fcs_collectible_state *fc_solve_sfs_check_state_end(
 
 #define ptr_new_state_foo (raw_ptr_new_state_raw->val)
 
+#ifdef FCS_RECONSTRUCT_MOVES
+    if (unlikely(HT_FIELD(hard_thread, reconstruction_target) != NULL))
+    {
+        reconstruct_moves(hard_thread, raw_ptr_new_state_raw, moves);
+        return INFO_STATE_PTR(raw_ptr_new_state_raw);
+    }
+#endif
     if (!fc_solve_check_and_add_state(
             hard_thread, raw_ptr_new_state_raw, &existing_state))
     {
         if (HT_FIELD(hard_thread, allocated_from_list))
         {
-            ptr_new_state_foo->parent = instance->list_of_vacant_states;
+            FCS_S_NEXT(instance, INFO_STATE_PTR(raw_ptr_new_state_raw)) =
+                instance->list_of_vacant_states;
             instance->list_of_vacant_states =
                 INFO_STATE_PTR(raw_ptr_new_state_raw);
         }
@@ -680,8 +806,8 @@ extern fcs_collectible_state *fc_solve_sfs_check_state_end(
         }
 
 #ifdef FCS_WITH_DEPTH_FIELD
-        calculate_real_depth(
-            calc_real_depth, FCS_STATE_kv_to_collectible(&existing_state));
+        calculate_real_depth(instance, calc_real_depth,
+            FCS_STATE_kv_to_collectible(&existing_state));
 #endif
 
 // Re-parent the existing state to this one.
@@ -690,28 +816,33 @@ extern fcs_collectible_state *fc_solve_sfs_check_state_end(
 // can be reached from this one is lower than what it
 // already have, then re-assign its parent to this state.
 #ifndef FCS_HARD_CODE_REPARENT_STATES_AS_FALSE
-#define ptr_state (raw_state_raw.val)
         if (STRUCT_QUERY_FLAG(instance, FCS_RUNTIME_TO_REPARENT_STATES_REAL) &&
-            (kv_calc_depth(&existing_state) >
-                kv_calc_depth(&raw_state_raw) + 1))
+            (kv_calc_depth(instance, &existing_state) >
+                kv_calc_depth(instance, &raw_state_raw) + 1))
         {
-#ifdef FCS_WITH_MOVES
+            fcs_collectible_state *const existing =
+                FCS_STATE_kv_to_collectible(&existing_state);
+            fcs_collectible_state *const ptr_state =
+                FCS_STATE_kv_to_collectible(&raw_state_raw);
+#ifdef FCS_WITH_MOVES_TO_PARENT
             // Make a copy of "moves" because "moves" will be destroyed
-            existing_state.val->moves_to_parent =
+            FCS_S_MOVES_TO_PARENT(instance, existing) =
                 fc_solve_move_stack_compact_allocate(hard_thread, moves);
 #endif
-            if (!(existing_state.val->visited & FCS_VISITED_DEAD_END))
+            if (!(FCS_S_VISITED(instance, existing) & FCS_VISITED_DEAD_END))
             {
                 if ((--(FCS_S_NUM_ACTIVE_CHILDREN(
-                        existing_state.val->parent))) == 0)
+                        instance, FCS_S_PARENT(instance, existing)))) == 0)
                 {
-                    MARK_AS_DEAD_END(existing_state.val->parent);
+                    MARK_AS_DEAD_END(
+                        instance, FCS_S_PARENT(instance, existing));
                 }
-                ptr_state->num_active_children++;
+                ++FCS_S_NUM_ACTIVE_CHILDREN(instance, ptr_state);
             }
-            existing_state.val->parent = INFO_STATE_PTR(&raw_state_raw);
+            FCS_S_PARENT(instance, existing) = INFO_STATE_PTR(&raw_state_raw);
 #ifdef FCS_WITH_DEPTH_FIELD
-            existing_state.val->depth = ptr_state->depth + 1;
+            FCS_S_DEPTH(instance, existing) =
+                FCS_S_DEPTH(instance, ptr_state) + 1;
 #endif
         }
 #endif
@@ -719,6 +850,8 @@ extern fcs_collectible_state *fc_solve_sfs_check_state_end(
     }
     else
     {
+        init_derived_state_info(hard_thread, &raw_state_raw,
+            raw_ptr_new_state_raw FCS__pass_moves(moves));
         return INFO_STATE_PTR(raw_ptr_new_state_raw);
     }
 }
@@ -38,10 +38,80 @@ static inline void fc_solve__assign_dest_stack_and_col_ptr(
     *(ptr) = dest_col;
 }
 
+#ifdef FCS_WITH_COLS_SEQ_BREAKS
+#define FCS_COL_SEQ_BREAK(idx) (((fcs_col_seq_breaks)1) << (idx))
+#endif
+
+// Adds the positions of the cards of a single column that are not followed
+// by one of their children (i.e: the ends of its sequences), and returns
+// them as an fcs_col_seq_breaks mask.
+static inline fcs_col_seq_breaks fc_solve__calc_positions_by_rank_col(
+    int8_t *const positions_by_rank, const fcs_const_cards_column dest_col,
+    const int8_t ds PASS_ON_NOT_FC_ONLY(const int sequences_are_built_by))
+{
+    fcs_col_seq_breaks seq_breaks = 0;
+    int top_card_idx = fcs_col_len(dest_col);
+
+    if (unlikely((top_card_idx--) == 0))
+    {
+        return seq_breaks;
+    }
+
+    fcs_card dest_card;
+    {
+        fcs_card dest_below_card;
+        dest_card = fcs_col_get_card(dest_col, 0);
+        for (int dc = 0; dc < top_card_idx; dc++, dest_card = dest_below_card)
+        {
+            dest_below_card = fcs_col_get_card(dest_col, dc + 1);
+            if (!fcs_is_parent_card(dest_below_card, dest_card))
+            {
+                fc_solve__assign_dest_stack_and_col_ptr(
+                    positions_by_rank, ds, (int8_t)dc, dest_card);
+#ifdef FCS_WITH_COLS_SEQ_BREAKS
+                seq_breaks |= FCS_COL_SEQ_BREAK(dc);
+#endif
+            }
+        }
+    }
+    fc_solve__assign_dest_stack_and_col_ptr(
+        positions_by_rank, ds, (int8_t)top_card_idx, dest_card);
+#ifdef FCS_WITH_COLS_SEQ_BREAKS
+    seq_breaks |= FCS_COL_SEQ_BREAK(top_card_idx);
+#endif
+
+    return seq_breaks;
+}
+
+#ifdef FCS_WITH_COLS_SEQ_BREAKS
+static inline fcs_col_seq_breaks fc_solve__calc_col_seq_breaks(
+    const fcs_const_cards_column col PASS_ON_NOT_FC_ONLY(
+        const int sequences_are_built_by))
+{
+    const int top_card_idx = fcs_col_len(col) - 1;
+    if (top_card_idx < 0)
+    {
+        return 0;
+    }
+    fcs_col_seq_breaks seq_breaks = FCS_COL_SEQ_BREAK(top_card_idx);
+    for (int dc = 0; dc < top_card_idx; dc++)
+    {
+        if (!fcs_is_parent_card(
+                fcs_col_get_card(col, dc + 1), fcs_col_get_card(col, dc)))
+        {
+            seq_breaks |= FCS_COL_SEQ_BREAK(dc);
+        }
+    }
+
+    return seq_breaks;
+}
+#endif
+
 static inline void fc_solve__calc_positions_by_rank_data(
     fcs_soft_thread *const soft_thread GCC_UNUSED,
     const fcs_state *const ptr_state_key,
-    fcs__positions_by_rank positions_by_rank)
+    fcs__positions_by_rank positions_by_rank PASS_COLS_SEQ_BREAKS(
+        fcs__cols_seq_breaks cols_seq_breaks))
 {
 #ifndef HARD_CODED_ALL
     var_AUTO(instance, fcs_st_instance(soft_thread));
@@ -69,6 +139,11 @@ static inline void fc_solve__calc_positions_by_rank_data(
                 p_by_r[FCS_POS_IDX(rank, suit)] =
                     (fcs_pos_by_rank){.col = (int8_t)ds, .height = (int8_t)dc};
             }
+#ifdef FCS_WITH_COLS_SEQ_BREAKS
+            cols_seq_breaks[ds] = fc_solve__calc_col_seq_breaks(
+                dest_col PASS_ON_NOT_FC_ONLY(
+                    GET_INSTANCE_SEQUENCES_ARE_BUILT_BY(instance)));
+#endif
         }
     }
     else
@@ -90,37 +165,118 @@ static inline void fc_solve__calc_positions_by_rank_data(
         // indices looking for the cards and filling them.
         for (int ds = 0; ds < LOCAL_STACKS_NUM; ds++)
         {
-            const_AUTO(dest_col, fcs_state_get_col(state_key, ds));
-            int top_card_idx = fcs_col_len(dest_col);
+#ifdef FCS_WITH_COLS_SEQ_BREAKS
+            cols_seq_breaks[ds] =
+#endif
+                fc_solve__calc_positions_by_rank_col(positions_by_rank,
+                    fcs_state_get_col(state_key, ds),
+                    (int8_t)ds PASS_ON_NOT_FC_ONLY(sequences_are_built_by));
+        }
+    }
+#undef state_key
+#undef ptr_state_key
+}
 
-            if (unlikely((top_card_idx--) == 0))
+#ifndef FCS_RCS_STATES
+// Calculates the positions (and the sequence breaks) of a state from those
+// of its parent, which were calculated when the parent was expanded. A move
+// only changes a few columns, and the canonization merely reorders the
+// rest, so only the columns that are not found in the parent need to be
+// scanned.
+//
+// Only the one-deck variants that keep the ends of the sequences are
+// handled here, because with more decks the slots of a card form a
+// -1-terminated list that the remapping would leave with holes.
+static inline void fc_solve__derive_positions_by_rank_data(
+    fcs_soft_thread *const soft_thread GCC_UNUSED,
+    const fcs_state *const parent_state_key,
+    const fcs__positions_by_rank parent_positions_by_rank,
+    const fcs_state *const ptr_state_key,
+    fcs__positions_by_rank positions_by_rank PASS_COLS_SEQ_BREAKS(
+        const fcs__cols_seq_breaks parent_cols_seq_breaks)
+        PASS_COLS_SEQ_BREAKS(fcs__cols_seq_breaks cols_seq_breaks))
+{
+#ifndef HARD_CODED_ALL
+    var_AUTO(instance, fcs_st_instance(soft_thread));
+    SET_GAME_PARAMS();
+#endif
+    if (
+#ifndef FCS_DISABLE_SIMPLE_SIMON
+        instance->is_simple_simon ||
+#endif
+        (LOCAL_DECKS_NUM != 1))
+    {
+        fc_solve__calc_positions_by_rank_data(soft_thread, ptr_state_key,
+            positions_by_rank PASS_COLS_SEQ_BREAKS(cols_seq_breaks));
+        return;
+    }
+    FCS_ON_NOT_FC_ONLY(const int sequences_are_built_by =
+                           GET_INSTANCE_SEQUENCES_ARE_BUILT_BY(instance));
+
+    // col_map[parent_col] is the column of the state that has the same
+    // cards, or -1.
+    int8_t col_map[MAX_NUM_STACKS];
+    bool is_new_col[MAX_NUM_STACKS];
+    memset(col_map, -1, sizeof(col_map));
+    for (int ds = 0; ds < LOCAL_STACKS_NUM; ds++)
+    {
+        const_AUTO(col, fcs_state_get_col(*ptr_state_key, ds));
+#ifdef FCS_WITH_COLS_SEQ_BREAKS
+        cols_seq_breaks[ds] = 0;
+#endif
+        if (!(is_new_col[ds] = (fcs_col_len(col) != 0)))
+        {
+            continue;
+        }
+        for (int ps = 0; ps < LOCAL_STACKS_NUM; ps++)
+        {
+            if (col_map[ps] >= 0)
             {
                 continue;
             }
-
-            fcs_card dest_card;
+            const_AUTO(parent_col, fcs_state_get_col(*parent_state_key, ps));
+#ifdef INDIRECT_STACK_STATES
+            // The columns of the collected states are cached, so equal
+            // columns share the same pointer.
+            if (col == parent_col)
+#else
+            if (!memcmp(col, parent_col, (size_t)fcs_col_len(col) + 1))
+#endif
             {
-                fcs_card dest_below_card;
-                dest_card = fcs_col_get_card(dest_col, 0);
-                for (int dc = 0; dc < top_card_idx;
-                     dc++, dest_card = dest_below_card)
-                {
-                    dest_below_card = fcs_col_get_card(dest_col, dc + 1);
-                    if (!fcs_is_parent_card(dest_below_card, dest_card))
-                    {
-                        fc_solve__assign_dest_stack_and_col_ptr(
-                            positions_by_rank, (int8_t)ds, (int8_t)dc,
-                            dest_card);
-                    }
-                }
+                col_map[ps] = (int8_t)ds;
+                is_new_col[ds] = false;
+#ifdef FCS_WITH_COLS_SEQ_BREAKS
+                cols_seq_breaks[ds] = parent_cols_seq_breaks[ps];
+#endif
+                break;
             }
-            fc_solve__assign_dest_stack_and_col_ptr(
-                positions_by_rank, (int8_t)ds, (int8_t)top_card_idx, dest_card);
         }
     }
-#undef state_key
-#undef ptr_state_key
+
+    memset(positions_by_rank, -1, sizeof(fcs__positions_by_rank));
+    for (size_t i = 0; i < FCS_POS_BY_RANK_LEN; i += 2)
+    {
+        const int8_t ps = parent_positions_by_rank[i];
+        if ((ps >= 0) && (col_map[ps] >= 0))
+        {
+            positions_by_rank[i] = col_map[ps];
+            positions_by_rank[i + 1] = parent_positions_by_rank[i + 1];
+        }
+    }
+    for (int ds = 0; ds < LOCAL_STACKS_NUM; ds++)
+    {
+        if (is_new_col[ds])
+        {
+#ifdef FCS_WITH_COLS_SEQ_BREAKS
+            cols_seq_breaks[ds] =
+#endif
+                fc_solve__calc_positions_by_rank_col(positions_by_rank,
+                    fcs_state_get_col(*ptr_state_key, ds),
+                    (int8_t)ds PASS_ON_NOT_FC_ONLY(sequences_are_built_by));
+        }
+    }
 }
+#endif
 
 static inline const int8_t *fc_solve_calc_positions_by_rank_location(
     fcs_soft_thread *const soft_thread)
@@ -136,8 +292,25 @@ static inline const int8_t *fc_solve_calc_positions_by_rank_location(
     }
 }
 
+#ifdef FCS_WITH_COLS_SEQ_BREAKS
+static inline const fcs_col_seq_breaks *fc_solve_calc_cols_seq_breaks_location(
+    fcs_soft_thread *const soft_thread)
+{
+    if (soft_thread->super_method_type == FCS_SUPER_METHOD_DFS)
+    {
+        return (DFS_VAR(soft_thread, soft_dfs_info)[DFS_VAR(soft_thread, depth)]
+                    .cols_seq_breaks);
+    }
+    else
+    {
+        return (BEFS_M_VAR(soft_thread, befs_cols_seq_breaks));
+    }
+}
+#endif
+
 #ifndef FCS_ZERO_FREECELLS_MODE
 static inline void add_to_move_funcs_list(
+    const fc_solve_solve_for_state_move_func *const move_funcs,
     fcs_move_func **const out_move_funcs_list, size_t *const num_so_far,
     const fcs_move_func *const indexes, const size_t count_to_add)
 {
@@ -146,7 +319,7 @@ static inline void add_to_move_funcs_list(
         SREALLOC(*out_move_funcs_list, num + count_to_add);
     for (size_t i = 0; i < count_to_add; ++i)
     {
-        move_funcs_list[num++].f = fc_solve_sfs_move_funcs[indexes[i].idx];
+        move_funcs_list[num++].f = move_funcs[indexes[i].idx];
     }
 
     *out_move_funcs_list = move_funcs_list;
@@ -159,10 +332,7 @@ extern int fc_solve_sfs_check_state_begin(fcs_hard_thread *const,
     fcs_kv_state SFS__PASS_MOVE_STACK(fcs_move_stack *const));
 
 extern fcs_collectible_state *fc_solve_sfs_check_state_end(fcs_soft_thread *,
-#ifndef FCS_HARD_CODE_REPARENT_STATES_AS_FALSE
-    fcs_kv_state,
-#endif
-    fcs_kv_state *FCS__pass_moves(fcs_move_stack *));
+    fcs_kv_state, fcs_kv_state *FCS__pass_moves(fcs_move_stack *));
 
 #ifdef FCS_WITH_MOVES
 #define FCS_SET_final_state() instance->final_state = PTR_STATE
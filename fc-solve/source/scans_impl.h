@@ -27,11 +27,21 @@ extern "C" {
            effective_max_num_states_in_collection)
 #endif
 
+#ifdef FCS_WITHOUT_MAX_NUM_STATES
+#define check_if_limits_exceeded__stop_request()
+#else
+#define check_if_limits_exceeded__stop_request()                               \
+    || (unlikely(!((*instance_num_checked_states_ptr) &                        \
+                   FCS_STOP_REQUEST_CHECK_MASK)) &&                            \
+           fcs_instance_is_stop_requested(instance))
+#endif
+
 // This macro checks if we need to terminate from running this soft
 // thread and return to the soft thread manager with an
 // FCS_STATE_SUSPEND_PROCESS
 #define check_if_limits_exceeded()                                             \
-    (check_if_limits_exceeded__num() check_if_limits_exceeded__num_states())
+    (check_if_limits_exceeded__num() check_if_limits_exceeded__num_states()    \
+            check_if_limits_exceeded__stop_request())
 
 #define BEFS_MAX_DEPTH 20000
 
@@ -112,16 +122,17 @@ static inline void fc_solve_initialize_befs_rater(
 
 typedef int fcs_depth;
 
-static inline fcs_depth calc_depth(fcs_collectible_state *ptr_state GCC_UNUSED)
+static inline fcs_depth calc_depth(fcs_instance *const instance GCC_UNUSED,
+    fcs_collectible_state *ptr_state GCC_UNUSED)
 {
 #ifdef FCS_WITH_DEPTH_FIELD
-    return (FCS_S_DEPTH(ptr_state));
+    return (FCS_S_DEPTH(instance, ptr_state));
 #else
 #ifdef FCS_HARD_CODE_STATE_DEPTH_FIELD
     return 0;
 #else
     register fcs_depth ret = 0;
-    while ((ptr_state = FCS_S_PARENT(ptr_state)) != NULL)
+    while ((ptr_state = FCS_S_PARENT(instance, ptr_state)) != NULL)
     {
         ++ret;
     }
@@ -321,7 +332,7 @@ static inline pq_rating befs_rate_state(
 // up to the original state, and thus calculates its real depth.
 //
 // It then assigns the newly updated depth throughout the path.
-static inline void calculate_real_depth(
+static inline void calculate_real_depth(fcs_instance *const instance GCC_UNUSED,
     const bool calc_real_depth, fcs_collectible_state *const ptr_state_orig)
 {
     if (calc_real_depth)
@@ -331,64 +342,66 @@ static inline void calculate_real_depth(
         // Count the number of states until the original state.
         while (temp_state != NULL)
         {
-            temp_state = FCS_S_PARENT(temp_state);
+            temp_state = FCS_S_PARENT(instance, temp_state);
             ++this_real_depth;
         }
         temp_state = ptr_state_orig;
         // Assign the new depth throughout the path
-        while (FCS_S_DEPTH(temp_state) != this_real_depth)
+        while (FCS_S_DEPTH(instance, temp_state) != this_real_depth)
         {
-            FCS_S_DEPTH(temp_state) = (int)this_real_depth;
+            FCS_S_DEPTH(instance, temp_state) = (int)this_real_depth;
             --this_real_depth;
-            temp_state = FCS_S_PARENT(temp_state);
+            temp_state = FCS_S_PARENT(instance, temp_state);
         }
     }
 }
 #else
-#define calculate_real_depth(calc_real_depth, ptr_state_orig)
+#define calculate_real_depth(instance, calc_real_depth, ptr_state_orig)
 #endif
 
 // The mark_as_dead_end() inline function marks a state as a dead end, and
 // afterwards propagates this information to its parent and ancestor states.
 static inline void mark_as_dead_end__proto(
+    fcs_instance *const instance GCC_UNUSED,
     fcs_collectible_state *const ptr_state_input)
 {
     fcs_collectible_state *temp_state = (ptr_state_input);
     // Mark as a dead end
-    FCS_S_VISITED(temp_state) |= FCS_VISITED_DEAD_END;
-    temp_state = FCS_S_PARENT(temp_state);
+    FCS_S_VISITED(instance, temp_state) |= FCS_VISITED_DEAD_END;
+    temp_state = FCS_S_PARENT(instance, temp_state);
     if (temp_state != NULL)
     {
         // Decrease the refcount of the state
-        --(FCS_S_NUM_ACTIVE_CHILDREN(temp_state));
-        while ((FCS_S_NUM_ACTIVE_CHILDREN(temp_state) == 0) &&
-               (FCS_S_VISITED(temp_state) & FCS_VISITED_ALL_TESTS_DONE))
+        --(FCS_S_NUM_ACTIVE_CHILDREN(instance, temp_state));
+        while ((FCS_S_NUM_ACTIVE_CHILDREN(instance, temp_state) == 0) &&
+               (FCS_S_VISITED(instance, temp_state) &
+                   FCS_VISITED_ALL_TESTS_DONE))
         {
             // Mark as dead end
-            FCS_S_VISITED(temp_state) |= FCS_VISITED_DEAD_END;
+            FCS_S_VISITED(instance, temp_state) |= FCS_VISITED_DEAD_END;
             // Go to its parent state
-            temp_state = FCS_S_PARENT(temp_state);
+            temp_state = FCS_S_PARENT(instance, temp_state);
             if (!temp_state)
             {
                 break;
             }
             // Decrease the refcount
-            (FCS_S_NUM_ACTIVE_CHILDREN(temp_state))--;
+            (FCS_S_NUM_ACTIVE_CHILDREN(instance, temp_state))--;
         }
     }
 }
 
 #ifdef FCS_HARD_CODE_SCANS_SYNERGY_AS_TRUE
-#define MARK_AS_DEAD_END(state)                                                \
+#define MARK_AS_DEAD_END(instance, state)                                      \
     {                                                                          \
-        mark_as_dead_end__proto(state);                                        \
+        mark_as_dead_end__proto(instance, state);                              \
     }
 #else
-#define MARK_AS_DEAD_END(state)                                                \
+#define MARK_AS_DEAD_END(instance, state)                                      \
     {                                                                          \
         if (scans_synergy)                                                     \
         {                                                                      \
-            mark_as_dead_end__proto(state);                                    \
+            mark_as_dead_end__proto(instance, state);                          \
         }                                                                      \
     }
 #endif
@@ -418,19 +431,22 @@ static inline fcs_game_limit count_num_vacant_stacks(
 }
 
 static inline bool fcs__should_state_be_pruned__state(
+    fcs_instance *const instance GCC_UNUSED,
     const fcs_collectible_state *const ptr_state)
 {
-    return (!(FCS_S_VISITED(ptr_state) & FCS_VISITED_GENERATED_BY_PRUNING));
+    return (!(FCS_S_VISITED(instance, ptr_state) &
+              FCS_VISITED_GENERATED_BY_PRUNING));
 }
 
 #ifdef FCS_ENABLE_PRUNE__R_TF__UNCOND
-#define fcs__should_state_be_pruned(enable_pruning, ptr_state)                 \
-    fcs__should_state_be_pruned__state(ptr_state)
+#define fcs__should_state_be_pruned(instance, enable_pruning, ptr_state)       \
+    fcs__should_state_be_pruned__state(instance, ptr_state)
 #else
-static inline bool fcs__should_state_be_pruned(
+static inline bool fcs__should_state_be_pruned(fcs_instance *const instance,
     const bool enable_pruning, const fcs_collectible_state *const ptr_state)
 {
-    return (enable_pruning && fcs__should_state_be_pruned__state(ptr_state));
+    return (enable_pruning &&
+            fcs__should_state_be_pruned__state(instance, ptr_state));
 }
 #endif
 
@@ -17,6 +17,27 @@ my $aliases_decl =
 my $GEN =
     "// This file is generated by gen-move-funcs.pl.\n// Do not edit by hand!";
 
+sub func_name
+{
+    my ( $f, $wrap_plain ) = @_;
+    my $s = "fc_solve_sfs_$f";
+    return
+          $f =~ /simple_simon/  ? "WRAP_SIMPSIM($s)"
+        : $f =~ /freecell|_fc_/ ? "WRAP_ZEROFC($s)"
+        :                         $wrap_plain->($s);
+}
+
+# The same table as an X-macro, so that the tables of the specialized move
+# functions (see specialized_moves.h) can be laid out in the same order.
+my $move_funcs_list_string = join(
+    ", \\\n",
+    (
+        map {
+            "    " . func_name( $_->{'function'}, sub { "WRAP_PLAIN($_[0])" } )
+        } @$move_funcs
+    )
+);
+
 path('move_funcs_maps.h')->spew_utf8(<<"EOF");
 $GEN
 #pragma once
@@ -27,20 +48,14 @@ typedef uint8_t fcs_move_func_aliases_mapping;
 
 extern $move_funcs_decl;
 extern $aliases_decl;
-EOF
 
-sub func_name
-{
-    my $f = shift;
-    my $s = "fc_solve_sfs_$f";
-    return
-          $f =~ /simple_simon/  ? "WRAP_SIMPSIM($s)"
-        : $f =~ /freecell|_fc_/ ? "WRAP_ZEROFC($s)"
-        :                         $s;
-}
+#define FCS_MOVE_FUNCS_LIST(WRAP_PLAIN, WRAP_ZEROFC, WRAP_SIMPSIM) \\
+$move_funcs_list_string
+EOF
 
 my $move_funcs_string = join( ",\n",
-    ( map { "    " . func_name( $_->{'function'} ) } @$move_funcs ) );
+    ( map { "    " . func_name( $_->{'function'}, sub { $_[0] } ) } @$move_funcs )
+);
 my $aliases_string = join(
     ',',
     map {
@@ -0,0 +1,653 @@
+// This file is part of Freecell Solver. It is subject to the license terms in
+// the COPYING.txt file found in the top-level directory of this distribution
+// and at http://fc-solve.shlomifish.org/docs/distro/COPYING.html . No part of
+// Freecell Solver, including this file, may be copied, modified, propagated,
+// or distributed except according to the terms contained in the COPYING file.
+//
+// Copyright (c) 2026 Shlomi Fish
+// serve.h - the "fc-solve --serve" mode. It keeps a pool of configured
+// instances for every preset that it was asked for, and solves the boards
+// that it is sent over a Unix domain socket, or the standard input, in
+// several worker threads.
+//
+// A request is a "solve <id> <preset> <length>" line, where a preset of "-"
+// stands for the flags that the server was given, followed by length bytes
+// of the board. The requests may be pipelined. Each one is answered, in the
+// order in which they were solved, with a
+// "<id> <verdict> <num_iters> <num_states> <length>" line followed by length
+// bytes of the output of fc-solve for the board.
+#pragma once
+
+#include "freecell-solver/fcs_conf.h"
+
+#if defined(FCS_HAVE_PTHREADS) && !defined(WIN32) &&                          \
+    !defined(FCS_USE_PRECOMPILED_CMD_LINE_THEME)
+#define FC_SOLVE_WITH_SERVE 1
+#include <errno.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "try_param.h"
+
+#define SERVE_MAX_BOARD_LEN 65536
+#define SERVE_MAX_NUM_POOLS 64
+
+typedef struct
+{
+    // NULL for the flags of the server.
+    char *preset;
+    void **idle;
+    size_t num_idle, num_allocated;
+    // The queued jobs that refer to the pool.
+    size_t num_jobs;
+    // Whether the pool was taken out of the server's pools, because its
+    // preset could not be loaded. It is freed once it has no jobs.
+    bool is_dropped;
+    pthread_cond_t has_idle;
+} serve_pool;
+
+typedef struct
+{
+    int fd;
+    bool owns_fd;
+    // The reader of the connection and its requests that were not answered.
+    size_t num_refs;
+    pthread_mutex_t write_lock;
+} serve_conn;
+
+typedef struct serve_job_struct
+{
+    struct serve_job_struct *next;
+    serve_conn *conn;
+    serve_pool *pool;
+    char id[65];
+    char *board;
+} serve_job;
+
+typedef struct
+{
+    int argc;
+    char **argv;
+    int first_flag;
+    fc_solve_display_information_context display_context;
+    size_t pool_size;
+    serve_pool *pools[SERVE_MAX_NUM_POOLS];
+    size_t num_pools;
+    serve_job *queue_head, *queue_tail;
+    bool is_shutting_down;
+    // Guards the pools, the queue and the references to the connections.
+    pthread_mutex_t lock;
+    pthread_cond_t has_jobs;
+} serve_server;
+
+static void serve_clear_iter_handler(void *const instance GCC_UNUSED)
+{
+#ifndef FCS_WITHOUT_ITER_HANDLER
+    // The iterations output would be mixed with the answers.
+    freecell_solver_user_set_iter_handler_long(instance, NULL, NULL);
+#endif
+}
+
+// Returns NULL if the preset could not be read. It is called without the
+// lock held.
+static void *serve_alloc_instance(
+    serve_server *const server, const char *const preset)
+{
+    void *const instance = freecell_solver_user_alloc();
+    FCS__DECL_ERR_PTR(error_string);
+    if (preset)
+    {
+        const int ret = freecell_solver_user_cmd_line_read_cmd_line_preset(
+            instance, preset,
+            known_parameters FCS__PASS_ERR_STR(&error_string), -1, NULL);
+#ifdef FCS_WITH_ERROR_STRS
+        free(error_string);
+        error_string = NULL;
+#endif
+        if ((ret != FCS_CMD_LINE_OK) &&
+            (ret != FCS_CMD_LINE_UNRECOGNIZED_OPTION))
+        {
+            freecell_solver_user_free(instance);
+            return NULL;
+        }
+    }
+    // The flags were already checked when the server started, and the
+    // display context that they set there is in server->display_context, so
+    // dc is only a scratch area for the callback.
+    fc_solve_display_information_context dc = INITIAL_DISPLAY_CONTEXT;
+    int last_arg;
+    freecell_solver_user_cmd_line_parse_args_with_file_nesting_count(instance,
+        server->argc, (freecell_solver_str_t *)(void *)server->argv,
+        server->first_flag, known_parameters, fc_solve__cmd_line_callback,
+        &dc FCS__PASS_ERR_STR(&error_string), &last_arg, -1, NULL);
+#ifdef FCS_WITH_ERROR_STRS
+    free(error_string);
+#endif
+    serve_clear_iter_handler(instance);
+    return instance;
+}
+
+static serve_pool *serve_new_pool(
+    serve_server *const server, const char *const preset)
+{
+    serve_pool *const pool = SMALLOC1(pool);
+    *pool = (serve_pool){.preset = (preset ? strdup(preset) : NULL),
+        .idle = SMALLOC(pool->idle, server->pool_size),
+        .num_idle = 0,
+        .num_allocated = 0,
+        .num_jobs = 0,
+        .is_dropped = false};
+    pthread_cond_init(&pool->has_idle, NULL);
+    server->pools[server->num_pools++] = pool;
+    return pool;
+}
+
+// Should be called with the lock held. Returns NULL if there are too many
+// presets.
+static serve_pool *serve_find_pool(
+    serve_server *const server, const char *const preset)
+{
+    for (size_t i = 0; i < server->num_pools; ++i)
+    {
+        const char *const pool_preset = server->pools[i]->preset;
+        if ((!preset && !pool_preset) ||
+            (preset && pool_preset && !strcmp(preset, pool_preset)))
+        {
+            return server->pools[i];
+        }
+    }
+    return ((server->num_pools < SERVE_MAX_NUM_POOLS)
+                ? serve_new_pool(server, preset)
+                : NULL);
+}
+
+static void serve_free_pool(serve_pool *const pool)
+{
+    for (size_t i = 0; i < pool->num_idle; ++i)
+    {
+        freecell_solver_user_free(pool->idle[i]);
+    }
+    free(pool->idle);
+    free(pool->preset);
+    pthread_cond_destroy(&pool->has_idle);
+    free(pool);
+}
+
+// Should be called with the lock held. Frees the slot of the pool, so a
+// later request for its preset will try to load it again.
+static void serve_drop_pool(serve_server *const server, serve_pool *const pool)
+{
+    for (size_t i = 0; i < server->num_pools; ++i)
+    {
+        if (server->pools[i] == pool)
+        {
+            server->pools[i] = server->pools[--server->num_pools];
+            break;
+        }
+    }
+    pool->is_dropped = true;
+}
+
+static void *serve_pool_take(serve_server *const server, serve_pool *const pool)
+{
+    if (!pool)
+    {
+        return NULL;
+    }
+    pthread_mutex_lock(&server->lock);
+    while ((!pool->is_dropped) && (!pool->num_idle) &&
+           (pool->num_allocated == server->pool_size))
+    {
+        pthread_cond_wait(&pool->has_idle, &server->lock);
+    }
+    if (pool->is_dropped)
+    {
+        pthread_mutex_unlock(&server->lock);
+        return NULL;
+    }
+    if (pool->num_idle)
+    {
+        void *const instance = pool->idle[--pool->num_idle];
+        pthread_mutex_unlock(&server->lock);
+        return instance;
+    }
+    // Reserve the place of the new instance while it is configured.
+    ++pool->num_allocated;
+    pthread_mutex_unlock(&server->lock);
+
+    void *const instance = serve_alloc_instance(server, pool->preset);
+    if (!instance)
+    {
+        pthread_mutex_lock(&server->lock);
+        // Without any instance, the preset could never be loaded.
+        if (!--pool->num_allocated)
+        {
+            serve_drop_pool(server, pool);
+            pthread_cond_broadcast(&pool->has_idle);
+        }
+        else
+        {
+            pthread_cond_signal(&pool->has_idle);
+        }
+        pthread_mutex_unlock(&server->lock);
+    }
+    return instance;
+}
+
+// Releases the reference of a job to its pool.
+static void serve_pool_release_job(
+    serve_server *const server, serve_pool *const pool)
+{
+    if (!pool)
+    {
+        return;
+    }
+    pthread_mutex_lock(&server->lock);
+    const bool to_free = ((!--pool->num_jobs) && pool->is_dropped);
+    pthread_mutex_unlock(&server->lock);
+    if (to_free)
+    {
+        serve_free_pool(pool);
+    }
+}
+
+static void serve_pool_put(
+    serve_server *const server, serve_pool *const pool, void *const instance)
+{
+    freecell_solver_user_recycle(instance);
+    pthread_mutex_lock(&server->lock);
+    pool->idle[pool->num_idle++] = instance;
+    pthread_cond_signal(&pool->has_idle);
+    pthread_mutex_unlock(&server->lock);
+}
+
+static void serve_conn_release(
+    serve_server *const server, serve_conn *const conn)
+{
+    pthread_mutex_lock(&server->lock);
+    const bool is_last = (!--conn->num_refs);
+    pthread_mutex_unlock(&server->lock);
+    if (is_last)
+    {
+        if (conn->owns_fd)
+        {
+            close(conn->fd);
+        }
+        pthread_mutex_destroy(&conn->write_lock);
+        free(conn);
+    }
+}
+
+static void serve_write_all(const int fd, const char *buf, size_t len)
+{
+    while (len)
+    {
+        const ssize_t written = write(fd, buf, len);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            // The client went away, so the rest of its answers are dropped.
+            return;
+        }
+        buf += written;
+        len -= (size_t)written;
+    }
+}
+
+static void serve_respond(serve_conn *const conn, const char *const id,
+    const char *const verdict, const fcs_iters_int num_iters,
+    const long num_states, const char *const output, const size_t output_len)
+{
+    char header[200];
+    const int header_len = snprintf(header, sizeof(header),
+        "%s %s %ld %ld %lu\n", id, verdict, (long)num_iters, num_states,
+        (unsigned long)output_len);
+    pthread_mutex_lock(&conn->write_lock);
+    serve_write_all(conn->fd, header, (size_t)header_len);
+    serve_write_all(conn->fd, output, output_len);
+    pthread_mutex_unlock(&conn->write_lock);
+}
+
+static const char *serve_verdict(const int ret)
+{
+    switch (ret)
+    {
+    case FCS_STATE_WAS_SOLVED:
+        return "solved";
+    case FCS_STATE_IS_NOT_SOLVEABLE:
+        return "unsolvable";
+    case FCS_STATE_SUSPEND_PROCESS:
+        return "intractable";
+    case FCS_STATE_INVALID_STATE:
+        return "invalid";
+    default:
+        return "error";
+    }
+}
+
+// Solves the board and writes what fc-solve would have printed for it to
+// output_fh. Returns the verdict of freecell_solver_user_solve_board().
+static int serve_solve_board(void *const instance, const char *const board,
+    const fc_solve_display_information_context *const dc,
+    FILE *const output_fh)
+{
+    const int ret = freecell_solver_user_solve_board(instance, board);
+    switch (ret)
+    {
+    case FCS_STATE_INVALID_STATE: {
+#ifdef FCS_WITH_ERROR_STRS
+        char error_string[120];
+        freecell_solver_user_get_invalid_state_error_into_string(
+            instance, error_string FC_SOLVE__PASS_T(dc->display_10_as_t));
+        fprintf(output_fh, "%s\n", error_string);
+#else
+        fprintf(output_fh, "%s\n", "Invalid state");
+#endif
+    }
+    break;
+
+    case FCS_STATE_FLARES_PLAN_ERROR:
+#ifdef FCS_WITH_ERROR_STRS
+        fprintf(output_fh, "Flares Plan: %s\n",
+            freecell_solver_user_get_last_error_string(instance));
+#else
+        fprintf(output_fh, "%s\n", "Flares Plan Error");
+#endif
+        break;
+
+    default:
+        fc_solve_output_result_to_file(output_fh, instance, ret, dc);
+        break;
+    }
+    return ret;
+}
+
+static void serve_solve(serve_server *const server, serve_job *const job)
+{
+    char *output = NULL;
+    size_t output_len = 0;
+    FILE *const output_fh = open_memstream(&output, &output_len);
+    const char *verdict = "error";
+    fcs_iters_int num_iters = 0;
+    long num_states = 0;
+
+    void *const instance = serve_pool_take(server, job->pool);
+    if (!instance)
+    {
+        fputs("Could not load the preset.\n", output_fh);
+    }
+    else
+    {
+        verdict = serve_verdict(serve_solve_board(
+            instance, job->board, &server->display_context, output_fh));
+        num_iters = freecell_solver_user_get_num_times_long(instance);
+#ifndef FCS_DISABLE_NUM_STORED_STATES
+        num_states =
+            (long)freecell_solver_user_get_num_states_in_collection_long(
+                instance);
+#endif
+        serve_pool_put(server, job->pool, instance);
+    }
+    serve_pool_release_job(server, job->pool);
+    fclose(output_fh);
+    serve_respond(
+        job->conn, job->id, verdict, num_iters, num_states, output, output_len);
+    free(output);
+}
+
+static void *serve_worker(void *const void_server)
+{
+    serve_server *const server = (serve_server *)void_server;
+    while (true)
+    {
+        pthread_mutex_lock(&server->lock);
+        while ((!server->queue_head) && (!server->is_shutting_down))
+        {
+            pthread_cond_wait(&server->has_jobs, &server->lock);
+        }
+        serve_job *const job = server->queue_head;
+        if (job && (!(server->queue_head = job->next)))
+        {
+            server->queue_tail = NULL;
+        }
+        pthread_mutex_unlock(&server->lock);
+        if (!job)
+        {
+            return NULL;
+        }
+
+        serve_solve(server, job);
+        serve_conn_release(server, job->conn);
+        free(job->board);
+        free(job);
+    }
+}
+
+// Reads the requests from in until it ends, or until a malformed request,
+// and queues them. Consumes the reference of the reader to conn.
+static void serve_read_requests(
+    serve_server *const server, serve_conn *const conn, FILE *const in)
+{
+    char line[300];
+    while (fgets(line, sizeof(line), in))
+    {
+        if (!strcmp(line, "\n"))
+        {
+            continue;
+        }
+        char id[65], preset[129];
+        unsigned long board_len;
+        if ((sscanf(line, "solve %64s %128s %lu", id, preset, &board_len) !=
+                3) ||
+            (board_len > SERVE_MAX_BOARD_LEN))
+        {
+            static const char malformed[] = "Malformed request.\n";
+            serve_respond(
+                conn, "-", "error", 0, 0, malformed, sizeof(malformed) - 1);
+            break;
+        }
+        char *const board = SMALLOC(board, board_len + 1);
+        if (fread(board, 1, board_len, in) != board_len)
+        {
+            free(board);
+            break;
+        }
+        board[board_len] = '\0';
+
+        serve_job *const job = SMALLOC1(job);
+        *job = (serve_job){.next = NULL, .conn = conn, .board = board};
+        strcpy(job->id, id);
+        pthread_mutex_lock(&server->lock);
+        job->pool =
+            serve_find_pool(server, (strcmp(preset, "-") ? preset : NULL));
+        if (job->pool)
+        {
+            ++job->pool->num_jobs;
+        }
+        ++conn->num_refs;
+        if (server->queue_tail)
+        {
+            server->queue_tail->next = job;
+        }
+        else
+        {
+            server->queue_head = job;
+        }
+        server->queue_tail = job;
+        pthread_cond_signal(&server->has_jobs);
+        pthread_mutex_unlock(&server->lock);
+    }
+    serve_conn_release(server, conn);
+}
+
+static serve_conn *serve_new_conn(const int fd, const bool owns_fd)
+{
+    serve_conn *const conn = SMALLOC1(conn);
+    *conn = (serve_conn){.fd = fd, .owns_fd = owns_fd, .num_refs = 1};
+    pthread_mutex_init(&conn->write_lock, NULL);
+    return conn;
+}
+
+typedef struct
+{
+    serve_server *server;
+    serve_conn *conn;
+} serve_reader_context;
+
+static void *serve_reader(void *const void_context)
+{
+    const serve_reader_context context = *(serve_reader_context *)void_context;
+    free(void_context);
+    FILE *const in = fdopen(dup(context.conn->fd), "r");
+    if (!in)
+    {
+        serve_conn_release(context.server, context.conn);
+        return NULL;
+    }
+    serve_read_requests(context.server, context.conn, in);
+    fclose(in);
+    return NULL;
+}
+
+static void serve_accept_connections(
+    serve_server *const server, const char *const socket_path)
+{
+    const int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+    if (strlen(socket_path) >= sizeof(addr.sun_path))
+    {
+        exit_error("The socket path \"%s\" is too long.\n", socket_path);
+    }
+    strcpy(addr.sun_path, socket_path);
+    unlink(socket_path);
+    if ((listen_fd < 0) ||
+        bind(listen_fd, (const struct sockaddr *)&addr, sizeof(addr)) ||
+        listen(listen_fd, SOMAXCONN))
+    {
+        exit_error("Could not listen on \"%s\": %s\n", socket_path,
+            strerror(errno));
+    }
+    while (true)
+    {
+        const int fd = accept(listen_fd, NULL, NULL);
+        if (fd < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+        serve_reader_context *const context = SMALLOC1(context);
+        *context = (serve_reader_context){
+            .server = server, .conn = serve_new_conn(fd, true)};
+        pthread_t reader;
+        if (pthread_create(&reader, NULL, serve_reader, context))
+        {
+            serve_conn_release(server, context->conn);
+            free(context);
+            continue;
+        }
+        pthread_detach(reader);
+    }
+    close(listen_fd);
+    unlink(socket_path);
+}
+
+static int fc_solve_serve_main(const int argc, char **const argv)
+{
+    const char *socket_path = NULL;
+    size_t num_workers = 0, pool_size = 0;
+    int arg = 2;
+    for (; arg < argc; ++arg)
+    {
+        const char *param;
+        if ((param = TRY_P("--socket")))
+        {
+            socket_path = param;
+        }
+        else if ((param = TRY_P("--workers")))
+        {
+            num_workers = (size_t)atol(param);
+        }
+        else if ((param = TRY_P("--pool-size")))
+        {
+            pool_size = (size_t)atol(param);
+        }
+        else
+        {
+            break;
+        }
+    }
+    if (!num_workers)
+    {
+        const long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        num_workers = ((num_cpus > 0) ? (size_t)num_cpus : 1);
+    }
+
+    display_context = INITIAL_DISPLAY_CONTEXT;
+    serve_server server = {.argc = argc,
+        .argv = argv,
+        .first_flag = arg,
+        .pool_size = (pool_size ? pool_size : num_workers),
+        .num_pools = 0,
+        .queue_head = NULL,
+        .queue_tail = NULL,
+        .is_shutting_down = false};
+    // It checks the flags, and becomes the first instance of the pool of the
+    // server's flags.
+    void *const instance = alloc_instance_and_parse(argc, argv, &arg,
+        known_parameters, fc_solve__cmd_line_callback, &display_context, true);
+    serve_clear_iter_handler(instance);
+    server.display_context = display_context;
+    pthread_mutex_init(&server.lock, NULL);
+    pthread_cond_init(&server.has_jobs, NULL);
+    serve_pool *const pool = serve_new_pool(&server, NULL);
+    pool->idle[pool->num_idle++] = instance;
+    pool->num_allocated = 1;
+    signal(SIGPIPE, SIG_IGN);
+
+    pthread_t workers[num_workers];
+    for (size_t i = 0; i < num_workers; ++i)
+    {
+        const int check =
+            pthread_create(&workers[i], NULL, serve_worker, &server);
+        if (check)
+        {
+            exit_error("Worker Thread No. %lu Initialization failed with "
+                       "error %d!\n",
+                (unsigned long)i, check);
+        }
+    }
+
+    if (socket_path)
+    {
+        serve_accept_connections(&server, socket_path);
+    }
+    else
+    {
+        serve_read_requests(
+            &server, serve_new_conn(STDOUT_FILENO, false), stdin);
+    }
+
+    pthread_mutex_lock(&server.lock);
+    server.is_shutting_down = true;
+    pthread_cond_broadcast(&server.has_jobs);
+    pthread_mutex_unlock(&server.lock);
+    for (size_t i = 0; i < num_workers; ++i)
+    {
+        pthread_join(workers[i], NULL);
+    }
+    for (size_t i = 0; i < server.num_pools; ++i)
+    {
+        serve_free_pool(server.pools[i]);
+    }
+    pthread_cond_destroy(&server.has_jobs);
+    pthread_mutex_destroy(&server.lock);
+    return 0;
+}
+#endif
@@ -0,0 +1,109 @@
+// This file is part of Freecell Solver. It is subject to the license terms in
+// the COPYING.txt file found in the top-level directory of this distribution
+// and at http://fc-solve.shlomifish.org/docs/distro/COPYING.html . No part of
+// Freecell Solver, including this file, may be copied, modified, propagated,
+// or distributed except according to the terms contained in the COPYING file.
+//
+// Copyright (c) 2026 Shlomi Fish
+// specialized_moves.h - tables of move functions that were compiled with the
+// game parameters of one popular variant as compile-time constants, and the
+// selection of the table that matches the instance's game parameters.
+//
+// Each specialized_moves__*.c translation unit defines FCS_SPECIALIZED_MOVES
+// and the FCS_SPECIALIZED_* parameters, and includes freecell.c or simpsim.c
+// (see the end of meta_move_funcs_helpers.h). Any other game uses the generic
+// fc_solve_sfs_move_funcs table.
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "freecell.h"
+#include "simpsim.h"
+
+#ifdef FCS_WITH_SPECIALIZED_MOVES
+typedef struct
+{
+    fcs_game_type_params game_params;
+    fc_solve_solve_for_state_move_func move_funcs[FCS_MOVE_FUNCS_NUM];
+} fcs_specialized_moves;
+
+#define FCS_SPECIALIZED_GAME_PARAMS                                            \
+    {                                                                          \
+        .freecells_num = FCS_SPECIALIZED_FREECELLS_NUM,                        \
+        .stacks_num = FCS_SPECIALIZED_STACKS_NUM,                              \
+        .decks_num = FCS_SPECIALIZED_DECKS_NUM,                                \
+        .game_flags = (FCS_SPECIALIZED_SEQS_BUILT_BY |                         \
+                       (FCS_SPECIALIZED_EMPTY_STACKS_FILL << 2) |              \
+                       (FCS_SPECIALIZED_UNLIMITED_SEQUENCE_MOVE << 4)),        \
+    }
+
+// The wrappers for FCS_MOVE_FUNCS_LIST() .
+#define FCS_SPECIALIZED_MOVE(f) f##__specialized
+#define FCS_GENERIC_MOVE(f) f
+#if MAX_NUM_FREECELLS > 0
+#define FCS_GENERIC_ZEROFC_MOVE(f) f
+#else
+#define FCS_GENERIC_ZEROFC_MOVE(f) fc_solve_sfs_null_move_func
+#endif
+#ifdef FCS_DISABLE_SIMPLE_SIMON
+#define FCS_GENERIC_SIMPSIM_MOVE(f) fc_solve_sfs_move_top_stack_cards_to_founds
+#else
+#define FCS_GENERIC_SIMPSIM_MOVE(f) f
+#endif
+
+#if (MAX_NUM_FREECELLS >= 4) && (MAX_NUM_STACKS >= 8)
+#define FCS_SPECIALIZED_MOVES__FREECELL
+#define FCS_SPECIALIZED_MOVES__BAKERS_GAME
+extern const fcs_specialized_moves fc_solve_specialized_moves__freecell;
+extern const fcs_specialized_moves fc_solve_specialized_moves__bakers_game;
+#endif
+#if (MAX_NUM_FREECELLS >= 4) && (MAX_NUM_STACKS >= 10)
+#define FCS_SPECIALIZED_MOVES__SEAHAVEN_TOWERS
+extern const fcs_specialized_moves
+    fc_solve_specialized_moves__seahaven_towers;
+#endif
+#if !defined(FCS_DISABLE_SIMPLE_SIMON) && (MAX_NUM_STACKS >= 10)
+#define FCS_SPECIALIZED_MOVES__SIMPLE_SIMON
+extern const fcs_specialized_moves fc_solve_specialized_moves__simple_simon;
+#endif
+
+static inline const fc_solve_solve_for_state_move_func *
+fc_solve_select_move_funcs(const fcs_game_type_params *const game_params)
+{
+    static const fcs_specialized_moves *const variants[] = {
+#ifdef FCS_SPECIALIZED_MOVES__FREECELL
+        &fc_solve_specialized_moves__freecell,
+#endif
+#ifdef FCS_SPECIALIZED_MOVES__BAKERS_GAME
+        &fc_solve_specialized_moves__bakers_game,
+#endif
+#ifdef FCS_SPECIALIZED_MOVES__SEAHAVEN_TOWERS
+        &fc_solve_specialized_moves__seahaven_towers,
+#endif
+#ifdef FCS_SPECIALIZED_MOVES__SIMPLE_SIMON
+        &fc_solve_specialized_moves__simple_simon,
+#endif
+        NULL};
+
+    for (const fcs_specialized_moves *const *variant = variants; *variant;
+         ++variant)
+    {
+        const_AUTO(params, &((*variant)->game_params));
+        if ((params->freecells_num == game_params->freecells_num) &&
+            (params->stacks_num == game_params->stacks_num) &&
+            (params->decks_num == game_params->decks_num) &&
+            (params->game_flags == game_params->game_flags))
+        {
+            return (*variant)->move_funcs;
+        }
+    }
+
+    return fc_solve_sfs_move_funcs;
+}
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,29 @@
+// This file is part of Freecell Solver. It is subject to the license terms in
+// the COPYING.txt file found in the top-level directory of this distribution
+// and at http://fc-solve.shlomifish.org/docs/distro/COPYING.html . No part of
+// Freecell Solver, including this file, may be copied, modified, propagated,
+// or distributed except according to the terms contained in the COPYING file.
+//
+// Copyright (c) 2026 Shlomi Fish
+// specialized_moves__bakers_game.c - the Freecell moves, compiled for Baker's
+// Game: 4 freecells, 8 columns and sequences built by suit.
+#include "specialized_moves.h"
+
+#ifdef FCS_SPECIALIZED_MOVES__BAKERS_GAME
+#define FCS_SPECIALIZED_MOVES
+#define FCS_SPECIALIZED_FREECELLS_NUM 4
+#define FCS_SPECIALIZED_STACKS_NUM 8
+#define FCS_SPECIALIZED_DECKS_NUM 1
+#define FCS_SPECIALIZED_SEQS_BUILT_BY FCS_SEQ_BUILT_BY_SUIT
+#define FCS_SPECIALIZED_EMPTY_STACKS_FILL FCS_ES_FILLED_BY_ANY_CARD
+#define FCS_SPECIALIZED_UNLIMITED_SEQUENCE_MOVE 0
+#include "freecell.c"
+
+const fcs_specialized_moves fc_solve_specialized_moves__bakers_game = {
+    .game_params = FCS_SPECIALIZED_GAME_PARAMS,
+    .move_funcs = {FCS_MOVE_FUNCS_LIST(
+        FCS_SPECIALIZED_MOVE, FCS_SPECIALIZED_MOVE, FCS_GENERIC_SIMPSIM_MOVE)},
+};
+#else
+char fc_solve_specialized_moves__bakers_game__nothing;
+#endif
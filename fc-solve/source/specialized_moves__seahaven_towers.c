@@ -0,0 +1,30 @@
+// This file is part of Freecell Solver. It is subject to the license terms in
+// the COPYING.txt file found in the top-level directory of this distribution
+// and at http://fc-solve.shlomifish.org/docs/distro/COPYING.html . No part of
+// Freecell Solver, including this file, may be copied, modified, propagated,
+// or distributed except according to the terms contained in the COPYING file.
+//
+// Copyright (c) 2026 Shlomi Fish
+// specialized_moves__seahaven_towers.c - the Freecell moves, compiled for
+// Seahaven Towers: 4 freecells, 10 columns, sequences built by suit, and
+// empty columns that may only be filled by kings.
+#include "specialized_moves.h"
+
+#ifdef FCS_SPECIALIZED_MOVES__SEAHAVEN_TOWERS
+#define FCS_SPECIALIZED_MOVES
+#define FCS_SPECIALIZED_FREECELLS_NUM 4
+#define FCS_SPECIALIZED_STACKS_NUM 10
+#define FCS_SPECIALIZED_DECKS_NUM 1
+#define FCS_SPECIALIZED_SEQS_BUILT_BY FCS_SEQ_BUILT_BY_SUIT
+#define FCS_SPECIALIZED_EMPTY_STACKS_FILL FCS_ES_FILLED_BY_KINGS_ONLY
+#define FCS_SPECIALIZED_UNLIMITED_SEQUENCE_MOVE 0
+#include "freecell.c"
+
+const fcs_specialized_moves fc_solve_specialized_moves__seahaven_towers = {
+    .game_params = FCS_SPECIALIZED_GAME_PARAMS,
+    .move_funcs = {FCS_MOVE_FUNCS_LIST(
+        FCS_SPECIALIZED_MOVE, FCS_SPECIALIZED_MOVE, FCS_GENERIC_SIMPSIM_MOVE)},
+};
+#else
+char fc_solve_specialized_moves__seahaven_towers__nothing;
+#endif
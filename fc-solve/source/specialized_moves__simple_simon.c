@@ -0,0 +1,29 @@
+// This file is part of Freecell Solver. It is subject to the license terms in
+// the COPYING.txt file found in the top-level directory of this distribution
+// and at http://fc-solve.shlomifish.org/docs/distro/COPYING.html . No part of
+// Freecell Solver, including this file, may be copied, modified, propagated,
+// or distributed except according to the terms contained in the COPYING file.
+//
+// Copyright (c) 2026 Shlomi Fish
+// specialized_moves__simple_simon.c - the Simple Simon moves, compiled for its
+// 10 columns and no freecells.
+#include "specialized_moves.h"
+
+#ifdef FCS_SPECIALIZED_MOVES__SIMPLE_SIMON
+#define FCS_SPECIALIZED_MOVES
+#define FCS_SPECIALIZED_FREECELLS_NUM 0
+#define FCS_SPECIALIZED_STACKS_NUM 10
+#define FCS_SPECIALIZED_DECKS_NUM 1
+#define FCS_SPECIALIZED_SEQS_BUILT_BY FCS_SEQ_BUILT_BY_SUIT
+#define FCS_SPECIALIZED_EMPTY_STACKS_FILL FCS_ES_FILLED_BY_ANY_CARD
+#define FCS_SPECIALIZED_UNLIMITED_SEQUENCE_MOVE 0
+#include "simpsim.c"
+
+const fcs_specialized_moves fc_solve_specialized_moves__simple_simon = {
+    .game_params = FCS_SPECIALIZED_GAME_PARAMS,
+    .move_funcs = {FCS_MOVE_FUNCS_LIST(
+        FCS_GENERIC_MOVE, FCS_GENERIC_ZEROFC_MOVE, FCS_SPECIALIZED_MOVE)},
+};
+#else
+char fc_solve_specialized_moves__simple_simon__nothing;
+#endif
@@ -0,0 +1,475 @@
+// This file is part of Freecell Solver. It is subject to the license terms in
+// the COPYING.txt file found in the top-level directory of this distribution
+// and at http://fc-solve.shlomifish.org/docs/distro/COPYING.html . No part of
+// Freecell Solver, including this file, may be copied, modified, propagated,
+// or distributed except according to the terms contained in the COPYING file.
+//
+// Copyright (c) 2026 Shlomi Fish
+// split_fcc_coordinator.h - the --coordinate mode of split_fcc_solver.c ,
+// which solves all the FCCs of a board using a persistent pool of worker
+// processes instead of a new process for every FCC (see
+// ../scripts/SplitFcc.pm ).
+//
+// The pending FCCs are kept sorted by the depth of their fingerprints. An FCC
+// is handed to an idle worker only once no FCC of a lower depth is pending or
+// being solved, because only those may still add entry points to it. The exit
+// points found by a worker are appended to the binary input files of their
+// FCCs, and the worker which solves such an FCC later on drops the duplicate
+// entry points.
+#pragma once
+
+#include <dirent.h>
+#include <errno.h>
+#include <sys/select.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <signal.h>
+
+#define READ_FD 0
+#define WRITE_FD 1
+
+typedef struct SplitFccPendingNode SplitFccPendingNode;
+struct SplitFccPendingNode
+{
+    RB_ENTRY(SplitFccPendingNode) entry_;
+    size_t depth;
+    fcs_which_moves_bitmask fingerprint;
+};
+
+static inline int SplitFccPendingNode_compare(
+    SplitFccPendingNode *a, SplitFccPendingNode *b)
+{
+    if (a->depth != b->depth)
+    {
+        return ((a->depth < b->depth) ? -1 : 1);
+    }
+    return memcmp(a->fingerprint.s, b->fingerprint.s, sizeof(a->fingerprint));
+}
+
+RB_HEAD(SplitFccPendingList, SplitFccPendingNode);
+RB_GENERATE_STATIC(SplitFccPendingList, SplitFccPendingNode, entry_,
+    SplitFccPendingNode_compare)
+
+typedef struct
+{
+    fcs_which_moves_bitmask fingerprint;
+    unsigned long job_idx;
+} split_fcc_request;
+
+typedef struct
+{
+    unsigned long job_idx;
+    bool was_solved;
+} split_fcc_response;
+
+typedef struct
+{
+    pid_t pid;
+    int child_to_parent_pipe[2], parent_to_child_pipe[2];
+    bool is_busy;
+    split_fcc_request req;
+    size_t depth;
+} split_fcc_worker;
+
+static inline void split_fcc__calc_input_fn(char *const fn,
+    const char *const output_dir,
+    const fcs_which_moves_bitmask *const fingerprint)
+{
+    char hex[sizeof(fingerprint->s) * 2 + 1];
+    for (size_t i = 0; i < sizeof(fingerprint->s); ++i)
+    {
+        sprintf(&hex[i << 1], "%02x", (unsigned)fingerprint->s[i]);
+    }
+    snprintf(fn, PATH_MAX, "%s/fcc-%s.in", output_dir, hex);
+}
+
+static inline void split_fcc__calc_exits_fn(
+    char *const fn, const char *const output_dir, const unsigned long job_idx)
+{
+    snprintf(fn, PATH_MAX, "%s/job-%lu.exits", output_dir, job_idx);
+}
+
+static inline void split_fcc__append_entries(const char *const output_dir,
+    const fcs_which_moves_bitmask *const fingerprint,
+    const fcs_split_fcc_entry *const entries,
+    const unsigned char *const *const moves, const size_t num_entries)
+{
+    char fn[PATH_MAX + 1];
+    split_fcc__calc_input_fn(fn, output_dir, fingerprint);
+    FILE *const fh = fopen(fn, "ab");
+    if (!fh)
+    {
+        exit_error("Cannot open '%s' for appending. Exiting.", fn);
+    }
+    for (size_t i = 0; i < num_entries; ++i)
+    {
+        fwrite(&(entries[i]), sizeof(entries[i]), 1, fh);
+        fwrite(moves[i], 1, entries[i].moves_len, fh);
+    }
+    fclose(fh);
+}
+
+static inline void split_fcc__add_pending(
+    struct SplitFccPendingList *const pending, size_t *const num_pending,
+    const fcs_which_moves_bitmask *const fingerprint)
+{
+    SplitFccPendingNode *const node = SMALLOC1(node);
+    node->fingerprint = *fingerprint;
+    node->depth = fingerprint_calc_depth(fingerprint);
+    if (RB_INSERT(SplitFccPendingList, pending, node))
+    {
+        free(node);
+    }
+    else
+    {
+        ++(*num_pending);
+    }
+}
+
+typedef struct
+{
+    fcs_split_fcc_exit exit_point;
+    size_t moves_offset;
+} split_fcc_loaded_exit;
+
+static int split_fcc_loaded_exit_compare(
+    const void *const void_a, const void *const void_b)
+{
+    const split_fcc_loaded_exit *const a = void_a, *const b = void_b;
+    return memcmp(a->exit_point.fingerprint.s, b->exit_point.fingerprint.s,
+        sizeof(a->exit_point.fingerprint));
+}
+
+// Moves the exit points which a job has found into the inputs of their FCCs,
+// and returns their count.
+static size_t split_fcc__merge_exits(const char *const output_dir,
+    const char *const exits_fn, struct SplitFccPendingList *const pending,
+    size_t *const num_pending)
+{
+    FILE *const fh = fopen(exits_fn, "rb");
+    if (!fh)
+    {
+        exit_error("Cannot open '%s' for reading. Exiting.", exits_fn);
+    }
+    split_fcc_loaded_exit *exits = NULL;
+    size_t num_exits = 0, max_num_exits = 0;
+    unsigned char *moves = NULL;
+    size_t moves_len = 0, max_moves_len = 0;
+    fcs_split_fcc_exit exit_point;
+    while (fread(&exit_point, sizeof(exit_point), 1, fh) == 1)
+    {
+        const size_t len = exit_point.entry.moves_len;
+        if (num_exits == max_num_exits)
+        {
+            max_num_exits = (max_num_exits << 1) + 64;
+            exits = SREALLOC(exits, max_num_exits);
+        }
+        if (moves_len + len > max_moves_len)
+        {
+            max_moves_len = ((moves_len + len) << 1) + 64;
+            moves = SREALLOC(moves, max_moves_len);
+        }
+        if (fread(&moves[moves_len], 1, len, fh) != len)
+        {
+            exit_error("'%s' is truncated. Exiting.", exits_fn);
+        }
+        exits[num_exits++] = (split_fcc_loaded_exit){
+            .exit_point = exit_point, .moves_offset = moves_len};
+        moves_len += len;
+    }
+    fclose(fh);
+    unlink(exits_fn);
+
+    // Group the exit points by their FCC, so every input file is opened once.
+    qsort(exits, num_exits, sizeof(exits[0]), split_fcc_loaded_exit_compare);
+    fcs_split_fcc_entry *const entries = SMALLOC(entries, num_exits + 1);
+    const unsigned char **const entries_moves =
+        SMALLOC(entries_moves, num_exits + 1);
+    for (size_t start = 0, end; start < num_exits; start = end)
+    {
+        for (end = start; (end < num_exits) &&
+                          (!split_fcc_loaded_exit_compare(
+                              &(exits[start]), &(exits[end])));
+             ++end)
+        {
+            entries[end - start] = exits[end].exit_point.entry;
+            entries_moves[end - start] = &(moves[exits[end].moves_offset]);
+        }
+        const_AUTO(fingerprint, &(exits[start].exit_point.fingerprint));
+        split_fcc__append_entries(
+            output_dir, fingerprint, entries, entries_moves, end - start);
+        split_fcc__add_pending(pending, num_pending, fingerprint);
+    }
+    free(entries_moves);
+    free(entries);
+    free(exits);
+    free(moves);
+
+    return num_exits;
+}
+
+// Removes the store of an FCC, which is either a file or a directory of files
+// depending on the backend, so the next FCC does not start from its states.
+static void split_fcc__remove_store(const char *const path)
+{
+    DIR *const dh = opendir(path);
+    if (!dh)
+    {
+        unlink(path);
+        return;
+    }
+    const struct dirent *entry;
+    while ((entry = readdir(dh)))
+    {
+        if (strcmp(entry->d_name, ".") && strcmp(entry->d_name, ".."))
+        {
+            char fn[PATH_MAX + 1];
+            snprintf(fn, PATH_MAX, "%s/%s", path, entry->d_name);
+            unlink(fn);
+        }
+    }
+    closedir(dh);
+    rmdir(path);
+}
+
+static void split_fcc__run_worker(const split_fcc_worker *const w,
+    const size_t worker_idx, const fcs_dbm_common_input *const common_inp,
+    const char *const output_dir, fcs_state_keyval_pair *const init_state,
+    fcs_delta_stater *const delta)
+{
+    // Every worker gets its own offload directory, and every FCC gets its own
+    // store.
+    char offload_dir_path[PATH_MAX + 1], dbm_store_path[PATH_MAX + 1];
+    snprintf(offload_dir_path, PATH_MAX, "%s/worker-%lu",
+        common_inp->offload_dir_path, (unsigned long)worker_idx);
+    if (mkdir(offload_dir_path, 0777) && (errno != EEXIST))
+    {
+        exit_error("Cannot create '%s'. Exiting.", offload_dir_path);
+    }
+    fcs_dbm_common_input inp = *common_inp;
+    inp.offload_dir_path = offload_dir_path;
+    inp.dbm_store_path = dbm_store_path;
+#ifndef FCS_DBM_SINGLE_THREAD
+    const_AUTO(num_threads, inp.num_threads);
+#endif
+
+    split_fcc_request req;
+    while (read(w->parent_to_child_pipe[READ_FD], &req, sizeof(req)) ==
+           sizeof(req))
+    {
+        char input_fn[PATH_MAX + 1], exits_fn[PATH_MAX + 1];
+        split_fcc__calc_input_fn(input_fn, output_dir, &(req.fingerprint));
+        split_fcc__calc_exits_fn(exits_fn, output_dir, req.job_idx);
+        snprintf(dbm_store_path, PATH_MAX, "%s.%lu.%lu",
+            common_inp->dbm_store_path, (unsigned long)worker_idx,
+            req.job_idx);
+        split_fcc__remove_store(dbm_store_path);
+
+        dbm_solver_instance instance;
+        instance_init(&instance, &inp, &(req.fingerprint), stdout);
+        instance.fcc_exit_points_are_binary = true;
+        FccEntryPointNode *const key_ptr =
+            instance__load_binary_entry_points(&instance, input_fn);
+
+        const split_fcc_response response = {.job_idx = req.job_idx,
+            .was_solved = instance__solve_fcc(&instance, init_state, delta,
+                key_ptr, exits_fn, NUM_THREADS())};
+        split_fcc__remove_store(dbm_store_path);
+        if (sizeof(response) != write(w->child_to_parent_pipe[WRITE_FD],
+                                    &response, sizeof(response)))
+        {
+            abort();
+        }
+    }
+    close(w->child_to_parent_pipe[WRITE_FD]);
+    close(w->parent_to_child_pipe[READ_FD]);
+}
+
+static void split_fcc__coordinate(const fcs_dbm_common_input *const inp,
+    const char *const output_dir, const size_t num_workers,
+    fcs_state_keyval_pair *const init_state, fcs_delta_stater *const delta)
+{
+    FILE *const out_fh = stdout;
+    struct SplitFccPendingList pending = RB_INITIALIZER(&pending);
+    size_t num_pending = 0;
+    {
+        // The initial state is the only entry point of the first FCC.
+        const fcs_which_moves_bitmask init_fingerprint = {{'\0'}};
+        fcs_split_fcc_entry init_entry;
+        memset(&init_entry, '\0', sizeof(init_entry));
+        fcs_init_and_encode_state(
+            delta, inp->local_variant, init_state, &(init_entry.key));
+        const unsigned char *const no_moves = NULL;
+        char fn[PATH_MAX + 1];
+        split_fcc__calc_input_fn(fn, output_dir, &init_fingerprint);
+        unlink(fn);
+        split_fcc__append_entries(
+            output_dir, &init_fingerprint, &init_entry, &no_moves, 1);
+        split_fcc__add_pending(&pending, &num_pending, &init_fingerprint);
+    }
+
+    split_fcc_worker workers[num_workers];
+    for (size_t idx = 0; idx < num_workers; ++idx)
+    {
+        split_fcc_worker *const w = &(workers[idx]);
+        w->is_busy = false;
+        if (pipe(w->child_to_parent_pipe))
+        {
+            exit_error("C->P Pipe for worker No. %lu failed! Exiting.\n",
+                (unsigned long)idx);
+        }
+        if (pipe(w->parent_to_child_pipe))
+        {
+            exit_error("P->C Pipe for worker No. %lu failed! Exiting.\n",
+                (unsigned long)idx);
+        }
+        fflush(out_fh);
+        switch ((w->pid = fork()))
+        {
+        case -1:
+            exit_error("Fork for worker No. %lu failed! Exiting.\n",
+                (unsigned long)idx);
+
+        case 0:
+            // I'm the child.
+            close(w->parent_to_child_pipe[WRITE_FD]);
+            close(w->child_to_parent_pipe[READ_FD]);
+            split_fcc__run_worker(w, idx, inp, output_dir, init_state, delta);
+            exit(0);
+
+        default:
+            // I'm the parent.
+            close(w->parent_to_child_pipe[READ_FD]);
+            close(w->child_to_parent_pipe[WRITE_FD]);
+            break;
+        }
+    }
+
+    unsigned long next_job_idx = 0, num_solved_fccs = 0, num_exit_points = 0;
+    size_t num_busy = 0;
+    bool was_solved = false;
+    while (!was_solved)
+    {
+        size_t min_busy_depth = SIZE_MAX;
+        for (size_t idx = 0; idx < num_workers; ++idx)
+        {
+            if (workers[idx].is_busy)
+            {
+                min_busy_depth = min(min_busy_depth, workers[idx].depth);
+            }
+        }
+        for (size_t idx = 0; idx < num_workers; ++idx)
+        {
+            split_fcc_worker *const w = &(workers[idx]);
+            SplitFccPendingNode *const next =
+                RB_MIN(SplitFccPendingList, &pending);
+            if ((!next) || (next->depth > min_busy_depth))
+            {
+                break;
+            }
+            if (w->is_busy)
+            {
+                continue;
+            }
+            w->req = (split_fcc_request){
+                .fingerprint = next->fingerprint, .job_idx = next_job_idx++};
+            w->depth = next->depth;
+            if (write(w->parent_to_child_pipe[WRITE_FD], &(w->req),
+                    sizeof(w->req)) != sizeof(w->req))
+            {
+                exit_error("Writing to worker No. %lu failed! Exiting.\n",
+                    (unsigned long)idx);
+            }
+            w->is_busy = true;
+            ++num_busy;
+            min_busy_depth = min(min_busy_depth, w->depth);
+            RB_REMOVE(SplitFccPendingList, &pending, next);
+            free(next);
+            --num_pending;
+        }
+        if (!num_busy)
+        {
+            break;
+        }
+
+        fd_set readers;
+        FD_ZERO(&readers);
+        int max_fd = -1;
+        for (size_t idx = 0; idx < num_workers; ++idx)
+        {
+            if (workers[idx].is_busy)
+            {
+                const int fd = workers[idx].child_to_parent_pipe[READ_FD];
+                FD_SET(fd, &readers);
+                max_fd = max(max_fd, fd);
+            }
+        }
+        if (select(max_fd + 1, &readers, NULL, NULL, NULL) == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            exit_error("%s\n", "select() failed! Exiting.");
+        }
+        for (size_t idx = 0; idx < num_workers; ++idx)
+        {
+            split_fcc_worker *const w = &(workers[idx]);
+            if (!(w->is_busy &&
+                    FD_ISSET(w->child_to_parent_pipe[READ_FD], &readers)))
+            {
+                continue;
+            }
+            split_fcc_response response;
+            if (read(w->child_to_parent_pipe[READ_FD], &response,
+                    sizeof(response)) != sizeof(response))
+            {
+                exit_error("Worker No. %lu has died! Exiting.\n",
+                    (unsigned long)idx);
+            }
+            w->is_busy = false;
+            --num_busy;
+            ++num_solved_fccs;
+            char fn[PATH_MAX + 1];
+            split_fcc__calc_input_fn(fn, output_dir, &(w->req.fingerprint));
+            unlink(fn);
+            split_fcc__calc_exits_fn(fn, output_dir, response.job_idx);
+            num_exit_points +=
+                split_fcc__merge_exits(output_dir, fn, &pending, &num_pending);
+            if (response.was_solved)
+            {
+                was_solved = true;
+            }
+            fprintf(out_fh,
+                "Coordinator: FCCs solved: %lu ; depth: %lu ; exit points: "
+                "%lu ; pending FCCs: %lu ; running: %lu\n",
+                num_solved_fccs, (unsigned long)w->depth, num_exit_points,
+                (unsigned long)num_pending, (unsigned long)num_busy);
+            fflush(out_fh);
+        }
+    }
+
+    for (size_t idx = 0; idx < num_workers; ++idx)
+    {
+        if (workers[idx].is_busy)
+        {
+            kill(workers[idx].pid, SIGTERM);
+        }
+        close(workers[idx].parent_to_child_pipe[WRITE_FD]);
+    }
+    for (size_t idx = 0; idx < num_workers; ++idx)
+    {
+        waitpid(workers[idx].pid, NULL, 0);
+        close(workers[idx].child_to_parent_pipe[READ_FD]);
+    }
+    SplitFccPendingNode *node;
+    while ((node = RB_MIN(SplitFccPendingList, &pending)))
+    {
+        RB_REMOVE(SplitFccPendingList, &pending, node);
+        free(node);
+    }
+
+    fprintf(out_fh, "Coordinator: %s after solving %lu FCCs.\n",
+        (was_solved ? "Success" : "Could not solve successfully"),
+        num_solved_fccs);
+}
@@ -37,7 +37,9 @@ struct FccEntryPointNode
         fcs_dbm_record key;
         struct
         {
-            long location_in_file;
+            // The moves leading to the entry point are kept at this offset
+            // of instance->entry_points_moves.
+            size_t moves_offset, moves_len;
 #if 0
             int depth;
             int was_consumed: 1;
@@ -58,6 +60,21 @@ RB_HEAD(FccEntryPointList, FccEntryPointNode);
 static const FccEntryPointList FccEntryPointList_init =
     RB_INITIALIZER(&(instance->fcc_entry_points));
 
+// The binary format of the FCC inputs of --coordinate : every record is
+// followed by moves_len bytes of moves.
+typedef struct
+{
+    fcs_encoded_state_buffer key;
+    uint32_t moves_len;
+} fcs_split_fcc_entry;
+
+// An exit point is an entry point of the FCC with the new fingerprint.
+typedef struct
+{
+    fcs_which_moves_bitmask fingerprint;
+    fcs_split_fcc_entry entry;
+} fcs_split_fcc_exit;
+
 typedef struct
 {
     fcs_dbm_collection_by_depth coll;
@@ -81,9 +98,12 @@ typedef struct
     fcs_which_moves_bitmask fingerprint_which_irreversible_moves_bitmask;
     fcs_lock fcc_exit_points_output_lock;
     FILE *fcc_exit_points_out_fh;
-    FILE *fingerprint_fh;
-    char *fingerprint_line;
-    size_t fingerprint_line_size;
+    // Whether the exit points are written as fcs_split_fcc_exit records
+    // instead of text lines.
+    bool fcc_exit_points_are_binary;
+    bool was_queue_init;
+    unsigned char *entry_points_moves;
+    size_t entry_points_moves_len, max_entry_points_moves_len;
     unsigned char *moves_to_state;
     size_t max_moves_to_state_len;
     size_t moves_to_state_len;
@@ -100,6 +120,24 @@ typedef struct
 RB_GENERATE_STATIC(
     FccEntryPointList, FccEntryPointNode, entry_, FccEntryPointNode_compare)
 
+// The depth of an FCC is the sum of the 2-bit counts of its fingerprint, and
+// every irreversible move increases it.
+static inline size_t fingerprint_calc_depth(
+    const fcs_which_moves_bitmask *const fingerprint)
+{
+    size_t depth = 0;
+    for (size_t i = 0; i < COUNT(fingerprint->s); ++i)
+    {
+        unsigned char c = fingerprint->s[i];
+        while (c != 0)
+        {
+            depth += (c & 0x3);
+            c >>= 2;
+        }
+    }
+    return depth;
+}
+
 static inline void instance_init(dbm_solver_instance *const instance,
     const fcs_dbm_common_input *const inp,
     fcs_which_moves_bitmask *fingerprint_which_irreversible_moves_bitmask,
@@ -116,26 +154,18 @@ static inline void instance_init(dbm_solver_instance *const instance,
     instance->fingerprint_which_irreversible_moves_bitmask =
         (*fingerprint_which_irreversible_moves_bitmask);
 
+    instance->fcc_exit_points_out_fh = NULL;
+    instance->fcc_exit_points_are_binary = false;
+    instance->was_queue_init = false;
+    instance->entry_points_moves = NULL;
+    instance->entry_points_moves_len = 0;
+    instance->max_entry_points_moves_len = 0;
+    instance->moves_to_state = NULL;
+    instance->max_moves_to_state_len = instance->moves_to_state_len = 0;
     instance->moves_base64_encoding_buffer = NULL;
     instance->moves_base64_encoding_buffer_max_len = 0;
-    {
-        size_t curr_depth = 0;
-        {
-            for (size_t i = 0;
-                 i < COUNT(fingerprint_which_irreversible_moves_bitmask->s);
-                 ++i)
-            {
-                unsigned char c =
-                    fingerprint_which_irreversible_moves_bitmask->s[i];
-                while (c != 0)
-                {
-                    curr_depth += (c & 0x3);
-                    c >>= 2;
-                }
-            }
-        }
-        instance->curr_depth = curr_depth;
-    }
+    instance->curr_depth =
+        fingerprint_calc_depth(fingerprint_which_irreversible_moves_bitmask);
 
     fcs_lock_init(&instance->global_lock);
     instance->offload_dir_path = inp->offload_dir_path;
@@ -150,7 +180,8 @@ static inline void instance_init(dbm_solver_instance *const instance,
 
         fcs_dbm__cache_store__init(&(coll->cache_store), &(instance->common),
             &(coll->queue_meta_alloc), inp->dbm_store_path,
-            inp->pre_cache_max_count, inp->caches_delta);
+            inp->pre_cache_max_count, inp->caches_delta,
+            inp->bloom_filter_max_count);
     }
 }
 
@@ -169,6 +200,9 @@ static inline void instance_destroy(dbm_solver_instance *const instance)
     fcs_lock_destroy(&instance->fcc_entry_points_lock);
     fcs_lock_destroy(&instance->fcc_exit_points_output_lock);
     fcs_lock_destroy(&instance->output_lock);
+    free(instance->entry_points_moves);
+    free(instance->moves_to_state);
+    free(instance->moves_base64_encoding_buffer);
 }
 
 struct fcs_dbm_solver_thread_struct
@@ -363,12 +397,8 @@ static void *instance_run_solver_thread(void *const void_arg)
             }
 
             // Encode all the states.
-            for (var_AUTO(derived_iter, derived_list); derived_iter;
-                 derived_iter = derived_iter->next)
-            {
-                fcs_init_and_encode_state(delta_stater, local_variant,
-                    &(derived_iter->state), &(derived_iter->key));
-            }
+            fcs_dbm__encode_derived_states(
+                delta_stater, local_variant, &derived_list, 1);
 
             instance_check_multiple_keys(thread, instance, &(coll->cache_store),
                 &(coll->queue_meta_alloc), &derived_list, 1
@@ -411,7 +441,7 @@ static inline void instance_alloc_num_moves(
 static inline void instance_check_key(
     dbm_solver_thread *const thread, dbm_solver_instance *const instance,
     const size_t key_depth, fcs_encoded_state_buffer *const key,
-    fcs_dbm_store_val parent, const unsigned char move GCC_UNUSED,
+    fcs_dbm_store_val parent, const unsigned char move,
     const fcs_which_moves_bitmask *const which_irreversible_moves_bitmask
 #ifndef FCS_DBM_WITHOUT_CACHES
     ,
@@ -426,7 +456,7 @@ static inline void instance_check_key(
 #endif
     const_AUTO(coll, &(instance->coll));
     fcs_dbm_record *token;
-    if ((token = cache_store__has_key(&coll->cache_store, key, parent)))
+    if ((token = cache_store__has_key(&coll->cache_store, key, parent, move)))
     {
 #ifndef FCS_DBM_WITHOUT_CACHES
         cache_store__insert_key(
@@ -468,13 +498,13 @@ static inline void instance_check_key(
             // instance_check_multiple_keys and we should not lock it here.
 #ifndef FCS_DBM__VAL_IS_ANCESTOR
             size_t trace_num;
-            fcs_encoded_state_buffer *trace;
+            fcs_dbm_record *trace;
             calc_trace(token, &trace, &trace_num);
 #endif
             {
 #ifndef FCS_DBM__VAL_IS_ANCESTOR
                 FccEntryPointNode fcc_entry_key;
-                fcc_entry_key.kv.key.key = trace[trace_num - 1];
+                fcc_entry_key.kv.key.key = trace[trace_num - 1].key;
                 FccEntryPointNode *val_proto = RB_FIND(FccEntryPointList,
 #else
                 FccEntryPointNode *val_proto = token->ancestor;
@@ -483,38 +513,13 @@ static inline void instance_check_key(
                 {
                     goto cleanup;
                 }
-                const long location_in_file =
-                    val_proto->kv.val.location_in_file;
-                fseek(instance->fingerprint_fh, location_in_file, SEEK_SET);
-
-#ifdef HAVE_GETLINE
-                if (getline(&(instance->fingerprint_line),
-                        &(instance->fingerprint_line_size),
-                        instance->fingerprint_fh) <= 0)
-                {
-                    // https://github.com/shlomif/fc-solve/issues/83
-                    fcs_lock_unlock(&instance->fcc_exit_points_output_lock);
-                    abort();
-                }
-#else
-                fgets(instance->fingerprint_line,
-                    (int)instance->fingerprint_line_size,
-                    instance->fingerprint_fh);
-#endif
-                char *const moves_to_state_enc =
-                    strchr(strchr(instance->fingerprint_line, ' ') + 1, ' ') +
-                    1;
-                char *const trailing_newline = strchr(moves_to_state_enc, '\n');
-                if (trailing_newline)
-                {
-                    *trailing_newline = '\0';
-                }
-                const size_t string_len = strlen(moves_to_state_enc);
-                instance_alloc_num_moves(
-                    instance, ((string_len * 3) >> 2) + 20);
-                base64_decode(moves_to_state_enc, string_len,
-                    ((unsigned char *)instance->moves_to_state),
-                    &(instance->moves_to_state_len));
+                const size_t moves_len = val_proto->kv.val.moves_len;
+                instance_alloc_num_moves(instance, moves_len + 20);
+                memcpy(instance->moves_to_state,
+                    &(instance->entry_points_moves[val_proto->kv.val
+                                                       .moves_offset]),
+                    moves_len);
+                instance->moves_to_state_len = moves_len;
             }
 
 #ifdef FCS_DBM__VAL_IS_ANCESTOR
@@ -535,11 +540,23 @@ static inline void instance_check_key(
             for (ssize_t i = s_trace_num; i > 0; --i)
             {
                 moves_to_state[(ssize_t)moves_to_state_len + s_trace_num - i] =
-                    get_move_from_parent_to_child(instance,
-                        &(thread->delta_stater), trace[i], trace[i - 1]);
+                    fcs_dbm_record_get_move(&(trace[i - 1]));
             }
 
 #endif
+            if (instance->fcc_exit_points_are_binary)
+            {
+                fcs_split_fcc_exit exit_point;
+                memset(&exit_point, '\0', sizeof(exit_point));
+                exit_point.fingerprint = new_fingerprint;
+                exit_point.entry.key = *key;
+                exit_point.entry.moves_len = (uint32_t)added_moves_to_output;
+                fwrite(&exit_point, sizeof(exit_point), 1,
+                    instance->fcc_exit_points_out_fh);
+                fwrite(moves_to_state, 1, added_moves_to_output,
+                    instance->fcc_exit_points_out_fh);
+                goto cleanup;
+            }
             const size_t new_max_enc_len =
                 ((added_moves_to_output * 4) / 3) + 20;
 
@@ -616,6 +633,219 @@ static void instance_run_all_threads(dbm_solver_instance *const instance,
     dbm__free_threads(instance, num_threads, threads, free_thread);
 }
 
+static inline FccEntryPointNode *instance__add_entry_point(
+    dbm_solver_instance *const instance,
+    const fcs_encoded_state_buffer *const key, const int state_depth,
+    const unsigned char *const moves, const size_t moves_len)
+{
+    FccEntryPointNode *const entry_point = fcs_compact_alloc_ptr(
+        &(instance->fcc_entry_points_allocator), sizeof(*entry_point));
+#ifdef FCS_DBM__VAL_IS_ANCESTOR
+    entry_point->kv.key.ancestor = entry_point;
+#else
+    fcs_dbm_record_set_parent_ptr(&(entry_point->kv.key), NULL);
+#endif
+    entry_point->kv.key.key = *key;
+
+    const size_t new_moves_len = instance->entry_points_moves_len + moves_len;
+    if (new_moves_len > instance->max_entry_points_moves_len)
+    {
+        instance->max_entry_points_moves_len = (new_moves_len << 1) + 64;
+        instance->entry_points_moves = SREALLOC(instance->entry_points_moves,
+            instance->max_entry_points_moves_len);
+    }
+    memcpy(&(instance->entry_points_moves[instance->entry_points_moves_len]),
+        moves, moves_len);
+    entry_point->kv.val.moves_offset = instance->entry_points_moves_len;
+    entry_point->kv.val.moves_len = moves_len;
+    instance->entry_points_moves_len = new_moves_len;
+
+    RB_INSERT(FccEntryPointList, &(instance->fcc_entry_points), entry_point);
+
+    const offloading_queue_item token =
+        ((const offloading_queue_item)(&(entry_point->kv.key)));
+    if (instance->was_queue_init)
+    {
+        fcs_depth_multi_queue__insert(
+            &(instance->coll.depth_queue), state_depth, &(token));
+    }
+    else
+    {
+        fcs_depth_multi_queue__init(&(instance->coll.depth_queue),
+            instance->offload_dir_path, state_depth, &(token));
+        instance->was_queue_init = true;
+    }
+    ++instance->common.num_states_in_collection;
+    ++instance->common.count_of_items_in_queue;
+
+    return entry_point;
+}
+
+// Reads the entry points from lines of "[state] [depth] [moves]" where the
+// state and the moves are base64 encoded.
+static FccEntryPointNode *instance__load_text_entry_points(
+    dbm_solver_instance *const instance, const char *const path)
+{
+    FILE *const fh = fopen(path, "rt");
+    if (!fh)
+    {
+        exit_error("Cannot open '%s' for reading. Exiting.", path);
+    }
+    FccEntryPointNode *key_ptr = NULL;
+#ifdef HAVE_GETLINE
+    char *line = NULL;
+    size_t line_size = 0;
+    while (getline(&line, &line_size, fh) != -1)
+#else
+    size_t line_size = 16000;
+    char *line = SMALLOC(line, line_size);
+    while (fgets(line, (int)line_size - 1, fh))
+#endif
+    {
+        char state_base64[100] = {0};
+        int state_depth = -1;
+        if ((2 != sscanf(line, "%99s %d", state_base64, &state_depth)) ||
+            (state_depth < 0))
+        {
+            exit_error("Wrongly input state_depth!\n");
+        }
+        fcs_encoded_state_buffer key;
+        size_t key_size;
+        base64_decode(state_base64, strlen(state_base64),
+            ((unsigned char *)&key), &(key_size));
+        assert(key_size == sizeof(key));
+
+        char *const moves_to_state_enc =
+            strchr(strchr(line, ' ') + 1, ' ') + 1;
+        char *const trailing_newline = strchr(moves_to_state_enc, '\n');
+        if (trailing_newline)
+        {
+            *trailing_newline = '\0';
+        }
+        const size_t string_len = strlen(moves_to_state_enc);
+        instance_alloc_num_moves(instance, ((string_len * 3) >> 2) + 20);
+        size_t moves_len;
+        base64_decode(moves_to_state_enc, string_len,
+            instance->moves_to_state, &moves_len);
+
+        // TODO : Should traverse starting from key.
+        key_ptr = instance__add_entry_point(
+            instance, &key, state_depth, instance->moves_to_state, moves_len);
+    }
+    free(line);
+    fclose(fh);
+
+    return key_ptr;
+}
+
+typedef struct
+{
+    fcs_split_fcc_entry entry;
+    size_t moves_offset;
+} split_fcc_loaded_entry;
+
+static int split_fcc_loaded_entry_compare(
+    const void *const void_a, const void *const void_b)
+{
+    const split_fcc_loaded_entry *const a = void_a, *const b = void_b;
+    const int ret = compare_enc_states(&(a->entry.key), &(b->entry.key));
+    if (ret)
+    {
+        return ret;
+    }
+    return ((a->entry.moves_len < b->entry.moves_len)
+                ? -1
+                : (a->entry.moves_len > b->entry.moves_len));
+}
+
+// Reads fcs_split_fcc_entry records, which may have been appended by several
+// FCCs, and keeps only the shortest way to every entry point.
+static FccEntryPointNode *instance__load_binary_entry_points(
+    dbm_solver_instance *const instance, const char *const path)
+{
+    FILE *const fh = fopen(path, "rb");
+    if (!fh)
+    {
+        exit_error("Cannot open '%s' for reading. Exiting.", path);
+    }
+    split_fcc_loaded_entry *entries = NULL;
+    size_t num_entries = 0, max_num_entries = 0;
+    unsigned char *moves = NULL;
+    size_t moves_len = 0, max_moves_len = 0;
+    fcs_split_fcc_entry entry;
+    while (fread(&entry, sizeof(entry), 1, fh) == 1)
+    {
+        if (num_entries == max_num_entries)
+        {
+            max_num_entries = (max_num_entries << 1) + 64;
+            entries = SREALLOC(entries, max_num_entries);
+        }
+        if (moves_len + entry.moves_len > max_moves_len)
+        {
+            max_moves_len = ((moves_len + entry.moves_len) << 1) + 64;
+            moves = SREALLOC(moves, max_moves_len);
+        }
+        if (fread(&moves[moves_len], 1, entry.moves_len, fh) !=
+            entry.moves_len)
+        {
+            exit_error("'%s' is truncated. Exiting.", path);
+        }
+        entries[num_entries++] =
+            (split_fcc_loaded_entry){.entry = entry, .moves_offset = moves_len};
+        moves_len += entry.moves_len;
+    }
+    fclose(fh);
+
+    qsort(entries, num_entries, sizeof(entries[0]),
+        split_fcc_loaded_entry_compare);
+
+    FccEntryPointNode *key_ptr = NULL;
+    for (size_t i = 0; i < num_entries; ++i)
+    {
+        const_AUTO(e, &(entries[i]));
+        if (i && (!compare_enc_states(&(e->entry.key), &(e[-1].entry.key))))
+        {
+            continue;
+        }
+        key_ptr = instance__add_entry_point(instance, &(e->entry.key),
+            (int)e->entry.moves_len, &(moves[e->moves_offset]),
+            e->entry.moves_len);
+    }
+    free(entries);
+    free(moves);
+
+    return key_ptr;
+}
+
+// Solves the FCC whose entry points were loaded into the instance, writes its
+// exit points into exits_fn and destroys the instance. Returns whether a
+// solution was found.
+static bool instance__solve_fcc(dbm_solver_instance *const instance,
+    fcs_state_keyval_pair *const init_state, fcs_delta_stater *const delta,
+    FccEntryPointNode *const key_ptr, const char *const exits_fn,
+    const size_t num_threads)
+{
+    if (!instance->was_queue_init)
+    {
+        exit_error("%s\n", "No entry points were input.");
+    }
+    char exits_fn_temp[PATH_MAX + 1];
+    snprintf(exits_fn_temp, PATH_MAX, "%s.temp", exits_fn);
+    if (!(instance->fcc_exit_points_out_fh = fopen(exits_fn_temp,
+              (instance->fcc_exit_points_are_binary ? "wb" : "wt"))))
+    {
+        exit_error("Cannot open '%s' for writing. Exiting.", exits_fn_temp);
+    }
+
+    instance_run_all_threads(instance, init_state, key_ptr, num_threads);
+    fclose(instance->fcc_exit_points_out_fh);
+    rename(exits_fn_temp, exits_fn);
+
+    return handle_and_destroy_instance_solution(instance, delta);
+}
+
+#include "split_fcc_coordinator.h"
+
 int main(int argc, char *argv[])
 {
     apr_initialize();
@@ -628,6 +858,8 @@ int main(int argc, char *argv[])
     const char *fingerprint_input_location_path = NULL;
     const char *path_to_output_dir = NULL;
     const char *filename = NULL;
+    bool should_coordinate = false;
+    size_t num_workers = 2;
     DECLARE_IND_BUF_T(init_indirect_stacks_buffer)
     const char *param;
     fcs_dbm_common_input inp = fcs_dbm_common_input_init;
@@ -654,6 +886,17 @@ int main(int argc, char *argv[])
         {
             fingerprint_input_location_path = param;
         }
+        else if (!strcmp(argv[arg], "--coordinate"))
+        {
+            should_coordinate = true;
+        }
+        else if ((param = TRY_P("--num-workers")))
+        {
+            if ((num_workers = (size_t)atoi(param)) < 1)
+            {
+                exit_error("--num-workers must be at least 1.\n");
+            }
+        }
         else
         {
             break;
@@ -665,9 +908,18 @@ int main(int argc, char *argv[])
         exit_error("%s\n", "Junk at the end of the parameters");
     }
 
-    if (!(filename && fingerprint_input_location_path &&
-            mod_base64_fcc_fingerprint && path_to_output_dir &&
-            inp.offload_dir_path))
+    if (should_coordinate)
+    {
+        if (!(filename && path_to_output_dir && inp.offload_dir_path))
+        {
+            exit_error(
+                "One or more of these parameters was not specified: %s\n",
+                "--board, --output, --offload-dir-path");
+        }
+    }
+    else if (!(filename && fingerprint_input_location_path &&
+                 mod_base64_fcc_fingerprint && path_to_output_dir &&
+                 inp.offload_dir_path))
     {
         exit_error("One or more of these parameters was not specified: %s\n",
             "--board, --fingerprint, --input, --output, --offload-dir-path");
@@ -676,156 +928,48 @@ int main(int argc, char *argv[])
     read_state_from_file(inp.local_variant, filename,
         &init_state PASS_IND_BUF_T(init_indirect_stacks_buffer));
     horne_prune__simple(inp.local_variant, &init_state);
-    fcs_which_moves_bitmask fingerprint_which_irreversible_moves_bitmask = {
-        {'\0'}};
-    {
-        size_t fingerprint_data_len = 0;
-        base64_decode(mod_base64_fcc_fingerprint,
-            strlen(mod_base64_fcc_fingerprint),
-            fingerprint_which_irreversible_moves_bitmask.s,
-            &fingerprint_data_len);
-
-        if (fingerprint_data_len !=
-            sizeof(fingerprint_which_irreversible_moves_bitmask))
-        {
-            exit_error("%s\n", "--fingerprint is invalid length.");
-        }
-    }
 
     const_AUTO(local_variant, inp.local_variant);
 #ifndef FCS_DBM_SINGLE_THREAD
     const_AUTO(num_threads, inp.num_threads);
 #endif
-    // Calculate the fingerprint_which_irreversible_moves_bitmask's curr_depth.
     fcs_delta_stater delta;
     fc_solve_delta_stater_init(&delta, local_variant, &init_state.s, STACKS_NUM,
         FREECELLS_NUM PASS_ON_NOT_FC_ONLY(CALC_SEQUENCES_ARE_BUILT_BY()));
 
-    dbm_solver_instance instance;
-    FccEntryPointNode *key_ptr = NULL;
-    fcs_encoded_state_buffer parent_state_enc;
-
-    instance_init(
-        &instance, &inp, &fingerprint_which_irreversible_moves_bitmask, stdout);
-
-    FILE *fingerprint_fh = fopen(fingerprint_input_location_path, "rt");
-    if (!fingerprint_fh)
+    if (should_coordinate)
     {
-        exit_error("Cannot open '%s' for reading. Exiting.",
-            fingerprint_input_location_path);
+        split_fcc__coordinate(
+            &inp, path_to_output_dir, num_workers, &init_state, &delta);
     }
-
-#ifdef HAVE_GETLINE
-    instance.fingerprint_line = NULL;
-    instance.fingerprint_line_size = 0;
-#else
-    instance.fingerprint_line_size = 16000;
-    instance.fingerprint_line =
-        SMALLOC(instance.fingerprint_line, instance.fingerprint_line_size);
-#endif
-
-    long location_in_file = 0;
-    bool was_init = false;
-#ifdef HAVE_GETLINE
-    while (getline(&instance.fingerprint_line, &instance.fingerprint_line_size,
-               fingerprint_fh) != -1)
-#else
-    while (fgets(instance.fingerprint_line,
-        (int)instance.fingerprint_line_size - 1, fingerprint_fh))
-#endif
+    else
     {
-        FccEntryPointNode *const entry_point = fcs_compact_alloc_ptr(
-            &(instance.fcc_entry_points_allocator), sizeof(*entry_point));
-#ifdef FCS_DBM__VAL_IS_ANCESTOR
-        entry_point->kv.key.ancestor = entry_point;
-#else
-        fcs_dbm_record_set_parent_ptr(&(entry_point->kv.key), NULL);
-#endif
-        char state_base64[100] = {0};
-        int state_depth = -1;
-        assert(2 == sscanf(instance.fingerprint_line, "%99s %d", state_base64,
-                        &state_depth));
-        if (state_depth < 0)
-        {
-            exit_error("Wrongly input state_depth!\n");
-        }
-        size_t unused_size;
-        base64_decode(state_base64, strlen(state_base64),
-            ((unsigned char *)&(entry_point->kv.key.key)), &(unused_size));
-
-        assert(unused_size == sizeof(entry_point->kv.key.key));
-
-        // TODO : Should traverse starting from key.
-        key_ptr = entry_point;
-        // The NULL parent_state_enc and move for indicating this is the initial
-        // state.
-        fcs_init_encoded_state(&(parent_state_enc));
-
-// These states should be traversed - not blocked, so don't put them inside the
-// store.
-#if 0
-#ifndef FCS_DBM_WITHOUT_CACHES
-        cache_store__insert_key(&(instance.cache_store), &(key_ptr->kv.key.key), &parent_state_enc, NULL, '\0');
-#else
-        token = fc_solve_dbm_store_insert_key_value(instance.coll.store, &(key_ptr->kv.key.key), NULL, true);
-#endif
-
-#if 0
-        entry_point->kv.val.was_consumed =
-            entry_point->kv.val.is_reachable =
-            false;
-#endif
-#endif
-        entry_point->kv.val.location_in_file = location_in_file;
-
-        RB_INSERT(FccEntryPointList, &(instance.fcc_entry_points), entry_point);
+        fcs_which_moves_bitmask fingerprint_which_irreversible_moves_bitmask =
+            {{'\0'}};
+        size_t fingerprint_data_len = 0;
+        base64_decode(mod_base64_fcc_fingerprint,
+            strlen(mod_base64_fcc_fingerprint),
+            fingerprint_which_irreversible_moves_bitmask.s,
+            &fingerprint_data_len);
 
+        if (fingerprint_data_len !=
+            sizeof(fingerprint_which_irreversible_moves_bitmask))
         {
-            const offloading_queue_item token =
-                ((const offloading_queue_item)(&(entry_point->kv.key)));
-            if (was_init)
-            {
-                fcs_depth_multi_queue__insert(
-                    &(instance.coll.depth_queue), state_depth, &(token));
-            }
-            else
-            {
-                fcs_depth_multi_queue__init(&(instance.coll.depth_queue),
-                    instance.offload_dir_path, state_depth, &(token));
-                was_init = true;
-            }
+            exit_error("%s\n", "--fingerprint is invalid length.");
         }
-        ++instance.common.num_states_in_collection;
-        ++instance.common.count_of_items_in_queue;
-        // Valid for the next iteration:
-        location_in_file = ftell(fingerprint_fh);
-    }
 
-    fseek(fingerprint_fh, 0, SEEK_SET);
-    instance.fingerprint_fh = fingerprint_fh;
-
-    long count_of_instance_runs = 0;
-    instance.moves_to_state = NULL;
-    instance.max_moves_to_state_len = instance.moves_to_state_len = 0;
-
-    ++count_of_instance_runs;
-
-    char fcc_exit_points_out_fn[PATH_MAX - 40],
-        fcc_exit_points_out_fn_temp[PATH_MAX + 1];
-    snprintf(fcc_exit_points_out_fn, COUNT(fcc_exit_points_out_fn),
-        "%s/exits.%ld", path_to_output_dir, count_of_instance_runs);
-    snprintf(fcc_exit_points_out_fn_temp, PATH_MAX, "%s.temp",
-        fcc_exit_points_out_fn);
-    instance.fcc_exit_points_out_fh = fopen(fcc_exit_points_out_fn_temp, "wt");
-
-    instance_run_all_threads(&instance, &init_state, key_ptr, NUM_THREADS());
-    fclose(instance.fcc_exit_points_out_fh);
-    rename(fcc_exit_points_out_fn_temp, fcc_exit_points_out_fn);
-    fclose(fingerprint_fh);
-    handle_and_destroy_instance_solution(&instance, &delta);
-    free(instance.moves_to_state);
-    free(instance.moves_base64_encoding_buffer);
-    free(instance.fingerprint_line);
+        dbm_solver_instance instance;
+        instance_init(&instance, &inp,
+            &fingerprint_which_irreversible_moves_bitmask, stdout);
+        FccEntryPointNode *const key_ptr = instance__load_text_entry_points(
+            &instance, fingerprint_input_location_path);
+
+        char fcc_exit_points_out_fn[PATH_MAX - 40];
+        snprintf(fcc_exit_points_out_fn, COUNT(fcc_exit_points_out_fn),
+            "%s/exits.1", path_to_output_dir);
+        instance__solve_fcc(&instance, &init_state, &delta, key_ptr,
+            fcc_exit_points_out_fn, NUM_THREADS());
+    }
     fc_solve_delta_stater_release(&delta);
     apr_terminate();
     return 0;
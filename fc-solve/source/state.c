@@ -21,15 +21,37 @@ static inline int fcs_stack_compare(const void *s1, const void *s2)
 #define GET_STACK(c) fcs_state_get_col(*state_key, (c))
 #ifdef COMPACT_STATES
 
-#define DECLARE_TEMP_STACK() char temp_stack[FCS_CARDS_COL_WIDTH]
-#define STACK_COMPARE(a, b) (fcs_stack_compare((a), (b)))
-#define COPY_STACK(d, s) (memcpy(d, s, FCS_CARDS_COL_WIDTH))
+#define DECLARE_SORT_KEYS()
+#define STACK_IS_LESS(a, b)                                                    \
+    (fcs_stack_compare(GET_STACK(a), GET_STACK(b)) < 0)
+#define SWAP_STACKS(a, b)                                                      \
+    {                                                                          \
+        char temp_stack[FCS_CARDS_COL_WIDTH];                                  \
+        memcpy(temp_stack, GET_STACK(a), FCS_CARDS_COL_WIDTH);                 \
+        memcpy(GET_STACK(a), GET_STACK(b), FCS_CARDS_COL_WIDTH);               \
+        memcpy(GET_STACK(b), temp_stack, FCS_CARDS_COL_WIDTH);                 \
+    }
 
 #elif defined(INDIRECT_STACK_STATES)
 
-#define DECLARE_TEMP_STACK() fcs_card *temp_stack
-#define STACK_COMPARE(a, b) (fc_solve_stack_compare_for_canonize(a, b))
-#define COPY_STACK(d, s) (d = s)
+// The columns are only pointed to, so their sort keys are read once, instead
+// of dereferencing two columns in every comparison.
+#define DECLARE_SORT_KEYS()                                                    \
+    fcs_card sort_keys[MAX_NUM_STACKS];                                        \
+    for (size_t i = 0; i < STACKS_NUM__VAL; ++i)                               \
+    {                                                                          \
+        sort_keys[i] = fc_solve_stack_sort_key(GET_STACK(i));                  \
+    }
+#define STACK_IS_LESS(a, b) (sort_keys[a] < sort_keys[b])
+#define SWAP_STACKS(a, b)                                                      \
+    {                                                                          \
+        const fcs_cards_column temp_stack = GET_STACK(a);                      \
+        GET_STACK(a) = GET_STACK(b);                                           \
+        GET_STACK(b) = temp_stack;                                             \
+        const fcs_card temp_key = sort_keys[a];                                \
+        sort_keys[a] = sort_keys[b];                                           \
+        sort_keys[b] = temp_key;                                               \
+    }
 
 #endif
 #if MAX_NUM_FREECELLS > 0
@@ -40,19 +62,15 @@ void fc_solve_canonize_state(
     fcs_state *const ptr_state_key FREECELLS_AND_STACKS_ARGS())
 {
 #define state_key (ptr_state_key)
+    DECLARE_SORT_KEYS();
     // Insertion-sort the columns
 
     for (size_t b = 1; b < STACKS_NUM__VAL; b++)
     {
         size_t c = b;
-        while ((c > 0) && ((STACK_COMPARE(GET_STACK(c), GET_STACK(c - 1))) < 0))
+        while ((c > 0) && STACK_IS_LESS(c, c - 1))
         {
-            {
-                DECLARE_TEMP_STACK();
-                COPY_STACK(temp_stack, GET_STACK(c));
-                COPY_STACK(GET_STACK(c), GET_STACK(c - 1));
-                COPY_STACK(GET_STACK(c - 1), temp_stack);
-            }
+            SWAP_STACKS(c, c - 1);
 
             --c;
         }
@@ -83,18 +101,14 @@ void fc_solve_canonize_state_with_locs(fcs_state *const ptr_state_key,
 #define state_key (ptr_state_key)
     fcs_state_locs_struct *const locs FREECELLS_AND_STACKS_ARGS())
 {
+    DECLARE_SORT_KEYS();
     // Insertion-sort the columns
     for (size_t b = 1; b < STACKS_NUM__VAL; b++)
     {
         size_t c = b;
-        while ((c > 0) && ((STACK_COMPARE(GET_STACK(c), GET_STACK(c - 1))) < 0))
+        while ((c > 0) && STACK_IS_LESS(c, c - 1))
         {
-            {
-                DECLARE_TEMP_STACK();
-                COPY_STACK(temp_stack, GET_STACK(c));
-                COPY_STACK(GET_STACK(c), GET_STACK(c - 1));
-                COPY_STACK(GET_STACK(c - 1), temp_stack);
-            }
+            SWAP_STACKS(c, c - 1);
 
             const_AUTO(swap_loc, locs->stack_locs[c]);
             locs->stack_locs[c] = locs->stack_locs[c - 1];
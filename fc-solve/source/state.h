@@ -46,8 +46,9 @@ extern "C" {
 #define FCS_CHAR_BIT_SIZE_LOG2 3
 #define MAX_NUM_SCANS (FCS_MAX_NUM_SCANS_BUCKETS * (sizeof(unsigned char) * 8))
 
-#define is_scan_visited(ptr_state, scan_id)                                    \
-    ((FCS_S_SCAN_VISITED(ptr_state))[(scan_id) >> FCS_CHAR_BIT_SIZE_LOG2] &    \
+#define is_scan_visited(instance, ptr_state, scan_id)                          \
+    ((FCS_S_SCAN_VISITED(                                                      \
+         instance, ptr_state))[(scan_id) >> FCS_CHAR_BIT_SIZE_LOG2] &          \
         (1 << ((scan_id) & ((1 << (FCS_CHAR_BIT_SIZE_LOG2)) - 1))))
 
 typedef uint_fast16_t stack_i;
@@ -196,6 +197,10 @@ static inline bool fcs_col_is_king(
 
 struct fcs_state_keyval_pair_struct;
 
+#ifdef FCS_WITH_STATE_SIDE_TABLES
+#include "state_side_tables.h"
+#endif
+
 // NOTE: the order of elements here is intended to reduce framgmentation
 // and memory consumption. Namely:
 //
@@ -204,12 +209,17 @@ struct fcs_state_keyval_pair_struct;
 // 3. chars come next.
 struct fcs_state_extra_info_struct
 {
+#ifdef FCS_WITH_STATE_SIDE_TABLES
+    // The index of the state's entries in the instance's state_side_tables,
+    // which hold the rest of its extra info.
+    fcs_state_id id;
+#else
 #ifdef FCS_RCS_STATES
     struct fcs_state_extra_info_struct *parent;
 #else
     struct fcs_state_keyval_pair_struct *parent;
 #endif
-#ifdef FCS_WITH_MOVES
+#ifdef FCS_WITH_MOVES_TO_PARENT
     fcs_move_stack *moves_to_parent;
 #endif
 
@@ -245,11 +255,16 @@ struct fcs_state_extra_info_struct
     // FCS_VISITED_GENERATED_BY_PRUNING - indicates that the state was
     // generated by pruning, so one can skip calling the pruning function
     // for it.
+    //
+    // FCS_VISITED_PINNED - is set temporarily while the dead ends are swept
+    // out of the collection, on the states that a scan is positioned at, so
+    // they will not be swept.
     fcs_game_limit visited;
 
     // This is a vector of flags - one for each scan. Each indicates whether
     // its scan has already visited this state
     unsigned char scan_visited[FCS_MAX_NUM_SCANS_BUCKETS];
+#endif
 
 #ifdef INDIRECT_STACK_STATES
     // A vector of flags that indicates which columns were already copied.
@@ -369,17 +384,34 @@ static inline void FCS_STATE_collectible_to_kv(
 
 #endif
 
-#define FCS_S_NEXT(s) FCS_S_ACCESSOR(s, parent)
-#define FCS_S_PARENT(s) FCS_S_ACCESSOR(s, parent)
-#define FCS_S_NUM_ACTIVE_CHILDREN(s) FCS_S_ACCESSOR(s, num_active_children)
-#define FCS_S_MOVES_TO_PARENT(s) FCS_S_ACCESSOR(s, moves_to_parent)
-#define FCS_S_VISITED(s) FCS_S_ACCESSOR(s, visited)
-#define FCS_S_SCAN_VISITED(s) FCS_S_ACCESSOR(s, scan_visited)
+#ifdef FCS_WITH_STATE_SIDE_TABLES
+// The extra info of a state is kept in the side tables of its instance.
+#define FCS_S_SIDE_ENTRY(instance, s, chunks)                                  \
+    FCS_STATE_SIDE_TABLES_ENTRY(                                               \
+        &((instance)->state_side_tables), chunks, FCS_S_ACCESSOR(s, id))
+#define FCS_S_FIELD(instance, s, field)                                        \
+    FCS_S_SIDE_ENTRY(instance, s, field##_chunks)
+#define FCS_S_HOT_FIELD(instance, s, field)                                    \
+    (FCS_S_SIDE_ENTRY(instance, s, hot_chunks).field)
+#else
+#define FCS_S_FIELD(instance, s, field) FCS_S_ACCESSOR(s, field)
+#define FCS_S_HOT_FIELD(instance, s, field) FCS_S_ACCESSOR(s, field)
+#endif
+
+#define FCS_S_NEXT(instance, s) FCS_S_FIELD(instance, s, parent)
+#define FCS_S_PARENT(instance, s) FCS_S_FIELD(instance, s, parent)
+#define FCS_S_NUM_ACTIVE_CHILDREN(instance, s)                                 \
+    FCS_S_HOT_FIELD(instance, s, num_active_children)
+#define FCS_S_MOVES_TO_PARENT(instance, s)                                     \
+    FCS_S_FIELD(instance, s, moves_to_parent)
+#define FCS_S_VISITED(instance, s) FCS_S_HOT_FIELD(instance, s, visited)
 #ifdef FCS_WITH_DEPTH_FIELD
-#define FCS_S_DEPTH(s) FCS_S_ACCESSOR(s, depth)
+#define FCS_S_DEPTH(instance, s) FCS_S_FIELD(instance, s, depth)
 #endif
+#define FCS_S_SCAN_VISITED(instance, s)                                        \
+    FCS_S_HOT_FIELD(instance, s, scan_visited)
 #ifndef FCS_WITHOUT_VISITED_ITER
-#define FCS_S_VISITED_ITER(s) FCS_S_ACCESSOR(s, visited_iter)
+#define FCS_S_VISITED_ITER(instance, s) FCS_S_FIELD(instance, s, visited_iter)
 #endif
 
 #define fc_solve_empty_card ((fcs_card)0)
@@ -573,19 +605,23 @@ static inline void fc_solve_state_init_proto(fcs_state_keyval_pair *const state
         state->s.columns[i] = NULL;
     }
 #endif
+#ifdef FCS_WITH_STATE_SIDE_TABLES
+    state->info.id = 0;
+#else
     state->info.parent = NULL;
-#ifdef FCS_WITH_MOVES
+#ifdef FCS_WITH_MOVES_TO_PARENT
     state->info.moves_to_parent = NULL;
 #endif
 #ifdef FCS_WITH_DEPTH_FIELD
     state->info.depth = 0;
 #endif
     state->info.visited = 0;
+    state->info.num_active_children = 0;
 #ifndef FCS_WITHOUT_VISITED_ITER
     state->info.visited_iter = 0;
 #endif
-    state->info.num_active_children = 0;
     memset(state->info.scan_visited, '\0', sizeof(state->info.scan_visited));
+#endif
 #ifdef INDIRECT_STACK_STATES
     state->info.stacks_copy_on_write_flags = 0;
 #endif
@@ -930,6 +966,7 @@ enum
     FCS_VISITED_DEAD_END = 0x4,
     FCS_VISITED_ALL_TESTS_DONE = 0x8,
     FCS_VISITED_GENERATED_BY_PRUNING = 0x10,
+    FCS_VISITED_PINNED = 0x20,
 };
 
 static inline int fc_solve_card_compare(const fcs_card c1, const fcs_card c2)
@@ -977,50 +1014,63 @@ static inline int fc_solve_stack_compare_for_comparison(
     }
 }
 
-static inline int fc_solve_stack_compare_for_canonize(
-    const void *const v_s1, const void *const v_s2)
+// The empty columns come first, and the rest are ordered by their first
+// cards, which are never fc_solve_empty_card.
+static inline fcs_card fc_solve_stack_sort_key(
+    const fcs_const_cards_column col)
 {
-    const fcs_card *const s1 = (const fcs_card *const)v_s1;
-    const fcs_card *const s2 = (const fcs_card *const)v_s2;
+    return (fcs_col_len(col) ? fcs_col_get_card(col, 0) : fc_solve_empty_card);
+}
+#endif
 
+// Unlike fc_solve_state_compare(), it also compares the columns of
+// INDIRECT_STACK_STATES by their cards, so they do not have to be cached.
+static inline bool fc_solve_state_is_equal(
+    const fcs_state *const s1, const fcs_state *const s2)
+{
+#ifdef INDIRECT_STACK_STATES
+    for (size_t i = 0; i < MAX_NUM_STACKS; ++i)
     {
-#ifdef __cplusplus
-        using std::min;
-#endif
-        const int min_len = min(s1[0], s2[0]);
-        if (min_len)
+        const_AUTO(col1, fcs_state_get_col(*s1, i));
+        const_AUTO(col2, fcs_state_get_col(*s2, i));
+        if ((col1 != col2) &&
+            ((!col1) || (!col2) ||
+                fc_solve_stack_compare_for_comparison(col1, col2)))
         {
-            return fc_solve_card_compare(s1[1], s2[1]);
+            return false;
         }
     }
-    // The reason I do the stack length comparisons after the card-by-card
-    // comparison is to maintain correspondence with
-    // fcs_stack_compare_for_stack_sort, and with the one card comparison
-    // of the other state representation mechanisms.
-
-    // For some reason this code is faster than s1[0]-s2[0]
-    if (s1[0] < s2[0])
-    {
-        return -1;
-    }
-    else if (s1[0] > s2[0])
-    {
-        return 1;
-    }
-    else
-    {
-        return 0;
-    }
-}
+    return (
+#if MAX_NUM_FREECELLS > 0
+        !memcmp(s1->freecells, s2->freecells, sizeof(s1->freecells)) &&
+#endif
+        !memcmp(s1->foundations, s2->foundations, sizeof(s1->foundations)));
+#else
+    return !fc_solve_state_compare(s1, s2);
 #endif
+}
 
-static inline void set_scan_visited(
-    fcs_collectible_state *const ptr_state, const size_t scan_id)
+static inline void fcs_set_scan_visited_flag(
+    unsigned char *const scan_visited, const size_t scan_id)
 {
-    (FCS_S_SCAN_VISITED(ptr_state))[scan_id >> FCS_CHAR_BIT_SIZE_LOG2] |=
+    scan_visited[scan_id >> FCS_CHAR_BIT_SIZE_LOG2] |=
         (1 << ((scan_id) & ((1 << (FCS_CHAR_BIT_SIZE_LOG2)) - 1)));
 }
 
+static inline void fcs_unset_scan_visited_flag(
+    unsigned char *const scan_visited, const size_t scan_id)
+{
+    scan_visited[scan_id >> FCS_CHAR_BIT_SIZE_LOG2] &= (unsigned char)(~(
+        1 << ((scan_id) & ((1 << (FCS_CHAR_BIT_SIZE_LOG2)) - 1))));
+}
+
+#define set_scan_visited(instance, ptr_state, scan_id)                         \
+    fcs_set_scan_visited_flag(                                                 \
+        FCS_S_SCAN_VISITED(instance, ptr_state), (scan_id))
+#define unset_scan_visited(instance, ptr_state, scan_id)                       \
+    fcs_unset_scan_visited_flag(                                               \
+        FCS_S_SCAN_VISITED(instance, ptr_state), (scan_id))
+
 // This macro determines if child can be placed above parent.
 //
 // The variable sequences_are_built_by has to be initialized to
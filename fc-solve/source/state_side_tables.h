@@ -0,0 +1,165 @@
+// This file is part of Freecell Solver. It is subject to the license terms in
+// the COPYING.txt file found in the top-level directory of this distribution
+// and at http://fc-solve.shlomifish.org/docs/distro/COPYING.html . No part of
+// Freecell Solver, including this file, may be copied, modified, propagated,
+// or distributed except according to the terms contained in the COPYING file.
+//
+// Copyright (c) 2026 Shlomi Fish
+// state_side_tables.h - the extra info of the collected states (their flags,
+// parents, moves to the parents, depths and visited_iter's), which is kept in
+// parallel arrays instead of inside the states. A slot of a state gets a
+// dense 32-bit id, which indexes these arrays, when the first state that is
+// derived into it is added to the collection. The id stays with the slot when
+// it is recycled through the list of vacant states, so the ids are bounded by
+// the peak number of the states.
+//
+// The arrays are allocated in chunks which are kept when the instance is
+// recycled, so resetting them only rewinds the next id.
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "rinutils/alloc_wrap.h"
+
+#ifdef FCS_DISABLE_NUM_STORED_STATES
+#error "The state side tables need the number of the stored states."
+#endif
+
+typedef uint32_t fcs_state_id;
+#define FCS_STATE_ID_MAX UINT32_MAX
+// The limit on the number of the states in the collection, which leaves
+// room for the states that are derived before the limit is checked again,
+// and for the ids of the special states such as the dead-end state.
+#define FCS_STATE_SIDE_TABLES_MAX_NUM_STATES                                   \
+    ((fcs_iters_int)(FCS_STATE_ID_MAX - (1 << 20)))
+
+// The fields that the scans test for every derived state are packed together.
+typedef struct
+{
+    unsigned char scan_visited[FCS_MAX_NUM_SCANS_BUCKETS];
+    fcs_game_limit visited;
+    unsigned short num_active_children;
+} fcs_state_hot_fields;
+
+#ifdef FCS_RCS_STATES
+typedef struct fcs_state_extra_info_struct *fcs_state_parent_ptr;
+#else
+typedef struct fcs_state_keyval_pair_struct *fcs_state_parent_ptr;
+#endif
+
+#define FCS_STATE_SIDE_TABLES_CHUNK_SIZE_LOG2 14
+#define FCS_STATE_SIDE_TABLES_CHUNK_SIZE                                       \
+    (((fcs_state_id)1) << FCS_STATE_SIDE_TABLES_CHUNK_SIZE_LOG2)
+
+typedef struct
+{
+    fcs_state_hot_fields **hot_chunks;
+    fcs_state_parent_ptr **parent_chunks;
+#ifdef FCS_WITH_MOVES_TO_PARENT
+    fcs_move_stack ***moves_to_parent_chunks;
+#endif
+#ifdef FCS_WITH_DEPTH_FIELD
+    int **depth_chunks;
+#endif
+#ifndef FCS_WITHOUT_VISITED_ITER
+    fcs_iters_int **visited_iter_chunks;
+#endif
+    size_t num_chunks;
+    fcs_state_id next_id;
+} fcs_state_side_tables;
+
+// The entry of the id in the chunks of one of the side tables.
+#define FCS_STATE_SIDE_TABLES_ENTRY(tables, chunks, id)                        \
+    ((tables)->chunks[(id) >> FCS_STATE_SIDE_TABLES_CHUNK_SIZE_LOG2]           \
+                     [(id) & (FCS_STATE_SIDE_TABLES_CHUNK_SIZE - 1)])
+
+#ifdef FCS_WITH_MOVES_TO_PARENT
+#define FCS_STATE_SIDE_TABLES__MOVES_TO_PARENT(op) op(moves_to_parent_chunks)
+#else
+#define FCS_STATE_SIDE_TABLES__MOVES_TO_PARENT(op)
+#endif
+#ifdef FCS_WITH_DEPTH_FIELD
+#define FCS_STATE_SIDE_TABLES__DEPTH(op) op(depth_chunks)
+#else
+#define FCS_STATE_SIDE_TABLES__DEPTH(op)
+#endif
+#ifndef FCS_WITHOUT_VISITED_ITER
+#define FCS_STATE_SIDE_TABLES__VISITED_ITER(op) op(visited_iter_chunks)
+#else
+#define FCS_STATE_SIDE_TABLES__VISITED_ITER(op)
+#endif
+// Applies op to every one of the chunks' arrays.
+#define FCS_STATE_SIDE_TABLES__FOREACH(op)                                     \
+    op(hot_chunks) op(parent_chunks)                                           \
+        FCS_STATE_SIDE_TABLES__MOVES_TO_PARENT(op)                             \
+            FCS_STATE_SIDE_TABLES__DEPTH(op)                                   \
+                FCS_STATE_SIDE_TABLES__VISITED_ITER(op)
+
+static inline void fc_solve_state_side_tables_init(
+    fcs_state_side_tables *const tables)
+{
+#define INIT(chunks) tables->chunks = NULL;
+    FCS_STATE_SIDE_TABLES__FOREACH(INIT)
+#undef INIT
+    tables->num_chunks = 0;
+    tables->next_id = 0;
+}
+
+static inline void fc_solve_state_side_tables_recycle(
+    fcs_state_side_tables *const tables)
+{
+    tables->next_id = 0;
+}
+
+static inline void fc_solve_state_side_tables_free(
+    fcs_state_side_tables *const tables)
+{
+#define FREE(chunks)                                                           \
+    for (size_t i = 0; i < tables->num_chunks; ++i)                            \
+    {                                                                          \
+        free(tables->chunks[i]);                                               \
+    }                                                                          \
+    free(tables->chunks);
+    FCS_STATE_SIDE_TABLES__FOREACH(FREE)
+#undef FREE
+    fc_solve_state_side_tables_init(tables);
+}
+
+// Returns a new id, whose entries are cleared.
+static inline fcs_state_id fc_solve_state_side_tables_new_id(
+    fcs_state_side_tables *const tables)
+{
+    const fcs_state_id id = tables->next_id++;
+    const size_t chunk_idx = (id >> FCS_STATE_SIDE_TABLES_CHUNK_SIZE_LOG2);
+    if (unlikely(chunk_idx == tables->num_chunks))
+    {
+        ++tables->num_chunks;
+#define GROW(chunks)                                                           \
+    tables->chunks = SREALLOC(tables->chunks, tables->num_chunks);             \
+    tables->chunks[chunk_idx] =                                                \
+        SMALLOC(tables->chunks[chunk_idx], FCS_STATE_SIDE_TABLES_CHUNK_SIZE);
+        FCS_STATE_SIDE_TABLES__FOREACH(GROW)
+#undef GROW
+    }
+    FCS_STATE_SIDE_TABLES_ENTRY(tables, hot_chunks, id) =
+        (fcs_state_hot_fields){
+            .scan_visited = {0}, .visited = 0, .num_active_children = 0};
+    FCS_STATE_SIDE_TABLES_ENTRY(tables, parent_chunks, id) = NULL;
+#ifdef FCS_WITH_MOVES_TO_PARENT
+    FCS_STATE_SIDE_TABLES_ENTRY(tables, moves_to_parent_chunks, id) = NULL;
+#endif
+#ifdef FCS_WITH_DEPTH_FIELD
+    FCS_STATE_SIDE_TABLES_ENTRY(tables, depth_chunks, id) = 0;
+#endif
+#ifndef FCS_WITHOUT_VISITED_ITER
+    FCS_STATE_SIDE_TABLES_ENTRY(tables, visited_iter_chunks, id) = 0;
+#endif
+
+    return id;
+}
+
+#ifdef __cplusplus
+}
+#endif
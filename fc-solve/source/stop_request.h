@@ -0,0 +1,69 @@
+// This file is part of Freecell Solver. It is subject to the license terms in
+// the COPYING.txt file found in the top-level directory of this distribution
+// and at http://fc-solve.shlomifish.org/docs/distro/COPYING.html . No part of
+// Freecell Solver, including this file, may be copied, modified, propagated,
+// or distributed except according to the terms contained in the COPYING file.
+//
+// Copyright (c) 2026 Shlomi Fish
+// stop_request.h - a request to suspend the solving process, either because
+// it was cancelled from another thread or because its deadline has passed.
+// The scans check it once every FCS_STOP_REQUEST_CHECK_MASK + 1 checked
+// states, and then return FCS_STATE_SUSPEND_PROCESS, so the solving may be
+// resumed afterwards.
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+typedef struct
+{
+    // The time of the monotonic clock, in nanoseconds, from which the solving
+    // is suspended, or 0 for none.
+    int64_t deadline;
+    // It may be set from other threads, so it is only accessed atomically.
+    bool cancel_requested;
+} fcs_stop_request;
+
+#define FCS_STOP_REQUEST_CHECK_MASK ((1 << 10) - 1)
+
+static inline void fc_solve_stop_request_init(fcs_stop_request *const stop)
+{
+    *stop = (fcs_stop_request){.deadline = 0, .cancel_requested = false};
+}
+
+static inline int64_t fc_solve_monotonic_ns(void)
+{
+#ifdef _WIN32
+    return (int64_t)GetTickCount64() * 1000000;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000000 + (int64_t)now.tv_nsec;
+#endif
+}
+
+static inline void fc_solve_stop_request_set_cancel(
+    fcs_stop_request *const stop, const bool cancel_requested)
+{
+    __atomic_store_n(
+        &(stop->cancel_requested), cancel_requested, __ATOMIC_RELAXED);
+}
+
+static inline bool fc_solve_is_stop_requested(
+    const fcs_stop_request *const stop)
+{
+    return (__atomic_load_n(&(stop->cancel_requested), __ATOMIC_RELAXED) ||
+            (stop->deadline && (fc_solve_monotonic_ns() >= stop->deadline)));
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,278 @@
+// This file is part of Freecell Solver. It is subject to the license terms in
+// the COPYING.txt file found in the top-level directory of this distribution
+// and at http://fc-solve.shlomifish.org/docs/distro/COPYING.html . No part of
+// Freecell Solver, including this file, may be copied, modified, propagated,
+// or distributed except according to the terms contained in the COPYING file.
+//
+// Copyright (c) 2026 Shlomi Fish
+// stream.h - the "fc-solve --stream" mode. It reads a sequence of boards from
+// the standard input, solves them in several worker threads, each with an
+// instance of its own, and writes what fc-solve would have printed for every
+// board to the standard output, in the order of the input.
+//
+// The boards are separated by lines that consist of the delimiter ("%" by
+// default), and so are their outputs. With --binary, every board and every
+// output is preceded by its length as a 32-bit little-endian integer instead.
+#pragma once
+
+#include "serve.h"
+
+#ifdef FC_SOLVE_WITH_SERVE
+typedef struct
+{
+    char *output;
+    size_t output_len;
+    bool is_ready;
+} stream_slot;
+
+typedef struct
+{
+    FILE *in;
+    bool is_binary;
+    const char *delimiter;
+    fc_solve_display_information_context display_context;
+    // The outputs of at most num_slots boards are kept until the ones
+    // before them were written.
+    stream_slot *slots;
+    size_t num_slots;
+    size_t next_seq_to_read, next_seq_to_write;
+    bool is_eof;
+    // Guards the input, the output and the slots.
+    pthread_mutex_t lock;
+    pthread_cond_t has_room;
+} stream_context;
+
+typedef struct
+{
+    stream_context *context;
+    void *instance;
+} stream_worker_context;
+
+static inline void stream_write_len(const size_t len)
+{
+    const unsigned char bytes[4] = {(unsigned char)len,
+        (unsigned char)(len >> 8), (unsigned char)(len >> 16),
+        (unsigned char)(len >> 24)};
+    fwrite(bytes, 1, sizeof(bytes), stdout);
+}
+
+// Returns NULL at the end of the input.
+static char *stream_read_board(stream_context *const context)
+{
+    FILE *const in = context->in;
+    if (context->is_binary)
+    {
+        unsigned char bytes[4];
+        if (fread(bytes, 1, sizeof(bytes), in) != sizeof(bytes))
+        {
+            return NULL;
+        }
+        const size_t len = (size_t)bytes[0] | ((size_t)bytes[1] << 8) |
+                           ((size_t)bytes[2] << 16) | ((size_t)bytes[3] << 24);
+        if (len > SERVE_MAX_BOARD_LEN)
+        {
+            return NULL;
+        }
+        char *const board = SMALLOC(board, len + 1);
+        if (fread(board, 1, len, in) != len)
+        {
+            free(board);
+            return NULL;
+        }
+        board[len] = '\0';
+        return board;
+    }
+
+    char *board = NULL;
+    size_t board_len = 0;
+    FILE *const board_fh = open_memstream(&board, &board_len);
+    const size_t delimiter_len = strlen(context->delimiter);
+    bool has_lines = false;
+    char *line = NULL;
+    size_t line_size = 0;
+    ssize_t line_len;
+    while ((line_len = getline(&line, &line_size, in)) >= 0)
+    {
+        if (((size_t)line_len >= delimiter_len) &&
+            (!strncmp(line, context->delimiter, delimiter_len)) &&
+            ((size_t)line_len == delimiter_len ||
+                !strcmp(line + delimiter_len, "\n")))
+        {
+            break;
+        }
+        fputs(line, board_fh);
+        has_lines = true;
+    }
+    free(line);
+    fclose(board_fh);
+    if ((line_len < 0) && (!has_lines))
+    {
+        free(board);
+        return NULL;
+    }
+    return board;
+}
+
+// Should be called with the lock held.
+static void stream_write_ready_outputs(stream_context *const context)
+{
+    while (true)
+    {
+        stream_slot *const slot =
+            &context->slots[context->next_seq_to_write % context->num_slots];
+        if (!slot->is_ready)
+        {
+            return;
+        }
+        if (context->is_binary)
+        {
+            stream_write_len(slot->output_len);
+            fwrite(slot->output, 1, slot->output_len, stdout);
+        }
+        else
+        {
+            fwrite(slot->output, 1, slot->output_len, stdout);
+            fprintf(stdout, "%s\n", context->delimiter);
+        }
+        free(slot->output);
+        slot->is_ready = false;
+        ++context->next_seq_to_write;
+        pthread_cond_broadcast(&context->has_room);
+    }
+}
+
+static void *stream_worker(void *const void_worker_context)
+{
+    const stream_worker_context worker_context =
+        *(stream_worker_context *)void_worker_context;
+    stream_context *const context = worker_context.context;
+    while (true)
+    {
+        pthread_mutex_lock(&context->lock);
+        while ((!context->is_eof) &&
+               (context->next_seq_to_read - context->next_seq_to_write ==
+                   context->num_slots))
+        {
+            pthread_cond_wait(&context->has_room, &context->lock);
+        }
+        char *const board =
+            (context->is_eof ? NULL : stream_read_board(context));
+        const size_t seq = context->next_seq_to_read;
+        if (board)
+        {
+            ++context->next_seq_to_read;
+        }
+        else
+        {
+            context->is_eof = true;
+            pthread_cond_broadcast(&context->has_room);
+        }
+        pthread_mutex_unlock(&context->lock);
+        if (!board)
+        {
+            return NULL;
+        }
+
+        char *output = NULL;
+        size_t output_len = 0;
+        FILE *const output_fh = open_memstream(&output, &output_len);
+        serve_solve_board(worker_context.instance, board,
+            &context->display_context, output_fh);
+        fclose(output_fh);
+        freecell_solver_user_recycle(worker_context.instance);
+        free(board);
+
+        pthread_mutex_lock(&context->lock);
+        context->slots[seq % context->num_slots] = (stream_slot){
+            .output = output, .output_len = output_len, .is_ready = true};
+        stream_write_ready_outputs(context);
+        pthread_mutex_unlock(&context->lock);
+    }
+}
+
+static int fc_solve_stream_main(const int argc, char **const argv)
+{
+    stream_context context = {.in = stdin,
+        .is_binary = false,
+        .delimiter = "%",
+        .next_seq_to_read = 0,
+        .next_seq_to_write = 0,
+        .is_eof = false};
+    size_t num_workers = 0;
+    int arg = 2;
+    for (; arg < argc; ++arg)
+    {
+        const char *param;
+        if ((param = TRY_P("--workers")))
+        {
+            num_workers = (size_t)atol(param);
+        }
+        else if ((param = TRY_P("--delimiter")))
+        {
+            context.delimiter = param;
+        }
+        else if (!strcmp(argv[arg], "--binary"))
+        {
+            context.is_binary = true;
+        }
+        else
+        {
+            break;
+        }
+    }
+    if (!num_workers)
+    {
+        const long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        num_workers = ((num_cpus > 0) ? (size_t)num_cpus : 1);
+    }
+    context.num_slots = 4 * num_workers;
+    context.slots = SMALLOC(context.slots, context.num_slots);
+    for (size_t i = 0; i < context.num_slots; ++i)
+    {
+        context.slots[i].is_ready = false;
+    }
+
+    display_context = INITIAL_DISPLAY_CONTEXT;
+    const int first_flag = arg;
+    stream_worker_context worker_contexts[num_workers];
+    for (size_t i = 0; i < num_workers; ++i)
+    {
+        arg = first_flag;
+        worker_contexts[i] = (stream_worker_context){.context = &context,
+            .instance = alloc_instance_and_parse(argc, argv, &arg,
+                known_parameters, fc_solve__cmd_line_callback,
+                &display_context, true)};
+        serve_clear_iter_handler(worker_contexts[i].instance);
+    }
+    context.display_context = display_context;
+    pthread_mutex_init(&context.lock, NULL);
+    pthread_cond_init(&context.has_room, NULL);
+
+    pthread_t workers[num_workers];
+    for (size_t i = 1; i < num_workers; ++i)
+    {
+        const int check = pthread_create(
+            &workers[i], NULL, stream_worker, &worker_contexts[i]);
+        if (check)
+        {
+            exit_error("Worker Thread No. %lu Initialization failed with "
+                       "error %d!\n",
+                (unsigned long)i, check);
+        }
+    }
+    stream_worker(&worker_contexts[0]);
+    for (size_t i = 1; i < num_workers; ++i)
+    {
+        pthread_join(workers[i], NULL);
+    }
+
+    for (size_t i = 0; i < num_workers; ++i)
+    {
+        freecell_solver_user_free(worker_contexts[i].instance);
+    }
+    free(context.slots);
+    pthread_cond_destroy(&context.has_room);
+    pthread_mutex_destroy(&context.lock);
+    return 0;
+}
+#endif
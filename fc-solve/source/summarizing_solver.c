@@ -57,6 +57,7 @@ int main(int argc, char *argv[])
     void *const instance = simple_alloc_and_parse(argc, argv, arg);
 
     const bool variant_is_freecell = (!strcmp(variant, "freecell"));
+    const fcs_pysol_game_type pysol_game = fc_solve_pysol_game_by_name(variant);
     char buffer[2000];
     if (variant_is_freecell)
     {
@@ -68,6 +69,11 @@ int main(int argc, char *argv[])
     {
         get_board_l__without_setup(board_num, buffer);
     }
+    else if (pysol_game != FCS_PYSOL_GAME_UNKNOWN)
+    {
+        fc_solve_get_pysol_board(
+            pysol_game, FCS_PYSOL_DEALS_PYSOLFC, board_num, buffer);
+    }
     else
     {
         char command[1000];
@@ -0,0 +1,167 @@
+// This file is part of Freecell Solver. It is subject to the license terms in
+// the COPYING.txt file found in the top-level directory of this distribution
+// and at http://fc-solve.shlomifish.org/docs/distro/COPYING.html . No part of
+// Freecell Solver, including this file, may be copied, modified, propagated,
+// or distributed except according to the terms contained in the COPYING file.
+//
+// Copyright (c) 2026 Shlomi Fish
+// A test for the Bloom filter in front of the DBM store lookups.
+#include "rinutils/rin_cmocka.h"
+#include "rinutils/unused.h"
+
+#define FCS_DBM_SINGLE_THREAD
+#include "dbm_solver_head.h"
+
+typedef struct
+{
+    fcs_dbm__cache_store__common cache_store;
+    meta_allocator meta_alloc;
+    fcs_offloading_queue queue;
+    dbm_instance_common_elems common;
+} dbm_solver_instance;
+
+#define CHECK_KEY_CALC_DEPTH() 0
+
+#include "dbm_procs.h"
+
+// A store that holds nothing, and counts the lookups that reached it.
+static unsigned long num_store_lookups;
+
+void fc_solve_dbm_store_init(fcs_dbm_store *const store,
+    const char *const path GCC_UNUSED, void **const recycle_bin GCC_UNUSED)
+{
+    *store = NULL;
+}
+
+bool fc_solve_dbm_store_does_key_exist(
+    fcs_dbm_store store GCC_UNUSED, const unsigned char *const key GCC_UNUSED)
+{
+    ++num_store_lookups;
+    return false;
+}
+
+void fc_solve_dbm_store_destroy(fcs_dbm_store store GCC_UNUSED) {}
+
+static fcs_encoded_state_buffer make_key(const unsigned long idx)
+{
+    fcs_encoded_state_buffer key;
+    memset(&key, '\0', sizeof(key));
+    key.s[0] = 4;
+    key.s[1] = (uint8_t)(idx >> 16);
+    key.s[2] = (uint8_t)(idx >> 8);
+    key.s[3] = (uint8_t)idx;
+    key.s[4] = 0x55;
+    return key;
+}
+
+#define MAX_COUNT 1000
+
+static void no_false_negatives_tests(void **state GCC_UNUSED)
+{
+    fcs_dbm_bloom bloom;
+    fcs_dbm_bloom_init(&bloom, MAX_COUNT);
+    // TEST
+    assert_true(fcs_dbm_bloom_is_enabled(&bloom));
+    for (unsigned long idx = 0; idx < MAX_COUNT; ++idx)
+    {
+        const fcs_encoded_state_buffer key = make_key(idx);
+        fcs_dbm_bloom_insert(&bloom, &key);
+    }
+    bool all_hit = true;
+    for (unsigned long idx = 0; idx < MAX_COUNT; ++idx)
+    {
+        const fcs_encoded_state_buffer key = make_key(idx);
+        all_hit &= fcs_dbm_bloom_may_contain(&bloom, &key);
+    }
+    // TEST
+    assert_true(all_hit);
+    // About 1% of the keys that were not inserted may hit at the capacity.
+    unsigned long num_false_positives = 0;
+    for (unsigned long idx = MAX_COUNT; idx < 11 * MAX_COUNT; ++idx)
+    {
+        const fcs_encoded_state_buffer key = make_key(idx);
+        num_false_positives += fcs_dbm_bloom_may_contain(&bloom, &key);
+    }
+    // TEST
+    assert_true(num_false_positives < MAX_COUNT * 10 / 20);
+    fcs_dbm_bloom_destroy(&bloom);
+
+    fcs_dbm_bloom_init(&bloom, 0);
+    // TEST
+    assert_false(fcs_dbm_bloom_is_enabled(&bloom));
+    fcs_dbm_bloom_destroy(&bloom);
+}
+
+// Returns the number of the lookups of the keys from first to first+count-1
+// that reached the store.
+static unsigned long count_store_lookups(
+    fcs_dbm__cache_store__common *const cache_store, const unsigned long first,
+    const unsigned long count)
+{
+    num_store_lookups = 0;
+    for (unsigned long idx = first; idx < first + count; ++idx)
+    {
+        fcs_encoded_state_buffer key = make_key(idx);
+        if (!cache_store__has_key(cache_store, &key, NULL, '\0'))
+        {
+            fail_msg("Key No. %lu was found.\n", idx);
+        }
+    }
+    return num_store_lookups;
+}
+
+static void fall_through_tests(void **state GCC_UNUSED)
+{
+    for (int enabled = 0; enabled < 2; ++enabled)
+    {
+        dbm_instance_common_elems common;
+        meta_allocator meta_alloc;
+        fc_solve_meta_compact_allocator_init(&meta_alloc);
+        fcs_dbm__common_init(
+            &common, ULONG_MAX, ULONG_MAX, FCS_DBM_VARIANT_2FC_FREECELL, stdout);
+        fcs_dbm__cache_store__common cache_store;
+        // The pre-cache and the cache are too small to keep any of the keys,
+        // so the lookups can only be answered by the filter or the store.
+        fcs_dbm__cache_store__init(&cache_store, &common, &meta_alloc, NULL,
+            0, 0, (enabled ? MAX_COUNT : 0));
+        // An empty filter answers all the lookups by itself.
+        // TEST*2
+        assert_int_equal(count_store_lookups(&cache_store, 0, MAX_COUNT),
+            (enabled ? 0 : MAX_COUNT));
+        // Add the keys to the filter as if they were offloaded to the store.
+        for (unsigned long idx = 0; enabled && idx < MAX_COUNT; ++idx)
+        {
+            fcs_encoded_state_buffer key = make_key(idx);
+            fcs_dbm_bloom_insert(&(cache_store.bloom), &key);
+        }
+        // Every inserted key falls through to the store, whether the filter
+        // is disabled or holds max-count keys.
+        // TEST*2
+        assert_int_equal(count_store_lookups(&cache_store, 0, MAX_COUNT),
+            MAX_COUNT);
+        const unsigned long num_other_lookups =
+            count_store_lookups(&cache_store, MAX_COUNT, 10 * MAX_COUNT);
+        // TEST*2
+        assert_true(enabled ? (num_other_lookups < 10 * MAX_COUNT / 20)
+                            : (num_other_lookups == 10 * MAX_COUNT));
+        // TEST*2
+        assert_int_equal(
+            common.bloom_stats.lookups, (enabled ? 12 * MAX_COUNT : 0));
+
+        fcs_dbm_bloom_destroy(&(cache_store.bloom));
+        cache_destroy(&(cache_store.cache));
+        fc_solve_kaz_tree_destroy(cache_store.pre_cache.kaz_tree);
+        fc_solve_compact_allocator_finish(
+            &(cache_store.pre_cache.kv_allocator));
+        fc_solve_meta_compact_allocator_finish(&meta_alloc);
+    }
+}
+
+int main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(no_false_negatives_tests),
+        cmocka_unit_test(fall_through_tests),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
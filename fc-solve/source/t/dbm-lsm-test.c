@@ -0,0 +1,216 @@
+// This file is part of Freecell Solver. It is subject to the license terms in
+// the COPYING.txt file found in the top-level directory of this distribution
+// and at http://fc-solve.shlomifish.org/docs/distro/COPYING.html . No part of
+// Freecell Solver, including this file, may be copied, modified, propagated,
+// or distributed except according to the terms contained in the COPYING file.
+//
+// Copyright (c) 2026 Shlomi Fish
+// A test for the log-structured DBM store.
+#include "rinutils/rin_cmocka.h"
+#include "rinutils/unused.h"
+
+// Compact synchronously, so the runs can be inspected after every offload.
+#ifndef FCS_DBM_SINGLE_THREAD
+#define FCS_DBM_SINGLE_THREAD
+#endif
+#include "dbm_lsm.c"
+
+static int compare_pre_cache_keys(const void *const void_a,
+    const void *const void_b
+#ifdef AVL_with_rb_param
+    ,
+    void *const context GCC_UNUSED
+#endif
+)
+{
+    return memcmp(&(((const pre_cache_key_val_pair *)void_a)->key),
+        &(((const pre_cache_key_val_pair *)void_b)->key),
+        sizeof(fcs_encoded_state_buffer));
+}
+
+static fcs_encoded_state_buffer make_key(const unsigned long idx)
+{
+    fcs_encoded_state_buffer key;
+    memset(&key, '\0', sizeof(key));
+    key.s[0] = 4;
+    key.s[1] = (uint8_t)(idx >> 16);
+    key.s[2] = (uint8_t)(idx >> 8);
+    key.s[3] = (uint8_t)idx;
+    key.s[4] = 0x55;
+    return key;
+}
+
+static fcs_encoded_state_buffer make_parent(
+    const unsigned long idx, const unsigned long generation)
+{
+    fcs_encoded_state_buffer parent = make_key(idx);
+    parent.s[5] = (uint8_t)generation;
+    return parent;
+}
+
+// Offloads the keys from first to first+count-1, whose parents are of the
+// generation, as one pre-cache.
+static void offload(fcs_dbm_store store, const unsigned long first,
+    const unsigned long count, const unsigned long generation)
+{
+    meta_allocator meta_alloc;
+    fc_solve_meta_compact_allocator_init(&meta_alloc);
+    fcs_pre_cache pre_cache = {.tree_recycle_bin = NULL, .count_elements = 0};
+    pre_cache.kaz_tree = fc_solve_kaz_tree_create(compare_pre_cache_keys,
+        NULL, &meta_alloc, &(pre_cache.tree_recycle_bin));
+    pre_cache_key_val_pair *const kvs = SMALLOC(kvs, count);
+    // Insert in a scrambled order to check that the runs come out sorted.
+    for (unsigned long i = 0; i < count; ++i)
+    {
+        const unsigned long idx = first + ((i * 7) % count);
+        kvs[i].key = make_key(idx);
+        kvs[i].parent = make_parent(idx, generation);
+        fc_solve_kaz_tree_alloc_insert(pre_cache.kaz_tree, &(kvs[i]));
+        ++pre_cache.count_elements;
+    }
+    fc_solve_dbm_store_offload_pre_cache(store, &pre_cache);
+    fc_solve_kaz_tree_destroy(pre_cache.kaz_tree);
+    free(kvs);
+    fc_solve_meta_compact_allocator_finish(&meta_alloc);
+}
+
+// Returns whether the keys from first to first+count-1 all have parents of
+// the generation.
+static bool check_keys(fcs_dbm_store store, const unsigned long first,
+    const unsigned long count, const unsigned long generation)
+{
+    for (unsigned long idx = first; idx < first + count; ++idx)
+    {
+        const fcs_encoded_state_buffer key = make_key(idx),
+                                       expected = make_parent(idx, generation);
+        fcs_encoded_state_buffer parent;
+        if (!(fc_solve_dbm_store_does_key_exist(store, key.s) &&
+                fc_solve_dbm_store_lookup_parent(store, key.s, parent.s) &&
+                !memcmp(&parent, &expected, sizeof(parent))))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static size_t count_run_files(const char *const dir)
+{
+    size_t ret = 0;
+    DIR *const dh = opendir(dir);
+    const struct dirent *entry;
+    while ((entry = readdir(dh)))
+    {
+        ret += (strncmp(entry->d_name, "run-", 4) == 0);
+    }
+    closedir(dh);
+    return ret;
+}
+
+static void remove_store(const char *const dir)
+{
+    DIR *const dh = opendir(dir);
+    const struct dirent *entry;
+    while ((entry = readdir(dh)))
+    {
+        if (strncmp(entry->d_name, "run-", 4) == 0)
+        {
+            char path[PATH_MAX];
+            snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+            unlink(path);
+        }
+    }
+    closedir(dh);
+    rmdir(dir);
+}
+
+static void round_trip_tests(void **state GCC_UNUSED)
+{
+    char dir[] = "/tmp/fcs-dbm-lsm-test-XXXXXX";
+    assert_non_null(mkdtemp(dir));
+    fcs_dbm_store store;
+    fc_solve_dbm_store_init(&store, dir, NULL);
+    offload(store, 0, 1000, 1);
+    // TEST
+    assert_true(check_keys(store, 0, 1000, 1));
+    const fcs_encoded_state_buffer missing = make_key(1000);
+    fcs_encoded_state_buffer parent;
+    // TEST
+    assert_false(fc_solve_dbm_store_does_key_exist(store, missing.s));
+    // TEST
+    assert_false(fc_solve_dbm_store_lookup_parent(store, missing.s, parent.s));
+    fc_solve_dbm_store_destroy(store);
+
+    // The runs persist, and a leftover temporary run is discarded.
+    char leftover_path[PATH_MAX];
+    snprintf(leftover_path, sizeof(leftover_path), "%s/run-0000000009.tmp",
+        dir);
+    FILE *const leftover = fopen(leftover_path, "wb");
+    assert_non_null(leftover);
+    fclose(leftover);
+    fc_solve_dbm_store_init(&store, dir, NULL);
+    // TEST
+    assert_int_equal(count_run_files(dir), 1);
+    // TEST
+    assert_true(check_keys(store, 0, 1000, 1));
+    offload(store, 1000, 500, 2);
+    // TEST
+    assert_true(check_keys(store, 0, 1000, 1));
+    // TEST
+    assert_true(check_keys(store, 1000, 500, 2));
+    fc_solve_dbm_store_destroy(store);
+    remove_store(dir);
+}
+
+static void compaction_tests(void **state GCC_UNUSED)
+{
+    char dir[] = "/tmp/fcs-dbm-lsm-test-XXXXXX";
+    assert_non_null(mkdtemp(dir));
+    fcs_dbm_store store;
+    fc_solve_dbm_store_init(&store, dir, NULL);
+    const fcs_dbm_lsm *const db = (const fcs_dbm_lsm *)store;
+    for (unsigned long gen = 1; gen <= FCS_DBM_LSM_MAX_RUNS; ++gen)
+    {
+        // Every run overlaps the previous one by half.
+        offload(store, gen * 100, 200, gen);
+    }
+    // TEST
+    assert_int_equal(db->num_runs, FCS_DBM_LSM_MAX_RUNS);
+    offload(store, (FCS_DBM_LSM_MAX_RUNS + 1) * 100, 200,
+        FCS_DBM_LSM_MAX_RUNS + 1);
+    // TEST
+    assert_int_equal(db->num_runs, 1);
+    // TEST
+    assert_int_equal(count_run_files(dir), 1);
+    // TEST
+    assert_int_equal(db->runs[0].count, (FCS_DBM_LSM_MAX_RUNS + 2) * 100);
+    // The newest parent of every key survived the merge.
+    bool all_good = true;
+    for (unsigned long gen = 1; gen <= FCS_DBM_LSM_MAX_RUNS + 1; ++gen)
+    {
+        all_good &= check_keys(store, gen * 100, 100, gen);
+    }
+    // TEST
+    assert_true(all_good);
+    // TEST
+    assert_true(
+        check_keys(store, (FCS_DBM_LSM_MAX_RUNS + 2) * 100, 100,
+            FCS_DBM_LSM_MAX_RUNS + 1));
+    fc_solve_dbm_store_destroy(store);
+
+    // The merged run is loaded back.
+    fc_solve_dbm_store_init(&store, dir, NULL);
+    // TEST
+    assert_true(check_keys(store, 100, 100, 1));
+    fc_solve_dbm_store_destroy(store);
+    remove_store(dir);
+}
+
+int main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(round_trip_tests),
+        cmocka_unit_test(compaction_tests),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
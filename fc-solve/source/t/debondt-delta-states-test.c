@@ -127,11 +127,69 @@ static void main_tests(void **state GCC_UNUSED)
     }
 }
 
+// The table driven writer must produce the same bytes as the plain
+// fcs_var_base_writer, and the table driven reader must read the digits back.
+static void var_base_table_tests(void **state GCC_UNUSED)
+{
+    const unsigned long bases[] = {14, 14, 14, 14, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+        5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+        5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 3, 3, 3, 3};
+    fcs_var_base_table table;
+    fc_solve_var_base_table_init(&table);
+    for (size_t i = 0; i < COUNT(bases); ++i)
+    {
+        fc_solve_var_base_table_add_digit(&table, bases[i]);
+    }
+
+    fcs_var_base_writer w;
+    fcs_var_base_table_writer table_w;
+    fcs_var_base_table_reader table_r;
+    fc_solve_var_base_writer_init(&w);
+    fc_solve_var_base_table_writer_init(&table_w);
+    fc_solve_var_base_table_reader_init(&table_r);
+
+    for (unsigned long seed = 0; seed < 1000; ++seed)
+    {
+        unsigned long digits[COUNT(bases)];
+        fc_solve_var_base_writer_start(&w);
+        fc_solve_var_base_table_writer_start(&table_w);
+        for (size_t i = 0; i < COUNT(bases); ++i)
+        {
+            // Cover both the maximal digits and a spread of other ones.
+            digits[i] = ((seed == 0) ? (bases[i] - 1)
+                                     : ((seed * 7919 + i * 104729) % bases[i]));
+            fc_solve_var_base_writer_write(&w, bases[i], digits[i]);
+            fc_solve_var_base_table_writer_write(
+                &table_w, &table, bases[i], digits[i]);
+        }
+        fcs_encoded_state_buffer got, expected;
+        fcs_init_encoded_state(&got);
+        fcs_init_encoded_state(&expected);
+        assert_int_equal(fc_solve_var_base_writer_get_data(&w, expected.s),
+            fc_solve_var_base_table_writer_get_data(&table_w, &table, got.s));
+        assert_memory_equal(got.s, expected.s, sizeof(got.s));
+
+        fc_solve_var_base_table_reader_start(
+            &table_r, &table, got.s, sizeof(got.s));
+        for (size_t i = 0; i < COUNT(bases); ++i)
+        {
+            assert_int_equal(
+                fc_solve_var_base_table_reader_read(&table_r, &table, bases[i]),
+                digits[i]);
+        }
+    }
+
+    fc_solve_var_base_table_reader_release(&table_r);
+    fc_solve_var_base_table_writer_release(&table_w);
+    fc_solve_var_base_writer_release(&w);
+}
+
 int main(void)
 {
     // plan(2);
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(main_tests),
+        cmocka_unit_test(var_base_table_tests),
     };
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
@@ -0,0 +1,153 @@
+// This file is part of Freecell Solver. It is subject to the license terms in
+// the COPYING.txt file found in the top-level directory of this distribution
+// and at http://fc-solve.shlomifish.org/docs/distro/COPYING.html . No part of
+// Freecell Solver, including this file, may be copied, modified, propagated,
+// or distributed except according to the terms contained in the COPYING file.
+//
+// Copyright (c) 2026 Shlomi Fish
+// A test for the endgame tablebase.
+#include "rinutils/rin_cmocka.h"
+#include "rinutils/unused.h"
+#include "endgame_tablebase_gen.h"
+
+// Generates the tablebase of the rules and loads it.
+static void generate(
+    const fcs_etb_rules *const rules, fcs_endgame_tablebase *const etb)
+{
+    char filename[] = "/tmp/fcs-etb-test-XXXXXX";
+    const int fd = mkstemp(filename);
+    assert_true(fd >= 0);
+    FILE *const out = fdopen(fd, "wb");
+    // TEST
+    assert_true(fc_solve_etb_generate(rules, out));
+    const int close_ret = fclose(out);
+    assert_int_equal(close_ret, 0);
+    // TEST
+    assert_true(fc_solve_etb_load(etb, filename));
+    unlink(filename);
+}
+
+// The hearts from the king downwards, placed bottom first in the first
+// column, while all the other cards are in the foundations.
+static fcs_plain_position hearts_column(
+    const fcs_card *const ranks, const size_t num_cards)
+{
+    fcs_plain_position pos;
+    memset(&pos, '\0', sizeof(pos));
+    for (size_t suit = 0; suit < FCS_NUM_SUITS; ++suit)
+    {
+        pos.foundations[suit] = 13;
+    }
+    pos.foundations[0] = (uint8_t)(13 - num_cards);
+    for (size_t i = 0; i < num_cards; ++i)
+    {
+        pos.cols[0][i] = fcs_make_card(ranks[i], 0);
+    }
+    pos.cols_lens[0] = (uint8_t)num_cards;
+
+    return pos;
+}
+
+static int distance(
+    const fcs_endgame_tablebase *const etb, const fcs_plain_position *const pos)
+{
+    fcs_etb_key key;
+    fc_solve_etb_encode(&(etb->rules.game), pos, &key);
+    return fc_solve_etb_lookup(etb, &key);
+}
+
+static void freecell_tests(void **state GCC_UNUSED)
+{
+    const fcs_etb_rules rules = {
+        .game =
+            {
+                .num_freecells = 4,
+                .num_columns = 8,
+                .sequences_are_built_by = FCS_SEQ_BUILT_BY_ALTERNATE_COLOR,
+                .empty_stacks_fill = FCS_ES_FILLED_BY_ANY_CARD,
+                .unlimited_sequence_move = false,
+            },
+        .max_cards = 3,
+    };
+    fcs_endgame_tablebase etb;
+    generate(&rules, &etb);
+
+    const fcs_card in_order[] = {13, 12};
+    const fcs_card buried[] = {12, 13};
+    fcs_plain_position pos = hearts_column(in_order, COUNT(in_order));
+    // TEST
+    assert_int_equal(distance(&etb, &pos), 2);
+
+    // The same position in another column has the same key.
+    fcs_plain_position moved = pos;
+    memcpy(moved.cols[5], pos.cols[0], pos.cols_lens[0]);
+    moved.cols_lens[5] = pos.cols_lens[0];
+    moved.cols_lens[0] = 0;
+    fcs_etb_key key, moved_key;
+    fc_solve_etb_encode(&(rules.game), &pos, &key);
+    fc_solve_etb_encode(&(rules.game), &moved, &moved_key);
+    // TEST
+    assert_memory_equal(&key, &moved_key, sizeof(key));
+
+    fcs_plain_position decoded;
+    fc_solve_etb_decode(&(rules.game), &key, &decoded);
+    // TEST
+    assert_memory_equal(&decoded, &pos, sizeof(pos));
+
+    pos = hearts_column(buried, COUNT(buried));
+    // TEST
+    assert_int_equal(distance(&etb, &pos), 3);
+
+    fcs_plain_move moves[FCS_ETB_MAX_DISTANCE];
+    // TEST
+    assert_int_equal(fc_solve_etb_solve(&etb, pos, moves), 3);
+    for (size_t i = 0; i < 3; ++i)
+    {
+        // TEST*3
+        assert_true(
+            fc_solve_plain_is_move_legal(&(rules.game), &pos, moves[i]));
+        fc_solve_plain_apply_move(&pos, moves[i]);
+    }
+    // TEST
+    assert_int_equal(fc_solve_plain_count_cards(&(rules.game), &pos), 0);
+
+    fc_solve_etb_unload(&etb);
+}
+
+static void loss_tests(void **state GCC_UNUSED)
+{
+    const fcs_etb_rules rules = {
+        .game =
+            {
+                .num_freecells = 0,
+                .num_columns = 1,
+                .sequences_are_built_by = FCS_SEQ_BUILT_BY_ALTERNATE_COLOR,
+                .empty_stacks_fill = FCS_ES_FILLED_BY_ANY_CARD,
+                .unlimited_sequence_move = false,
+            },
+        .max_cards = 3,
+    };
+    fcs_endgame_tablebase etb;
+    generate(&rules, &etb);
+
+    const fcs_card in_order[] = {13, 12};
+    const fcs_card buried[] = {12, 13};
+    fcs_plain_position pos = hearts_column(in_order, COUNT(in_order));
+    // TEST
+    assert_int_equal(distance(&etb, &pos), 2);
+    pos = hearts_column(buried, COUNT(buried));
+    // TEST
+    assert_int_equal(distance(&etb, &pos), FCS_ETB_LOSS);
+
+    fc_solve_etb_unload(&etb);
+}
+
+int main(void)
+{
+    // plan(15);
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(freecell_tests),
+        cmocka_unit_test(loss_tests),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
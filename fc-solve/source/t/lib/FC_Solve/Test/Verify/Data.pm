@@ -60,6 +60,45 @@ __PACKAGE__->populate(
             },
             msg => "A configuration with which the solver got stuck."
         },
+        '24_dfs_restarts' => {
+            args => {
+                deal  => 24,
+                theme => [
+                    "--method",       "random-dfs",
+                    "--dfs-restarts", "luby:100",
+                ]
+            },
+            msg => "Solving Deal #24 with random-dfs and Luby restarts",
+        },
+        '1941_seeds_portfolio' => {
+            args => {
+                deal  => 1941,
+                theme => [
+                    "--method",          "random-dfs",
+                    "--dfs-restarts",    "geometric:64:2",
+                    "--seeds-portfolio", "3",
+                ]
+            },
+            msg => "Solving Deal #1941 with a portfolio of restarting seeds",
+        },
+        '24_recycle_dead_ends' => {
+            args => {
+                deal  => 24,
+                theme => [ "--recycle-dead-ends", "0", ],
+            },
+            msg => "Solving Deal #24 while recycling the dead ends",
+        },
+        '24_trim_soft_dfs_and_a_star' => {
+            args => {
+                deal  => 24,
+                theme => [
+                    "--method", "soft-dfs", "-to", "0123456789", "-step", "50",
+                    "-nst", "--method", "a-star", "--trim-max-stored-states",
+                    "100",
+                ],
+            },
+            msg => "Trimming the states of a Soft-DFS scan and an a-star scan",
+        },
         '617_jgl' => {
             args => { deal => 617, theme => [ "-l", "john-galt-line" ], },
             msg  => "Solving Deal #617 with the john-galt-line",
@@ -111,6 +150,15 @@ __PACKAGE__->populate(
             args => { deal => 24, theme => ["-opt"], },
             msg  => "-opt should work.",
         },
+        '24_local_opt' => {
+            args => {
+                deal  => 24,
+                theme => [
+                    "--local-opt-window", "16", "--local-opt-threads", "2",
+                ],
+            },
+            msg => "--local-opt-window should yield a valid solution.",
+        },
         '24_opt_sp_r_tf' => {
             args => { deal => 24, theme => [ "-opt", "-sp", "r:tf", ], },
             msg  => "-opt in conjunction with --set-pruning r:tf should work.",
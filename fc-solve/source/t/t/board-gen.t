@@ -3,7 +3,7 @@
 use strict;
 use warnings;
 
-use Test::More tests => 45;
+use Test::More tests => 55;
 use Test::Differences qw/ eq_or_diff /;
 use Path::Tiny        qw/ path /;
 use Test::Trap
@@ -868,6 +868,27 @@ eq_or_diff( _child_slurp('24.board'), [$BOARD_24_T], "gen-multi-c 24", );
 # TEST
 eq_or_diff( _child_slurp('25.board'), [$BOARD_25_T], "gen-multi-c 25", );
 
+# The in-process PySolFC deals of every variant match the ones of
+# make_pysol_freecell_board.py, both for the deals of the Microsoft LCG and
+# for the Mersenne Twister ones.
+foreach my $variant (
+    qw/ freecell forecell eight_off seahaven_towers bakers_dozen simple_simon
+    beleaguered_castle citadel streets_and_alleys fan /
+    )
+{
+    my @deals = ( 1, 24, 31999, 32001, 1000000, 8589934591 );
+    _reset_dir;
+    system( $GEN_MULTI__C, '--dir', $dir . '', '--suffix', '.board',
+        '--variant', $variant, @deals );
+
+    # TEST*10
+    eq_or_diff(
+        [ map { @{ _child_slurp("$_.board") } } @deals ],
+        [ map { normalize_lf(scalar `$MAKE_PYSOL -F -t $_ $variant`) } @deals ],
+        "gen-multi-c --variant $variant matches make_pysol_freecell_board.py",
+    );
+}
+
 $dir->remove_tree;
 __END__
 
@@ -0,0 +1,79 @@
+#!/usr/bin/perl
+
+use strict;
+use warnings;
+use autodie;
+
+use Test::More;
+use File::Temp      qw/ tempdir /;
+use Path::Tiny      qw/ path /;
+use FC_Solve::Paths qw/ $FC_SOLVE_EXE $IS_WIN samp_board /;
+
+if ($IS_WIN)
+{
+    plan skip_all => "fc-solve --serve is not available on Windows";
+}
+plan tests => 6;
+
+my @boards   = ( '24-mid.board', '24-with-7-cols.board' );
+my $dir      = tempdir( CLEANUP => 1 );
+my $requests = path($dir)->child('requests.txt');
+$requests->spew_raw(
+    join '',
+    (
+        map {
+            my $board = samp_board( $boards[$_] )->slurp_raw;
+            "solve b$_ - " . length($board) . "\n" . $board;
+        } keys @boards
+    ),
+    "solve invalid - 12\nFoundations:",
+);
+
+my $got = `$FC_SOLVE_EXE --serve --workers 2 -m -snx < $requests`;
+
+# TEST
+ok( !$?, "fc-solve --serve ran fine" );
+
+my %answers;
+while ( $got =~ s/\A(\S+) (\S+) (\d+) (\d+) (\d+)\n//ms )
+{
+    my ( $id, $verdict, $len ) = ( $1, $2, $5 );
+    $answers{$id} = { verdict => $verdict, output => substr( $got, 0, $len ) };
+    substr( $got, 0, $len ) = '';
+}
+
+# TEST
+is( $got, '', "The answers were parsed in full" );
+
+foreach my $idx ( keys @boards )
+{
+    my $board    = samp_board( $boards[$idx] );
+    my $expected = `$FC_SOLVE_EXE -m -snx $board`;
+
+    # TEST*2
+    is_deeply(
+        $answers{"b$idx"},
+        { verdict => 'solved', output => $expected },
+        "The answer for $boards[$idx] is the same as that of fc-solve",
+    );
+}
+
+# TEST
+is( $answers{invalid}{verdict}, 'invalid', "An invalid board is reported" );
+
+# TEST
+is( scalar( keys %answers ), 3, "Every request was answered" );
+
+__END__
+
+=head1 COPYRIGHT AND LICENSE
+
+This file is part of Freecell Solver. It is subject to the license terms in
+the COPYING.txt file found in the top-level directory of this distribution
+and at http://fc-solve.shlomifish.org/docs/distro/COPYING.html . No part of
+Freecell Solver, including this file, may be copied, modified, propagated,
+or distributed except according to the terms contained in the COPYING file.
+
+Copyright (c) 2026 Shlomi Fish
+
+=cut
@@ -0,0 +1,69 @@
+#!/usr/bin/perl
+
+use strict;
+use warnings;
+use autodie;
+
+use Test::More;
+use File::Temp      qw/ tempdir /;
+use Path::Tiny      qw/ path /;
+use FC_Solve::Paths qw/ $FC_SOLVE_EXE $IS_WIN samp_board /;
+
+if ($IS_WIN)
+{
+    plan skip_all => "fc-solve --stream is not available on Windows";
+}
+plan tests => 4;
+
+my @boards = ( '24-mid.board', '24-with-7-cols.board', '24-mid.board' );
+my $dir    = tempdir( CLEANUP => 1 );
+my $input  = path($dir)->child('boards.txt');
+
+my @flags = ( '-p', '-t', '-sam' );
+$input->spew_raw( join '',
+    map { samp_board($_)->slurp_raw . "%\n" } @boards );
+my $expected = join '',
+    map { my $fn = samp_board($_); `$FC_SOLVE_EXE @flags $fn` . "%\n" }
+    @boards;
+
+# TEST
+is( scalar(`$FC_SOLVE_EXE --stream --workers 3 @flags < $input`),
+    $expected, "The boards are solved in order" );
+
+# TEST
+ok( !$?, "fc-solve --stream ran fine" );
+
+$input->spew_raw(
+    join '',
+    map {
+        my $board = samp_board($_)->slurp_raw;
+        pack( 'V', length($board) ) . $board
+    } @boards
+);
+$expected = join '', map {
+    my $fn     = samp_board($_);
+    my $output = `$FC_SOLVE_EXE @flags $fn`;
+    pack( 'V', length($output) ) . $output
+} @boards;
+
+# TEST
+is( scalar(`$FC_SOLVE_EXE --stream --binary --workers 2 @flags < $input`),
+    $expected, "--binary frames the boards and the outputs" );
+
+# TEST
+is( scalar(`$FC_SOLVE_EXE --stream --binary --workers 2 @flags -i < $input`),
+    $expected, "-i does not break the framing" );
+
+__END__
+
+=head1 COPYRIGHT AND LICENSE
+
+This file is part of Freecell Solver. It is subject to the license terms in
+the COPYING.txt file found in the top-level directory of this distribution
+and at http://fc-solve.shlomifish.org/docs/distro/COPYING.html . No part of
+Freecell Solver, including this file, may be copied, modified, propagated,
+or distributed except according to the terms contained in the COPYING file.
+
+Copyright (c) 2026 Shlomi Fish
+
+=cut
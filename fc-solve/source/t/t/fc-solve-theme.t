@@ -0,0 +1,81 @@
+#!/usr/bin/perl
+
+use strict;
+use warnings;
+
+use Test::More tests => 7;
+use File::Temp      qw/ tempdir /;
+use Path::Tiny      qw/ path /;
+use FC_Solve::Paths qw/ $FC_SOLVE_EXE samp_board /;
+
+my $dir   = tempdir( CLEANUP => 1 );
+my $theme = path($dir)->child('test.theme');
+my $board = samp_board('24-mid.board');
+my $flags = '--method a-star -asw 0.2,0.3,0.5,0,0 -step 50 -nst '
+    . '--method soft-dfs -to 01ABCDE';
+
+# TEST
+ok( !system("$FC_SOLVE_EXE --save-theme $theme -p -t -sam $flags"),
+    "--save-theme ran fine" );
+
+# TEST
+is(
+    scalar(`$FC_SOLVE_EXE --load-theme $theme -p -t -sam $board`),
+    scalar(`$FC_SOLVE_EXE $flags -p -t -sam $board`),
+    "The theme configures the solver like the options that it was saved from"
+);
+
+# TEST
+unlike( $theme->slurp_raw, qr/-(?:p|t|sam)\0/,
+    "The display options are not kept in the theme" );
+
+my $preset_theme = path($dir)->child('qualified-seed.theme');
+
+# TEST
+ok(
+    !system( "$FC_SOLVE_EXE --save-theme $preset_theme -p -t -sam "
+            . "-l qualified-seed" ),
+    "--save-theme ran fine with a preset of flares"
+);
+
+my $preset_output = `$FC_SOLVE_EXE -l qualified-seed -p -t -sam $board`;
+{
+    # The preset was expanded into the theme, so the presets are not needed
+    # to load it.
+    local $ENV{FREECELL_SOLVER_PRESETRC} = path($dir)->child('no-presetrc');
+
+    # TEST
+    is(
+        scalar(`$FC_SOLVE_EXE --load-theme $preset_theme -p -t -sam $board`),
+        $preset_output,
+        "The theme of a preset configures the solver like the preset"
+    );
+}
+
+# TEST
+like(
+    $preset_theme->slurp_raw,
+    qr/--flare-name\0/,
+    "The flares of the preset are kept in the theme"
+);
+
+my $bad_theme = path($dir)->child('bad.theme');
+$bad_theme->spew_raw( "FCSTHEME" . ( "\0" x 40 ) );
+
+# TEST
+isnt( system("$FC_SOLVE_EXE --load-theme $bad_theme $board 2>/dev/null"),
+    0, "An invalid theme is rejected" );
+
+__END__
+
+=head1 COPYRIGHT AND LICENSE
+
+This file is part of Freecell Solver. It is subject to the license terms in
+the COPYING.txt file found in the top-level directory of this distribution
+and at http://fc-solve.shlomifish.org/docs/distro/COPYING.html . No part of
+Freecell Solver, including this file, may be copied, modified, propagated,
+or distributed except according to the terms contained in the COPYING file.
+
+Copyright (c) 2026 Shlomi Fish
+
+=cut
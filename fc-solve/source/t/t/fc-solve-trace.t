@@ -0,0 +1,49 @@
+#!/usr/bin/perl
+
+use strict;
+use warnings;
+
+use Test::More tests => 3;
+use FC_Solve::Paths qw/ $FC_SOLVE_EXE samp_board /;
+
+my $board    = samp_board('24-mid.board');
+my $expected = `$FC_SOLVE_EXE -p -t -sam $board`;
+my $got = `$FC_SOLVE_EXE --trace-ring-size 5 --trace-sample-step 3 -p -t -sam $board`;
+
+my @traces;
+while ( $got =~ s/^(Trace: .*\n)\z//m )
+{
+    unshift @traces, $1;
+}
+
+# TEST
+is( $got, $expected, "The trace is appended to the unmodified output" );
+
+# TEST
+cmp_ok( scalar(@traces), '>=', 5, "The last 5 sampled iterations were kept" );
+
+# TEST
+is(
+    scalar(
+        grep {
+            /\ATrace: Iteration: (\d+) Depth: \d+ Parent Iteration: \d+ Soft Thread: \d+ State: [0-9a-f]+\n\z/
+                and ( ( $1 + 1 ) % 3 == 0 )
+        } @traces
+    ),
+    scalar(@traces),
+    "Only every third iteration is recorded"
+);
+
+__END__
+
+=head1 COPYRIGHT AND LICENSE
+
+This file is part of Freecell Solver. It is subject to the license terms in
+the COPYING.txt file found in the top-level directory of this distribution
+and at http://fc-solve.shlomifish.org/docs/distro/COPYING.html . No part of
+Freecell Solver, including this file, may be copied, modified, propagated,
+or distributed except according to the terms contained in the COPYING file.
+
+Copyright (c) 2026 Shlomi Fish
+
+=cut
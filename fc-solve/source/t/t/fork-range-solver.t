@@ -0,0 +1,92 @@
+#!/usr/bin/perl
+
+use strict;
+use warnings;
+
+use Test::More tests => 8;
+use String::ShellQuote qw/ shell_quote /;
+use FC_Solve::Paths qw/ $IS_WIN bin_exe_raw is_freecell_only /;
+
+SKIP:
+{
+    my $exe = bin_exe_raw( ['freecell-solver-fork-solve'] );
+    if ( $IS_WIN || is_freecell_only() || !-e $exe )
+    {
+        Test::More::skip(
+            "win32, freecell-only or without the forking range solver", 8 );
+    }
+
+    # Seahaven Towers deal No. 19 takes several seconds to solve, and the
+    # deals after it take a few milliseconds.
+    my @hang_args = (
+        $exe, 19, 24, 1, '--num-workers', 1, '--hang-timeout', 1,
+        '--variant', 'seahaven_towers',
+    );
+
+    my $cmd    = shell_quote(@hang_args);
+    my $output = `$cmd 2>&1`;
+
+    # TEST
+    ok( !$?, "The forking solver exited successfully after a hang" );
+
+    # TEST
+    like(
+        $output,
+        qr{^Intractable Board No\. 19 at}ms,
+        "The deal that hung is reported as intractable",
+    );
+
+    # TEST
+    like(
+        $output,
+        qr{^Reached Board No\. 6 at}ms,
+        "The respawned worker solved the rest of the deals",
+    );
+
+    # TEST
+    unlike(
+        $output,
+        qr{^Intractable Board No\. 2[0-4] }ms,
+        "Only the deal that hung was skipped",
+    );
+
+    $cmd    = shell_quote( @hang_args, '--max-respawns', 0 );
+    $output = `$cmd 2>&1`;
+
+    # TEST
+    ok( $?, "The forking solver fails when it may not respawn a worker" );
+
+    # TEST
+    like(
+        $output,
+        qr{^5 deals were not solved}ms,
+        "The deals that were left are reported",
+    );
+
+    $cmd = shell_quote( $exe, 1, 10, 5, '--num-workers', 2, '--pin-cpus' );
+    $output = `$cmd 2>&1`;
+
+    # TEST
+    ok( !$?, "The forking solver exited successfully with --pin-cpus" );
+
+    # TEST
+    like(
+        $output,
+        qr{^Reached Board No\. 10 at}ms,
+        "All the deals were solved by the pinned workers",
+    );
+}
+
+__END__
+
+=head1 COPYRIGHT AND LICENSE
+
+This file is part of Freecell Solver. It is subject to the license terms in
+the COPYING.txt file found in the top-level directory of this distribution
+and at http://fc-solve.shlomifish.org/docs/distro/COPYING.html . No part of
+Freecell Solver, including this file, may be copied, modified, propagated,
+or distributed except according to the terms contained in the COPYING file.
+
+Copyright (c) 2026 Shlomi Fish
+
+=cut
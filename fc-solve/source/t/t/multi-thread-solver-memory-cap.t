@@ -0,0 +1,75 @@
+#!/usr/bin/perl
+
+use strict;
+use warnings;
+
+use Test::More tests => 9;
+use FC_Solve::Paths qw/ bin_exe_raw /;
+
+my $MULTI_THREAD_SOLVER =
+    bin_exe_raw( ['freecell-solver-multi-thread-solve'] );
+
+{
+    my $output = `$MULTI_THREAD_SOLVER 1 3 1 --num-workers 2`;
+
+    # TEST
+    unlike( $output, qr{^Intractable}ms,
+        "The boards are solved without a memory cap" );
+}
+
+{
+    my $output = `$MULTI_THREAD_SOLVER 1 3 1 --num-workers 2 --memory-cap 1`;
+
+    # TEST
+    ok( !$?, "The solver with --memory-cap ran fine" );
+
+    foreach my $deal ( 1 .. 3 )
+    {
+        # TEST*3
+        like(
+            $output,
+            qr{^Intractable Board No. \Q$deal\E}ms,
+            "Boards are marked as intractable once over the --memory-cap"
+        );
+    }
+
+    # TEST
+    like( $output, qr{^Finished at}ms, "All the workers finished" );
+}
+
+{
+    # Deal No. 9 takes millions of iterations, while each of the other deals
+    # takes well under a megabyte.
+    my $output =
+        `$MULTI_THREAD_SOLVER 1 10 1 --num-workers 2 --memory-cap 20000000`;
+
+    # TEST
+    ok( !$?, "The solver with a realistic --memory-cap ran fine" );
+
+    # TEST
+    like(
+        $output,
+        qr{^Intractable Board No\. 9 }ms,
+        "The board that holds the most memory is suspended"
+    );
+
+    # TEST
+    unlike(
+        $output,
+        qr{^(?:Intractable|Unsolved) Board No\. (?!9 )}ms,
+        "The other boards are solved while it grows"
+    );
+}
+__END__
+
+=head1 COPYRIGHT AND LICENSE
+
+This file is part of Freecell Solver. It is subject to the license terms in
+the COPYING.txt file found in the top-level directory of this distribution
+and at http://fc-solve.shlomifish.org/docs/distro/COPYING.html . No part of
+Freecell Solver, including this file, may be copied, modified, propagated,
+or distributed except according to the terms contained in the COPYING file.
+
+Copyright (c) 2026 Shlomi Fish
+
+=cut
@@ -0,0 +1,64 @@
+#!/usr/bin/perl
+
+use strict;
+use warnings;
+
+use Test::More tests => 4;
+use File::Temp         qw/ tempdir /;
+use String::ShellQuote qw/ shell_quote /;
+use FC_Solve::Paths qw/ $IS_WIN bin_exe_raw is_without_dbm samp_board /;
+
+SKIP:
+{
+    if ( is_without_dbm() || $IS_WIN )
+    {
+        Test::More::skip( "without the dbm fc_solvers or win32", 4 );
+    }
+
+    my $dir = tempdir( CLEANUP => 1 );
+    mkdir("$dir/out");
+    mkdir("$dir/offload");
+    my $cmd = shell_quote(
+        bin_exe_raw( ['split_fcc_fc_solver'] ),
+        '--coordinate', '--num-workers', 2, '--num-threads', 1,
+        '--board', samp_board('2freecells-24-mid-with-colons.board'),
+        '--output', "$dir/out", '--offload-dir-path', "$dir/offload",
+        '--dbm-store-path', "$dir/store",
+    );
+    my $output = `$cmd`;
+
+    # TEST
+    ok( !$?, "split_fcc_fc_solver --coordinate exited successfully" );
+
+    # TEST
+    like(
+        $output,
+        qr{^Coordinator: FCCs solved: 2 ;}ms,
+        "The workers solved more than one FCC",
+    );
+
+    # TEST
+    like(
+        $output,
+        qr{^Coordinator: Success after solving [0-9]+ FCCs\.$}ms,
+        "The board was solved by the coordinated workers",
+    );
+
+    # TEST
+    is_deeply( [ glob("$dir/store.*") ],
+        [], "The stores of the FCCs were removed after solving them" );
+}
+
+__END__
+
+=head1 COPYRIGHT AND LICENSE
+
+This file is part of Freecell Solver. It is subject to the license terms in
+the COPYING.txt file found in the top-level directory of this distribution
+and at http://fc-solve.shlomifish.org/docs/distro/COPYING.html . No part of
+Freecell Solver, including this file, may be copied, modified, propagated,
+or distributed except according to the terms contained in the COPYING file.
+
+Copyright (c) 2026 Shlomi Fish
+
+=cut
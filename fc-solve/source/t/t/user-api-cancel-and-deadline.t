@@ -0,0 +1,214 @@
+#!/usr/bin/perl
+
+use strict;
+use warnings;
+
+use Test::More;
+use FC_Solve::Paths qw/ $IS_WIN is_freecell_only is_tag /;
+
+BEGIN
+{
+    if ( $IS_WIN || is_freecell_only() )
+    {
+        plan skip_all => "win32 or freecell-only";
+    }
+    elsif ( is_tag('FCS_WITHOUT_EXPORTED_RESUME_SOLUTION') )
+    {
+        plan skip_all => "FCS_WITHOUT_EXPORTED_RESUME_SOLUTION";
+    }
+    plan tests => 7;
+}
+
+package CancelTest;
+
+use FC_Solve::InlineWrap (
+    C => <<'EOF',
+#include "rinutils/unused.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <time.h>
+#include "freecell-solver/fcs_user.h"
+
+typedef struct
+{
+    void *instance;
+    bool started, cancelled;
+} cancel_context;
+
+// Keeps the solving in its first iteration until the other thread requested
+// the cancellation, so the request arrives in the middle of the solving.
+static void wait_for_cancel(void *const user_instance GCC_UNUSED,
+    const fcs_int_limit_t iter_num GCC_UNUSED, const int depth GCC_UNUSED,
+    void *const ptr_state GCC_UNUSED,
+    const fcs_int_limit_t parent_iter_num GCC_UNUSED, void *const context_ptr)
+{
+    cancel_context *const context = (cancel_context *)context_ptr;
+    if (context->started)
+    {
+        return;
+    }
+    __atomic_store_n(&(context->started), true, __ATOMIC_RELEASE);
+    while (!__atomic_load_n(&(context->cancelled), __ATOMIC_ACQUIRE))
+    {
+    }
+}
+
+static void *cancel_thread(void *const context_ptr)
+{
+    cancel_context *const context = (cancel_context *)context_ptr;
+    while (!__atomic_load_n(&(context->started), __ATOMIC_ACQUIRE))
+    {
+    }
+    freecell_solver_user_request_cancel(context->instance);
+    __atomic_store_n(&(context->cancelled), true, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static void *new_instance(void)
+{
+    void *const instance = freecell_solver_user_alloc();
+    freecell_solver_user_apply_preset(instance, "bakers_game");
+    return instance;
+}
+
+// Solves the board, resuming it once if it was suspended, and fills in the
+// return codes and the iterations counts of both calls.
+static void solve_and_resume(
+    void *const instance, const char *const board, long *const results)
+{
+    results[0] = freecell_solver_user_solve_board(instance, board);
+    results[1] = (long)freecell_solver_user_get_num_times_long(instance);
+    freecell_solver_user_set_deadline(instance, 0);
+    results[2] = ((results[0] == FCS_STATE_SUSPEND_PROCESS)
+                      ? freecell_solver_user_resume_solution(instance)
+                      : results[0]);
+    results[3] = (long)freecell_solver_user_get_num_times_long(instance);
+    freecell_solver_user_free(instance);
+}
+
+static void solve_with_expired_deadline__proto(
+    const char *const board, long *const results)
+{
+    void *const instance = new_instance();
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    freecell_solver_user_set_deadline(
+        instance, (long long)now.tv_sec * 1000000000LL + now.tv_nsec);
+    solve_and_resume(instance, board, results);
+}
+
+static void solve_cancelled_from_thread__proto(
+    const char *const board, long *const results)
+{
+    cancel_context context = {
+        .instance = new_instance(), .started = false, .cancelled = false};
+    freecell_solver_user_set_iter_handler_long(
+        context.instance, wait_for_cancel, &context);
+    pthread_t thread;
+    pthread_create(&thread, NULL, cancel_thread, &context);
+    solve_and_resume(context.instance, board, results);
+    pthread_join(thread, NULL);
+}
+
+static void solve_uninterrupted__proto(
+    const char *const board, long *const results)
+{
+    solve_and_resume(new_instance(), board, results);
+}
+
+static SV *results_as_array_ref(const long *const results)
+{
+    AV *const ret = newAV();
+    for (int i = 0; i < 4; ++i)
+    {
+        av_push(ret, newSViv(results[i]));
+    }
+    return newRV_noinc((SV *)ret);
+}
+
+SV *solve_uninterrupted(char *board)
+{
+    long results[4];
+    solve_uninterrupted__proto(board, results);
+    return results_as_array_ref(results);
+}
+
+SV *solve_with_expired_deadline(char *board)
+{
+    long results[4];
+    solve_with_expired_deadline__proto(board, results);
+    return results_as_array_ref(results);
+}
+
+SV *solve_cancelled_from_thread(char *board)
+{
+    long results[4];
+    solve_cancelled_from_thread__proto(board, results);
+    return results_as_array_ref(results);
+}
+EOF
+    l => '-lfreecell-solver -lpthread',
+);
+
+package main;
+
+# The values of FCS_STATE_IS_NOT_SOLVEABLE and FCS_STATE_SUSPEND_PROCESS.
+my $IS_NOT_SOLVEABLE = 1;
+my $SUSPEND_PROCESS  = 5;
+
+# MS deal No. 10, which is not solvable in Baker's Game.
+my $BOARD = <<'EOF';
+5S KD JC TS 9D KH 8D
+5H 2S 9H 7H TD AD 6D
+6H QD 6C TC AH 8S TH
+6S 2D 7C QC QS 7D 3H
+5D AS 7S KC 3D AC
+4D 9C QH 4H 4C 5C
+2H 3S 8H 9S JS 4S
+JH JD 3C KS 2C 8C
+EOF
+
+my ( undef, undef, $plain_ret, $plain_iters ) =
+    @{ CancelTest::solve_uninterrupted($BOARD) };
+
+# TEST
+is( $plain_ret, $IS_NOT_SOLVEABLE, "The board is fully traversed" );
+
+foreach my $rec (
+    [ "An expired deadline", \&CancelTest::solve_with_expired_deadline ],
+    [
+        "A cancellation from another thread",
+        \&CancelTest::solve_cancelled_from_thread
+    ],
+    )
+{
+    my ( $name, $cb ) = @$rec;
+    my ( $ret, $iters, $resumed_ret, $resumed_iters ) = @{ $cb->($BOARD) };
+
+    # TEST*2
+    is( $ret, $SUSPEND_PROCESS, "$name suspends the solving" );
+
+    # TEST*2
+    cmp_ok( $iters, '<', $plain_iters, "$name suspends before the end" );
+
+    # TEST*2
+    is_deeply(
+        [ $resumed_ret, $resumed_iters ],
+        [ $IS_NOT_SOLVEABLE, $plain_iters ],
+        "$name - the resumed solving goes on to the end",
+    );
+}
+
+__END__
+
+=head1 COPYRIGHT AND LICENSE
+
+This file is part of Freecell Solver. It is subject to the license terms in
+the COPYING.txt file found in the top-level directory of this distribution
+and at http://fc-solve.shlomifish.org/docs/distro/COPYING.html . No part of
+Freecell Solver, including this file, may be copied, modified, propagated,
+or distributed except according to the terms contained in the COPYING file.
+
+Copyright (c) 2026 Shlomi Fish
+
+=cut
@@ -22,13 +22,18 @@ static void print_help(void)
 {
     printf("\n%s",
         "freecell-solver-multi-thread-solve start end print_step\n"
-        "   [--binary-output-to filename] [fc-solve Arguments...]\n"
+        "   [--num-workers n] [--worker-step step] [--variant variant_str]\n"
+        "   [--memory-cap bytes] [fc-solve Arguments...]\n"
         "\n"
         "Solves a sequence of boards from the Microsoft/Freecell Pro Deals\n"
         "\n"
         "start - the first board in the sequence\n"
         "end - the last board in the sequence (inclusive)\n"
-        "print_step - at which division to print a status line\n");
+        "print_step - at which division to print a status line\n"
+        "\n"
+        "--memory-cap bytes - suspend the worker that holds the most memory\n"
+        "    (whose board is reported as intractable) once the workers hold\n"
+        "    more than that many bytes altogether\n");
 }
 #endif
 
@@ -41,10 +46,11 @@ static char **context_argv;
 static int arg = 1, context_argc;
 #endif
 static fcs_iters_int total_num_iters = 0;
+static void *memory_budget = NULL;
 
 static void *worker_thread(void *const void_arg)
 {
-    fcs_state_string state_string;
+    fcs_pysol_board_string state_string;
     get_board__setup_string(state_string);
 #ifdef FCS_USE_PRECOMPILED_CMD_LINE_THEME
     void *const instance = simple_alloc_and_parse(0, NULL, 0);
@@ -52,6 +58,11 @@ static void *worker_thread(void *const void_arg)
     void *const instance =
         simple_alloc_and_parse(context_argc, context_argv, arg);
 #endif
+    range_solvers__apply_variant(instance);
+    if (memory_budget)
+    {
+        freecell_solver_user_set_memory_budget(instance, memory_budget);
+    }
     typeof(total_num_iters) total_num_iters_temp = 0;
     fc_solve_ms_deal_idx_type board_num;
     do
@@ -114,6 +125,16 @@ static inline int range_solvers_main(int argc, char *argv[], const int par__arg,
         {
             board_num_step = fcs_str2msdeal(param);
         }
+        else if ((param = TRY_P("--variant")))
+        {
+            range_solvers__set_variant(param);
+        }
+        else if ((param = TRY_P("--memory-cap")))
+        {
+            freecell_solver_memory_budget_free(memory_budget);
+            memory_budget =
+                freecell_solver_memory_budget_alloc((size_t)atoll(param));
+        }
         else
         {
             break;
@@ -146,6 +167,7 @@ static inline int range_solvers_main(int argc, char *argv[], const int par__arg,
         total_num_iters += num_iters[idx];
     }
     fc_solve_print_finished(total_num_iters);
+    freecell_solver_memory_budget_free(memory_budget);
 
     return 0;
 }
@@ -0,0 +1,138 @@
+// This file is part of Freecell Solver. It is subject to the license terms in
+// the COPYING.txt file found in the top-level directory of this distribution
+// and at http://fc-solve.shlomifish.org/docs/distro/COPYING.html . No part of
+// Freecell Solver, including this file, may be copied, modified, propagated,
+// or distributed except according to the terms contained in the COPYING file.
+//
+// Copyright (c) 2026 Shlomi Fish
+// trace_ring.h - a preallocated ring of fcs_trace_record's, to which the
+// scans append a record for every sample_step-th checked state. Only the
+// solving thread appends to it, and it overwrites the oldest records, so the
+// scans never wait. It may be read at the same time from another thread,
+// which drops the records that were overwritten while it copied them.
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "rinutils/alloc_wrap.h"
+#include "freecell-solver/fcs_user.h"
+
+typedef struct
+{
+    fcs_trace_record *records;
+    // The number of records minus 1, which is a power of 2 minus 1.
+    size_t mask;
+    // The number of records that were ever appended.
+    unsigned long long head;
+    fcs_iters_int sample_step, sample_countdown;
+} fcs_trace_ring;
+
+static inline void fc_solve_trace_ring_init(fcs_trace_ring *const ring)
+{
+    *ring = (fcs_trace_ring){.records = NULL,
+        .mask = 0,
+        .head = 0,
+        .sample_step = 1,
+        .sample_countdown = 1};
+}
+
+static inline void fc_solve_trace_ring_free(fcs_trace_ring *const ring)
+{
+    free(ring->records);
+    const_AUTO(sample_step, ring->sample_step);
+    fc_solve_trace_ring_init(ring);
+    ring->sample_step = ring->sample_countdown = sample_step;
+}
+
+// Keeps at least the last num_records records, or none if num_records is 0.
+// One slot more is allocated for the record that may be being written.
+static inline void fc_solve_trace_ring_resize(
+    fcs_trace_ring *const ring, const size_t num_records)
+{
+    fc_solve_trace_ring_free(ring);
+    if (!num_records)
+    {
+        return;
+    }
+    size_t capacity = 1;
+    while (capacity <= num_records)
+    {
+        capacity <<= 1;
+    }
+    ring->records = SMALLOC(ring->records, capacity);
+    ring->mask = capacity - 1;
+}
+
+static inline void fc_solve_trace_ring_set_sample_step(
+    fcs_trace_ring *const ring, const fcs_iters_int sample_step)
+{
+    ring->sample_step = ring->sample_countdown = sample_step;
+}
+
+static inline void fc_solve_trace_ring_sample(fcs_trace_ring *const ring,
+    const fcs_iters_int iter_num, const int depth,
+    const fcs_iters_int parent_iter_num, const void *const state,
+    const int soft_thread_id)
+{
+    if (--ring->sample_countdown)
+    {
+        return;
+    }
+    ring->sample_countdown = ring->sample_step;
+    const_AUTO(head, ring->head);
+    ring->records[head & ring->mask] = (fcs_trace_record){
+        .iter_num = (unsigned long long)iter_num,
+        .parent_iter_num = (unsigned long long)parent_iter_num,
+        .state_id = (unsigned long long)(uintptr_t)state,
+        .depth = depth,
+        .soft_thread_id = soft_thread_id};
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+// Copies at most max_num_records of the records from *cursor on to records,
+// skipping those that were already overwritten, and advances *cursor.
+// Returns the number of records that were copied.
+static inline size_t fc_solve_trace_ring_read(const fcs_trace_ring *const ring,
+    fcs_trace_record *const records, const size_t max_num_records,
+    unsigned long long *const cursor)
+{
+    if (!ring->records)
+    {
+        return 0;
+    }
+    const unsigned long long capacity = ring->mask + 1;
+    const unsigned long long head =
+        __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    unsigned long long start = min(*cursor, head);
+    if (head - start > capacity)
+    {
+        start = head - capacity;
+    }
+    const size_t num_records = (size_t)min(head - start, max_num_records);
+    for (size_t i = 0; i < num_records; ++i)
+    {
+        records[i] = ring->records[(start + i) & ring->mask];
+    }
+    *cursor = start + num_records;
+
+    // The record of index i is overwritten once the record of index
+    // i + capacity is appended, which may have begun when head reached it.
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    const unsigned long long new_head =
+        __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    const unsigned long long first_intact =
+        ((new_head >= capacity) ? (new_head - capacity + 1) : 0);
+    const size_t num_overwritten =
+        ((first_intact > start)
+                ? (size_t)min(first_intact - start, num_records)
+                : 0);
+    memmove(records, records + num_overwritten,
+        (num_records - num_overwritten) * sizeof(records[0]));
+    return num_records - num_overwritten;
+}
+
+#ifdef __cplusplus
+}
+#endif
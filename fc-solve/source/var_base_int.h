@@ -17,6 +17,7 @@ typedef unsigned __int128 var_base_int;
 #define FCS_var_base_int__set_ui(i, val) ((i) = (val))
 #define FCS_var_base_int__left_shift(i, shift) ((i) <<= (shift))
 #define FCS_var_base_int__add(i, diff) ((i) += (diff))
+#define FCS_var_base_int__add_ui(i, ul) ((i) += (ul))
 #define FCS_var_base_int__mod_div(i, i_mod, base)                              \
     (i_mod) = (i) % (base);                                                    \
     (i) /= (base)
@@ -36,6 +37,7 @@ typedef mpz_t var_base_int;
 #define FCS_var_base_int__set_ui(i, val) mpz_set_ui((i), (val))
 #define FCS_var_base_int__left_shift(i, shift) mpz_mul_2exp((i), (i), (shift))
 #define FCS_var_base_int__add(i, diff) mpz_add((i), (i), (diff))
+#define FCS_var_base_int__add_ui(i, ul) mpz_add_ui((i), (i), (ul))
 #define FCS_var_base_int__mod_div(i, i_mod, base)                              \
     mpz_fdiv_qr_ui(i, i_mod, i, base)
 #define FCS_var_base_int__get_ui(i) mpz_get_ui(i)
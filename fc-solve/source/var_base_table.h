@@ -0,0 +1,149 @@
+// This file is part of Freecell Solver. It is subject to the license terms in
+// the COPYING.txt file found in the top-level directory of this distribution
+// and at http://fc-solve.shlomifish.org/docs/distro/COPYING.html . No part of
+// Freecell Solver, including this file, may be copied, modified, propagated,
+// or distributed except according to the terms contained in the COPYING file.
+//
+// Copyright (c) 2026 Shlomi Fish
+// var_base_table.h - a precomputed layout for writing and reading a fixed
+// sequence of variable base digits.
+//
+// The digits are grouped into chunks whose combined base fits inside an
+// unsigned long, and the place value of every digit inside its chunk is
+// precomputed. Writing or reading a digit is then a single machine word
+// operation, and the var_base_int arithmetic is only needed to combine or
+// split the few chunks. The resulting number (and so the exported bytes) is
+// identical to the one produced by fcs_var_base_writer.
+#pragma once
+
+#include <limits.h>
+#include <string.h>
+#include "var_base_writer.h"
+#include "var_base_reader.h"
+
+#define FCS_VAR_BASE_TABLE_MAX_DIGITS 64
+#define FCS_VAR_BASE_TABLE_MAX_CHUNKS 8
+
+typedef unsigned long fcs_var_base_chunk;
+
+typedef struct
+{
+    size_t num_digits, num_chunks;
+    unsigned char bases[FCS_VAR_BASE_TABLE_MAX_DIGITS];
+    unsigned char chunk_of_digit[FCS_VAR_BASE_TABLE_MAX_DIGITS];
+    fcs_var_base_chunk place_values[FCS_VAR_BASE_TABLE_MAX_DIGITS];
+    fcs_var_base_chunk chunk_bases[FCS_VAR_BASE_TABLE_MAX_CHUNKS];
+} fcs_var_base_table;
+
+static inline void fc_solve_var_base_table_init(fcs_var_base_table *const table)
+{
+    table->num_digits = 0;
+    table->num_chunks = 1;
+    table->chunk_bases[0] = 1;
+}
+
+static inline void fc_solve_var_base_table_add_digit(
+    fcs_var_base_table *const table, const unsigned long base)
+{
+    assert(table->num_digits < FCS_VAR_BASE_TABLE_MAX_DIGITS);
+    assert((base >= 2) && (base <= UCHAR_MAX));
+
+    size_t chunk = table->num_chunks - 1;
+    if (table->chunk_bases[chunk] > ULONG_MAX / base)
+    {
+        assert(table->num_chunks < FCS_VAR_BASE_TABLE_MAX_CHUNKS);
+        chunk = table->num_chunks++;
+        table->chunk_bases[chunk] = 1;
+    }
+    const size_t digit_idx = table->num_digits++;
+    table->bases[digit_idx] = (unsigned char)base;
+    table->chunk_of_digit[digit_idx] = (unsigned char)chunk;
+    table->place_values[digit_idx] = table->chunk_bases[chunk];
+    table->chunk_bases[chunk] *= base;
+}
+
+typedef struct
+{
+    size_t digit_idx;
+    fcs_var_base_chunk chunks[FCS_VAR_BASE_TABLE_MAX_CHUNKS];
+    fcs_var_base_writer w;
+} fcs_var_base_table_writer;
+
+#define fc_solve_var_base_table_writer_init(s)                                 \
+    fc_solve_var_base_writer_init(&((s)->w))
+#define fc_solve_var_base_table_writer_release(s)                              \
+    fc_solve_var_base_writer_release(&((s)->w))
+
+static inline void fc_solve_var_base_table_writer_start(
+    fcs_var_base_table_writer *const w)
+{
+    w->digit_idx = 0;
+    memset(w->chunks, '\0', sizeof(w->chunks));
+}
+
+static inline void fc_solve_var_base_table_writer_write(
+    fcs_var_base_table_writer *const w, const fcs_var_base_table *const table,
+    const unsigned long base GCC_UNUSED, const unsigned long item)
+{
+    const size_t digit_idx = w->digit_idx++;
+    assert(digit_idx < table->num_digits);
+    assert(base == table->bases[digit_idx]);
+    assert(item < base);
+    w->chunks[table->chunk_of_digit[digit_idx]] +=
+        table->place_values[digit_idx] * item;
+}
+
+static inline size_t fc_solve_var_base_table_writer_get_data(
+    fcs_var_base_table_writer *const w, const fcs_var_base_table *const table,
+    unsigned char *const exported)
+{
+    // Horner's rule, starting from the most significant chunk.
+    FCS_var_base_int__set_ui(w->w.data, 0);
+    for (size_t chunk = table->num_chunks; chunk-- > 0;)
+    {
+        FCS_var_base_int__mul_ui(w->w.data, table->chunk_bases[chunk]);
+        FCS_var_base_int__add_ui(w->w.data, w->chunks[chunk]);
+    }
+
+    return fc_solve_var_base_writer_get_data(&(w->w), exported);
+}
+
+typedef struct
+{
+    size_t digit_idx;
+    fcs_var_base_chunk chunks[FCS_VAR_BASE_TABLE_MAX_CHUNKS];
+    fcs_var_base_reader r;
+} fcs_var_base_table_reader;
+
+#define fc_solve_var_base_table_reader_init(s)                                 \
+    fc_solve_var_base_reader_init(&((s)->r))
+#define fc_solve_var_base_table_reader_release(s)                              \
+    fc_solve_var_base_reader_release(&((s)->r))
+
+static inline void fc_solve_var_base_table_reader_start(
+    fcs_var_base_table_reader *const r, const fcs_var_base_table *const table,
+    const unsigned char *const data, const size_t data_len)
+{
+    fc_solve_var_base_reader_start(&(r->r), data, data_len);
+    for (size_t chunk = 0; chunk < table->num_chunks; ++chunk)
+    {
+        r->chunks[chunk] =
+            fc_solve_var_base_reader_read(&(r->r), table->chunk_bases[chunk]);
+    }
+    r->digit_idx = 0;
+}
+
+static inline unsigned long fc_solve_var_base_table_reader_read(
+    fcs_var_base_table_reader *const r, const fcs_var_base_table *const table,
+    const unsigned long base)
+{
+    const size_t digit_idx = r->digit_idx++;
+    assert(digit_idx < table->num_digits);
+    assert(base == table->bases[digit_idx]);
+    fcs_var_base_chunk *const chunk =
+        &(r->chunks[table->chunk_of_digit[digit_idx]]);
+    const unsigned long ret = (*chunk) % base;
+    (*chunk) /= base;
+
+    return ret;
+}